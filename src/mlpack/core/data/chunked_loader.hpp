@@ -0,0 +1,177 @@
+/**
+ * @file chunked_loader.hpp
+ *
+ * Load a matrix from file a block of points at a time, for datasets which are
+ * too large to hold in memory.
+ */
+#ifndef __MLPACK_CORE_DATA_CHUNKED_LOADER_HPP
+#define __MLPACK_CORE_DATA_CHUNKED_LOADER_HPP
+
+#include <mlpack/core/util/log.hpp>
+#include <mlpack/core/arma_extend/arma_extend.hpp> // Includes Armadillo.
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "mapped_file.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * ChunkedLoader reads a dataset from file in blocks of (at most) a fixed number
+ * of points, so that only one block has to be held in memory at a time.  The
+ * blocks, put side by side, are exactly the matrix that data::Load() would
+ * load with transposition enabled: each point is a column, even though the
+ * files store one point per row.  The transposition is done as each block is
+ * read, so the untransposed matrix is never built.
+ *
+ * The supported types of files are:
+ *
+ *  - CSV (csv_ascii), denoted by .csv, or optionally .txt
+ *  - ASCII (raw_ascii), denoted by .txt
+ *  - Armadillo ASCII (arma_ascii), also denoted by .txt
+ *  - Raw binary (raw_binary), denoted by .bin
+ *  - Armadillo binary (arma_binary), denoted by .bin
+ *
+ * As with data::Load(), a raw binary file has no header holding its size, so
+ * its elements are read as one-dimensional points.  The binary formats can be
+ * read through a memory mapping of the file (see MappedFile), which avoids
+ * copying the file through a stream buffer; otherwise, they are read with
+ * ordinary stream reads.  Text formats are always read line by line.
+ *
+ * A typical use would be:
+ *
+ * @code
+ * data::ChunkedLoader<double> loader("dataset.csv", 10000);
+ * arma::mat chunk;
+ * while (loader.NextChunk(chunk))
+ * {
+ *   // Process the points in chunk.
+ * }
+ * @endcode
+ *
+ * @tparam eT Element type of the matrices to load.
+ */
+template<typename eT = double>
+class ChunkedLoader
+{
+ public:
+  /**
+   * Open the given file for chunked loading, guessing the filetype from the
+   * extension.  If the file cannot be opened, or its type cannot be
+   * determined, an error is given, and IsOpen() will return false.
+   *
+   * @param filename Name of file to load.
+   * @param chunkSize Maximum number of points in each chunk.
+   * @param fatal If an error should be reported as fatal (default false).
+   * @param mapped If true, binary files are memory-mapped instead of read
+   *     through a stream.
+   */
+  ChunkedLoader(const std::string& filename,
+                const size_t chunkSize,
+                const bool fatal = false,
+                const bool mapped = true);
+
+  //! Close the file.
+  ~ChunkedLoader();
+
+  /**
+   * Load the next chunk of points into the given matrix, which will be set to
+   * the dimensionality of the data by the number of points read (at most
+   * ChunkSize()).  If there are no points left, or an error occurs, false is
+   * returned and the matrix is left empty.
+   *
+   * @param chunk Matrix to load the points into.
+   * @return Whether or not any points were loaded.
+   */
+  bool NextChunk(arma::Mat<eT>& chunk);
+
+  //! Go back to the start of the file, so that the next chunk is the first.
+  void Reset();
+
+  //! Return whether or not the file is open and has had no errors.
+  bool IsOpen() const { return opened; }
+
+  //! Get the dimensionality of the points in the file.
+  size_t Dimensionality() const { return dimensionality; }
+  //! Get the number of points in the file, or 0 if it is not known (for CSV
+  //! and raw ASCII files, it is only known once the whole file is read).
+  size_t NumPoints() const { return numPoints; }
+  //! Get the number of points which have been loaded since the last Reset().
+  size_t PointsRead() const { return pointsRead; }
+
+  //! Get the maximum number of points in each chunk.
+  size_t ChunkSize() const { return chunkSize; }
+  //! Modify the maximum number of points in each chunk.
+  size_t& ChunkSize() { return chunkSize; }
+
+  //! Return whether or not the file is memory-mapped.
+  bool Mapped() const { return file != NULL; }
+
+ private:
+  //! ChunkedLoader objects may not be copied.
+  ChunkedLoader(const ChunkedLoader& other);
+  //! ChunkedLoader objects may not be copied.
+  ChunkedLoader& operator=(const ChunkedLoader& other);
+
+  //! Open an arma_binary or raw_binary file, after the type is known.
+  bool OpenBinary(const bool mapped);
+  //! Open a csv_ascii, raw_ascii, or arma_ascii file, after the type is known.
+  bool OpenText();
+
+  //! Read the next chunk from a binary file.
+  bool NextBinaryChunk(arma::Mat<eT>& chunk);
+  //! Read the next chunk from a text file.
+  bool NextTextChunk(arma::Mat<eT>& chunk);
+
+  /**
+   * Read the next non-empty line of a text file into nextPoint.  Returns false
+   * at the end of the file, or if the line could not be parsed (in which case
+   * an error is given and the loader is closed).
+   */
+  bool ReadLine();
+
+  //! Give an error, as a warning or a fatal error depending on 'fatal'.
+  void Error(const std::string& message);
+
+  //! Name of the file.
+  std::string filename;
+  //! Maximum number of points in each chunk.
+  size_t chunkSize;
+  //! If true, errors are fatal.
+  bool fatal;
+  //! Type of the file.
+  arma::file_type loadType;
+  //! Whether or not the file is open.
+  bool opened;
+
+  //! The stream, if the file is not memory-mapped.
+  std::ifstream stream;
+  //! The mapped file, if the file is memory-mapped.
+  MappedFile* file;
+  //! Offset of the first element (binary) or first point (text) in the file.
+  size_t dataOffset;
+
+  //! Dimensionality of the points.
+  size_t dimensionality;
+  //! Number of points in the file (0 if unknown).
+  size_t numPoints;
+  //! Number of points read since the last Reset().
+  size_t pointsRead;
+
+  //! For text files, the next point (which has already been parsed).
+  std::vector<eT> nextPoint;
+  //! For text files, whether or not nextPoint holds a point.
+  bool hasNextPoint;
+  //! For text files, the line number of nextPoint.
+  size_t lineNumber;
+};
+
+}; // namespace data
+}; // namespace mlpack
+
+// Include implementation.
+#include "chunked_loader_impl.hpp"
+
+#endif
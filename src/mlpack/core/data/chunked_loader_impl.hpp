@@ -0,0 +1,448 @@
+/**
+ * @file chunked_loader_impl.hpp
+ *
+ * Implementation of ChunkedLoader.
+ */
+#ifndef __MLPACK_CORE_DATA_CHUNKED_LOADER_IMPL_HPP
+#define __MLPACK_CORE_DATA_CHUNKED_LOADER_IMPL_HPP
+
+// In case it hasn't already been included.
+#include "chunked_loader.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace mlpack {
+namespace data {
+
+template<typename eT>
+ChunkedLoader<eT>::ChunkedLoader(const std::string& filename,
+                                 const size_t chunkSize,
+                                 const bool fatal,
+                                 const bool mapped) :
+    filename(filename),
+    chunkSize(chunkSize),
+    fatal(fatal),
+    loadType(arma::raw_binary),
+    opened(false),
+    file(NULL),
+    dataOffset(0),
+    dimensionality(0),
+    numPoints(0),
+    pointsRead(0),
+    hasNextPoint(false),
+    lineNumber(0)
+{
+  if (chunkSize == 0)
+  {
+    Error("Chunk size for loading '" + filename + "' must be greater than 0.");
+    return;
+  }
+
+  // First we will try to discriminate by file extension.
+  size_t ext = filename.rfind('.');
+  if (ext == std::string::npos)
+  {
+    Error("Cannot determine type of file '" + filename + "'; no extension is "
+        "present.");
+    return;
+  }
+
+  // Get the extension and force it to lowercase.
+  std::string extension = filename.substr(ext + 1);
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+      ::tolower);
+
+  // Catch nonexistent files by opening the stream ourselves.
+  stream.open(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+  {
+    Error("Cannot open file '" + filename + "'.");
+    return;
+  }
+
+  std::string stringType;
+  if (extension == "csv")
+  {
+    loadType = arma::csv_ascii;
+    stringType = "CSV data";
+  }
+  else if (extension == "txt")
+  {
+    // This could be raw ASCII, Armadillo ASCII, or CSV; this is the same check
+    // that data::Load() does.
+    const std::string ARMA_MAT_TXT = "ARMA_MAT_TXT";
+    std::string rawHeader(ARMA_MAT_TXT.length(), '\0');
+    stream.read(&rawHeader[0], std::streamsize(ARMA_MAT_TXT.length()));
+    stream.clear();
+    stream.seekg(0);
+
+    if (rawHeader == ARMA_MAT_TXT)
+    {
+      loadType = arma::arma_ascii;
+      stringType = "Armadillo ASCII formatted data";
+    }
+    else
+    {
+      loadType = arma::diskio::guess_file_type(stream);
+      stream.clear();
+      stream.seekg(0);
+
+      if (loadType == arma::raw_ascii)
+        stringType = "raw ASCII formatted data";
+      else if (loadType == arma::csv_ascii)
+        stringType = "CSV data";
+    }
+  }
+  else if (extension == "bin")
+  {
+    // This could be raw binary or Armadillo binary (binary with header).
+    const std::string ARMA_MAT_BIN = "ARMA_MAT_BIN";
+    std::string rawHeader(ARMA_MAT_BIN.length(), '\0');
+    stream.read(&rawHeader[0], std::streamsize(ARMA_MAT_BIN.length()));
+    stream.clear();
+    stream.seekg(0);
+
+    if (rawHeader == ARMA_MAT_BIN)
+    {
+      loadType = arma::arma_binary;
+      stringType = "Armadillo binary formatted data";
+    }
+    else
+    {
+      loadType = arma::raw_binary;
+      stringType = "raw binary formatted data";
+    }
+  }
+
+  if (stringType == "")
+  {
+    Error("Unable to detect type of '" + filename + "' for chunked loading; "
+        "incorrect extension?");
+    return;
+  }
+
+  if (loadType == arma::raw_binary)
+    Log::Warn << "Loading '" << filename << "' as " << stringType << "; "
+        << "but this may not be the actual filetype!" << std::endl;
+
+  if (loadType == arma::arma_binary || loadType == arma::raw_binary)
+    opened = OpenBinary(mapped);
+  else
+    opened = OpenText();
+}
+
+template<typename eT>
+ChunkedLoader<eT>::~ChunkedLoader()
+{
+  delete file;
+}
+
+template<typename eT>
+bool ChunkedLoader<eT>::NextChunk(arma::Mat<eT>& chunk)
+{
+  if (!opened)
+  {
+    chunk.set_size(dimensionality, 0);
+    return false;
+  }
+
+  if (loadType == arma::arma_binary || loadType == arma::raw_binary)
+    return NextBinaryChunk(chunk);
+  else
+    return NextTextChunk(chunk);
+}
+
+template<typename eT>
+void ChunkedLoader<eT>::Reset()
+{
+  if (!opened)
+    return;
+
+  pointsRead = 0;
+  if (loadType != arma::arma_binary && loadType != arma::raw_binary)
+  {
+    stream.clear();
+    stream.seekg(dataOffset);
+    lineNumber = 0;
+    hasNextPoint = ReadLine();
+  }
+}
+
+template<typename eT>
+bool ChunkedLoader<eT>::OpenBinary(const bool mapped)
+{
+  uint64_t fileSize;
+  stream.seekg(0, std::ios::end);
+  fileSize = (uint64_t) stream.tellg();
+  stream.seekg(0);
+
+  if (loadType == arma::arma_binary)
+  {
+    // The header is the same one that Armadillo writes: the type of the
+    // elements, then the number of rows and columns.
+    std::string header;
+    uint64_t fileRows, fileCols;
+    stream >> header >> fileRows >> fileCols;
+    stream.get();
+    if (!stream.good())
+    {
+      Error("Could not read the header of '" + filename + "'.");
+      return false;
+    }
+
+    if (header != arma::diskio::gen_bin_header(arma::Mat<eT>()))
+    {
+      Error("'" + filename + "' holds elements of a different type than the "
+          "matrix being loaded (header '" + header + "').");
+      return false;
+    }
+
+    dataOffset = (size_t) stream.tellg();
+    // The file holds one point per row; those become our columns.
+    numPoints = fileRows;
+    dimensionality = fileCols;
+  }
+  else
+  {
+    dataOffset = 0;
+    numPoints = fileSize / sizeof(eT);
+    dimensionality = 1;
+  }
+
+  if (dataOffset + numPoints * dimensionality * sizeof(eT) > fileSize)
+  {
+    Error("'" + filename + "' is truncated.");
+    return false;
+  }
+
+  if (mapped)
+  {
+    file = new MappedFile(filename);
+    if (!file->IsOpen())
+    {
+      // We can still read through the stream.
+      Log::Warn << "Could not memory-map '" << filename << "'; reading it as a "
+          << "stream instead." << std::endl;
+      delete file;
+      file = NULL;
+    }
+    else
+    {
+      stream.close();
+    }
+  }
+
+  return true;
+}
+
+template<typename eT>
+bool ChunkedLoader<eT>::OpenText()
+{
+  if (loadType == arma::arma_ascii)
+  {
+    std::string header;
+    size_t fileRows, fileCols;
+    stream >> header >> fileRows >> fileCols;
+    if (!stream.good())
+    {
+      Error("Could not read the header of '" + filename + "'.");
+      return false;
+    }
+
+    if (header != arma::diskio::gen_txt_header(arma::Mat<eT>()))
+    {
+      Error("'" + filename + "' holds elements of a different type than the "
+          "matrix being loaded (header '" + header + "').");
+      return false;
+    }
+
+    // Skip the rest of the header line.
+    std::string rest;
+    std::getline(stream, rest);
+
+    numPoints = fileRows;
+    dimensionality = fileCols;
+  }
+
+  dataOffset = (size_t) stream.tellg();
+
+  // Read the first point, which gives us the dimensionality if we don't have
+  // it already.
+  opened = true;
+  hasNextPoint = ReadLine();
+  if (!opened)
+    return false;
+
+  if (hasNextPoint && dimensionality == 0)
+    dimensionality = nextPoint.size();
+
+  return true;
+}
+
+template<typename eT>
+bool ChunkedLoader<eT>::NextBinaryChunk(arma::Mat<eT>& chunk)
+{
+  const size_t count = std::min(chunkSize, numPoints - pointsRead);
+  chunk.set_size(dimensionality, count);
+  if (count == 0)
+    return false;
+
+  // The file holds the untransposed matrix in column-major order, so dimension
+  // d of the points [begin, begin + count) is a contiguous run of elements.  We
+  // read each run in order and scatter it across a row of the chunk.
+  const size_t begin = pointsRead;
+  if (file != NULL)
+  {
+    const char* data = file->Data() + dataOffset;
+    for (size_t d = 0; d < dimensionality; ++d)
+    {
+      // The data may not be aligned (the arma_binary header has no fixed
+      // length), so the elements are copied bytewise.
+      const char* run = data + (d * numPoints + begin) * sizeof(eT);
+      for (size_t i = 0; i < count; ++i)
+        std::memcpy(chunk.colptr(i) + d, run + i * sizeof(eT), sizeof(eT));
+    }
+  }
+  else
+  {
+    // Read each run in pieces, so that the buffer stays small.
+    const size_t pieceSize = std::min(count, (size_t) 65536);
+    std::vector<eT> buffer(pieceSize);
+    for (size_t d = 0; d < dimensionality; ++d)
+    {
+      stream.seekg(dataOffset + (d * numPoints + begin) * sizeof(eT));
+      for (size_t i = 0; i < count; i += pieceSize)
+      {
+        const size_t length = std::min(pieceSize, count - i);
+        stream.read((char*) &buffer[0], length * sizeof(eT));
+        for (size_t j = 0; j < length; ++j)
+          chunk(d, i + j) = buffer[j];
+      }
+    }
+
+    if (!stream.good())
+    {
+      Error("Error reading from '" + filename + "'.");
+      opened = false;
+      chunk.set_size(dimensionality, 0);
+      return false;
+    }
+  }
+
+  pointsRead += count;
+  return true;
+}
+
+template<typename eT>
+bool ChunkedLoader<eT>::NextTextChunk(arma::Mat<eT>& chunk)
+{
+  if (!hasNextPoint)
+  {
+    chunk.set_size(dimensionality, 0);
+    return false;
+  }
+
+  // We don't know how many points are left, so the chunk is grown as needed
+  // (this way a very large chunk size doesn't allocate a very large matrix).
+  chunk.set_size(dimensionality, std::min(chunkSize, (size_t) 1024));
+  size_t count = 0;
+  while (count < chunkSize && hasNextPoint)
+  {
+    if (count == chunk.n_cols)
+      chunk.resize(dimensionality, std::min(chunkSize, 2 * chunk.n_cols));
+
+    for (size_t d = 0; d < dimensionality; ++d)
+      chunk(d, count) = nextPoint[d];
+    ++count;
+
+    hasNextPoint = ReadLine();
+  }
+
+  if (!opened)
+  {
+    chunk.set_size(dimensionality, 0);
+    return false;
+  }
+
+  if (count < chunk.n_cols)
+    chunk.resize(dimensionality, count);
+
+  pointsRead += count;
+  if (!hasNextPoint)
+    numPoints = pointsRead;
+
+  return true;
+}
+
+template<typename eT>
+bool ChunkedLoader<eT>::ReadLine()
+{
+  std::string line;
+  while (std::getline(stream, line))
+  {
+    ++lineNumber;
+
+    // Each value is separated by commas and/or whitespace.
+    nextPoint.clear();
+    const char* position = line.c_str();
+    while (true)
+    {
+      while (*position == ',' || *position == ' ' || *position == '\t' ||
+             *position == '\r')
+        ++position;
+      if (*position == '\0')
+        break;
+
+      char* end;
+      const double value = std::strtod(position, &end);
+      if (end == position)
+      {
+        std::ostringstream oss;
+        oss << "Could not parse line " << lineNumber << " of '" << filename
+            << "'.";
+        Error(oss.str());
+        opened = false;
+        return false;
+      }
+
+      nextPoint.push_back(eT(value));
+      position = end;
+    }
+
+    // Skip empty lines.
+    if (nextPoint.empty())
+      continue;
+
+    if (dimensionality != 0 && nextPoint.size() != dimensionality)
+    {
+      std::ostringstream oss;
+      oss << "Line " << lineNumber << " of '" << filename << "' has "
+          << nextPoint.size() << " values, but " << dimensionality << " were "
+          << "expected.";
+      Error(oss.str());
+      opened = false;
+      return false;
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+template<typename eT>
+void ChunkedLoader<eT>::Error(const std::string& message)
+{
+  if (fatal)
+    Log::Fatal << message << std::endl;
+  else
+    Log::Warn << message << "  Load failed." << std::endl;
+}
+
+}; // namespace data
+}; // namespace mlpack
+
+#endif
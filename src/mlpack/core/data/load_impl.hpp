@@ -11,8 +11,11 @@
 #include "load.hpp"
 
 #include <algorithm>
+#include <limits>
 #include <mlpack/core/util/timers.hpp>
 
+#include "chunked_loader.hpp"
+
 namespace mlpack {
 namespace data {
 
@@ -201,7 +204,33 @@ bool Load(const std::string& filename,
     Log::Info << "Loading '" << filename << "' as " << stringType << ".  "
         << std::flush;
 
-  const bool success = matrix.load(stream, loadType);
+  bool success;
+  bool transposed = false;
+  if (transpose && loadType == arma::arma_binary)
+  {
+    // Armadillo binary files can be read straight into the transposed matrix,
+    // so the untransposed matrix (which would double the memory used) is never
+    // built.
+    stream.close();
+    ChunkedLoader<eT> loader(filename, std::numeric_limits<size_t>::max(),
+        false, false);
+    if (loader.IsOpen() && !loader.NextChunk(matrix))
+      matrix.set_size(loader.Dimensionality(), 0);
+    success = loader.IsOpen();
+    transposed = true;
+  }
+  else
+  {
+    success = matrix.load(stream, loadType);
+
+    // A raw binary file is loaded as a single column, so transposing it is
+    // only a change of shape.
+    if (success && transpose && loadType == arma::raw_binary)
+    {
+      arma::inplace_reshape(matrix, 1, matrix.n_elem);
+      transposed = true;
+    }
+  }
 
   if (!success)
   {
@@ -214,12 +243,15 @@ bool Load(const std::string& filename,
 
     return false;
   }
+  else if (transposed)
+    Log::Info << "Size is " << matrix.n_rows << " x " << matrix.n_cols
+        << ".\n";
   else
     Log::Info << "Size is " << (transpose ? matrix.n_cols : matrix.n_rows)
         << " x " << (transpose ? matrix.n_rows : matrix.n_cols) << ".\n";
 
   // Now transpose the matrix, if necessary.
-  if (transpose)
+  if (transpose && !transposed)
     matrix = trans(matrix);
 
   Timer::Stop("loading_data");
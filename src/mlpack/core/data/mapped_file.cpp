@@ -0,0 +1,90 @@
+/**
+ * @file mapped_file.cpp
+ *
+ * Implementation of MappedFile.
+ */
+#include "mapped_file.hpp"
+
+#include <fstream>
+
+#ifndef _WIN32
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+using namespace mlpack;
+using namespace mlpack::data;
+
+MappedFile::MappedFile(const std::string& filename) :
+    data(NULL),
+    size(0),
+    opened(false)
+{
+#ifndef _WIN32
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1)
+    return;
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) == -1)
+  {
+    close(fd);
+    return;
+  }
+
+  opened = true;
+  size = (size_t) fileStat.st_size;
+  if (size > 0)
+  {
+    // A private mapping is copy-on-write, so callers may modify the memory
+    // without changing the file.
+    void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd,
+        0);
+    if (mapping == MAP_FAILED)
+    {
+      opened = false;
+      size = 0;
+    }
+    else
+    {
+      data = (char*) mapping;
+    }
+  }
+
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+#else
+  std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+    return;
+
+  stream.seekg(0, std::ios::end);
+  size = (size_t) stream.tellg();
+  stream.seekg(0, std::ios::beg);
+  opened = true;
+
+  if (size > 0)
+  {
+    // Holding the contents in a vector of doubles keeps them aligned.
+    buffer.resize((size + sizeof(double) - 1) / sizeof(double));
+    data = (char*) &buffer[0];
+    if (!stream.read(data, size))
+    {
+      data = NULL;
+      opened = false;
+      size = 0;
+      buffer.clear();
+    }
+  }
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifndef _WIN32
+  if (data != NULL)
+    munmap(data, size);
+#endif
+}
@@ -0,0 +1,69 @@
+/**
+ * @file mapped_file.hpp
+ *
+ * A view of the contents of a file, which is memory-mapped where the platform
+ * supports it.
+ */
+#ifndef __MLPACK_CORE_DATA_MAPPED_FILE_HPP
+#define __MLPACK_CORE_DATA_MAPPED_FILE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <string>
+#include <vector>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * MappedFile gives access to the contents of a file without reading it up
+ * front.  On POSIX systems, the file is memory-mapped (privately, so writes to
+ * the memory are never written back to the file); elsewhere, the file is read
+ * into memory in its entirety.  Either way, Data() points to the first byte of
+ * the file, and is aligned at least as strictly as a double.
+ *
+ * The mapping is released when the object is destroyed, so any matrices which
+ * alias the memory must not outlive the MappedFile.
+ */
+class MappedFile
+{
+ public:
+  /**
+   * Map the given file.  If the file cannot be opened or mapped, IsOpen() will
+   * return false.
+   *
+   * @param filename Name of file to map.
+   */
+  MappedFile(const std::string& filename);
+
+  //! Release the mapping.
+  ~MappedFile();
+
+  //! Return whether or not the file was successfully mapped.
+  bool IsOpen() const { return opened; }
+
+  //! Get the contents of the file.
+  char* Data() const { return data; }
+
+  //! Get the size of the file, in bytes.
+  size_t Size() const { return size; }
+
+ private:
+  //! MappedFile objects may not be copied.
+  MappedFile(const MappedFile& other);
+  //! MappedFile objects may not be copied.
+  MappedFile& operator=(const MappedFile& other);
+
+  //! The contents of the file.
+  char* data;
+  //! The size of the file.
+  size_t size;
+  //! Whether or not the file was opened.
+  bool opened;
+  //! If the file could not be mapped, this holds its contents.
+  std::vector<double> buffer;
+};
+
+}; // namespace data
+}; // namespace mlpack
+
+#endif
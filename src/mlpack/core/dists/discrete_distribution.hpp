@@ -104,6 +104,26 @@ class DiscreteDistribution
     return probabilities(obs);
   }
 
+  /**
+   * Calculate the log-probability of each observation (column) in the given
+   * matrix.  As with Probability(), bounds checking is not performed.
+   *
+   * @param observations List of observations.
+   * @param logProbabilities Output log-probabilities for each observation.
+   */
+  void LogProbability(const arma::mat& observations,
+                      arma::vec& logProbabilities) const
+  {
+    logProbabilities.set_size(observations.n_cols);
+    for (size_t i = 0; i < observations.n_cols; ++i)
+    {
+      // Adding 0.5 helps ensure that we cast the floating point to a size_t
+      // correctly.
+      const size_t obs = size_t(observations(0, i) + 0.5);
+      logProbabilities[i] = std::log(probabilities(obs));
+    }
+  }
+
   /**
    * Return a randomly generated observation (one-dimensional vector; one
    * observation) according to the probability distribution defined by this
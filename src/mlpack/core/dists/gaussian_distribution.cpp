@@ -11,33 +11,108 @@ using namespace mlpack;
 using namespace mlpack::distribution;
 
 /**
- * Calculates the multivariate Gaussian probability density function for each
- * data point (column) in the given matrix, with respect to the given mean and
- * variance.
+ * Return the log-probability of the given observation.
+ */
+double GaussianDistribution::LogProbability(const arma::vec& observation) const
+{
+  // With covariance = L * L^T, the exponent is -0.5 * || L^-1 (x - mean) ||^2.
+  const arma::vec z = arma::solve(arma::trimatl(covLower), observation - mean);
+
+  return -0.5 * observation.n_elem * std::log(2 * M_PI) - 0.5 * logDetCov -
+      0.5 * arma::dot(z, z);
+}
+
+/**
+ * Calculates the multivariate Gaussian log probability density function for
+ * each data point (column) in the given matrix.
  *
  * @param x List of observations.
- * @param mean Mean of multivariate Gaussian.
- * @param cov Covariance of multivariate Gaussian.
- * @param probabilities Output probabilities for each input observation.
+ * @param logProbabilities Output log probabilities for each input observation.
  */
-
-double GaussianDistribution::Probability(const arma::vec& observation) const
+void GaussianDistribution::LogProbability(const arma::mat& x,
+                                          arma::vec& logProbabilities) const
 {
-  arma::vec diff = mean - observation;
+  // Column i of 'diffs' is the difference between x.col(i) and the mean.
+  arma::mat diffs = x;
+  diffs.each_col() -= mean;
 
-  arma::vec exponent = -0.5 * (trans(diff) * inv(covariance) * diff);
+  // We only want the diagonal elements of (diffs' * cov^-1 * diffs), which are
+  // the squared norms of the columns of L^-1 * diffs.  One triangular solve
+  // handles all the points.
+  const arma::mat z = arma::solve(arma::trimatl(covLower), diffs);
 
-  // TODO: What if det(cov) < 0?
-  return pow(2 * M_PI, (double) observation.n_elem / -2.0) *
-      pow(det(covariance), -0.5) * exp(exponent[0]);
+  logProbabilities = -0.5 * arma::trans(arma::sum(z % z, 0));
+  logProbabilities += -0.5 * x.n_rows * std::log(2 * M_PI) - 0.5 * logDetCov;
 }
 
+arma::vec GaussianDistribution::Random() const
+{
+  return covLower * arma::randn<arma::vec>(mean.n_elem) + mean;
+}
 
+/**
+ * Set the covariance and factorize it.
+ */
+void GaussianDistribution::Covariance(const arma::mat& covariance)
+{
+  this->covariance = covariance;
+  FactorCovariance();
+}
 
-arma::vec GaussianDistribution::Random() const
+/**
+ * Compute the Cholesky factor and log-determinant of the covariance.
+ */
+void GaussianDistribution::FactorCovariance()
 {
-  // Should we store chol(covariance) for easier calculation later?
-  return trans(chol(covariance)) * arma::randn<arma::vec>(mean.n_elem) + mean;
+  if (covariance.n_elem == 0)
+  {
+    covLower.reset();
+    logDetCov = 0.0;
+    return;
+  }
+
+  if (!covariance.is_finite())
+  {
+    Log::Debug << "GaussianDistribution::FactorCovariance(): covariance is not "
+        << "finite." << std::endl;
+    covLower.set_size(covariance.n_rows, covariance.n_cols);
+    covLower.fill(arma::datum::nan);
+    logDetCov = arma::datum::nan;
+    return;
+  }
+
+  // arma::chol() gives the upper-triangular factor.
+  arma::mat covUpper;
+  if (!arma::chol(covUpper, covariance))
+  {
+    // The covariance is not positive definite, but it may be nearly so (for
+    // instance, if the points only barely span the space).  Perturb the
+    // diagonal of a copy until it can be factorized.  The perturbation grows
+    // geometrically, so this ends once it is larger than the magnitude of the
+    // most negative eigenvalue.
+    Log::Debug << "GaussianDistribution::FactorCovariance(): covariance is not "
+        << "positive definite.  Adding perturbation." << std::endl;
+
+    arma::mat perturbed = covariance;
+    double perturbation = 1e-30;
+    do
+    {
+      if (perturbation > 1e300)
+      {
+        // This can only happen if the elements are close to overflowing.
+        covLower.set_size(covariance.n_rows, covariance.n_cols);
+        covLower.fill(arma::datum::nan);
+        logDetCov = arma::datum::nan;
+        return;
+      }
+
+      perturbed.diag() += perturbation;
+      perturbation *= 10; // Slow, but we don't want to add too much.
+    } while (!arma::chol(covUpper, perturbed));
+  }
+
+  covLower = arma::trans(covUpper);
+  logDetCov = 2.0 * arma::accu(arma::log(covLower.diag()));
 }
 
 /**
@@ -56,6 +131,7 @@ void GaussianDistribution::Estimate(const arma::mat& observations)
   {
     mean.zeros(0);
     covariance.zeros(0);
+    FactorCovariance();
     return;
   }
 
@@ -77,19 +153,8 @@ void GaussianDistribution::Estimate(const arma::mat& observations)
   // that it is the unbiased estimator.
   covariance /= (observations.n_cols - 1);
 
-  // Ensure that the covariance is positive definite.
-  if (det(covariance) <= 1e-50)
-  {
-    Log::Debug << "GaussianDistribution::Estimate(): Covariance matrix is not "
-        << "positive definite. Adding perturbation." << std::endl;
-
-    double perturbation = 1e-30;
-    while (det(covariance) <= 1e-50)
-    {
-      covariance.diag() += perturbation;
-      perturbation *= 10; // Slow, but we don't want to add too much.
-    }
-  }
+  // FactorCovariance() handles a covariance that is not positive definite.
+  FactorCovariance();
 }
 
 /**
@@ -109,6 +174,7 @@ void GaussianDistribution::Estimate(const arma::mat& observations,
   {
     mean.zeros(0);
     covariance.zeros(0);
+    FactorCovariance();
     return;
   }
 
@@ -127,6 +193,7 @@ void GaussianDistribution::Estimate(const arma::mat& observations,
     // Nothing in this Gaussian!  At least set the covariance so that it's
     // invertible.
     covariance.diag() += 1e-50;
+    FactorCovariance();
     return;
   }
 
@@ -143,19 +210,8 @@ void GaussianDistribution::Estimate(const arma::mat& observations,
   // This is probably biased, but I don't know how to unbias it.
   covariance /= sumProb;
 
-  // Ensure that the covariance is positive definite.
-  if (det(covariance) <= 1e-50)
-  {
-    Log::Debug << "GaussianDistribution::Estimate(): Covariance matrix is not "
-        << "positive definite. Adding perturbation." << std::endl;
-
-    double perturbation = 1e-30;
-    while (det(covariance) <= 1e-50)
-    {
-      covariance.diag() += perturbation;
-      perturbation *= 10; // Slow, but we don't want to add too much.
-    }
-  }
+  // FactorCovariance() handles a covariance that is not positive definite.
+  FactorCovariance();
 }
 
 /**
@@ -193,4 +249,5 @@ void GaussianDistribution::Load(const util::SaveRestoreUtility& sr)
 {
   sr.LoadParameter(mean, "mean");
   sr.LoadParameter(covariance, "covariance");
+  FactorCovariance();
 }
@@ -23,12 +23,18 @@ class GaussianDistribution
   arma::vec mean;
   //! Covariance of the distribution.
   arma::mat covariance;
+  //! Lower-triangular Cholesky factor of the covariance (covariance = covLower
+  //! * covLower^T).  If the covariance is not positive definite, this is the
+  //! factor of the covariance with a small perturbation added to its diagonal.
+  arma::mat covLower;
+  //! Log-determinant of the covariance.
+  double logDetCov;
 
  public:
   /**
    * Default constructor, which creates a Gaussian with zero dimension.
    */
-  GaussianDistribution() { /* nothing to do */ }
+  GaussianDistribution() : logDetCov(0.0) { /* nothing to do */ }
 
   /**
    * Create a Gaussian distribution with zero mean and identity covariance with
@@ -36,14 +42,19 @@ class GaussianDistribution
    */
   GaussianDistribution(const size_t dimension) :
       mean(arma::zeros<arma::vec>(dimension)),
-      covariance(arma::eye<arma::mat>(dimension, dimension))
+      covariance(arma::eye<arma::mat>(dimension, dimension)),
+      covLower(arma::eye<arma::mat>(dimension, dimension)),
+      logDetCov(0.0)
   { /* Nothing to do. */ }
 
   /**
    * Create a Gaussian distribution with the given mean and covariance.
    */
   GaussianDistribution(const arma::vec& mean, const arma::mat& covariance) :
-      mean(mean), covariance(covariance) { /* Nothing to do. */ }
+      mean(mean), covariance(covariance)
+  {
+    FactorCovariance();
+  }
 
   //! Return the dimensionality of this distribution.
   size_t Dimensionality() const { return mean.n_elem; }
@@ -51,8 +62,17 @@ class GaussianDistribution
   /**
    * Return the probability of the given observation.
    */
-  double Probability(const arma::vec& observation) const;
-  
+  double Probability(const arma::vec& observation) const
+  {
+    return std::exp(LogProbability(observation));
+  }
+
+  /**
+   * Return the log-probability of the given observation.  This uses the cached
+   * Cholesky factor of the covariance, so it costs one triangular solve.
+   */
+  double LogProbability(const arma::vec& observation) const;
+
   /**
    * Calculates the multivariate Gaussian probability density function for each
    * data point (column) in the given matrix
@@ -60,8 +80,25 @@ class GaussianDistribution
    * @param x List of observations.
    * @param probabilities Output probabilities for each input observation.
    */
-  void Probability(const arma::mat& x, arma::vec& probabilities) const;
-  
+  void Probability(const arma::mat& x, arma::vec& probabilities) const
+  {
+    LogProbability(x, probabilities);
+    probabilities = arma::exp(probabilities);
+  }
+
+  /**
+   * Calculates the multivariate Gaussian log probability density function for
+   * each data point (column) in the given matrix.  All of the points are
+   * handled with a single triangular solve against the cached Cholesky factor
+   * of the covariance.  Working in log-space avoids the underflow that
+   * Probability() suffers from in high dimensions.
+   *
+   * @param x List of observations.
+   * @param logProbabilities Output log probabilities for each input
+   *     observation.
+   */
+  void LogProbability(const arma::mat& x, arma::vec& logProbabilities) const;
+
   /**
    * Return a randomly generated observation according to the probability
    * distribution defined by this object.
@@ -101,9 +138,19 @@ class GaussianDistribution
   const arma::mat& Covariance() const { return covariance; }
 
   /**
-   * Return a modifiable copy of the covariance.
+   * Set the covariance matrix.  The covariance is factorized immediately, so
+   * that subsequent calls to Probability() and LogProbability() are cheap.
+   * There is deliberately no non-const accessor, since modifying the
+   * covariance in-place would invalidate the cached factorization.
    */
-  arma::mat& Covariance() { return covariance; }
+  void Covariance(const arma::mat& covariance);
+
+  /**
+   * Return the log-determinant of the covariance that Probability() and
+   * LogProbability() use (that is, of the perturbed covariance, if the
+   * covariance is not positive definite).
+   */
+  double LogDetCov() const { return logDetCov; }
 
   /**
    * Returns a string representation of this object.
@@ -116,37 +163,18 @@ class GaussianDistribution
   void Save(util::SaveRestoreUtility& n) const;
   void Load(const util::SaveRestoreUtility& n);
   static std::string const Type() { return "GaussianDistribution"; }
-  
-  
-    
-};
 
-/**
-* Calculates the multivariate Gaussian probability density function for each
-* data point (column) in the given matrix
-*
-* @param x List of observations.
-* @param probabilities Output probabilities for each input observation.
-*/
-inline void GaussianDistribution::Probability(const arma::mat& x,
-                                              arma::vec& probabilities) const
-{
-  // Column i of 'diffs' is the difference between x.col(i) and the mean.
-  arma::mat diffs = x - (mean * arma::ones<arma::rowvec>(x.n_cols));
-  
-  // Now, we only want to calculate the diagonal elements of (diffs' * cov^-1 *
-  // diffs).  We just don't need any of the other elements.  We can calculate
-  // the right hand part of the equation (instead of the left side) so that
-  // later we are referencing columns, not rows -- that is faster.
-  arma::mat rhs = -0.5 * inv(covariance) * diffs;
-  arma::vec exponents(diffs.n_cols); // We will now fill this.
-  for (size_t i = 0; i < diffs.n_cols; i++)
-    exponents(i) = exp(accu(diffs.unsafe_col(i) % rhs.unsafe_col(i)));
-  
-  probabilities = pow(2 * M_PI, (double) mean.n_elem / -2.0) *
-  pow(arma::det(covariance), -0.5) * exponents;
-}
-  
+ private:
+  /**
+   * Compute the Cholesky factor and log-determinant of the covariance.  If the
+   * covariance is not positive definite (for instance, if it is nearly
+   * singular), the factor is taken of the covariance plus the smallest
+   * perturbation of its diagonal that makes it positive definite; the stored
+   * covariance is not changed.  If the covariance is not finite, the factor
+   * and log-determinant are NaN, so LogProbability() returns NaN.
+   */
+  void FactorCovariance();
+};
 
 }; // namespace distribution
 }; // namespace mlpack
@@ -71,6 +71,19 @@ double RegressionDistribution::Probability(const arma::vec& observation) const
   return err.Probability(observation(0)-fitted);
 }
 
+/**
+ * Evaluate log probability density function of given observations.
+ *
+ * @param observations points to evaluate log probability at
+ */
+void RegressionDistribution::LogProbability(const arma::mat& observations,
+                                            arma::vec& logProbabilities) const
+{
+  arma::vec fitted;
+  rf.Predict(observations.rows(1, observations.n_rows - 1), fitted);
+  err.LogProbability(observations.row(0) - fitted.t(), logProbabilities);
+}
+
 void RegressionDistribution::Predict(const arma::mat& points,
                                      arma::vec& predictions) const
 {
@@ -48,7 +48,9 @@ class RegressionDistribution
       rf(regression::LinearRegression(predictors, responses))
   {
     err = GaussianDistribution(1);
-    err.Covariance() = rf.ComputeError(predictors, responses);
+    arma::mat covariance(1, 1);
+    covariance(0, 0) = rf.ComputeError(predictors, responses);
+    err.Covariance(covariance);
   }
 
   /**
@@ -80,6 +82,16 @@ class RegressionDistribution
   */
   double Probability(const arma::vec& observation) const;
 
+  /**
+   * Evaluate the log of the probability density function at each of the given
+   * observations (columns), with one prediction for all of them.
+   *
+   * @param observations Points to evaluate the log-probability at.
+   * @param logProbabilities Output log-probabilities for each observation.
+   */
+  void LogProbability(const arma::mat& observations,
+                      arma::vec& logProbabilities) const;
+
   /**
    * Calculate y_i for each data point in points.
    *
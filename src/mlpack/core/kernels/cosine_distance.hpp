@@ -53,6 +53,12 @@ class KernelTraits<CosineDistance>
  public:
   //! The cosine kernel is normalized: K(x, x) = 1 for all x.
   static const bool IsNormalized = true;
+
+  //! The cosine kernel does not depend only on the distance between points.
+  static const bool UsesDistance = false;
+
+  //! The cosine kernel does not depend only on the dot product.
+  static const bool UsesDotProduct = false;
 };
 
 }; // namespace kernel
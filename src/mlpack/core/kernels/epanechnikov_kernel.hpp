@@ -87,6 +87,12 @@ class KernelTraits<EpanechnikovKernel>
  public:
   //! The Epanechnikov kernel is normalized: K(x, x) = 1 for all x.
   static const bool IsNormalized = true;
+
+  //! The Epanechnikov kernel depends only on the distance between points.
+  static const bool UsesDistance = true;
+
+  //! The Epanechnikov kernel does not depend only on the dot product.
+  static const bool UsesDotProduct = false;
 };
 
 }; // namespace kernel
@@ -140,6 +140,12 @@ class KernelTraits<GaussianKernel>
  public:
   //! The Gaussian kernel is normalized: K(x, x) = 1 for all x.
   static const bool IsNormalized = true;
+
+  //! The Gaussian kernel depends only on the distance between points.
+  static const bool UsesDistance = true;
+
+  //! The Gaussian kernel does not depend only on the dot product.
+  static const bool UsesDotProduct = false;
 };
 
 }; // namespace kernel
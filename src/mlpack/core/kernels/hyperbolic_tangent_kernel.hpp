@@ -55,6 +55,18 @@ class HyperbolicTangentKernel
     return tanh(scale * arma::dot(a, b) + offset);
   }
 
+  /**
+   * Evaluate the hyperbolic tangent kernel given the dot product of the two
+   * points.
+   *
+   * @param dot The dot product of the two points.
+   * @return K(a, b).
+   */
+  double EvaluateDotProduct(const double dot) const
+  {
+    return tanh(scale * dot + offset);
+  }
+
   //! Get scale factor.
   double Scale() const { return scale; }
   //! Modify scale factor.
@@ -80,6 +92,21 @@ class HyperbolicTangentKernel
   double offset;
 };
 
+//! Kernel traits for the hyperbolic tangent kernel.
+template<>
+class KernelTraits<HyperbolicTangentKernel>
+{
+ public:
+  //! The hyperbolic tangent kernel is not normalized.
+  static const bool IsNormalized = false;
+
+  //! The hyperbolic tangent kernel does not depend only on the distance between points.
+  static const bool UsesDistance = false;
+
+  //! The hyperbolic tangent kernel depends only on the dot product.
+  static const bool UsesDotProduct = true;
+};
+
 }; // namespace kernel
 }; // namespace mlpack
 
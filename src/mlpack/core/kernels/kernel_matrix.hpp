@@ -0,0 +1,62 @@
+/**
+ * @file kernel_matrix.hpp
+ *
+ * Functions to build the matrix of kernel evaluations between all pairs of
+ * points in one or two datasets.
+ */
+#ifndef __MLPACK_CORE_KERNELS_KERNEL_MATRIX_HPP
+#define __MLPACK_CORE_KERNELS_KERNEL_MATRIX_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace kernel {
+
+/**
+ * Build the kernel matrix of the given dataset: kernelMatrix(i, j) is
+ * K(data.col(i), data.col(j)).  The matrix is symmetric, so only the upper
+ * triangular part is evaluated.
+ *
+ * How the matrix is built depends on the KernelTraits of the kernel.  If
+ * UsesDistance is true, each block of the matrix is computed with a single
+ * matrix product, using ||a - b||^2 = ||a||^2 + ||b||^2 - 2 a^T b, and the
+ * kernel is only evaluated on the resulting distances.  If UsesDotProduct is
+ * true, each block is a matrix product, and the kernel is evaluated on the dot
+ * products.  In both cases the blocks are small enough to stay in cache and
+ * are computed in parallel with OpenMP.  Other kernels are evaluated one pair
+ * of points at a time with Evaluate().
+ *
+ * @param data Dataset (one point per column).
+ * @param kernel Kernel to evaluate.
+ * @param kernelMatrix Matrix to store the kernel matrix in; it will be set to
+ *     size data.n_cols x data.n_cols.
+ */
+template<typename KernelType>
+void BuildKernelMatrix(const arma::mat& data,
+                       KernelType& kernel,
+                       arma::mat& kernelMatrix);
+
+/**
+ * Build the matrix of kernel evaluations between two datasets:
+ * kernelMatrix(i, j) is K(a.col(i), b.col(j)).  See the other overload for
+ * how the matrix is computed.
+ *
+ * @param a First dataset (one point per column).
+ * @param b Second dataset (one point per column).
+ * @param kernel Kernel to evaluate.
+ * @param kernelMatrix Matrix to store the kernel evaluations in; it will be
+ *     set to size a.n_cols x b.n_cols.
+ */
+template<typename KernelType>
+void BuildKernelMatrix(const arma::mat& a,
+                       const arma::mat& b,
+                       KernelType& kernel,
+                       arma::mat& kernelMatrix);
+
+}; // namespace kernel
+}; // namespace mlpack
+
+// Include implementation.
+#include "kernel_matrix_impl.hpp"
+
+#endif
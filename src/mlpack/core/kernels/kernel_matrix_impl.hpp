@@ -0,0 +1,173 @@
+/**
+ * @file kernel_matrix_impl.hpp
+ *
+ * Implementation of BuildKernelMatrix().
+ */
+#ifndef __MLPACK_CORE_KERNELS_KERNEL_MATRIX_IMPL_HPP
+#define __MLPACK_CORE_KERNELS_KERNEL_MATRIX_IMPL_HPP
+
+// In case it hasn't already been included.
+#include "kernel_matrix.hpp"
+
+#include <boost/utility/enable_if.hpp>
+
+namespace mlpack {
+namespace kernel {
+
+//! The number of points on each side of the blocks of the kernel matrix.  A
+//! 256 x 256 block of doubles takes 512kB.
+static const size_t KernelMatrixBlockSize = 256;
+
+//! Turn a block of dot products between a.cols(aBegin, aEnd) and
+//! b.cols(bBegin, bEnd) into kernel evaluations, for kernels which depend only
+//! on the distance.  If 'diagonal' is true, the block lies on the diagonal of a
+//! symmetric kernel matrix.
+template<typename KernelType>
+void KernelMatrixBlock(const arma::mat& a,
+                       const arma::mat& b,
+                       const size_t aBegin,
+                       const size_t aEnd,
+                       const size_t bBegin,
+                       const size_t bEnd,
+                       const bool diagonal,
+                       KernelType& kernel,
+                       arma::mat& block,
+                       const typename boost::enable_if_c<
+                           KernelTraits<KernelType>::UsesDistance
+                       >::type* = 0)
+{
+  const arma::rowvec aNorms = arma::sum(arma::square(a.cols(aBegin, aEnd)), 0);
+  const arma::rowvec bNorms = arma::sum(arma::square(b.cols(bBegin, bEnd)), 0);
+
+  for (size_t j = 0; j < block.n_cols; ++j)
+  {
+    for (size_t i = 0; i < block.n_rows; ++i)
+    {
+      // Roundoff can make the squared distance slightly negative, and on the
+      // diagonal we know it is exactly zero.
+      const double squaredDistance = (diagonal && i == j) ? 0.0 :
+          std::max(aNorms[i] + bNorms[j] - 2.0 * block(i, j), 0.0);
+      block(i, j) = kernel.Evaluate(sqrt(squaredDistance));
+    }
+  }
+}
+
+//! Turn a block of dot products into kernel evaluations, for kernels which
+//! depend only on the dot product.
+template<typename KernelType>
+void KernelMatrixBlock(const arma::mat& /* a */,
+                       const arma::mat& /* b */,
+                       const size_t /* aBegin */,
+                       const size_t /* aEnd */,
+                       const size_t /* bBegin */,
+                       const size_t /* bEnd */,
+                       const bool /* diagonal */,
+                       KernelType& kernel,
+                       arma::mat& block,
+                       const typename boost::enable_if_c<
+                           !KernelTraits<KernelType>::UsesDistance &&
+                           KernelTraits<KernelType>::UsesDotProduct
+                       >::type* = 0)
+{
+  for (size_t j = 0; j < block.n_cols; ++j)
+    for (size_t i = 0; i < block.n_rows; ++i)
+      block(i, j) = kernel.EvaluateDotProduct(block(i, j));
+}
+
+//! Build the kernel matrix blockwise, with one matrix product per block.
+template<typename KernelType>
+void BuildKernelMatrixImpl(const arma::mat& a,
+                           const arma::mat& b,
+                           const bool symmetric,
+                           KernelType& kernel,
+                           arma::mat& kernelMatrix,
+                           const typename boost::enable_if_c<
+                               KernelTraits<KernelType>::UsesDistance ||
+                               KernelTraits<KernelType>::UsesDotProduct
+                           >::type* = 0)
+{
+  const size_t blockSize = KernelMatrixBlockSize;
+  const size_t aBlocks = (a.n_cols + blockSize - 1) / blockSize;
+  const size_t bBlocks = (b.n_cols + blockSize - 1) / blockSize;
+
+  // List the blocks to compute; for a symmetric matrix, only those on or above
+  // the diagonal.
+  std::vector<std::pair<size_t, size_t> > blocks;
+  for (size_t j = 0; j < bBlocks; ++j)
+    for (size_t i = 0; i < (symmetric ? (j + 1) : aBlocks); ++i)
+      blocks.push_back(std::make_pair(i, j));
+
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t k = 0; k < blocks.size(); ++k)
+  {
+    const size_t aBegin = blocks[k].first * blockSize;
+    const size_t aEnd = std::min(aBegin + blockSize, (size_t) a.n_cols) - 1;
+    const size_t bBegin = blocks[k].second * blockSize;
+    const size_t bEnd = std::min(bBegin + blockSize, (size_t) b.n_cols) - 1;
+
+    arma::mat block = arma::trans(a.cols(aBegin, aEnd)) * b.cols(bBegin, bEnd);
+    KernelMatrixBlock(a, b, aBegin, aEnd, bBegin, bEnd,
+        symmetric && (aBegin == bBegin), kernel, block);
+
+    kernelMatrix.submat(aBegin, bBegin, aEnd, bEnd) = block;
+    // Blocks never overlap, so the mirrored block can be written here too.
+    if (symmetric && aBegin != bBegin)
+      kernelMatrix.submat(bBegin, aBegin, bEnd, aEnd) = arma::trans(block);
+  }
+}
+
+//! Build the kernel matrix one kernel evaluation at a time, for kernels which
+//! can only be evaluated on points.
+template<typename KernelType>
+void BuildKernelMatrixImpl(const arma::mat& a,
+                           const arma::mat& b,
+                           const bool symmetric,
+                           KernelType& kernel,
+                           arma::mat& kernelMatrix,
+                           const typename boost::enable_if_c<
+                               !KernelTraits<KernelType>::UsesDistance &&
+                               !KernelTraits<KernelType>::UsesDotProduct
+                           >::type* = 0)
+{
+  // We don't know whether Evaluate() is safe to call from several threads, so
+  // this is done serially.
+  for (size_t j = 0; j < b.n_cols; ++j)
+    for (size_t i = 0; i < (symmetric ? (j + 1) : a.n_cols); ++i)
+      kernelMatrix(i, j) = kernel.Evaluate(a.unsafe_col(i), b.unsafe_col(j));
+
+  // Copy to the lower triangular part of the matrix.
+  if (symmetric)
+    for (size_t i = 1; i < a.n_cols; ++i)
+      for (size_t j = 0; j < i; ++j)
+        kernelMatrix(i, j) = kernelMatrix(j, i);
+}
+
+template<typename KernelType>
+void BuildKernelMatrix(const arma::mat& data,
+                       KernelType& kernel,
+                       arma::mat& kernelMatrix)
+{
+  kernelMatrix.set_size(data.n_cols, data.n_cols);
+  BuildKernelMatrixImpl(data, data, true, kernel, kernelMatrix);
+}
+
+template<typename KernelType>
+void BuildKernelMatrix(const arma::mat& a,
+                       const arma::mat& b,
+                       KernelType& kernel,
+                       arma::mat& kernelMatrix)
+{
+  if (a.n_rows != b.n_rows)
+  {
+    Log::Fatal << "BuildKernelMatrix(): datasets have different dimensionality"
+        << " (" << a.n_rows << " and " << b.n_rows << ")!" << std::endl;
+  }
+
+  kernelMatrix.set_size(a.n_cols, b.n_cols);
+  BuildKernelMatrixImpl(a, b, false, kernel, kernelMatrix);
+}
+
+}; // namespace kernel
+}; // namespace mlpack
+
+#endif
@@ -26,6 +26,22 @@ class KernelTraits
    * If true, then the kernel is normalized: K(x, x) = K(y, y) = 1 for all x.
    */
   static const bool IsNormalized = false;
+
+  /**
+   * If true, then K(a, b) depends only on the Euclidean distance between a and
+   * b, and the kernel provides Evaluate(const double distance).  This allows
+   * kernel matrices to be built from pairwise distances (see
+   * BuildKernelMatrix()).
+   */
+  static const bool UsesDistance = false;
+
+  /**
+   * If true, then K(a, b) depends only on the dot product of a and b, and the
+   * kernel provides EvaluateDotProduct(const double dot).  This allows kernel
+   * matrices to be built from a single matrix product (see
+   * BuildKernelMatrix()).
+   */
+  static const bool UsesDotProduct = false;
 };
 
 }; // namespace kernel
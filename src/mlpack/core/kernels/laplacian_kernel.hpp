@@ -98,6 +98,12 @@ class KernelTraits<LaplacianKernel>
  public:
   //! The Laplacian kernel is normalized: K(x, x) = 1 for all x.
   static const bool IsNormalized = true;
+
+  //! The Laplacian kernel depends only on the distance between points.
+  static const bool UsesDistance = true;
+
+  //! The Laplacian kernel does not depend only on the dot product.
+  static const bool UsesDotProduct = false;
 };
 
 }; // namespace kernel
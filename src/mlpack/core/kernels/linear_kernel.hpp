@@ -48,6 +48,14 @@ class LinearKernel
     return arma::dot(a, b);
   }
 
+  /**
+   * Evaluation of the linear kernel given the dot product of the two points.
+   *
+   * @param dot The dot product of the two points.
+   * @return K(a, b).
+   */
+  static double EvaluateDotProduct(const double dot) { return dot; }
+
   //! Return a string representation of the kernel.
   std::string ToString() const
   {
@@ -57,6 +65,21 @@ class LinearKernel
   }
 };
 
+//! Kernel traits for the linear kernel.
+template<>
+class KernelTraits<LinearKernel>
+{
+ public:
+  //! The linear kernel is not normalized.
+  static const bool IsNormalized = false;
+
+  //! The linear kernel does not depend only on the distance between points.
+  static const bool UsesDistance = false;
+
+  //! The linear kernel depends only on the dot product.
+  static const bool UsesDotProduct = true;
+};
+
 }; // namespace kernel
 }; // namespace mlpack
 
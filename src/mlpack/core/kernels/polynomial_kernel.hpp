@@ -50,6 +50,18 @@ class PolynomialKernel
     return pow((arma::dot(a, b) + offset), degree);
   }
 
+  /**
+   * Evaluation of the polynomial kernel given the dot product of the two
+   * points.
+   *
+   * @param dot The dot product of the two points.
+   * @return K(a, b).
+   */
+  double EvaluateDotProduct(const double dot) const
+  {
+    return pow((dot + offset), degree);
+  }
+
   //! Get the degree of the polynomial.
   const double& Degree() const { return degree; }
   //! Modify the degree of the polynomial.
@@ -77,6 +89,21 @@ class PolynomialKernel
   double offset;
 };
 
+//! Kernel traits for the polynomial kernel.
+template<>
+class KernelTraits<PolynomialKernel>
+{
+ public:
+  //! The polynomial kernel is not normalized.
+  static const bool IsNormalized = false;
+
+  //! The polynomial kernel does not depend only on the distance between points.
+  static const bool UsesDistance = false;
+
+  //! The polynomial kernel depends only on the dot product.
+  static const bool UsesDotProduct = true;
+};
+
 }; // namespace kernel
 }; // namespace mlpack
 
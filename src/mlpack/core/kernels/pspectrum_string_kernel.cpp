@@ -10,6 +10,8 @@
  */
 #include "pspectrum_string_kernel.hpp"
 
+#include <algorithm>
+
 using namespace std;
 using namespace mlpack;
 using namespace mlpack::kernel;
@@ -27,57 +29,141 @@ mlpack::kernel::PSpectrumStringKernel::PSpectrumStringKernel(
     datasets(datasets),
     p(p)
 {
-  // We have to assemble the counts of substrings.  This is not a particularly
-  // fast operation, unfortunately, but it only needs to be done once.
-  Log::Info << "Assembling counts of substrings of length " << p << "."
+  Log::Info << "Assembling spectra of substrings of length " << p << "."
       << std::endl;
 
-  // Resize for number of datasets.
+  if (p == 0)
+    Log::Fatal << "PSpectrumStringKernel: p must be greater than 0!" << endl;
+
+  // Encoding a substring of length p shifts its first digit by
+  // multiplier^(p - 1).
+  const uint64_t multiplier = Multiplier(p);
+  uint64_t leadingPower = 1;
+  for (size_t j = 1; j < p; ++j)
+    leadingPower *= multiplier;
+
+  hashes.resize(datasets.size());
   counts.resize(datasets.size());
+  squaredNorms.resize(datasets.size());
 
   for (size_t dataset = 0; dataset < datasets.size(); ++dataset)
   {
     const std::vector<std::string>& set = datasets[dataset];
 
-    // Resize for number of strings in dataset.
+    hashes[dataset].resize(set.size());
     counts[dataset].resize(set.size());
+    squaredNorms[dataset].resize(set.size());
 
-    // Inspect each string in the dataset.
+    // Each string is independent of the others.  Strings may have very
+    // different lengths, so the work is handed out dynamically.
+    #pragma omp parallel for schedule(dynamic, 16)
     for (size_t index = 0; index < set.size(); ++index)
     {
-      // Convenience references.
       const std::string& str = set[index];
-      std::map<std::string, int>& mapping = counts[dataset][index];
 
-      size_t start = 0;
-      while ((start + p) <= str.length())
+      // Encode each window of p alphanumeric characters.  The window is
+      // restarted after any other character.
+      std::vector<uint64_t> windows;
+      windows.reserve(str.length());
+      uint64_t hash = 0;
+      size_t windowLength = 0;
+      for (size_t i = 0; i < str.length(); ++i)
       {
-        string sub = str.substr(start, p);
-
-        // Convert all characters to lowercase.
-        bool invalid = false;
-        for (size_t j = 0; j < p; ++j)
+        const int digit = Digit(str[i]);
+        if (digit < 0)
         {
-          if (!isalnum(sub[j]))
-          {
-            invalid = true;
-            break; // Only consider substrings with alphanumerics.
-          }
-
-          sub[j] = tolower(sub[j]);
+          hash = 0;
+          windowLength = 0;
+          continue;
         }
 
-        // Increment position in string.
-        ++start;
+        // Drop the first character of the window if it is full.
+        if (windowLength == p)
+          hash -= leadingPower * (uint64_t) Digit(str[i - p]);
+        else
+          ++windowLength;
 
-        if (!invalid)
-        {
-          // Add to the map.
-          ++mapping[sub];
-        }
+        hash = multiplier * hash + (uint64_t) digit;
+
+        if (windowLength == p)
+          windows.push_back(hash);
       }
+
+      // Sort the substrings, and collapse runs of the same substring into a
+      // single entry with a count.
+      std::sort(windows.begin(), windows.end());
+
+      std::vector<uint64_t>& stringHashes = hashes[dataset][index];
+      std::vector<size_t>& stringCounts = counts[dataset][index];
+      double squaredNorm = 0;
+      for (size_t i = 0; i < windows.size(); )
+      {
+        size_t run = 1;
+        while (i + run < windows.size() && windows[i + run] == windows[i])
+          ++run;
+
+        stringHashes.push_back(windows[i]);
+        stringCounts.push_back(run);
+        squaredNorm += double(run) * double(run);
+        i += run;
+      }
+
+      squaredNorms[dataset][index] = squaredNorm;
     }
   }
 
   Log::Info << "Substring extraction complete." << std::endl;
 }
+
+size_t PSpectrumStringKernel::Count(const size_t dataset,
+                                    const size_t index,
+                                    const std::string& substring) const
+{
+  if (substring.length() != p)
+    return 0;
+
+  const uint64_t multiplier = Multiplier(p);
+  uint64_t hash = 0;
+  for (size_t j = 0; j < p; ++j)
+  {
+    const int digit = Digit(substring[j]);
+    if (digit < 0)
+      return 0;
+
+    hash = multiplier * hash + (uint64_t) digit;
+  }
+
+  const std::vector<uint64_t>& stringHashes = hashes[dataset][index];
+  const std::vector<uint64_t>::const_iterator it = std::lower_bound(
+      stringHashes.begin(), stringHashes.end(), hash);
+  if (it == stringHashes.end() || *it != hash)
+    return 0;
+
+  return counts[dataset][index][it - stringHashes.begin()];
+}
+
+uint64_t PSpectrumStringKernel::Multiplier(const size_t p)
+{
+  // 36^12 < 2^64, so up to p = 12 every substring gets its own base-36 number.
+  // Past that, multiplying by 36 (which is even) would shift the first digits
+  // out of the 64 bits entirely, so an odd multiplier is used instead; then
+  // every digit affects the hash, whatever p is.
+  if (p <= 12)
+    return 36;
+  else
+    return 0x9E3779B97F4A7C15ULL;
+}
+
+int PSpectrumStringKernel::Digit(const char c)
+{
+  // This is the same as isalnum() and tolower() in the "C" locale, but doesn't
+  // depend on the locale.
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  else if (c >= 'a' && c <= 'z')
+    return 10 + (c - 'a');
+  else if (c >= 'A' && c <= 'Z')
+    return 10 + (c - 'A');
+  else
+    return -1;
+}
@@ -11,7 +11,6 @@
 #ifndef __MLPACK_CORE_KERNELS_PSPECTRUM_STRING_KERNEL_HPP
 #define __MLPACK_CORE_KERNELS_PSPECTRUM_STRING_KERNEL_HPP
 
-#include <map>
 #include <string>
 #include <vector>
 
@@ -55,6 +54,19 @@ namespace kernel {
  * the data according to the fake data matrix -- resulting in a meaningless
  * tree.  This kernel was originally written for the FastMKS method; so, at the
  * very least, it will work with that.
+ *
+ * When the kernel is constructed, each string is turned into its spectrum: a
+ * sorted array of the (encoded) substrings of length p in the string, and a
+ * parallel array holding the number of times each one appears.  Only
+ * substrings made of alphanumeric characters are counted, and case is
+ * ignored.  For p <= 12, each substring is encoded exactly as a number in base
+ * 36 (one digit for each of the 36 possible characters), which fits in 64
+ * bits.  For larger p, a polynomial hash modulo 2^64 with a large odd
+ * multiplier is used instead, so collisions are extremely unlikely.  Either
+ * way, the encoding is computed with a rolling update as the window moves
+ * along the string.  Evaluating the kernel is then a merge of two sorted
+ * arrays of integers, and the squared norm of each spectrum (the kernel
+ * evaluated between a string and itself) is precomputed.
  */
 class PSpectrumStringKernel
 {
@@ -83,12 +95,28 @@ class PSpectrumStringKernel
   template<typename VecType>
   double Evaluate(const VecType& a, const VecType& b) const;
 
-  //! Access the lists of substrings.
-  const std::vector<std::vector<std::map<std::string, int> > >& Counts() const
-  { return counts; }
-  //! Modify the lists of substrings.
-  std::vector<std::vector<std::map<std::string, int> > >& Counts()
+  /**
+   * Return the number of times the given substring appears in the given
+   * string.  If the substring is not of length p, or contains characters which
+   * are not alphanumeric, 0 is returned.
+   *
+   * @param dataset Index of the dataset.
+   * @param index Index of the string in the dataset.
+   * @param substring Substring to count.
+   */
+  size_t Count(const size_t dataset,
+               const size_t index,
+               const std::string& substring) const;
+
+  //! Access the sorted encoded substrings of each string.
+  const std::vector<std::vector<std::vector<uint64_t> > >& Hashes() const
+  { return hashes; }
+  //! Access the number of times each of the substrings in Hashes() appears.
+  const std::vector<std::vector<std::vector<size_t> > >& Counts() const
   { return counts; }
+  //! Access the squared norm of the spectrum of each string.
+  const std::vector<std::vector<double> >& SquaredNorms() const
+  { return squaredNorms; }
 
   //! Access the value of p.
   size_t P() const { return p; }
@@ -113,12 +141,27 @@ class PSpectrumStringKernel
   //! The datasets.
   const std::vector<std::vector<std::string> >& datasets;
 
-  //! Mappings of the datasets to counts of substrings.  Such a huge structure
-  //! is not wonderful...
-  std::vector<std::vector<std::map<std::string, int> > > counts;
+  //! The encoded substrings of each string in each dataset, in sorted order.
+  std::vector<std::vector<std::vector<uint64_t> > > hashes;
+  //! The number of times each substring in hashes appears in its string.
+  std::vector<std::vector<std::vector<size_t> > > counts;
+  //! The squared norm of the spectrum of each string.
+  std::vector<std::vector<double> > squaredNorms;
 
   //! The value of p to use in calculation.
   size_t p;
+
+  /**
+   * Return the multiplier used to encode substrings of length p: 36 if the
+   * base-36 encoding fits in 64 bits, and a large odd number otherwise.
+   */
+  static uint64_t Multiplier(const size_t p);
+
+  /**
+   * Return the digit used to encode the given character (0 through 35), or -1
+   * if it is not alphanumeric.
+   */
+  static int Digit(const char c);
 };
 
 }; // namespace kernel
@@ -31,44 +31,47 @@ template<typename VecType>
 double PSpectrumStringKernel::Evaluate(const VecType& a,
                                        const VecType& b) const
 {
-  // Get the map of substrings for the two strings we are interested in.
-  const std::map<std::string, int>& aMap = counts[a[0]][a[1]];
-  const std::map<std::string, int>& bMap = counts[b[0]][b[1]];
+  const size_t aSet = (size_t) a[0], aIndex = (size_t) a[1];
+  const size_t bSet = (size_t) b[0], bIndex = (size_t) b[1];
 
-  double eval = 0;
+  // The kernel between a string and itself is precomputed.
+  if (aSet == bSet && aIndex == bIndex)
+    return squaredNorms[aSet][aIndex];
 
-  // Loop through the two maps (which, when iterated through, are sorted
-  // alphabetically).
-  std::map<std::string, int>::const_iterator aIt = aMap.begin();
-  std::map<std::string, int>::const_iterator bIt = bMap.begin();
+  const std::vector<uint64_t>& aHashes = hashes[aSet][aIndex];
+  const std::vector<uint64_t>& bHashes = hashes[bSet][bIndex];
+  const std::vector<size_t>& aCounts = counts[aSet][aIndex];
+  const std::vector<size_t>& bCounts = counts[bSet][bIndex];
 
-  while ((aIt != aMap.end()) && (bIt != bMap.end()))
-  {
-    // Compare alphabetically (this is how std::map is ordered).
-    int result = (*aIt).first.compare((*bIt).first);
+  double eval = 0;
 
-    if (result == 0) // The same substring.
+  // Walk through the two sorted lists of substrings together, and multiply the
+  // counts of the substrings which appear in both.
+  size_t i = 0;
+  size_t j = 0;
+  while (i < aHashes.size() && j < bHashes.size())
+  {
+    if (aHashes[i] == bHashes[j]) // The same substring.
     {
-      eval += ((*aIt).second * (*bIt).second);
-
-      // Now increment both.
-      ++aIt;
-      ++bIt;
+      eval += double(aCounts[i]) * double(bCounts[j]);
+      ++i;
+      ++j;
     }
-    else if (result > 0)
+    else if (aHashes[i] < bHashes[j])
     {
-      // aIt is "ahead" of bIt (alphabetically); so increment bIt to "catch up".
-      ++bIt;
+      // a is behind b; so increment i to catch up.
+      ++i;
     }
     else
     {
-      // bIt is "ahead" of aIt (alphabetically); so increment aIt to "catch up".
-      ++aIt;
+      // b is behind a; so increment j to catch up.
+      ++j;
     }
   }
 
   return eval;
 }
+
 }; // namespace kernel
 }; // namespace mlpack
 
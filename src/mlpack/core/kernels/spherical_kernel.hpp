@@ -101,6 +101,12 @@ class KernelTraits<SphericalKernel>
  public:
   //! The spherical kernel is normalized: K(x, x) = 1 for all x.
   static const bool IsNormalized = true;
+
+  //! The spherical kernel depends only on the distance between points.
+  static const bool UsesDistance = true;
+
+  //! The spherical kernel does not depend only on the dot product.
+  static const bool UsesDotProduct = false;
 };
 
 }; // namespace kernel
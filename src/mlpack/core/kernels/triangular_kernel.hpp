@@ -53,7 +53,7 @@ class TriangularKernel
    */
   double Evaluate(const double distance) const
   {
-    return std::max(0.0, (1 - distance) / bandwidth);
+    return std::max(0.0, (1 - distance / bandwidth));
   }
 
   //! Get the bandwidth of the kernel.
@@ -82,6 +82,12 @@ class KernelTraits<TriangularKernel>
  public:
   //! The triangular kernel is normalized: K(x, x) = 1 for all x.
   static const bool IsNormalized = true;
+
+  //! The triangular kernel depends only on the distance between points.
+  static const bool UsesDistance = true;
+
+  //! The triangular kernel does not depend only on the dot product.
+  static const bool UsesDotProduct = false;
 };
 
 }; // namespace kernel
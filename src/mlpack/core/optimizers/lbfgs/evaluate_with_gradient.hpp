@@ -0,0 +1,74 @@
+/**
+ * @file evaluate_with_gradient.hpp
+ *
+ * Evaluate the objective and the gradient of a function at the same point,
+ * using the function's own EvaluateWithGradient() if it has one, and
+ * Evaluate() followed by Gradient() if it does not.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_LBFGS_EVALUATE_WITH_GRADIENT_HPP
+#define __MLPACK_CORE_OPTIMIZERS_LBFGS_EVALUATE_WITH_GRADIENT_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+HAS_MEM_FUNC(EvaluateWithGradient, HasEvaluateWithGradientSignature);
+
+/**
+ * HasEvaluateWithGradient<FunctionType>::value is true if FunctionType has a
+ * member
+ *
+ *   double EvaluateWithGradient(const arma::mat& coordinates,
+ *                               arma::mat& gradient);
+ *
+ * (const or not), which returns the objective at the given coordinates and
+ * stores the gradient at the same coordinates in gradient.  Functions whose
+ * objective and gradient share most of their computation (such as a forward
+ * pass over the whole dataset) should provide it.
+ */
+template<typename FunctionType>
+struct HasEvaluateWithGradient
+{
+  static const bool value =
+      HasEvaluateWithGradientSignature<FunctionType, double(FunctionType::*)(
+          const arma::mat&, arma::mat&)>::value ||
+      HasEvaluateWithGradientSignature<FunctionType, double(FunctionType::*)(
+          const arma::mat&, arma::mat&) const>::value;
+};
+
+//! Compute the objective and the gradient with the function's
+//! EvaluateWithGradient().
+template<typename FunctionType>
+inline double EvaluateWithGradient(FunctionType& function,
+                                   const arma::mat& coordinates,
+                                   arma::mat& gradient,
+                                   const typename boost::enable_if_c<
+                                       HasEvaluateWithGradient<
+                                           FunctionType>::value
+                                   >::type* = 0)
+{
+  return function.EvaluateWithGradient(coordinates, gradient);
+}
+
+//! Compute the objective and the gradient with separate calls to Evaluate()
+//! and Gradient().
+template<typename FunctionType>
+inline double EvaluateWithGradient(FunctionType& function,
+                                   const arma::mat& coordinates,
+                                   arma::mat& gradient,
+                                   const typename boost::disable_if_c<
+                                       HasEvaluateWithGradient<
+                                           FunctionType>::value
+                                   >::type* = 0)
+{
+  const double objective = function.Evaluate(coordinates);
+  function.Gradient(coordinates, gradient);
+  return objective;
+}
+
+}; // namespace optimization
+}; // namespace mlpack
+
+#endif
@@ -10,6 +10,8 @@
 
 #include <mlpack/core.hpp>
 
+#include "evaluate_with_gradient.hpp"
+
 namespace mlpack {
 namespace optimization {
 
@@ -24,6 +26,16 @@ namespace optimization {
  *  - double Evaluate(const arma::mat& coordinates);
  *  - void Gradient(const arma::mat& coordinates, arma::mat& gradient);
  *  - arma::mat& GetInitialPoint();
+ *
+ * The objective and gradient are always needed at the same points.  If the
+ * function also implements
+ *
+ *  - double EvaluateWithGradient(const arma::mat& coordinates,
+ *                                arma::mat& gradient);
+ *
+ * then that is called instead of Evaluate() and Gradient(), so that work which
+ * is common to both (such as a forward pass over the dataset) is only done
+ * once.  See HasEvaluateWithGradient in evaluate_with_gradient.hpp.
  */
 template<typename FunctionType>
 class L_BFGS
@@ -174,12 +186,14 @@ class L_BFGS
   std::pair<arma::mat, double> minPointIterate;
 
   /**
-   * Evaluate the function at the given iterate point and store the result if it
-   * is a new minimum.
+   * Evaluate the function and its gradient at the given iterate point and
+   * store the result if it is a new minimum.
    *
+   * @param iterate Point to evaluate the function at.
+   * @param gradient Matrix to store the gradient in.
    * @return The value of the function.
    */
-  double Evaluate(const arma::mat& iterate);
+  double EvaluateWithGradient(const arma::mat& iterate, arma::mat& gradient);
 
   /**
    * Calculate the scaling factor, gamma, which is used to scale the Hessian
@@ -63,17 +63,20 @@ L_BFGS<FunctionType>::L_BFGS(FunctionType& function,
 }
 
 /**
- * Evaluate the function at the given iterate point and store the result if
- * it is a new minimum.
+ * Evaluate the function and its gradient at the given iterate point and store
+ * the result if it is a new minimum.
  *
  * @return The value of the function
  */
 template<typename FunctionType>
-double L_BFGS<FunctionType>::Evaluate(const arma::mat& iterate)
+double L_BFGS<FunctionType>::EvaluateWithGradient(const arma::mat& iterate,
+                                                  arma::mat& gradient)
 {
   // Evaluate the function and keep track of the minimum function
-  // value encountered during the optimization.
-  double functionValue = function.Evaluate(iterate);
+  // value encountered during the optimization.  If the function can compute
+  // its objective and gradient together, it does.
+  double functionValue = optimization::EvaluateWithGradient(function, iterate,
+      gradient);
 
   if (functionValue < minPointIterate.second)
   {
@@ -180,8 +183,7 @@ bool L_BFGS<FunctionType>::LineSearch(double& functionValue,
     // point.
     newIterateTmp = iterate;
     newIterateTmp += stepSize * searchDirection;
-    functionValue = Evaluate(newIterateTmp);
-    function.Gradient(newIterateTmp, gradient);
+    functionValue = EvaluateWithGradient(newIterateTmp, gradient);
     numIterations++;
 
     if (functionValue > initialFunctionValue + stepSize *
@@ -353,9 +355,6 @@ double L_BFGS<FunctionType>::Optimize(arma::mat& iterate,
   // Whether to optimize until convergence.
   bool optimizeUntilConvergence = (maxIterations == 0);
 
-  // The initial function value.
-  double functionValue = Evaluate(iterate);
-
   // The gradient: the current and the old.
   arma::mat gradient;
   arma::mat oldGradient;
@@ -366,15 +365,17 @@ double L_BFGS<FunctionType>::Optimize(arma::mat& iterate,
   arma::mat searchDirection;
   searchDirection.zeros(iterate.n_rows, iterate.n_cols);
 
-  // The initial gradient value.
-  function.Gradient(iterate, gradient);
+  // The initial function value and gradient.
+  double functionValue = EvaluateWithGradient(iterate, gradient);
 
   // The main optimization loop.
   for (size_t itNum = 0; optimizeUntilConvergence || (itNum != maxIterations);
        ++itNum)
   {
+    // The line search leaves functionValue at the value of the new iterate, so
+    // there is no need to evaluate the function again here.
     Log::Debug << "L-BFGS iteration " << itNum << "; objective " <<
-        function.Evaluate(iterate) << "." << std::endl;
+        functionValue << "." << std::endl;
 
     // Break when the norm of the gradient becomes too small.
     if (GradientNormTooSmall(gradient))
@@ -0,0 +1,135 @@
+/**
+ * @file batch_function.hpp
+ *
+ * Evaluate the objective and gradient of a separable function on a contiguous
+ * batch of its constituent functions, using the function's own batch overloads
+ * of Evaluate() and Gradient() if it has them, and one function at a time if it
+ * does not.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_BATCH_FUNCTION_HPP
+#define __MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_BATCH_FUNCTION_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+HAS_MEM_FUNC(Evaluate, HasEvaluateSignature);
+HAS_MEM_FUNC(Gradient, HasGradientSignature);
+
+/**
+ * HasBatchEvaluate<FunctionType>::value is true if FunctionType has a member
+ *
+ *   double Evaluate(const arma::mat& parameters,
+ *                   const size_t begin,
+ *                   const size_t batchSize);
+ *
+ * (const or not), which returns the sum of the objectives of the functions
+ * begin, begin + 1, ..., begin + batchSize - 1.
+ */
+template<typename FunctionType>
+struct HasBatchEvaluate
+{
+  static const bool value =
+      HasEvaluateSignature<FunctionType, double(FunctionType::*)(
+          const arma::mat&, const size_t, const size_t)>::value ||
+      HasEvaluateSignature<FunctionType, double(FunctionType::*)(
+          const arma::mat&, const size_t, const size_t) const>::value;
+};
+
+/**
+ * HasBatchGradient<FunctionType>::value is true if FunctionType has a member
+ *
+ *   void Gradient(const arma::mat& parameters,
+ *                 const size_t begin,
+ *                 arma::mat& gradient,
+ *                 const size_t batchSize);
+ *
+ * (const or not), which stores the sum of the gradients of the functions
+ * begin, begin + 1, ..., begin + batchSize - 1 in gradient.
+ */
+template<typename FunctionType>
+struct HasBatchGradient
+{
+  static const bool value =
+      HasGradientSignature<FunctionType, void(FunctionType::*)(
+          const arma::mat&, const size_t, arma::mat&, const size_t)>::value ||
+      HasGradientSignature<FunctionType, void(FunctionType::*)(
+          const arma::mat&, const size_t, arma::mat&,
+          const size_t) const>::value;
+};
+
+//! Evaluate the sum of the objectives of functions [begin, begin + batchSize)
+//! with the function's batch Evaluate().
+template<typename FunctionType>
+inline double EvaluateBatch(FunctionType& function,
+                            const arma::mat& parameters,
+                            const size_t begin,
+                            const size_t batchSize,
+                            const typename boost::enable_if_c<
+                                HasBatchEvaluate<FunctionType>::value
+                            >::type* = 0)
+{
+  return function.Evaluate(parameters, begin, batchSize);
+}
+
+//! Evaluate the sum of the objectives of functions [begin, begin + batchSize)
+//! one function at a time.
+template<typename FunctionType>
+inline double EvaluateBatch(FunctionType& function,
+                            const arma::mat& parameters,
+                            const size_t begin,
+                            const size_t batchSize,
+                            const typename boost::disable_if_c<
+                                HasBatchEvaluate<FunctionType>::value
+                            >::type* = 0)
+{
+  double objective = 0;
+  for (size_t i = begin; i < begin + batchSize; ++i)
+    objective += function.Evaluate(parameters, i);
+
+  return objective;
+}
+
+//! Compute the sum of the gradients of functions [begin, begin + batchSize)
+//! with the function's batch Gradient().
+template<typename FunctionType>
+inline void GradientBatch(FunctionType& function,
+                          const arma::mat& parameters,
+                          const size_t begin,
+                          arma::mat& gradient,
+                          const size_t batchSize,
+                          const typename boost::enable_if_c<
+                              HasBatchGradient<FunctionType>::value
+                          >::type* = 0)
+{
+  function.Gradient(parameters, begin, gradient, batchSize);
+}
+
+//! Compute the sum of the gradients of functions [begin, begin + batchSize)
+//! one function at a time.
+template<typename FunctionType>
+inline void GradientBatch(FunctionType& function,
+                          const arma::mat& parameters,
+                          const size_t begin,
+                          arma::mat& gradient,
+                          const size_t batchSize,
+                          const typename boost::disable_if_c<
+                              HasBatchGradient<FunctionType>::value
+                          >::type* = 0)
+{
+  function.Gradient(parameters, begin, gradient);
+
+  arma::mat pointGradient;
+  for (size_t i = begin + 1; i < begin + batchSize; ++i)
+  {
+    function.Gradient(parameters, i, pointGradient);
+    gradient += pointGradient;
+  }
+}
+
+}; // namespace optimization
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,173 @@
+/**
+ * @file minibatch_sgd.hpp
+ *
+ * Mini-batch stochastic gradient descent with momentum.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_MINIBATCH_SGD_HPP
+#define __MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_MINIBATCH_SGD_HPP
+
+#include <mlpack/core.hpp>
+#include "batch_function.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * Mini-batch stochastic gradient descent is a variant of stochastic gradient
+ * descent (see SGD) where each step uses the gradient of a batch of the
+ * functions \f$ f_i(A) \f$ instead of just one of them.  With a batch \f$ B
+ * \f$ of the functions and momentum \f$ \mu \f$, each update is
+ *
+ * \f[
+ * v_{j + 1} = \mu v_j - \frac{\alpha}{|B|} \sum_{i \in B} \nabla f_i(A_j)
+ * \f]
+ * \f[
+ * A_{j + 1} = A_j + v_{j + 1}
+ * \f]
+ *
+ * where \f$ \alpha \f$ is the step size.  With a batch size of 1 and no
+ * momentum, this is exactly SGD.
+ *
+ * The batches are contiguous: the functions are split into the batches [0,
+ * batchSize), [batchSize, 2 * batchSize), and so forth (the last batch may be
+ * smaller).  If shuffle is true, the batches are visited in a random order
+ * which is changed after each pass over all of the functions; but the
+ * functions within each batch are always the same, so if the functions are
+ * ordered in some meaningful way (for instance, a dataset sorted by label),
+ * the dataset should be shuffled before optimization.  The algorithm
+ * terminates after maxIterations batches, or when the sum of the objectives of
+ * the functions over a full pass changes by less than the tolerance.
+ *
+ * For MiniBatchSGD to work, a DecomposableFunctionType template parameter is
+ * required.  It must implement the same functions that SGD requires:
+ *
+ *   size_t NumFunctions();
+ *   double Evaluate(const arma::mat& coordinates, const size_t i);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t i,
+ *                 arma::mat& gradient);
+ *
+ * Evaluating one function at a time is usually slow, though, so the function
+ * may also implement
+ *
+ *   double Evaluate(const arma::mat& coordinates,
+ *                   const size_t begin,
+ *                   const size_t batchSize);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t begin,
+ *                 arma::mat& gradient,
+ *                 const size_t batchSize);
+ *
+ * which return the sum of the objectives, and the sum of the gradients, of the
+ * functions begin, begin + 1, ..., begin + batchSize - 1.  These are used
+ * whenever they are available (see HasBatchEvaluate and HasBatchGradient), so
+ * that a data-dependent function can, for instance, handle a batch of points
+ * with matrix operations.
+ *
+ * @tparam DecomposableFunctionType Decomposable objective function type to be
+ *     minimized.
+ */
+template<typename DecomposableFunctionType>
+class MiniBatchSGD
+{
+ public:
+  /**
+   * Construct the MiniBatchSGD optimizer with the given function and
+   * parameters.
+   *
+   * @param function Function to be optimized (minimized).
+   * @param batchSize Number of functions in each batch.
+   * @param stepSize Step size for each iteration.
+   * @param momentum Momentum of the updates (0 for no momentum).
+   * @param maxIterations Maximum number of batches visited (0 means no
+   *     limit).
+   * @param tolerance Maximum absolute tolerance to terminate algorithm.
+   * @param shuffle If true, the batches are visited in a random order;
+   *     otherwise, they are visited in linear order.
+   */
+  MiniBatchSGD(DecomposableFunctionType& function,
+               const size_t batchSize = 1000,
+               const double stepSize = 0.01,
+               const double momentum = 0.0,
+               const size_t maxIterations = 100000,
+               const double tolerance = 1e-5,
+               const bool shuffle = true);
+
+  /**
+   * Optimize the given function using mini-batch stochastic gradient descent.
+   * The given starting point will be modified to store the finishing point of
+   * the algorithm, and the final objective value is returned.
+   *
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(arma::mat& iterate);
+
+  //! Get the instantiated function to be optimized.
+  const DecomposableFunctionType& Function() const { return function; }
+  //! Modify the instantiated function.
+  DecomposableFunctionType& Function() { return function; }
+
+  //! Get the batch size.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the batch size.
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get the step size.
+  double StepSize() const { return stepSize; }
+  //! Modify the step size.
+  double& StepSize() { return stepSize; }
+
+  //! Get the momentum.
+  double Momentum() const { return momentum; }
+  //! Modify the momentum.
+  double& Momentum() { return momentum; }
+
+  //! Get the maximum number of iterations (0 indicates no limit).
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of iterations (0 indicates no limit).
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the tolerance for termination.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for termination.
+  double& Tolerance() { return tolerance; }
+
+  //! Get whether or not the batches are shuffled.
+  bool Shuffle() const { return shuffle; }
+  //! Modify whether or not the batches are shuffled.
+  bool& Shuffle() { return shuffle; }
+
+  // Convert the object into a string.
+  std::string ToString() const;
+
+ private:
+  //! The instantiated function.
+  DecomposableFunctionType& function;
+
+  //! The number of functions in each batch.
+  size_t batchSize;
+
+  //! The step size for each batch.
+  double stepSize;
+
+  //! The momentum of the updates.
+  double momentum;
+
+  //! The maximum number of allowed iterations.
+  size_t maxIterations;
+
+  //! The tolerance for termination.
+  double tolerance;
+
+  //! Controls whether or not the batches are shuffled when iterating.
+  bool shuffle;
+};
+
+}; // namespace optimization
+}; // namespace mlpack
+
+// Include implementation.
+#include "minibatch_sgd_impl.hpp"
+
+#endif
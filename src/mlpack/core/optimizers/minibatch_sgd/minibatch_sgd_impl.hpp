@@ -0,0 +1,151 @@
+/**
+ * @file minibatch_sgd_impl.hpp
+ *
+ * Implementation of mini-batch stochastic gradient descent.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_MINIBATCH_SGD_IMPL_HPP
+#define __MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_MINIBATCH_SGD_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "minibatch_sgd.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+template<typename DecomposableFunctionType>
+MiniBatchSGD<DecomposableFunctionType>::MiniBatchSGD(
+    DecomposableFunctionType& function,
+    const size_t batchSize,
+    const double stepSize,
+    const double momentum,
+    const size_t maxIterations,
+    const double tolerance,
+    const bool shuffle) :
+    function(function),
+    batchSize(batchSize),
+    stepSize(stepSize),
+    momentum(momentum),
+    maxIterations(maxIterations),
+    tolerance(tolerance),
+    shuffle(shuffle)
+{ /* Nothing to do. */ }
+
+//! Optimize the function (minimize).
+template<typename DecomposableFunctionType>
+double MiniBatchSGD<DecomposableFunctionType>::Optimize(arma::mat& iterate)
+{
+  if (batchSize == 0)
+  {
+    Log::Fatal << "MiniBatchSGD::Optimize(): batch size must be greater than "
+        << "0!" << std::endl;
+  }
+
+  // Find the number of functions and batches to use.
+  const size_t numFunctions = function.NumFunctions();
+  if (numFunctions == 0)
+  {
+    Log::Fatal << "MiniBatchSGD::Optimize(): the function has no separable "
+        << "functions to optimize!" << std::endl;
+  }
+
+  const size_t numBatches = (numFunctions + batchSize - 1) / batchSize;
+
+  // This is used only if shuffle is true.
+  arma::vec visitationOrder;
+  if (shuffle)
+    visitationOrder = arma::shuffle(arma::linspace(0, (numBatches - 1),
+        numBatches));
+
+  // To keep track of where we are and how things are going.
+  size_t currentBatch = 0;
+  double overallObjective = 0;
+  double lastObjective = DBL_MAX;
+
+  // Calculate the first objective function, all at once.
+  overallObjective = EvaluateBatch(function, iterate, 0, numFunctions);
+
+  // Now iterate!
+  arma::mat gradient(iterate.n_rows, iterate.n_cols);
+  arma::mat velocity;
+  velocity.zeros(iterate.n_rows, iterate.n_cols);
+  for (size_t i = 1; i != maxIterations; ++i, ++currentBatch)
+  {
+    // Is this iteration the start of a sequence?
+    if ((currentBatch % numBatches) == 0)
+    {
+      // Output current objective function.
+      Log::Info << "Mini-batch SGD: iteration " << i << ", objective "
+          << overallObjective << "." << std::endl;
+
+      if (overallObjective != overallObjective)
+      {
+        Log::Warn << "Mini-batch SGD: converged to " << overallObjective
+            << "; terminating with failure.  Try a smaller step size?"
+            << std::endl;
+        return overallObjective;
+      }
+
+      if (std::abs(lastObjective - overallObjective) < tolerance)
+      {
+        Log::Info << "Mini-batch SGD: minimized within tolerance " << tolerance
+            << "; terminating optimization." << std::endl;
+        return overallObjective;
+      }
+
+      // Reset the counter variables.
+      lastObjective = overallObjective;
+      overallObjective = 0;
+      currentBatch = 0;
+
+      if (shuffle) // Determine order of visitation.
+        visitationOrder = arma::shuffle(visitationOrder);
+    }
+
+    // Find the functions in this batch; the last one may be smaller.
+    const size_t batch = shuffle ? (size_t) visitationOrder[currentBatch] :
+        currentBatch;
+    const size_t begin = batch * batchSize;
+    const size_t effectiveBatchSize = std::min(batchSize,
+        numFunctions - begin);
+
+    // Evaluate the gradient for this batch, and update the iterate with the
+    // average gradient.
+    GradientBatch(function, iterate, begin, gradient, effectiveBatchSize);
+
+    velocity *= momentum;
+    velocity -= (stepSize / effectiveBatchSize) * gradient;
+    iterate += velocity;
+
+    // Now add that to the overall objective function.
+    overallObjective += EvaluateBatch(function, iterate, begin,
+        effectiveBatchSize);
+  }
+
+  Log::Info << "Mini-batch SGD: maximum iterations (" << maxIterations << ") "
+      << "reached; terminating optimization." << std::endl;
+  // Calculate final objective.
+  return EvaluateBatch(function, iterate, 0, numFunctions);
+}
+
+// Convert the object to a string.
+template<typename DecomposableFunctionType>
+std::string MiniBatchSGD<DecomposableFunctionType>::ToString() const
+{
+  std::ostringstream convert;
+  convert << "MiniBatchSGD [" << this << "]" << std::endl;
+  convert << "  Function:" << std::endl;
+  convert << util::Indent(function.ToString(), 2);
+  convert << "  Batch size: " << batchSize << std::endl;
+  convert << "  Step size: " << stepSize << std::endl;
+  convert << "  Momentum: " << momentum << std::endl;
+  convert << "  Maximum iterations: " << maxIterations << std::endl;
+  convert << "  Tolerance: " << tolerance << std::endl;
+  convert << "  Shuffle batches: " << (shuffle ? "true" : "false")
+      << std::endl;
+  return convert.str();
+}
+
+}; // namespace optimization
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,154 @@
+/**
+ * @file parallel_sgd.hpp
+ *
+ * Parallel, lock-free ("Hogwild!") stochastic gradient descent for separable
+ * functions with sparse gradients.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_PARALLEL_SGD_PARALLEL_SGD_HPP
+#define __MLPACK_CORE_OPTIMIZERS_PARALLEL_SGD_PARALLEL_SGD_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * An implementation of parallel stochastic gradient descent without locking,
+ * as described in
+ *
+ * @code
+ * @inproceedings{recht2011hogwild,
+ *   title={Hogwild!: A Lock-Free Approach to Parallelizing Stochastic Gradient
+ *       Descent},
+ *   author={Recht, Benjamin and Re, Christopher and Wright, Stephen and Niu,
+ *       Feng},
+ *   booktitle={Advances in Neural Information Processing Systems 24},
+ *   pages={693--701},
+ *   year={2011}
+ * }
+ * @endcode
+ *
+ * The updates are the same as those of SGD: for each of the functions \f$
+ * f_i(A) \f$, \f$ A \f$ is moved a step of size \f$ \alpha \f$ against the
+ * gradient of \f$ f_i(A) \f$.  But here the functions of each pass are split
+ * between the OpenMP threads, which all update the same iterate at once,
+ * without any locks: each thread computes the gradient of its function at
+ * whatever the iterate is at that moment, and subtracts each nonzero element
+ * of the gradient from the iterate with an atomic update.  When the gradient
+ * of each function touches only a few elements of the iterate (as for matrix
+ * factorization, or for linear models on sparse features), the threads rarely
+ * update the same elements, and this converges nearly as well as serial SGD.
+ *
+ * When OpenMP is not available, or only one thread is used, the functions are
+ * visited serially in the visitation order, so the optimization is
+ * deterministic for a given random seed.
+ *
+ * The optimization runs in passes over all of the functions (in a new random
+ * order for each pass, if shuffle is true).  After each pass the objective is
+ * evaluated, and the optimization terminates when it has changed by less than
+ * the tolerance, or when maxIterations functions have been visited.
+ *
+ * For ParallelSGD to work, a SparseFunctionType template parameter is
+ * required.  This class must implement the following functions:
+ *
+ *   size_t NumFunctions();
+ *   double Evaluate(const arma::mat& coordinates, const size_t i);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t i,
+ *                 arma::sp_mat& gradient);
+ *
+ * These are the same as for SGD, except that the gradient of each function is
+ * sparse.  Both Evaluate() and Gradient() are called from several threads at
+ * once, so they must not modify the function object.
+ *
+ * @tparam SparseFunctionType Decomposable objective function type with sparse
+ *     gradients to be minimized.
+ */
+template<typename SparseFunctionType>
+class ParallelSGD
+{
+ public:
+  /**
+   * Construct the ParallelSGD optimizer with the given function and
+   * parameters.  These have the same meaning as for SGD.
+   *
+   * @param function Function to be optimized (minimized).
+   * @param stepSize Step size for each update.
+   * @param maxIterations Maximum number of functions visited (0 means no
+   *     limit).
+   * @param tolerance Maximum absolute tolerance to terminate algorithm.
+   * @param shuffle If true, the function order is shuffled for each pass;
+   *     otherwise, each function is visited in linear order.
+   */
+  ParallelSGD(SparseFunctionType& function,
+              const double stepSize = 0.01,
+              const size_t maxIterations = 100000,
+              const double tolerance = 1e-5,
+              const bool shuffle = true);
+
+  /**
+   * Optimize the given function using parallel stochastic gradient descent.
+   * The given starting point will be modified to store the finishing point of
+   * the algorithm, and the final objective value is returned.
+   *
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(arma::mat& iterate);
+
+  //! Get the instantiated function to be optimized.
+  const SparseFunctionType& Function() const { return function; }
+  //! Modify the instantiated function.
+  SparseFunctionType& Function() { return function; }
+
+  //! Get the step size.
+  double StepSize() const { return stepSize; }
+  //! Modify the step size.
+  double& StepSize() { return stepSize; }
+
+  //! Get the maximum number of iterations (0 indicates no limit).
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of iterations (0 indicates no limit).
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the tolerance for termination.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for termination.
+  double& Tolerance() { return tolerance; }
+
+  //! Get whether or not the individual functions are shuffled.
+  bool Shuffle() const { return shuffle; }
+  //! Modify whether or not the individual functions are shuffled.
+  bool& Shuffle() { return shuffle; }
+
+  // Convert the object into a string.
+  std::string ToString() const;
+
+ private:
+  //! Evaluate the sum of all of the functions at the given point, in parallel.
+  double Objective(const arma::mat& iterate);
+
+  //! The instantiated function.
+  SparseFunctionType& function;
+
+  //! The step size for each update.
+  double stepSize;
+
+  //! The maximum number of allowed iterations.
+  size_t maxIterations;
+
+  //! The tolerance for termination.
+  double tolerance;
+
+  //! Controls whether or not the individual functions are shuffled when
+  //! iterating.
+  bool shuffle;
+};
+
+}; // namespace optimization
+}; // namespace mlpack
+
+// Include implementation.
+#include "parallel_sgd_impl.hpp"
+
+#endif
@@ -0,0 +1,142 @@
+/**
+ * @file parallel_sgd_impl.hpp
+ *
+ * Implementation of parallel, lock-free stochastic gradient descent.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_PARALLEL_SGD_PARALLEL_SGD_IMPL_HPP
+#define __MLPACK_CORE_OPTIMIZERS_PARALLEL_SGD_PARALLEL_SGD_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "parallel_sgd.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+template<typename SparseFunctionType>
+ParallelSGD<SparseFunctionType>::ParallelSGD(SparseFunctionType& function,
+                                             const double stepSize,
+                                             const size_t maxIterations,
+                                             const double tolerance,
+                                             const bool shuffle) :
+    function(function),
+    stepSize(stepSize),
+    maxIterations(maxIterations),
+    tolerance(tolerance),
+    shuffle(shuffle)
+{ /* Nothing to do. */ }
+
+//! Optimize the function (minimize).
+template<typename SparseFunctionType>
+double ParallelSGD<SparseFunctionType>::Optimize(arma::mat& iterate)
+{
+  // Find the number of functions to use.
+  const size_t numFunctions = function.NumFunctions();
+
+  // The order in which the functions are visited; it is shuffled before each
+  // pass if shuffle is true.
+  arma::Col<size_t> visitationOrder(numFunctions);
+  for (size_t i = 0; i < numFunctions; ++i)
+    visitationOrder[i] = i;
+
+  // To keep track of where we are and how things are going.
+  size_t iterations = 0;
+  double overallObjective = Objective(iterate);
+  double lastObjective = DBL_MAX;
+
+  for (size_t pass = 1; ; ++pass)
+  {
+    // Output current objective function.
+    Log::Info << "Parallel SGD: pass " << pass << ", objective "
+        << overallObjective << "." << std::endl;
+
+    if (overallObjective != overallObjective)
+    {
+      Log::Warn << "Parallel SGD: converged to " << overallObjective
+          << "; terminating with failure.  Try a smaller step size?"
+          << std::endl;
+      return overallObjective;
+    }
+
+    if (std::abs(lastObjective - overallObjective) < tolerance)
+    {
+      Log::Info << "Parallel SGD: minimized within tolerance " << tolerance
+          << "; terminating optimization." << std::endl;
+      return overallObjective;
+    }
+
+    if (maxIterations != 0 && iterations >= maxIterations)
+    {
+      Log::Info << "Parallel SGD: maximum iterations (" << maxIterations
+          << ") reached; terminating optimization." << std::endl;
+      return overallObjective;
+    }
+
+    if (shuffle) // Determine order of visitation.
+      visitationOrder = arma::shuffle(visitationOrder);
+
+    // The last pass may be cut short by the iteration limit.
+    const size_t updates = (maxIterations == 0) ? numFunctions :
+        std::min(numFunctions, maxIterations - iterations);
+
+    // Each thread takes a contiguous part of the visitation order.  Nothing is
+    // locked: the gradients are taken at whatever the iterate is when they are
+    // computed, and each element of the update is applied atomically.
+    #pragma omp parallel
+    {
+      arma::sp_mat gradient;
+
+      #pragma omp for schedule(static)
+      for (size_t j = 0; j < updates; ++j)
+      {
+        function.Gradient(iterate, visitationOrder[j], gradient);
+
+        for (arma::sp_mat::const_iterator it = gradient.begin();
+             it != gradient.end(); ++it)
+        {
+          const double update = stepSize * (*it);
+          double& element = iterate(it.row(), it.col());
+
+          #pragma omp atomic
+          element -= update;
+        }
+      }
+    }
+
+    iterations += updates;
+    lastObjective = overallObjective;
+    overallObjective = Objective(iterate);
+  }
+}
+
+template<typename SparseFunctionType>
+double ParallelSGD<SparseFunctionType>::Objective(const arma::mat& iterate)
+{
+  const size_t numFunctions = function.NumFunctions();
+
+  double objective = 0;
+  #pragma omp parallel for schedule(static) reduction(+:objective)
+  for (size_t i = 0; i < numFunctions; ++i)
+    objective += function.Evaluate(iterate, i);
+
+  return objective;
+}
+
+// Convert the object to a string.
+template<typename SparseFunctionType>
+std::string ParallelSGD<SparseFunctionType>::ToString() const
+{
+  std::ostringstream convert;
+  convert << "ParallelSGD [" << this << "]" << std::endl;
+  convert << "  Function:" << std::endl;
+  convert << util::Indent(function.ToString(), 2);
+  convert << "  Step size: " << stepSize << std::endl;
+  convert << "  Maximum iterations: " << maxIterations << std::endl;
+  convert << "  Tolerance: " << tolerance << std::endl;
+  convert << "  Shuffle points: " << (shuffle ? "true" : "false") << std::endl;
+  return convert.str();
+}
+
+}; // namespace optimization
+}; // namespace mlpack
+
+#endif
@@ -16,5 +16,6 @@
 #include "binary_space_tree/breadth_first_dual_tree_traverser.hpp"
 #include "binary_space_tree/breadth_first_dual_tree_traverser_impl.hpp"
 #include "binary_space_tree/traits.hpp"
+#include "binary_space_tree/mapped_tree.hpp"
 
 #endif
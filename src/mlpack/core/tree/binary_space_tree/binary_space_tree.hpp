@@ -463,6 +463,31 @@ class BinarySpaceTree
     return new BinarySpaceTree(begin, count, bound, stat, maxLeafSize);
   }
 
+  /**
+   * Construct an empty node on the given dataset, without splitting anything.
+   * This is used by MappedTree, which fills in the members of each node when
+   * it loads a saved tree.
+   *
+   * @param parent Parent of this node (NULL for the root).
+   * @param data Dataset the tree was built on.
+   */
+  BinarySpaceTree(BinarySpaceTree* parent, MatType& data) :
+      left(NULL),
+      right(NULL),
+      parent(parent),
+      begin(0),
+      count(0),
+      maxLeafSize(0),
+      bound(data.n_rows),
+      splitDimension(0),
+      parentDistance(0),
+      furthestDescendantDistance(0),
+      minimumBoundDistance(0),
+      dataset(data) { }
+
+  //! MappedTree saves and loads the nodes of a tree.
+  template<typename TreeType> friend class MappedTree;
+
   /**
    * Splits the current node, assigning its left and right children recursively.
    *
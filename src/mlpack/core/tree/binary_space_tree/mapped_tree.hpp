@@ -0,0 +1,200 @@
+/**
+ * @file mapped_tree.hpp
+ *
+ * Definition of MappedTree, which saves a built BinarySpaceTree (along with the
+ * reordered dataset it was built on) to a flat file, and loads it again by
+ * memory-mapping that file.
+ */
+#ifndef __MLPACK_CORE_TREE_BINARY_SPACE_TREE_MAPPED_TREE_HPP
+#define __MLPACK_CORE_TREE_BINARY_SPACE_TREE_MAPPED_TREE_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/data/mapped_file.hpp>
+
+#include "../bounds.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The header at the start of a saved tree file.  Every section of the file is a
+ * multiple of 8 bytes long, so every section is aligned.
+ */
+struct FlatTreeHeader
+{
+  //! Magic string; always "MLPACKTR".
+  char magic[8];
+  //! Version of the file format.
+  uint64_t version;
+  //! Always 0x0102030405060708, to detect files written with another byte
+  //! order.
+  uint64_t byteOrder;
+  //! Dimensionality of the dataset.
+  uint64_t dimensionality;
+  //! Number of points in the dataset.
+  uint64_t numPoints;
+  //! Number of nodes in the tree.
+  uint64_t numNodes;
+  //! Identifier of the type of bound (see FlatBoundType()).
+  uint64_t boundType;
+  //! Number of doubles used to store the bound of each node.
+  uint64_t boundSize;
+  //! Offset of the reordered dataset (column-major doubles).
+  uint64_t datasetOffset;
+  //! Offset of the oldFromNew mapping (64-bit integers).
+  uint64_t oldFromNewOffset;
+  //! Offset of the nodes (FlatTreeNode objects, in depth-first order).
+  uint64_t nodesOffset;
+  //! Offset of the bounds (boundSize doubles for each node).
+  uint64_t boundsOffset;
+};
+
+/**
+ * A single node of a saved tree.  Children are referred to by their index in
+ * the depth-first ordering of the nodes; since the root is node 0, an index of
+ * 0 means that there is no child.
+ */
+struct FlatTreeNode
+{
+  //! Index of the first point in the node.
+  uint64_t begin;
+  //! Number of points in the node.
+  uint64_t count;
+  //! The max leaf size.
+  uint64_t maxLeafSize;
+  //! The dimension the node was split on.
+  uint64_t splitDimension;
+  //! Index of the left child (0 if none).
+  uint64_t left;
+  //! Index of the right child (0 if none).
+  uint64_t right;
+  //! Distance from the centroid of the node to the centroid of its parent.
+  double parentDistance;
+  //! Furthest possible distance from the centroid to any descendant.
+  double furthestDescendantDistance;
+};
+
+/**
+ * MappedTree holds a BinarySpaceTree which was loaded from a file written by
+ * MappedTree::Save().  The file contains the reordered dataset, the oldFromNew
+ * mapping, and every node of the tree with its bound, in a flat, pointer-free
+ * layout.  Loading it maps the file into memory: the dataset is used in place
+ * (it is never read or copied up front), and only the tree nodes themselves
+ * are allocated.  The statistic of each node is rebuilt, so a tree saved with
+ * one statistic type may be loaded with another (for instance, a tree built by
+ * allknn can be used by range_search).
+ *
+ * The tree can be passed, with Dataset(), to the search classes which take
+ * pre-built trees, such as NeighborSearch and RangeSearch:
+ *
+ * @code
+ * typedef BinarySpaceTree<HRectBound<2>,
+ *     NeighborSearchStat<NearestNeighborSort> > TreeType;
+ *
+ * // Build the tree once and save it.
+ * std::vector<size_t> oldFromNew;
+ * TreeType tree(referenceData, oldFromNew);
+ * MappedTree<TreeType>::Save(tree, oldFromNew, "reference.tree");
+ *
+ * // Later, load it and search with it.
+ * MappedTree<TreeType> mappedTree("reference.tree");
+ * AllkNN allknn(&mappedTree.Tree(), mappedTree.Dataset());
+ * @endcode
+ *
+ * The supported bound types are HRectBound and BallBound (with arma::vec).  The
+ * dataset type of the tree must be arma::mat.
+ *
+ * @tparam TreeType Type of BinarySpaceTree to save or load.
+ */
+template<typename TreeType>
+class MappedTree
+{
+ public:
+  //! The current version of the file format.
+  static const uint64_t FormatVersion = 1;
+
+  /**
+   * Save the given tree, the dataset it was built on, and the mapping from new
+   * point indices to old point indices (as filled by the tree constructor) to
+   * the given file.
+   *
+   * @param tree Root of the tree to save.
+   * @param oldFromNew Mapping from new point indices to old point indices.
+   * @param filename File to save to.
+   * @return true if the file was written successfully.
+   */
+  static bool Save(const TreeType& tree,
+                   const std::vector<size_t>& oldFromNew,
+                   const std::string& filename);
+
+  /**
+   * Load a tree from the given file.  If the file cannot be loaded, a fatal
+   * error is given.
+   *
+   * @param filename File to load the tree from.
+   */
+  MappedTree(const std::string& filename);
+
+  /**
+   * Delete the tree and release the mapping.  Any references to the tree or the
+   * dataset become invalid.
+   */
+  ~MappedTree();
+
+  //! Get the tree.
+  const TreeType& Tree() const { return *tree; }
+  //! Modify the tree.
+  TreeType& Tree() { return *tree; }
+
+  //! Get the (reordered) dataset the tree was built on.
+  const arma::mat& Dataset() const { return *dataset; }
+
+  //! Get the mapping from new point indices to old point indices.
+  const std::vector<size_t>& OldFromNew() const { return oldFromNew; }
+
+ private:
+  //! MappedTree objects may not be copied.
+  MappedTree(const MappedTree& other);
+  //! MappedTree objects may not be copied.
+  MappedTree& operator=(const MappedTree& other);
+
+  /**
+   * Append the given node and its descendants to the list of flat nodes and
+   * bounds, returning the index of the node.
+   */
+  static size_t Flatten(const TreeType& node,
+                        const size_t boundSize,
+                        std::vector<FlatTreeNode>& nodes,
+                        std::vector<double>& bounds);
+
+  /**
+   * Build the node with the given index (and its descendants) from the list of
+   * flat nodes and bounds.
+   */
+  TreeType* Unflatten(const FlatTreeNode* nodes,
+                      const double* bounds,
+                      const FlatTreeHeader& header,
+                      const size_t index,
+                      TreeType* parent);
+
+  //! Build the statistic of a node whose children have been built.
+  template<typename StatisticType>
+  static void BuildStatistic(StatisticType& stat, TreeType& node);
+
+  //! The mapped file.
+  data::MappedFile file;
+  //! The dataset, which aliases the memory of the mapped file.
+  arma::mat* dataset;
+  //! The mapping from new point indices to old point indices.
+  std::vector<size_t> oldFromNew;
+  //! The root of the tree.
+  TreeType* tree;
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+// Include implementation.
+#include "mapped_tree_impl.hpp"
+
+#endif
@@ -0,0 +1,338 @@
+/**
+ * @file mapped_tree_impl.hpp
+ *
+ * Implementation of MappedTree.
+ */
+#ifndef __MLPACK_CORE_TREE_BINARY_SPACE_TREE_MAPPED_TREE_IMPL_HPP
+#define __MLPACK_CORE_TREE_BINARY_SPACE_TREE_MAPPED_TREE_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "mapped_tree.hpp"
+
+#include <fstream>
+
+namespace mlpack {
+namespace tree {
+
+//! The magic string at the start of every saved tree file.
+const char flatTreeMagic[8] = { 'M', 'L', 'P', 'A', 'C', 'K', 'T', 'R' };
+
+//! The value of FlatTreeHeader::byteOrder.
+const uint64_t flatTreeByteOrder = 0x0102030405060708ULL;
+
+//! Identify the type of an HRectBound.  The cached distances in the tree depend
+//! on the metric, so trees are only loaded with the same type of bound.
+template<int Power, bool TakeRoot>
+uint64_t FlatBoundType(const bound::HRectBound<Power, TakeRoot>& /* bound */)
+{
+  return (1ULL << 32) | ((uint64_t) Power << 1) | (TakeRoot ? 1 : 0);
+}
+
+//! Return the number of doubles needed to store an HRectBound.
+template<int Power, bool TakeRoot>
+size_t FlatBoundSize(const bound::HRectBound<Power, TakeRoot>& bound)
+{
+  return 2 * bound.Dim() + 1;
+}
+
+//! Store an HRectBound as a list of doubles: each range, then the min width.
+template<int Power, bool TakeRoot>
+void FlattenBound(const bound::HRectBound<Power, TakeRoot>& bound,
+                  double* flat)
+{
+  for (size_t i = 0; i < bound.Dim(); ++i)
+  {
+    flat[2 * i] = bound[i].Lo();
+    flat[2 * i + 1] = bound[i].Hi();
+  }
+  flat[2 * bound.Dim()] = bound.MinWidth();
+}
+
+//! Restore an HRectBound from a list of doubles.
+template<int Power, bool TakeRoot>
+void UnflattenBound(const double* flat,
+                    bound::HRectBound<Power, TakeRoot>& bound)
+{
+  for (size_t i = 0; i < bound.Dim(); ++i)
+    bound[i] = math::Range(flat[2 * i], flat[2 * i + 1]);
+  bound.MinWidth() = flat[2 * bound.Dim()];
+}
+
+//! Identify the type of a BallBound.
+template<typename MetricType>
+uint64_t FlatBoundType(
+    const bound::BallBound<arma::vec, MetricType>& /* bound */)
+{
+  return (2ULL << 32);
+}
+
+//! Return the number of doubles needed to store a BallBound.
+template<typename MetricType>
+size_t FlatBoundSize(const bound::BallBound<arma::vec, MetricType>& bound)
+{
+  return (size_t) bound.Dim() + 1;
+}
+
+//! Store a BallBound as a list of doubles: the center, then the radius.
+template<typename MetricType>
+void FlattenBound(const bound::BallBound<arma::vec, MetricType>& bound,
+                  double* flat)
+{
+  for (size_t i = 0; i < bound.Center().n_elem; ++i)
+    flat[i] = bound.Center()[i];
+  flat[bound.Center().n_elem] = bound.Radius();
+}
+
+//! Restore a BallBound from a list of doubles.
+template<typename MetricType>
+void UnflattenBound(const double* flat,
+                    bound::BallBound<arma::vec, MetricType>& bound)
+{
+  for (size_t i = 0; i < bound.Center().n_elem; ++i)
+    bound.Center()[i] = flat[i];
+  bound.Radius() = flat[bound.Center().n_elem];
+}
+
+template<typename TreeType>
+bool MappedTree<TreeType>::Save(const TreeType& tree,
+                                const std::vector<size_t>& oldFromNew,
+                                const std::string& filename)
+{
+  const arma::mat& dataset = tree.Dataset();
+  if (oldFromNew.size() != dataset.n_cols)
+  {
+    Log::Fatal << "MappedTree::Save(): oldFromNew has " << oldFromNew.size()
+        << " elements, but the dataset has " << dataset.n_cols << " points!"
+        << std::endl;
+  }
+
+  // Lay out the nodes in depth-first order.
+  const size_t boundSize = FlatBoundSize(tree.Bound());
+  std::vector<FlatTreeNode> nodes;
+  std::vector<double> bounds;
+  Flatten(tree, boundSize, nodes, bounds);
+
+  FlatTreeHeader header;
+  std::copy(flatTreeMagic, flatTreeMagic + 8, header.magic);
+  header.version = FormatVersion;
+  header.byteOrder = flatTreeByteOrder;
+  header.dimensionality = dataset.n_rows;
+  header.numPoints = dataset.n_cols;
+  header.numNodes = nodes.size();
+  header.boundType = FlatBoundType(tree.Bound());
+  header.boundSize = boundSize;
+  header.datasetOffset = sizeof(FlatTreeHeader);
+  header.oldFromNewOffset = header.datasetOffset +
+      dataset.n_elem * sizeof(double);
+  header.nodesOffset = header.oldFromNewOffset +
+      oldFromNew.size() * sizeof(uint64_t);
+  header.boundsOffset = header.nodesOffset +
+      nodes.size() * sizeof(FlatTreeNode);
+
+  std::ofstream stream(filename.c_str(), std::ios::out | std::ios::binary |
+      std::ios::trunc);
+  if (!stream.is_open())
+  {
+    Log::Warn << "MappedTree::Save(): could not open '" << filename << "' for "
+        << "writing." << std::endl;
+    return false;
+  }
+
+  stream.write((const char*) &header, sizeof(FlatTreeHeader));
+  stream.write((const char*) dataset.memptr(), dataset.n_elem * sizeof(double));
+
+  const std::vector<uint64_t> oldFromNew64(oldFromNew.begin(),
+      oldFromNew.end());
+  if (!oldFromNew64.empty())
+  {
+    stream.write((const char*) &oldFromNew64[0],
+        oldFromNew64.size() * sizeof(uint64_t));
+  }
+
+  stream.write((const char*) &nodes[0], nodes.size() * sizeof(FlatTreeNode));
+  if (!bounds.empty())
+    stream.write((const char*) &bounds[0], bounds.size() * sizeof(double));
+
+  if (stream.fail())
+  {
+    Log::Warn << "MappedTree::Save(): error writing to '" << filename << "'."
+        << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+template<typename TreeType>
+MappedTree<TreeType>::MappedTree(const std::string& filename) :
+    file(filename),
+    dataset(NULL),
+    tree(NULL)
+{
+  if (!file.IsOpen())
+  {
+    Log::Fatal << "MappedTree::MappedTree(): could not open '" << filename
+        << "'!" << std::endl;
+  }
+
+  if (file.Size() < sizeof(FlatTreeHeader) ||
+      !std::equal(flatTreeMagic, flatTreeMagic + 8, file.Data()))
+  {
+    Log::Fatal << "MappedTree::MappedTree(): '" << filename << "' is not a "
+        << "saved tree!" << std::endl;
+  }
+
+  const FlatTreeHeader& header = *((const FlatTreeHeader*) file.Data());
+  if (header.byteOrder != flatTreeByteOrder)
+  {
+    Log::Fatal << "MappedTree::MappedTree(): '" << filename << "' was saved "
+        << "on a machine with a different byte order!" << std::endl;
+  }
+
+  if (header.version > FormatVersion)
+  {
+    Log::Fatal << "MappedTree::MappedTree(): '" << filename << "' has format "
+        << "version " << header.version << ", but only versions up to "
+        << (size_t) FormatVersion << " are supported!" << std::endl;
+  }
+
+  // Make sure every section is where it should be, so that a truncated file
+  // doesn't cause reads past the end of the mapping.
+  const uint64_t datasetSize = header.dimensionality * header.numPoints *
+      sizeof(double);
+  const uint64_t oldFromNewSize = header.numPoints * sizeof(uint64_t);
+  const uint64_t nodesSize = header.numNodes * sizeof(FlatTreeNode);
+  const uint64_t boundsSize = header.numNodes * header.boundSize *
+      sizeof(double);
+  if (header.numNodes == 0 ||
+      header.oldFromNewOffset != header.datasetOffset + datasetSize ||
+      header.nodesOffset != header.oldFromNewOffset + oldFromNewSize ||
+      header.boundsOffset != header.nodesOffset + nodesSize ||
+      header.boundsOffset + boundsSize > file.Size())
+  {
+    Log::Fatal << "MappedTree::MappedTree(): '" << filename << "' is truncated "
+        << "or corrupt!" << std::endl;
+  }
+
+  // Use the dataset in place.  The mapping is private, so the points are
+  // loaded lazily by the operating system, and never written back to the file.
+  dataset = new arma::mat((double*) (file.Data() + header.datasetOffset),
+      header.dimensionality, header.numPoints, false, true);
+
+  const uint64_t* oldFromNew64 = (const uint64_t*) (file.Data() +
+      header.oldFromNewOffset);
+  oldFromNew.assign(oldFromNew64, oldFromNew64 + header.numPoints);
+
+  const FlatTreeNode* nodes = (const FlatTreeNode*) (file.Data() +
+      header.nodesOffset);
+  const double* bounds = (const double*) (file.Data() + header.boundsOffset);
+
+  tree = Unflatten(nodes, bounds, header, 0, NULL);
+}
+
+template<typename TreeType>
+MappedTree<TreeType>::~MappedTree()
+{
+  // The tree refers to the dataset, and the dataset refers to the mapping, so
+  // they must be deleted in this order.
+  delete tree;
+  delete dataset;
+}
+
+template<typename TreeType>
+size_t MappedTree<TreeType>::Flatten(const TreeType& node,
+                                     const size_t boundSize,
+                                     std::vector<FlatTreeNode>& nodes,
+                                     std::vector<double>& bounds)
+{
+  const size_t index = nodes.size();
+
+  FlatTreeNode flatNode;
+  flatNode.begin = node.Begin();
+  flatNode.count = node.Count();
+  flatNode.maxLeafSize = node.MaxLeafSize();
+  flatNode.splitDimension = node.SplitDimension();
+  flatNode.left = 0;
+  flatNode.right = 0;
+  flatNode.parentDistance = node.ParentDistance();
+  flatNode.furthestDescendantDistance = node.FurthestDescendantDistance();
+  nodes.push_back(flatNode);
+
+  bounds.resize(bounds.size() + boundSize);
+  FlattenBound(node.Bound(), &bounds[index * boundSize]);
+
+  // The vector of nodes may be reallocated by the recursion, so we can't hold
+  // a reference to this node.
+  if (node.Left())
+  {
+    const size_t left = Flatten(*node.Left(), boundSize, nodes, bounds);
+    nodes[index].left = left;
+  }
+  if (node.Right())
+  {
+    const size_t right = Flatten(*node.Right(), boundSize, nodes, bounds);
+    nodes[index].right = right;
+  }
+
+  return index;
+}
+
+template<typename TreeType>
+TreeType* MappedTree<TreeType>::Unflatten(const FlatTreeNode* nodes,
+                                          const double* bounds,
+                                          const FlatTreeHeader& header,
+                                          const size_t index,
+                                          TreeType* parent)
+{
+  const FlatTreeNode& flatNode = nodes[index];
+
+  // Children always come after their parent in depth-first order; checking
+  // this means a corrupt file can't send us into a loop.
+  if ((flatNode.left != 0 && (flatNode.left <= index ||
+       flatNode.left >= header.numNodes)) ||
+      (flatNode.right != 0 && (flatNode.right <= index ||
+       flatNode.right >= header.numNodes)) ||
+      (flatNode.begin + flatNode.count > header.numPoints))
+  {
+    Log::Fatal << "MappedTree::MappedTree(): node " << index << " is corrupt!"
+        << std::endl;
+  }
+
+  TreeType* node = new TreeType(parent, *dataset);
+  if (FlatBoundType(node->bound) != header.boundType ||
+      FlatBoundSize(node->bound) != header.boundSize)
+  {
+    Log::Fatal << "MappedTree::MappedTree(): the tree was saved with a "
+        << "different type of bound!" << std::endl;
+  }
+
+  node->begin = flatNode.begin;
+  node->count = flatNode.count;
+  node->maxLeafSize = flatNode.maxLeafSize;
+  node->splitDimension = flatNode.splitDimension;
+  node->parentDistance = flatNode.parentDistance;
+  node->furthestDescendantDistance = flatNode.furthestDescendantDistance;
+  UnflattenBound(bounds + index * header.boundSize, node->bound);
+
+  if (flatNode.left != 0)
+    node->left = Unflatten(nodes, bounds, header, flatNode.left, node);
+  if (flatNode.right != 0)
+    node->right = Unflatten(nodes, bounds, header, flatNode.right, node);
+
+  // As in the tree constructors, the statistic is built after the children.
+  BuildStatistic(node->stat, *node);
+
+  return node;
+}
+
+template<typename TreeType>
+template<typename StatisticType>
+void MappedTree<TreeType>::BuildStatistic(StatisticType& stat, TreeType& node)
+{
+  stat = StatisticType(node);
+}
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
@@ -4,15 +4,154 @@
  * @author Michael Fox
  *
  * The SaveRestoreUtility provides helper functions in saving and
- *   restoring models.  The current output file type is XML.
+ *   restoring models.  Models can be stored either as XML or in a compact
+ *   binary format.
  */
 #include <mlpack/core.hpp>
 
+#include <algorithm>
+#include <fstream>
+#include <limits>
+
 using namespace mlpack;
 using namespace mlpack::util;
 
+namespace {
+
+//! The magic string at the start of every binary model file.
+const char binaryMagic[8] = { 'M', 'L', 'P', 'A', 'C', 'K', 'S', 'R' };
+
+//! Matrix blocks in binary files are aligned to this many bytes.
+const size_t binaryAlignment = 8;
+
+//! Returns true if this machine is little-endian.
+inline bool IsLittleEndian()
+{
+  const uint16_t one = 1;
+  return (*((const unsigned char*) &one) == 1);
+}
+
+//! Reverse the bytes of each of the given 8-byte words.
+inline void SwapBytes(void* data, const size_t words)
+{
+  unsigned char* bytes = (unsigned char*) data;
+  for (size_t i = 0; i < words; ++i, bytes += 8)
+    std::reverse(bytes, bytes + 8);
+}
+
+//! Write the given 64-bit integer as little-endian.
+void WriteUInt64(std::ostream& stream, uint64_t value)
+{
+  if (!IsLittleEndian())
+    SwapBytes(&value, 1);
+  stream.write((const char*) &value, sizeof(uint64_t));
+}
+
+//! Return the number of bytes left to read in the stream, or 0 if the stream
+//! can't be searched.
+uint64_t BytesLeft(std::istream& stream)
+{
+  const std::streampos current = stream.tellg();
+  if (current == std::streampos(-1))
+    return 0;
+
+  stream.seekg(0, std::ios::end);
+  const std::streampos end = stream.tellg();
+  stream.seekg(current);
+  if (end == std::streampos(-1) || end < current)
+    return 0;
+
+  return (uint64_t) (end - current);
+}
+
+//! Read a little-endian 64-bit integer.
+bool ReadUInt64(std::istream& stream, uint64_t& value)
+{
+  if (!stream.read((char*) &value, sizeof(uint64_t)))
+    return false;
+  if (!IsLittleEndian())
+    SwapBytes(&value, 1);
+  return true;
+}
+
+//! Write a string as its length followed by its characters.
+void WriteString(std::ostream& stream, const std::string& str)
+{
+  WriteUInt64(stream, str.size());
+  stream.write(str.data(), str.size());
+}
+
+//! Read a string written by WriteString().
+bool ReadString(std::istream& stream, std::string& str)
+{
+  uint64_t length;
+  if (!ReadUInt64(stream, length) || length > BytesLeft(stream))
+    return false;
+  str.resize(length);
+  return (length == 0) || stream.read(&str[0], length);
+}
+
+//! Convert a matrix to the text representation used in XML files.
+std::string MatrixToString(const arma::mat& mat)
+{
+  std::ostringstream output;
+  size_t columns = mat.n_cols;
+  size_t rows = mat.n_rows;
+  for (size_t r = 0; r < rows; ++r)
+  {
+    for (size_t c = 0; c < columns - 1; ++c)
+    {
+      output << std::setprecision(15) << mat(r, c) << ",";
+    }
+    output << std::setprecision(15) << mat(r, columns - 1) << std::endl;
+  }
+  return output.str();
+}
+
+} // anonymous namespace
+
 bool SaveRestoreUtility::ReadFile(const std::string& filename)
 {
+  parameters.clear();
+  matrices.clear();
+  children.clear();
+
+  // Check for the binary format first.
+  std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+  {
+    Log::Fatal << "Could not open file '" << filename << "' for reading!"
+        << std::endl;
+  }
+
+  char magic[sizeof(binaryMagic)];
+  if (stream.read(magic, sizeof(binaryMagic)) &&
+      std::equal(magic, magic + sizeof(binaryMagic), binaryMagic))
+  {
+    uint64_t version;
+    if (!ReadUInt64(stream, version))
+    {
+      Log::Fatal << "Could not read header of binary model file '" << filename
+          << "'!" << std::endl;
+    }
+
+    if (version > BinaryFormatVersion)
+    {
+      Log::Fatal << "Binary model file '" << filename << "' has format version "
+          << version << ", but only versions up to "
+          << (size_t) BinaryFormatVersion << " are supported!" << std::endl;
+    }
+
+    if (!ReadBinary(stream))
+    {
+      Log::Fatal << "Binary model file '" << filename << "' is truncated or "
+          << "corrupt!" << std::endl;
+    }
+
+    return true;
+  }
+  stream.close();
+
   xmlDocPtr xmlDocTree = NULL;
   if (NULL == (xmlDocTree = xmlReadFile(filename.c_str(), NULL, 0)))
   {
@@ -49,6 +188,24 @@ void SaveRestoreUtility::ReadFile(xmlNode* n)
 
 bool SaveRestoreUtility::WriteFile(const std::string& filename)
 {
+  // Use the binary format if the extension is .bin.
+  const std::string binaryExtension = ".bin";
+  if (filename.size() >= binaryExtension.size() &&
+      filename.compare(filename.size() - binaryExtension.size(),
+      binaryExtension.size(), binaryExtension) == 0)
+  {
+    std::ofstream stream(filename.c_str(), std::ios::out | std::ios::binary |
+        std::ios::trunc);
+    if (!stream.is_open())
+      return false;
+
+    stream.write(binaryMagic, sizeof(binaryMagic));
+    WriteUInt64(stream, BinaryFormatVersion);
+    WriteBinary(stream);
+
+    return !stream.fail();
+  }
+
   bool success = false;
   xmlDocPtr xmlDocTree = xmlNewDoc(BAD_CAST "1.0");
   xmlNodePtr root = xmlNewNode(NULL, BAD_CAST "root");
@@ -64,8 +221,14 @@ bool SaveRestoreUtility::WriteFile(const std::string& filename)
 
 void SaveRestoreUtility::WriteFile(xmlNode* n)
 {
+  // In XML, matrices are stored as text, just like every other parameter.
+  std::map<std::string, std::string> textParameters(parameters);
+  for (std::map<std::string, arma::mat>::const_iterator it = matrices.begin();
+       it != matrices.end(); ++it)
+    textParameters[(*it).first] = MatrixToString((*it).second);
+
   for (std::map<std::string, std::string>::reverse_iterator it =
-	    parameters.rbegin(); it != parameters.rend(); ++it)
+	    textParameters.rbegin(); it != textParameters.rend(); ++it)
   {
     xmlNewChild(n, NULL, BAD_CAST(*it).first.c_str(),
         BAD_CAST(*it).second.c_str());
@@ -79,9 +242,132 @@ void SaveRestoreUtility::WriteFile(xmlNode* n)
   }
 }
 
+void SaveRestoreUtility::WriteBinary(std::ostream& stream) const
+{
+  WriteUInt64(stream, parameters.size());
+  for (std::map<std::string, std::string>::const_iterator it =
+       parameters.begin(); it != parameters.end(); ++it)
+  {
+    WriteString(stream, (*it).first);
+    WriteString(stream, (*it).second);
+  }
+
+  WriteUInt64(stream, matrices.size());
+  for (std::map<std::string, arma::mat>::const_iterator it = matrices.begin();
+       it != matrices.end(); ++it)
+  {
+    const arma::mat& matrix = (*it).second;
+    WriteString(stream, (*it).first);
+    WriteUInt64(stream, matrix.n_rows);
+    WriteUInt64(stream, matrix.n_cols);
+
+    // Pad so that the matrix data is aligned.
+    const size_t offset = (size_t) stream.tellp();
+    const size_t padding = (binaryAlignment - (offset % binaryAlignment)) %
+        binaryAlignment;
+    const char zeros[binaryAlignment] = { 0 };
+    stream.write(zeros, padding);
+
+    if (IsLittleEndian())
+    {
+      stream.write((const char*) matrix.memptr(),
+          matrix.n_elem * sizeof(double));
+    }
+    else
+    {
+      arma::mat swapped(matrix);
+      SwapBytes(swapped.memptr(), swapped.n_elem);
+      stream.write((const char*) swapped.memptr(),
+          swapped.n_elem * sizeof(double));
+    }
+  }
+
+  WriteUInt64(stream, children.size());
+  for (std::map<std::string, SaveRestoreUtility>::const_iterator it =
+       children.begin(); it != children.end(); ++it)
+  {
+    WriteString(stream, (*it).first);
+    (*it).second.WriteBinary(stream);
+  }
+}
+
+bool SaveRestoreUtility::ReadBinary(std::istream& stream)
+{
+  uint64_t numParameters;
+  if (!ReadUInt64(stream, numParameters))
+    return false;
+  for (uint64_t i = 0; i < numParameters; ++i)
+  {
+    std::string name;
+    if (!ReadString(stream, name) || !ReadString(stream, parameters[name]))
+      return false;
+    matrices.erase(name);
+  }
+
+  uint64_t numMatrices;
+  if (!ReadUInt64(stream, numMatrices))
+    return false;
+  for (uint64_t i = 0; i < numMatrices; ++i)
+  {
+    std::string name;
+    uint64_t rows, cols;
+    if (!ReadString(stream, name) || !ReadUInt64(stream, rows) ||
+        !ReadUInt64(stream, cols))
+      return false;
+
+    // Skip the padding.
+    const size_t offset = (size_t) stream.tellg();
+    stream.seekg((binaryAlignment - (offset % binaryAlignment)) %
+        binaryAlignment, std::ios::cur);
+
+    // A corrupt file could ask for an enormous matrix, so make sure that the
+    // size doesn't overflow and that the data is actually there before
+    // allocating anything.
+    if (cols != 0 && rows > std::numeric_limits<uint64_t>::max() / cols)
+      return false;
+    const uint64_t elements = rows * cols;
+    const uint64_t maxSize = std::numeric_limits<arma::uword>::max();
+    if (rows > maxSize || cols > maxSize || elements > maxSize ||
+        elements > BytesLeft(stream) / sizeof(double))
+      return false;
+
+    parameters.erase(name);
+    arma::mat& matrix = matrices[name];
+    matrix.set_size(rows, cols);
+    if (!stream.read((char*) matrix.memptr(), matrix.n_elem * sizeof(double)))
+      return false;
+    if (!IsLittleEndian())
+      SwapBytes(matrix.memptr(), matrix.n_elem);
+  }
+
+  uint64_t numChildren;
+  if (!ReadUInt64(stream, numChildren))
+    return false;
+  for (uint64_t i = 0; i < numChildren; ++i)
+  {
+    std::string name;
+    if (!ReadString(stream, name) || !children[name].ReadBinary(stream))
+      return false;
+  }
+
+  return true;
+}
+
+bool SaveRestoreUtility::HasParameter(const std::string& name) const
+{
+  return (parameters.count(name) != 0) || (matrices.count(name) != 0);
+}
+
 arma::mat& SaveRestoreUtility::LoadParameter(arma::mat& matrix,
                                              const std::string& name) const
 {
+  // Matrices that were saved directly, or read from a binary file, need no
+  // parsing.
+  std::map<std::string, arma::mat>::const_iterator matrixIt =
+      matrices.find(name);
+  if (matrixIt != matrices.end())
+    return (matrix = (*matrixIt).second);
+
   std::map<std::string, std::string>::const_iterator it = parameters.find(name);
   if (it != parameters.end())
   {
@@ -176,24 +462,16 @@ void SaveRestoreUtility::SaveParameter(const char c, const std::string& name)
   int temp = (int) c;
   std::ostringstream output;
   output << temp;
+  matrices.erase(name);
   parameters[name] = output.str();
 }
 
 void SaveRestoreUtility::SaveParameter(const arma::mat& mat,
                                        const std::string& name)
 {
-  std::ostringstream output;
-  size_t columns = mat.n_cols;
-  size_t rows = mat.n_rows;
-  for (size_t r = 0; r < rows; ++r)
-  {
-    for (size_t c = 0; c < columns - 1; ++c)
-    {
-      output << std::setprecision(15) << mat(r, c) << ",";
-    }
-    output << std::setprecision(15) << mat(r, columns - 1) << std::endl;
-  }
-  parameters[name] = output.str();
+  // The matrix is only converted to text if it is written to an XML file.
+  parameters.erase(name);
+  matrices[name] = mat;
 }
 
 // Special template specializations for vectors.
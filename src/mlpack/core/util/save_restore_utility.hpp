@@ -3,7 +3,8 @@
  * @author Neil Slagle
  *
  * The SaveRestoreUtility provides helper functions in saving and
- *   restoring models.  The current output file type is XML.
+ *   restoring models.  Models can be stored either as XML or in a compact
+ *   binary format (for files with the extension .bin).
  *
  * @experimental
  */
@@ -24,6 +25,23 @@
 namespace mlpack {
 namespace util {
 
+/**
+ * The SaveRestoreUtility holds a hierarchy of named parameters and matrices,
+ * which can be written to and read from a file.  Two file formats are
+ * supported:
+ *
+ *  - XML, where every parameter (including every matrix) is a text node.
+ *  - A binary format, used when the filename ends in ".bin".  The file starts
+ *    with a header holding the magic string "MLPACKSR" and a format version,
+ *    and each matrix is stored as a raw block of little-endian doubles
+ *    (column-major), aligned to 8 bytes from the start of the file.  This means
+ *    that loading is little more than a read() into the matrix memory, and the
+ *    matrix blocks can be memory-mapped directly.
+ *
+ * ReadFile() detects the format from the contents of the file, so a model can
+ * be converted between the two formats by reading it and writing it again with
+ * a different extension.
+ */
 class SaveRestoreUtility
 {
  private:
@@ -32,6 +50,12 @@ class SaveRestoreUtility
    */
   std::map<std::string, std::string> parameters;
 
+  /**
+   * matrices contains a list of names and matrices which have been saved with
+   * SaveParameter() or loaded from a binary file.
+   */
+  std::map<std::string, arma::mat> matrices;
+
   /**
    * children contains a list of names in string format and child
    * models in the model hierarchy in SaveRestoreUtility format
@@ -45,19 +69,30 @@ class SaveRestoreUtility
 
  public:
 
+  //! The current version of the binary file format.
+  static const uint32_t BinaryFormatVersion = 1;
+
   SaveRestoreUtility() {}
   ~SaveRestoreUtility() { parameters.clear(); }
 
   /**
-   * ReadFile reads an XML tree from a file.
+   * ReadFile reads a model from a file, which may be either XML or binary.  Any
+   * parameters which were previously held are discarded.
    */
   bool ReadFile(const std::string& filename);
 
   /**
-   * WriteFile writes the XML tree to a file.
+   * WriteFile writes the model to a file.  If the filename ends in ".bin", the
+   * binary format is used; otherwise, the model is written as XML.
    */
   bool WriteFile(const std::string& filename);
 
+  /**
+   * Return whether or not a parameter (or matrix) with the given name is held
+   * at this level of the hierarchy.
+   */
+  bool HasParameter(const std::string& name) const;
+
   /**
    * LoadParameter loads a parameter from the parameters map.
    */
@@ -116,13 +151,13 @@ class SaveRestoreUtility
   /**
    * Return the children.
    */
-  const std::map<std::string, SaveRestoreUtility> Children() const { return
+  const std::map<std::string, SaveRestoreUtility>& Children() const { return
     children; }
 
   /**
-   * Return modifiable copy of the children.
+   * Modify the children.
    */
-  std::map<std::string, SaveRestoreUtility> Children() { return children; }
+  std::map<std::string, SaveRestoreUtility>& Children() { return children; }
 
  private:
   /**
@@ -135,6 +170,18 @@ class SaveRestoreUtility
    */
   void ReadFile(xmlNode* n);
 
+  /**
+   * WriteBinary writes this node and its children, recursively, in the binary
+   * format.
+   */
+  void WriteBinary(std::ostream& stream) const;
+
+  /**
+   * ReadBinary reads this node and its children, recursively, from the binary
+   * format.  Returns false if the stream ends prematurely.
+   */
+  bool ReadBinary(std::istream& stream);
+
 };
 
 //! Specialization for arma::vec.
@@ -70,6 +70,7 @@ void SaveRestoreUtility::SaveParameter(const T& t, const std::string& name)
   // Manually increase precision to solve #313 for now, until we have a way to
   // store this as an actual binary number.
   output << std::setprecision(15) << t;
+  matrices.erase(name);
   parameters[name] = output.str();
 }
 
@@ -84,6 +85,7 @@ void SaveRestoreUtility::SaveParameter(const std::vector<T>& t,
   }
   std::string vectorAsStr = output.str();
   vectorAsStr.erase(vectorAsStr.length() - 1);
+  matrices.erase(name);
   parameters[name] = vectorAsStr;
 }
 
@@ -141,8 +141,12 @@ class CF
   const arma::mat& W() const { return w; }
   //! Get the Item Matrix.
   const arma::mat& H() const { return h; }
-  //! Get the Rating Matrix.
-  const arma::mat& Rating() const { return rating; }
+  /**
+   * Get the estimated rating matrix, W * H.  This is a dense (items x users)
+   * matrix which is computed on demand; it is not used (or stored) by
+   * GetRecommendations(), so for large datasets it should be avoided.
+   */
+  arma::mat Rating() const { return w * h; }
   //! Get the cleaned data matrix.
   const arma::sp_mat& CleanedData() const { return cleanedData; }
 
@@ -158,6 +162,12 @@ class CF
   /**
    * Generates the given number of recommendations for the specified users.
    *
+   * The neighborhood of each user is found in the rank-dimensional latent
+   * space of H (with a transformation that preserves distances between
+   * estimated rating vectors), and estimated ratings are computed for blocks
+   * of users at a time.  So the dense rating matrix W * H is never formed, and
+   * the memory used is O((users + items) * rank).
+   *
    * @param numRecs Number of Recommendations
    * @param recommendations Matrix to save recommendations
    * @param users Users for which recommendations are to be generated
@@ -182,8 +192,6 @@ class CF
   arma::mat w;
   //! Item matrix.
   arma::mat h;
-  //! Rating matrix.
-  arma::mat rating;
   //! Cleaned data matrix.
   arma::sp_mat cleanedData;
   //! Converts the User, Item, Value Matrix to User-Item Table
@@ -116,81 +116,112 @@ void CF<FactorizerType>::GetRecommendations(const size_t numRecs,
                                             arma::Mat<size_t>& recommendations,
                                             arma::Col<size_t>& users)
 {
-  // Generate new table by multiplying approximate values.
-  rating = w * h;
+  // We want the neighborhood of each queried user in the space of estimated
+  // ratings, W * H.  But that matrix is dense and has size (items x users), so
+  // we never build it.  Instead, note that for two users a and b,
+  //
+  //   || W h_a - W h_b ||^2 = (h_a - h_b)^T (W^T W) (h_a - h_b),
+  //
+  // so if W^T W = L^T L, the distance between the rating columns of a and b is
+  // the distance between L h_a and L h_b, which are only rank-dimensional.  We
+  // use an eigendecomposition (instead of a Cholesky decomposition) because
+  // W^T W is only positive semidefinite if W is rank-deficient.
+  arma::vec eigval;
+  arma::mat eigvec;
+  arma::eig_sym(eigval, eigvec, arma::trans(w) * w);
+  for (size_t i = 0; i < eigval.n_elem; ++i)
+    eigval[i] = (eigval[i] > 0.0) ? std::sqrt(eigval[i]) : 0.0;
+  const arma::mat transformation = arma::diagmat(eigval) * arma::trans(eigvec);
 
-  // Now, we will use the decomposed w and h matrices to estimate what the user
-  // would have rated items as, and then pick the best items.
+  // The rating-space geometry of the users, in rank dimensions.
+  arma::mat latentUsers = transformation * h;
 
-  // Temporarily store feature vector of queried users.
-  arma::mat query(rating.n_rows, users.n_elem);
+  // Temporarily store the latent vectors of queried users.
+  arma::mat query(latentUsers.n_rows, users.n_elem);
 
-  // Select feature vectors of queried users.
+  // Select latent vectors of queried users.
   for (size_t i = 0; i < users.n_elem; i++)
-    query.col(i) = rating.col(users(i));
+    query.col(i) = latentUsers.col(users(i));
 
   // Temporary storage for neighborhood of the queried users.
   arma::Mat<size_t> neighborhood;
 
   // Calculate the neighborhood of the queried users.
   // This should be a templatized option.
-  neighbor::AllkNN a(rating, query);
+  neighbor::AllkNN a(latentUsers, query);
   arma::mat resultingDistances; // Temporary storage.
   a.Search(numUsersForSimilarity, neighborhood, resultingDistances);
 
-  // Temporary storage for storing the average rating for each user in their
-  // neighborhood.
-  arma::mat averages = arma::zeros<arma::mat>(rating.n_rows, query.n_cols);
+  // The average rating vector of a neighborhood is W times the average of the
+  // neighbors' columns of H, so we only need to average rank-dimensional
+  // vectors.
+  arma::mat averages = arma::zeros<arma::mat>(h.n_rows, users.n_elem);
 
   // Iterate over each query user.
   for (size_t i = 0; i < neighborhood.n_cols; ++i)
   {
     // Iterate over each neighbor of the query user.
     for (size_t j = 0; j < neighborhood.n_rows; ++j)
-      averages.col(i) += rating.col(neighborhood(j, i));
+      averages.col(i) += h.col(neighborhood(j, i));
     // Normalize average.
     averages.col(i) /= neighborhood.n_rows;
   }
 
   // Generate recommendations for each query user by finding the maximum numRecs
-  // elements in the averages matrix.
+  // elements of their estimated ratings.  The estimated ratings are computed
+  // with one matrix multiplication for a block of users at a time, so the
+  // temporary storage is only (items x blockSize).
   recommendations.set_size(numRecs, users.n_elem);
   recommendations.fill(cleanedData.n_rows); // Invalid item number.
   arma::mat values(numRecs, users.n_elem);
   values.fill(-DBL_MAX); // The smallest possible value.
-  for (size_t i = 0; i < users.n_elem; i++)
+
+  const size_t blockSize = std::max(rank, (size_t) 64);
+  arma::mat ratings;
+  for (size_t begin = 0; begin < users.n_elem; begin += blockSize)
   {
-    // Look through the averages column corresponding to the current user.
-    for (size_t j = 0; j < averages.n_rows; ++j)
+    const size_t end = std::min(begin + blockSize, (size_t) users.n_elem);
+    ratings = w * averages.cols(begin, end - 1);
+
+    for (size_t i = begin; i < end; i++)
     {
-      // Ensure that the user hasn't already rated the item.
-      if (cleanedData(j, users(i)) != 0.0)
-        continue; // The user already rated the item.
+      arma::vec userRatings = ratings.unsafe_col(i - begin);
+
+      // Ensure that the user hasn't already rated the item: walk the nonzero
+      // elements of the user's column and exclude them.
+      for (arma::sp_mat::const_iterator it = cleanedData.begin_col(users(i));
+          it != cleanedData.end_col(users(i)); ++it)
+        userRatings(it.row()) = -DBL_MAX;
 
-      // Is the estimated value better than the worst candidate?
-      const double value = averages(j, i);
-      if (value > values(values.n_rows - 1, i))
+      // Look through the estimated ratings of the current user.
+      for (size_t j = 0; j < userRatings.n_elem; ++j)
       {
-        // It should be inserted.  Which position?
-        size_t insertPosition = values.n_rows - 1;
-        while (insertPosition > 0)
+        // Is the estimated value better than the worst candidate?
+        const double value = userRatings(j);
+        if (value > values(values.n_rows - 1, i))
         {
-          if (value <= values(insertPosition - 1, i))
-            break; // The current value is the right one.
-          insertPosition--;
-        }
+          // It should be inserted.  Which position?
+          size_t insertPosition = values.n_rows - 1;
+          while (insertPosition > 0)
+          {
+            if (value <= values(insertPosition - 1, i))
+              break; // The current value is the right one.
+            insertPosition--;
+          }
 
-        // Now insert it into the list.
-        InsertNeighbor(i, insertPosition, j, value, recommendations,
-            values);
+          // Now insert it into the list.
+          InsertNeighbor(i, insertPosition, j, value, recommendations,
+              values);
+        }
       }
-    }
 
-    // If we were not able to come up with enough recommendations, issue a
-    // warning.
-    if (recommendations(values.n_rows - 1, i) == cleanedData.n_rows + 1)
-      Log::Warn << "Could not provide " << values.n_rows << " recommendations "
-          << "for user " << users(i) << " (not enough un-rated items)!" << std::endl;
+      // If we were not able to come up with enough recommendations, issue a
+      // warning.
+      if (recommendations(values.n_rows - 1, i) == cleanedData.n_rows)
+        Log::Warn << "Could not provide " << values.n_rows << " recommendations "
+            << "for user " << users(i) << " (not enough un-rated items)!"
+            << std::endl;
+    }
   }
 }
 
@@ -176,7 +176,9 @@ DTree* mlpack::det::Trainer(arma::mat& dataset,
   std::vector<double> regularizationConstants;
   regularizationConstants.resize(prunedSequence.size(), 0);
 
-  // Go through each fold.
+  // Go through each fold.  The folds are run one at a time, because each one
+  // holds a copy of the training set and its sorted orders; Grow() parallelizes
+  // the work inside each fold instead.
   for (size_t fold = 0; fold < folds; fold++)
   {
     // Break up data into train and test sets.
@@ -209,9 +211,7 @@ DTree* mlpack::det::Trainer(arma::mat& dataset,
       cvOldFromNew[i] = i;
 
     // Grow the tree.
-    oldAlpha = 0.0;
-    alpha = cvDTree->Grow(train, cvOldFromNew, useVolumeReg, maxLeafSize,
-        minLeafSize);
+    cvDTree->Grow(train, cvOldFromNew, useVolumeReg, maxLeafSize, minLeafSize);
 
     // Sequentially prune with all the values of available alphas and adding
     // values for test values.  Don't enter this loop if there are less than two
@@ -231,9 +231,9 @@ DTree* mlpack::det::Trainer(arma::mat& dataset,
       regularizationConstants[i] += 2.0 * cvVal / (double) dataset.n_cols;
 
       // Determine the new alpha value and prune accordingly.
-      oldAlpha = 0.5 * (prunedSequence[i + 1].first +
+      const double cvAlpha = 0.5 * (prunedSequence[i + 1].first +
           prunedSequence[i + 2].first);
-      alpha = cvDTree->PruneAndUpdate(oldAlpha, train.n_cols, useVolumeReg);
+      cvDTree->PruneAndUpdate(cvAlpha, train.n_cols, useVolumeReg);
     }
 
     // Compute test values for this state of the tree.
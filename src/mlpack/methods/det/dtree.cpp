@@ -12,6 +12,9 @@
 using namespace mlpack;
 using namespace det;
 
+// Nodes with more points than this split their work into OpenMP tasks.
+static const size_t ParallelNodeSize = 10000;
+
 DTree::DTree() :
     start(0),
     end(0),
@@ -137,101 +140,166 @@ bool DTree::FindSplit(const arma::mat& data,
   assert(data.n_rows == maxVals.n_elem);
   assert(data.n_rows == minVals.n_elem);
 
-  const size_t points = end - start;
-
   double minError = logNegError;
   bool splitFound = false;
 
   // Loop through each dimension.
   for (size_t dim = 0; dim < maxVals.n_elem; dim++)
   {
-    // Have to deal with REAL, INTEGER, NOMINAL data differently, so we have to
-    // think of how to do that...
-    const double min = minVals[dim];
-    const double max = maxVals[dim];
-
-    // If there is nothing to split in this dimension, move on.
-    if (max - min == 0.0)
-      continue; // Skip to next dimension.
-
-    // Initializing all the stuff for this dimension.
-    bool dimSplitFound = false;
-    // Take an error estimate for this dimension.
-    double minDimError = std::pow(points, 2.0) / (max - min);
-    double dimLeftError = 0.0; // For -Wuninitialized.  These variables will
-    double dimRightError = 0.0; // always be set to something else before use.
-    double dimSplitValue = 0.0;
-
-    // Find the log volume of all the other dimensions.
-    double volumeWithoutDim = logVolume - std::log(max - min);
-
-    // Get the values for the dimension.
+    // Get the values for the dimension, sorted in ascending order.
     arma::rowvec dimVec = data.row(dim).subvec(start, end - 1);
-
-    // Sort the values in ascending order.
     dimVec = arma::sort(dimVec);
 
-    // Find the best split for this dimension.  We need to figure out why
-    // there are spikes if this minLeafSize is enforced here...
-    for (size_t i = minLeafSize - 1; i < dimVec.n_elem - minLeafSize; ++i)
+    double dimError, dimSplitValue, dimLeftError, dimRightError;
+    if (FindSplitInDimension(dimVec.memptr(), dim, data.n_cols, minLeafSize,
+        dimError, dimSplitValue, dimLeftError, dimRightError) &&
+        (dimError > minError))
     {
-      // This makes sense for real continuous data.  This kinda corrupts the
-      // data and estimation if the data is ordinal.
-      const double split = (dimVec[i] + dimVec[i + 1]) / 2.0;
+      minError = dimError;
+      splitDim = dim;
+      splitValue = dimSplitValue;
+      leftError = dimLeftError;
+      rightError = dimRightError;
+      splitFound = true;
+    }
+  }
 
-      if (split == dimVec[i])
-        continue; // We can't split here (two points are the same).
+  return splitFound;
+}
 
-      // Another way of picking split is using this:
-      //   split = leftsplit;
-      if ((split - min > 0.0) && (max - split > 0.0))
-      {
-        // Ensure that the right node will have at least the minimum number of
-        // points.
-        Log::Assert((points - i - 1) >= minLeafSize);
-
-        // Now we have to see if the error will be reduced.  Simple manipulation
-        // of the error function gives us the condition we must satisfy:
-        //   |t_l|^2 / V_l + |t_r|^2 / V_r  >= |t|^2 / (V_l + V_r)
-        // and because the volume is only dependent on the dimension we are
-        // splitting, we can assume V_l is just the range of the left and V_r is
-        // just the range of the right.
-        double negLeftError = std::pow(i + 1, 2.0) / (split - min);
-        double negRightError = std::pow(points - i - 1, 2.0) / (max - split);
-
-        // If this is better, take it.
-        if ((negLeftError + negRightError) >= minDimError)
-        {
-          minDimError = negLeftError + negRightError;
-          dimLeftError = negLeftError;
-          dimRightError = negRightError;
-          dimSplitValue = split;
-          dimSplitFound = true;
-        }
-      }
-    }
+// This is the same as FindSplit(), but the values of the points of this node
+// are already sorted in each dimension, so each dimension can be searched
+// independently.
+bool DTree::FindSortedSplit(const arma::mat& sortedValues,
+                            const size_t totalPoints,
+                            size_t& splitDim,
+                            double& splitValue,
+                            double& leftError,
+                            double& rightError,
+                            const size_t minLeafSize) const
+{
+  const size_t dims = maxVals.n_elem;
+  std::vector<char> dimSplitFound(dims);
+  arma::vec dimErrors(dims), dimSplitValues(dims), dimLeftErrors(dims),
+      dimRightErrors(dims);
 
-    double actualMinDimError = std::log(minDimError)
-        - 2 * std::log((double) data.n_cols) - volumeWithoutDim;
+  // Large nodes search each dimension in a separate task.
+  for (size_t dim = 0; dim < dims; ++dim)
+  {
+    #pragma omp task default(shared) firstprivate(dim) \
+        if(end - start > ParallelNodeSize)
+    dimSplitFound[dim] = FindSplitInDimension(sortedValues.colptr(dim) + start,
+        dim, totalPoints, minLeafSize, dimErrors[dim], dimSplitValues[dim],
+        dimLeftErrors[dim], dimRightErrors[dim]);
+  }
+  #pragma omp taskwait
 
-    if ((actualMinDimError > minError) && dimSplitFound)
+  // Take the best dimension.  As in FindSplit(), ties go to the first
+  // dimension.
+  double minError = logNegError;
+  bool splitFound = false;
+  for (size_t dim = 0; dim < dims; ++dim)
+  {
+    if (dimSplitFound[dim] && (dimErrors[dim] > minError))
     {
-      // Calculate actual error (in logspace) by adding terms back to our
-      // estimate.
-      minError = actualMinDimError;
+      minError = dimErrors[dim];
       splitDim = dim;
-      splitValue = dimSplitValue;
-      leftError = std::log(dimLeftError) - 2 * std::log((double) data.n_cols)
-          - volumeWithoutDim;
-      rightError = std::log(dimRightError) - 2 * std::log((double) data.n_cols)
-          - volumeWithoutDim;
+      splitValue = dimSplitValues[dim];
+      leftError = dimLeftErrors[dim];
+      rightError = dimRightErrors[dim];
       splitFound = true;
-    } // end if better split found in this dimension.
+    }
   }
 
   return splitFound;
 }
 
+bool DTree::FindSplitInDimension(const double* sortedDimValues,
+                                 const size_t dim,
+                                 const size_t totalPoints,
+                                 const size_t minLeafSize,
+                                 double& dimError,
+                                 double& splitValue,
+                                 double& leftError,
+                                 double& rightError) const
+{
+  const size_t points = end - start;
+
+  // Have to deal with REAL, INTEGER, NOMINAL data differently, so we have to
+  // think of how to do that...
+  const double min = minVals[dim];
+  const double max = maxVals[dim];
+
+  // If there is nothing to split in this dimension, move on.
+  if (max - min == 0.0)
+    return false;
+
+  // Initializing all the stuff for this dimension.
+  bool dimSplitFound = false;
+  // Take an error estimate for this dimension.
+  double minDimError = std::pow(points, 2.0) / (max - min);
+  double dimLeftError = 0.0; // For -Wuninitialized.  These variables will
+  double dimRightError = 0.0; // always be set to something else before use.
+  double dimSplitValue = 0.0;
+
+  // Find the log volume of all the other dimensions.
+  double volumeWithoutDim = logVolume - std::log(max - min);
+
+  // Find the best split for this dimension.  We need to figure out why
+  // there are spikes if this minLeafSize is enforced here...
+  for (size_t i = minLeafSize - 1; i < points - minLeafSize; ++i)
+  {
+    // This makes sense for real continuous data.  This kinda corrupts the
+    // data and estimation if the data is ordinal.
+    const double split = (sortedDimValues[i] + sortedDimValues[i + 1]) / 2.0;
+
+    if (split == sortedDimValues[i])
+      continue; // We can't split here (two points are the same).
+
+    // Another way of picking split is using this:
+    //   split = leftsplit;
+    if ((split - min > 0.0) && (max - split > 0.0))
+    {
+      // Ensure that the right node will have at least the minimum number of
+      // points.
+      Log::Assert((points - i - 1) >= minLeafSize);
+
+      // Now we have to see if the error will be reduced.  Simple manipulation
+      // of the error function gives us the condition we must satisfy:
+      //   |t_l|^2 / V_l + |t_r|^2 / V_r  >= |t|^2 / (V_l + V_r)
+      // and because the volume is only dependent on the dimension we are
+      // splitting, we can assume V_l is just the range of the left and V_r is
+      // just the range of the right.
+      double negLeftError = std::pow(i + 1, 2.0) / (split - min);
+      double negRightError = std::pow(points - i - 1, 2.0) / (max - split);
+
+      // If this is better, take it.
+      if ((negLeftError + negRightError) >= minDimError)
+      {
+        minDimError = negLeftError + negRightError;
+        dimLeftError = negLeftError;
+        dimRightError = negRightError;
+        dimSplitValue = split;
+        dimSplitFound = true;
+      }
+    }
+  }
+
+  if (!dimSplitFound)
+    return false;
+
+  // Calculate actual error (in logspace) by adding terms back to our estimate.
+  dimError = std::log(minDimError) - 2 * std::log((double) totalPoints) -
+      volumeWithoutDim;
+  splitValue = dimSplitValue;
+  leftError = std::log(dimLeftError) - 2 * std::log((double) totalPoints) -
+      volumeWithoutDim;
+  rightError = std::log(dimRightError) - 2 * std::log((double) totalPoints) -
+      volumeWithoutDim;
+
+  return true;
+}
+
 size_t DTree::SplitData(arma::mat& data,
                         const size_t splitDim,
                         const double splitValue,
@@ -275,6 +343,87 @@ double DTree::Grow(arma::mat& data,
   Log::Assert(data.n_rows == maxVals.n_elem);
   Log::Assert(data.n_rows == minVals.n_elem);
 
+  // Sort the points of this node in each dimension.  Points are identified by
+  // their position in the dataset right now; SplitData() will move them
+  // around, but the identifiers are only used to tell which child each point
+  // goes to.
+  arma::mat sortedValues(data.n_cols, data.n_rows);
+  arma::Mat<size_t> sortedIndices(data.n_cols, data.n_rows);
+
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t dim = 0; dim < data.n_rows; ++dim)
+  {
+    const arma::rowvec dimValues = data.row(dim).subvec(start, end - 1);
+    const arma::uvec order = arma::sort_index(dimValues);
+    for (size_t i = 0; i < order.n_elem; ++i)
+    {
+      sortedValues(start + i, dim) = dimValues[order[i]];
+      sortedIndices(start + i, dim) = start + order[i];
+    }
+  }
+
+  std::vector<char> goesLeft(data.n_cols);
+
+  // The tree is grown by one thread; the others pick up the tasks for large
+  // nodes.
+  double alpha = 0.0;
+  #pragma omp parallel
+  {
+    #pragma omp single
+    alpha = GrowSorted(data, oldFromNew, sortedValues, sortedIndices, goesLeft,
+        useVolReg, maxLeafSize, minLeafSize);
+  }
+
+  return alpha;
+}
+
+void DTree::SplitSorted(arma::mat& sortedValues,
+                        arma::Mat<size_t>& sortedIndices,
+                        std::vector<char>& goesLeft,
+                        const size_t splitDim,
+                        const size_t splitIndex) const
+{
+  // The points that go left are the first ones in the split dimension.
+  for (size_t i = start; i < end; ++i)
+    goesLeft[sortedIndices(i, splitDim)] = (i < splitIndex);
+
+  // Now do a stable partition of every other dimension, so that both sides
+  // stay sorted.
+  for (size_t dim = 0; dim < sortedValues.n_cols; ++dim)
+  {
+    if (dim == splitDim)
+      continue;
+
+    #pragma omp task default(shared) firstprivate(dim) \
+        if(end - start > ParallelNodeSize)
+    {
+      const arma::vec values = sortedValues.col(dim).subvec(start, end - 1);
+      const arma::Col<size_t> indices =
+          sortedIndices.col(dim).subvec(start, end - 1);
+
+      size_t leftIndex = start;
+      size_t rightIndex = splitIndex;
+      for (size_t i = 0; i < values.n_elem; ++i)
+      {
+        const size_t index = (goesLeft[indices[i]] ? leftIndex++ :
+            rightIndex++);
+        sortedValues(index, dim) = values[i];
+        sortedIndices(index, dim) = indices[i];
+      }
+    }
+  }
+  #pragma omp taskwait
+}
+
+double DTree::GrowSorted(arma::mat& data,
+                         arma::Col<size_t>& oldFromNew,
+                         arma::mat& sortedValues,
+                         arma::Mat<size_t>& sortedIndices,
+                         std::vector<char>& goesLeft,
+                         const bool useVolReg,
+                         const size_t maxLeafSize,
+                         const size_t minLeafSize)
+{
   double leftG, rightG;
 
   // Compute points ratio.
@@ -293,11 +442,13 @@ double DTree::Grow(arma::mat& data,
     size_t dim;
     double splitValueTmp;
     double leftError, rightError;
-    if (FindSplit(data, dim, splitValueTmp, leftError, rightError, minLeafSize))
+    if (FindSortedSplit(sortedValues, data.n_cols, dim, splitValueTmp,
+        leftError, rightError, minLeafSize))
     {
       // Move the data around for the children to have points in a node lie
       // contiguously (to increase efficiency during the training).
       const size_t splitIndex = SplitData(data, dim, splitValueTmp, oldFromNew);
+      SplitSorted(sortedValues, sortedIndices, goesLeft, dim, splitIndex);
 
       // Make max and min vals for the children.
       arma::vec maxValsL(maxVals);
@@ -316,10 +467,14 @@ double DTree::Grow(arma::mat& data,
       left = new DTree(maxValsL, minValsL, start, splitIndex, leftError);
       right = new DTree(maxValsR, minValsR, splitIndex, end, rightError);
 
-      leftG = left->Grow(data, oldFromNew, useVolReg, maxLeafSize,
-          minLeafSize);
-      rightG = right->Grow(data, oldFromNew, useVolReg, maxLeafSize,
-          minLeafSize);
+      // The children have disjoint sets of points, so large children can be
+      // grown at the same time.
+      #pragma omp task default(shared) if(splitIndex - start > ParallelNodeSize)
+      leftG = left->GrowSorted(data, oldFromNew, sortedValues, sortedIndices,
+          goesLeft, useVolReg, maxLeafSize, minLeafSize);
+      rightG = right->GrowSorted(data, oldFromNew, sortedValues, sortedIndices,
+          goesLeft, useVolReg, maxLeafSize, minLeafSize);
+      #pragma omp taskwait
 
       // Store values of R(T~) and |T~|.
       subtreeLeaves = left->SubtreeLeaves() + right->SubtreeLeaves();
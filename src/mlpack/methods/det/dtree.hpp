@@ -108,6 +108,12 @@ class DTree
    * Greedily expand the tree.  The points in the dataset will be reordered
    * during tree growth.
    *
+   * The points are sorted in each dimension once, before the tree is grown,
+   * and the sorted orders are split along with the nodes, so no node has to
+   * sort its points.  (This takes extra memory for two matrices of the same
+   * size as the dataset.)  If OpenMP is available, the candidate splits of
+   * each dimension and the children of large nodes are handled in parallel.
+   *
    * @param data Dataset to build tree on.
    * @param oldFromNew Mappings from old points to new points.
    * @param useVolReg If true, volume regularization is used.
@@ -297,6 +303,33 @@ class DTree
                  double& rightError,
                  const size_t minLeafSize = 5) const;
 
+  /**
+   * Find the dimension to split on, given the values of the points of this
+   * node sorted in each dimension (column i of sortedValues holds dimension
+   * i).
+   */
+  bool FindSortedSplit(const arma::mat& sortedValues,
+                       const size_t totalPoints,
+                       size_t& splitDim,
+                       double& splitValue,
+                       double& leftError,
+                       double& rightError,
+                       const size_t minLeafSize) const;
+
+  /**
+   * Find the best split in one dimension, given the sorted values of the
+   * points of this node in that dimension.  Returns false if no split reduces
+   * the error; otherwise, the error of the split is stored in dimError.
+   */
+  bool FindSplitInDimension(const double* sortedDimValues,
+                            const size_t dim,
+                            const size_t totalPoints,
+                            const size_t minLeafSize,
+                            double& dimError,
+                            double& splitValue,
+                            double& leftError,
+                            double& rightError) const;
+
   /**
    * Split the data, returning the number of points left of the split.
    */
@@ -305,6 +338,29 @@ class DTree
                    const double splitValue,
                    arma::Col<size_t>& oldFromNew) const;
 
+  /**
+   * Split the sorted values and indices of the points of this node between the
+   * children, keeping each side sorted.  goesLeft is used as scratch space.
+   */
+  void SplitSorted(arma::mat& sortedValues,
+                   arma::Mat<size_t>& sortedIndices,
+                   std::vector<char>& goesLeft,
+                   const size_t splitDim,
+                   const size_t splitIndex) const;
+
+  /**
+   * Greedily expand the tree, given the values (and indices) of the points of
+   * this node sorted in each dimension.  This is called by Grow().
+   */
+  double GrowSorted(arma::mat& data,
+                    arma::Col<size_t>& oldFromNew,
+                    arma::mat& sortedValues,
+                    arma::Mat<size_t>& sortedIndices,
+                    std::vector<char>& goesLeft,
+                    const bool useVolReg,
+                    const size_t maxLeafSize,
+                    const size_t minLeafSize);
+
 };
 
 }; // namespace det
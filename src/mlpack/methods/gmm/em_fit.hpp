@@ -10,11 +10,14 @@
 #define __MLPACK_METHODS_GMM_EM_FIT_HPP
 
 #include <mlpack/core.hpp>
+#include <mlpack/core/tree/binary_space_tree.hpp>
 
 // Default clustering mechanism.
 #include <mlpack/methods/kmeans/kmeans.hpp>
 // Default covariance matrix constraint.
 #include "positive_definite_constraint.hpp"
+// Statistic for the tree-based E-step.
+#include "em_tree_statistic.hpp"
 
 namespace mlpack {
 namespace gmm {
@@ -31,6 +34,16 @@ namespace gmm {
  *
  * This method should create 'clusters' clusters, and return the assignment of
  * each point to a cluster.
+ *
+ * By default the E-step evaluates every Gaussian on every point.  For models
+ * with many Gaussians, most of those conditional probabilities are negligible;
+ * if PruneTolerance() is set to a positive value, a kd-tree is built on the
+ * points (once, and used for every iteration), and each Gaussian is pruned from
+ * each node of the tree where its conditional probability is provably less
+ * than the tolerance for every point (see EMTreeRules).  The conditional
+ * probabilities are then held in a sparse matrix, and the M-step only visits
+ * their nonzero elements.  This gives an approximation of EM, which is exact
+ * when the tolerance is 0.
  */
 template<typename InitialClusteringType = kmeans::KMeans<>,
          typename CovarianceConstraintPolicy = PositiveDefiniteConstraint>
@@ -122,6 +135,16 @@ class EMFit
   //! Modify the tolerance for the convergence of the EM algorithm.
   double& Tolerance() { return tolerance; }
 
+  //! Get the tolerance for pruning Gaussians in the E-step (0 means no tree).
+  double PruneTolerance() const { return pruneTolerance; }
+  //! Modify the tolerance for pruning Gaussians in the E-step (0 means no
+  //! tree).
+  double& PruneTolerance() { return pruneTolerance; }
+
+  //! Convenience typedef for the tree used by the tree-based E-step.
+  typedef tree::BinarySpaceTree<bound::HRectBound<2, true>, EMTreeStatistic,
+      arma::mat> TreeType;
+
  private:
   /**
    * Run the clusterer, and then turn the cluster assignments into Gaussians.
@@ -152,10 +175,125 @@ class EMFit
                            dists,
                        const arma::vec& weights) const;
 
+  /**
+   * Compute the conditional probability of each point being from each
+   * Gaussian (the E-step).  The points are split into blocks which are handled
+   * in parallel, if OpenMP is available.
+   *
+   * @param observations List of observations.
+   * @param dists Current Gaussians.
+   * @param weights Current a priori weights.
+   * @param condProb Matrix to store conditional probabilities in (points x
+   *     Gaussians).
+   */
+  void ConditionalProbabilities(
+      const arma::mat& observations,
+      const std::vector<distribution::GaussianDistribution>& dists,
+      const arma::vec& weights,
+      arma::mat& condProb) const;
+
+  /**
+   * Compute, for each Gaussian, the scatter matrix of the observations around
+   * the Gaussian's mean, weighted by the given (non-negative) per-point
+   * weights.  If OpenMP is available and there are at least as many Gaussians
+   * as threads, the Gaussians are handled in parallel; otherwise the points are
+   * split into blocks which are handled in parallel, and the per-thread sums
+   * are reduced at the end.
+   *
+   * @param observations List of observations.
+   * @param condProb Weight of each point for each Gaussian (points x
+   *     Gaussians).
+   * @param dists Gaussians (only the means are used).
+   * @param scatters Vector to store the scatter matrices in.
+   */
+  void WeightedScatters(
+      const arma::mat& observations,
+      const arma::mat& condProb,
+      const std::vector<distribution::GaussianDistribution>& dists,
+      std::vector<arma::mat>& scatters) const;
+
+  /**
+   * Fit the observations with the tree-based E-step, after the initial model
+   * has been set.  This is a helper function for both overloads of Estimate().
+   *
+   * @param observations List of observations to train on.
+   * @param probabilities Probability of each point being from this model, or
+   *     an empty vector if every point has probability 1.
+   * @param dists Vector of Gaussians to train.
+   * @param weights Vector of a priori weights to train.
+   */
+  void TreeEstimate(const arma::mat& observations,
+                    const arma::vec& probabilities,
+                    std::vector<distribution::GaussianDistribution>& dists,
+                    arma::vec& weights);
+
+  /**
+   * Compute the conditional probability of each point being from each
+   * Gaussian with a traversal of the given tree, pruning Gaussians with
+   * negligible conditional probability.  The conditional probabilities are
+   * multiplied by the given weights of the points.
+   *
+   * @param tree Tree built on the dataset.
+   * @param dataset Dataset the tree is built on.
+   * @param dists Current Gaussians.
+   * @param weights Current a priori weights.
+   * @param pointWeights Weight of each point, or an empty vector if every point
+   *     has weight 1.
+   * @param condProb Sparse matrix to store conditional probabilities in (points
+   *     x Gaussians).
+   * @return Log-likelihood of the dataset under the current model.
+   */
+  double TreeConditionalProbabilities(
+      TreeType& tree,
+      const arma::mat& dataset,
+      const std::vector<distribution::GaussianDistribution>& dists,
+      const arma::vec& weights,
+      const arma::vec& pointWeights,
+      arma::sp_mat& condProb) const;
+
+  /**
+   * Compute, for each Gaussian, the scatter matrix of the observations around
+   * the Gaussian's mean, weighted by the given sparse per-point weights.  Only
+   * the nonzero weights are visited, and the Gaussians are handled in
+   * parallel, if OpenMP is available.
+   *
+   * @param observations List of observations.
+   * @param condProb Weight of each point for each Gaussian (points x
+   *     Gaussians).
+   * @param dists Gaussians (only the means are used).
+   * @param scatters Vector to store the scatter matrices in.
+   */
+  void WeightedScatters(
+      const arma::mat& observations,
+      const arma::sp_mat& condProb,
+      const std::vector<distribution::GaussianDistribution>& dists,
+      std::vector<arma::mat>& scatters) const;
+
+  /**
+   * Make sure that each Gaussian has the dimensionality of the observations.
+   * This is called before each parallel region, because an error raised
+   * inside the region (with Log::Fatal, which throws) would terminate the
+   * program instead of reaching the caller.  Nothing else in those regions
+   * can fail: GaussianDistribution::LogProbability() always has a
+   * factorization of the covariance to use.
+   *
+   * @param observations List of observations.
+   * @param dists Gaussians to check.
+   */
+  void CheckDistributions(
+      const arma::mat& observations,
+      const std::vector<distribution::GaussianDistribution>& dists) const;
+
+  //! The number of points handled at once by each thread in the E-step and the
+  //! M-step.
+  static const size_t BlockSize = 1024;
+
   //! Maximum iterations of EM algorithm.
   size_t maxIterations;
   //! Tolerance for convergence of EM.
   double tolerance;
+  //! Tolerance for pruning Gaussians in the E-step.
+  double pruneTolerance;
   //! Object which will perform the clustering.
   InitialClusteringType clusterer;
   //! Object which applies constraints to the covariance matrix.
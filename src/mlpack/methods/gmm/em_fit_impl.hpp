@@ -10,6 +10,7 @@
 
 // In case it hasn't been included yet.
 #include "em_fit.hpp"
+#include "em_tree_rules.hpp"
 
 namespace mlpack {
 namespace gmm {
@@ -23,6 +24,7 @@ EMFit<InitialClusteringType, CovarianceConstraintPolicy>::EMFit(
     CovarianceConstraintPolicy constraint) :
     maxIterations(maxIterations),
     tolerance(tolerance),
+    pruneTolerance(0.0),
     clusterer(clusterer),
     constraint(constraint)
 { /* Nothing to do. */ }
@@ -38,6 +40,12 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
   if (!useInitialModel)
     InitialClustering(observations, dists, weights);
 
+  if (pruneTolerance > 0.0)
+  {
+    TreeEstimate(observations, arma::vec(), dists, weights);
+    return;
+  }
+
   double l = LogLikelihood(observations, dists, weights);
 
   Log::Debug << "EMFit::Estimate(): initial clustering log-likelihood: "
@@ -55,49 +63,36 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
 
     // Calculate the conditional probabilities of choosing a particular
     // Gaussian given the observations and the present theta value.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Store conditional probabilities into condProb vector for each
-      // Gaussian.  First we make an alias of the condProb vector.
-      arma::vec condProbAlias = condProb.unsafe_col(i);
-      dists[i].Probability(observations, condProbAlias);
-      condProbAlias *= weights[i];
-    }
-
-    // Normalize row-wise.
-    for (size_t i = 0; i < condProb.n_rows; i++)
-    {
-      // Avoid dividing by zero; if the probability for everything is 0, we
-      // don't want to make it NaN.
-      const double probSum = accu(condProb.row(i));
-      if (probSum != 0.0)
-        condProb.row(i) /= probSum;
-    }
+    ConditionalProbabilities(observations, dists, weights, condProb);
 
     // Store the sum of the probability of each state over all the observations.
     arma::vec probRowSums = trans(arma::sum(condProb, 0 /* columnwise */));
 
     // Calculate the new value of the means using the updated conditional
-    // probabilities.
+    // probabilities.  This is one matrix multiplication for all Gaussians.
+    const arma::mat means = observations * condProb;
     for (size_t i = 0; i < dists.size(); i++)
     {
       // Don't update if there's no probability of the Gaussian having points.
       if (probRowSums[i] != 0)
-        dists[i].Mean() = (observations * condProb.col(i)) / probRowSums[i];
-
-      // Calculate the new value of the covariances using the updated
-      // conditional probabilities and the updated means.
-      arma::mat tmp = observations - (dists[i].Mean() *
-          arma::ones<arma::rowvec>(observations.n_cols));
-      arma::mat tmpB = tmp % (arma::ones<arma::vec>(observations.n_rows) *
-          trans(condProb.col(i)));
+        dists[i].Mean() = means.col(i) / probRowSums[i];
+    }
 
+    // Calculate the new value of the covariances using the updated
+    // conditional probabilities and the updated means.
+    std::vector<arma::mat> scatters;
+    WeightedScatters(observations, condProb, dists, scatters);
+    for (size_t i = 0; i < dists.size(); i++)
+    {
       // Don't update if there's no probability of the Gaussian having points.
       if (probRowSums[i] != 0.0)
-        dists[i].Covariance() = (tmp * trans(tmpB)) / probRowSums[i];
+      {
+        arma::mat covariance = scatters[i] / probRowSums[i];
 
-      // Apply covariance constraint.
-      constraint.ApplyConstraint(dists[i].Covariance());
+        // Apply covariance constraint.
+        constraint.ApplyConstraint(covariance);
+        dists[i].Covariance(covariance);
+      }
     }
 
     // Calculate the new values for omega using the updated conditional
@@ -123,6 +118,12 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
   if (!useInitialModel)
     InitialClustering(observations, dists, weights);
 
+  if (pruneTolerance > 0.0)
+  {
+    TreeEstimate(observations, probabilities, dists, weights);
+    return;
+  }
+
   double l = LogLikelihood(observations, dists, weights);
 
   Log::Debug << "EMFit::Estimate(): initial clustering log-likelihood: "
@@ -137,53 +138,34 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
   {
     // Calculate the conditional probabilities of choosing a particular
     // Gaussian given the observations and the present theta value.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Store conditional probabilities into condProb vector for each
-      // Gaussian.  First we make an alias of the condProb vector.
-      arma::vec condProbAlias = condProb.unsafe_col(i);
-      dists[i].Probability(observations, condProbAlias);
-      condProbAlias *= weights[i];
-    }
+    ConditionalProbabilities(observations, dists, weights, condProb);
 
-    // Normalize row-wise.
-    for (size_t i = 0; i < condProb.n_rows; i++)
-    {
-      // Avoid dividing by zero; if the probability for everything is 0, we
-      // don't want to make it NaN.
-      const double probSum = accu(condProb.row(i));
-      if (probSum != 0.0)
-        condProb.row(i) /= probSum;
-    }
+    // The conditional probability of each point being from Gaussian i
+    // multiplied by the probability of the point being from this mixture
+    // model.
+    condProb.each_col() %= probabilities;
 
     // This will store the sum of probabilities of each state over all the
     // observations.
-    arma::vec probRowSums(dists.size());
+    arma::vec probRowSums = trans(arma::sum(condProb, 0 /* columnwise */));
 
     // Calculate the new value of the means using the updated conditional
-    // probabilities.
+    // probabilities.  This is one matrix multiplication for all Gaussians.
+    const arma::mat means = observations * condProb;
     for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Calculate the sum of probabilities of points, which is the
-      // conditional probability of each point being from Gaussian i
-      // multiplied by the probability of the point being from this mixture
-      // model.
-      probRowSums[i] = accu(condProb.col(i) % probabilities);
-
-      dists[i].Mean() = (observations * (condProb.col(i) % probabilities)) /
-        probRowSums[i];
-
-      // Calculate the new value of the covariances using the updated
-      // conditional probabilities and the updated means.
-      arma::mat tmp = observations - (dists[i].Mean() *
-          arma::ones<arma::rowvec>(observations.n_cols));
-      arma::mat tmpB = tmp % (arma::ones<arma::vec>(observations.n_rows) *
-          trans(condProb.col(i) % probabilities));
+      dists[i].Mean() = means.col(i) / probRowSums[i];
 
-      dists[i].Covariance() = (tmp * trans(tmpB)) / probRowSums[i];
+    // Calculate the new value of the covariances using the updated
+    // conditional probabilities and the updated means.
+    std::vector<arma::mat> scatters;
+    WeightedScatters(observations, condProb, dists, scatters);
+    for (size_t i = 0; i < dists.size(); i++)
+    {
+      arma::mat covariance = scatters[i] / probRowSums[i];
 
       // Apply covariance constraint.
-      constraint.ApplyConstraint(dists[i].Covariance());
+      constraint.ApplyConstraint(covariance);
+      dists[i].Covariance(covariance);
     }
 
     // Calculate the new values for omega using the updated conditional
@@ -198,6 +180,134 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
   }
 }
 
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::TreeEstimate(
+    const arma::mat& observations,
+    const arma::vec& probabilities,
+    std::vector<distribution::GaussianDistribution>& dists,
+    arma::vec& weights)
+{
+  // The points don't change between iterations, so the tree is only built
+  // once.  Building it rearranges the points, so it is built on a copy, and
+  // everything below works in the order of the points in the tree.
+  Timer::Start("tree_building");
+  arma::mat dataset(observations);
+  std::vector<size_t> oldFromNew;
+  TreeType tree(dataset, oldFromNew);
+  Timer::Stop("tree_building");
+
+  arma::vec pointWeights;
+  double totalWeight = observations.n_cols;
+  if (probabilities.n_elem > 0)
+  {
+    pointWeights.set_size(probabilities.n_elem);
+    for (size_t i = 0; i < oldFromNew.size(); ++i)
+      pointWeights[i] = probabilities[oldFromNew[i]];
+    totalWeight = accu(probabilities);
+  }
+
+  // Each E-step also gives the log-likelihood of the model it was run with, so
+  // the E-step comes at the end of each iteration.
+  arma::sp_mat condProb;
+  double l = TreeConditionalProbabilities(tree, dataset, dists, weights,
+      pointWeights, condProb);
+
+  Log::Debug << "EMFit::Estimate(): initial clustering log-likelihood: "
+      << l << std::endl;
+
+  double lOld = -DBL_MAX;
+
+  // Iterate to update the model until no more improvement is found.
+  size_t iteration = 1;
+  while (std::abs(l - lOld) > tolerance && iteration != maxIterations)
+  {
+    Log::Info << "EMFit::Estimate(): iteration " << iteration << ", "
+        << "log-likelihood " << l << "." << std::endl;
+
+    // Calculate the new value of the means, and the sum of the probability of
+    // each state over all the observations.  Column i of condProb holds the
+    // points with nonzero probability for Gaussian i.
+    arma::vec probRowSums(dists.size());
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < dists.size(); ++i)
+    {
+      arma::vec mean = arma::zeros<arma::vec>(dataset.n_rows);
+      double probSum = 0.0;
+      for (size_t j = condProb.col_ptrs[i]; j < condProb.col_ptrs[i + 1]; ++j)
+      {
+        mean += condProb.values[j] * dataset.col(condProb.row_indices[j]);
+        probSum += condProb.values[j];
+      }
+
+      probRowSums[i] = probSum;
+
+      // Don't update if there's no probability of the Gaussian having points.
+      if (probSum != 0.0)
+        dists[i].Mean() = mean / probSum;
+    }
+
+    // Calculate the new value of the covariances using the updated
+    // conditional probabilities and the updated means.
+    std::vector<arma::mat> scatters;
+    WeightedScatters(dataset, condProb, dists, scatters);
+    for (size_t i = 0; i < dists.size(); i++)
+    {
+      // Don't update if there's no probability of the Gaussian having points.
+      if (probRowSums[i] != 0.0)
+      {
+        arma::mat covariance = scatters[i] / probRowSums[i];
+
+        // Apply covariance constraint.
+        constraint.ApplyConstraint(covariance);
+        dists[i].Covariance(covariance);
+      }
+    }
+
+    // Calculate the new values for omega using the updated conditional
+    // probabilities.
+    weights = probRowSums / totalWeight;
+
+    // Update values of l, and calculate the conditional probabilities for the
+    // next iteration.
+    lOld = l;
+    l = TreeConditionalProbabilities(tree, dataset, dists, weights,
+        pointWeights, condProb);
+
+    iteration++;
+  }
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+double EMFit<InitialClusteringType, CovarianceConstraintPolicy>::
+TreeConditionalProbabilities(
+    TreeType& tree,
+    const arma::mat& dataset,
+    const std::vector<distribution::GaussianDistribution>& dists,
+    const arma::vec& weights,
+    const arma::vec& pointWeights,
+    arma::sp_mat& condProb) const
+{
+  typedef EMTreeRules<TreeType> RulesType;
+  RulesType rules(dataset, dists, weights, pointWeights, pruneTolerance);
+
+  // The traverser only scores the children of each node, so the root is scored
+  // here.  Then do a traversal with a fake query index (since the query index
+  // is irrelevant; we are checking each node with all Gaussians).
+  if (rules.Score(0, tree) != DBL_MAX)
+  {
+    typename TreeType::template SingleTreeTraverser<RulesType>
+        traverser(rules);
+    traverser.Traverse(0, tree);
+  }
+
+  Log::Debug << "EMFit::Estimate(): " << rules.Evaluations() << " density "
+      << "evaluations (of " << dataset.n_cols * dists.size() << ")."
+      << std::endl;
+
+  rules.ConditionalProbabilities(condProb);
+  return rules.LogLikelihood();
+}
+
 template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
 void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::
 InitialClustering(const arma::mat& observations,
@@ -210,13 +320,14 @@ InitialClustering(const arma::mat& observations,
   // Run clustering algorithm.
   clusterer.Cluster(observations, dists.size(), assignments);
 
-  // Now calculate the means, covariances, and weights.
+  // Now calculate the means, covariances, and weights.  The covariances are
+  // accumulated separately and given to the distributions at the end, so that
+  // they are only factorized once.
+  std::vector<arma::mat> covariances(dists.size(),
+      arma::zeros<arma::mat>(observations.n_rows, observations.n_rows));
   weights.zeros();
   for (size_t i = 0; i < dists.size(); ++i)
-  {
     dists[i].Mean().zeros();
-    dists[i].Covariance().zeros();
-  }
 
   // From the assignments, generate our means, covariances, and weights.
   for (size_t i = 0; i < observations.n_cols; ++i)
@@ -227,8 +338,7 @@ InitialClustering(const arma::mat& observations,
     dists[cluster].Mean() += observations.col(i);
 
     // Add this to the relevant covariance.
-    dists[cluster].Covariance() += observations.col(i) *
-        trans(observations.col(i));
+    covariances[cluster] += observations.col(i) * trans(observations.col(i));
 
     // Now add one to the weights (we will normalize).
     weights[cluster]++;
@@ -244,15 +354,16 @@ InitialClustering(const arma::mat& observations,
   {
     const size_t cluster = assignments[i];
     const arma::vec normObs = observations.col(i) - dists[cluster].Mean();
-    dists[cluster].Covariance() += normObs * normObs.t();
+    covariances[cluster] += normObs * normObs.t();
   }
 
   for (size_t i = 0; i < dists.size(); ++i)
   {
-    dists[i].Covariance() /= (weights[i] > 1) ? weights[i] : 1;
+    covariances[i] /= (weights[i] > 1) ? weights[i] : 1;
 
     // Apply constraints to covariance matrix.
-    constraint.ApplyConstraint(dists[i].Covariance());
+    constraint.ApplyConstraint(covariances[i]);
+    dists[i].Covariance(covariances[i]);
   }
 
   // Finally, normalize weights.
@@ -265,26 +376,267 @@ double EMFit<InitialClusteringType, CovarianceConstraintPolicy>::LogLikelihood(
     const std::vector<distribution::GaussianDistribution>& dists,
     const arma::vec& weights) const
 {
-  double logLikelihood = 0;
+  CheckDistributions(observations, dists);
+
+  // The log-likelihood of each block of points is summed separately, and then
+  // the blocks are summed in order, so the result does not depend on the
+  // number of threads.
+  const size_t numBlocks = (observations.n_cols + BlockSize - 1) / BlockSize;
+  arma::vec blockLogLikelihoods(numBlocks);
+
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+  {
+    const size_t begin = b * BlockSize;
+    const size_t end = std::min(begin + BlockSize,
+        (size_t) observations.n_cols);
+    const arma::mat block = observations.cols(begin, end - 1);
+
+    arma::vec logPhis;
+    arma::mat logLikelihoods(dists.size(), block.n_cols);
+    for (size_t i = 0; i < dists.size(); ++i)
+    {
+      dists[i].LogProbability(block, logPhis);
+      logLikelihoods.row(i) = std::log(weights(i)) + trans(logPhis);
+    }
+
+    // Now sum over every point, with the log-sum-exp trick.
+    double logLikelihood = 0;
+    for (size_t j = 0; j < block.n_cols; ++j)
+    {
+      const double maxLogLikelihood = logLikelihoods.col(j).max();
+      if (maxLogLikelihood == -std::numeric_limits<double>::infinity())
+      {
+        #pragma omp critical
+        Log::Info << "Likelihood of point " << begin + j << " is 0!  It is "
+            << "probably an outlier." << std::endl;
+        logLikelihood += maxLogLikelihood;
+        continue;
+      }
+
+      logLikelihood += maxLogLikelihood +
+          log(accu(arma::exp(logLikelihoods.col(j) - maxLogLikelihood)));
+    }
+
+    blockLogLikelihoods[b] = logLikelihood;
+  }
+
+  return accu(blockLogLikelihoods);
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::
+ConditionalProbabilities(
+    const arma::mat& observations,
+    const std::vector<distribution::GaussianDistribution>& dists,
+    const arma::vec& weights,
+    arma::mat& condProb) const
+{
+  CheckDistributions(observations, dists);
+  condProb.set_size(observations.n_cols, dists.size());
+
+  // Each block of points is handled entirely by one thread: all of the
+  // Gaussians are evaluated on it, and then the probabilities of each point
+  // are normalized.  This is done in log-space, to avoid underflow in high
+  // dimensions.  The block is held with one column per point, so that each
+  // point's probabilities are contiguous, and it is transposed into condProb
+  // once at the end.
+  const size_t numBlocks = (observations.n_cols + BlockSize - 1) / BlockSize;
+
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+  {
+    const size_t begin = b * BlockSize;
+    const size_t end = std::min(begin + BlockSize,
+        (size_t) observations.n_cols);
+    const arma::mat block = observations.cols(begin, end - 1);
+
+    arma::vec logProbs;
+    arma::mat blockProbs(dists.size(), block.n_cols);
+    for (size_t i = 0; i < dists.size(); ++i)
+    {
+      dists[i].LogProbability(block, logProbs);
+      blockProbs.row(i) = arma::trans(logProbs) + std::log(weights[i]);
+    }
 
-  arma::vec phis;
-  arma::mat likelihoods(dists.size(), observations.n_cols);
-  
+    // Normalize each point.
+    for (size_t j = 0; j < block.n_cols; ++j)
+    {
+      // Avoid dividing by zero; if the probability for everything is 0, we
+      // don't want to make it NaN.
+      const double maxLogProb = blockProbs.col(j).max();
+      if (maxLogProb == -std::numeric_limits<double>::infinity())
+      {
+        blockProbs.col(j).zeros();
+        continue;
+      }
+
+      // Shift by the largest log-probability before exponentiating, so that
+      // at least one of the terms does not underflow.
+      blockProbs.col(j) = arma::exp(blockProbs.col(j) - maxLogProb);
+      blockProbs.col(j) /= accu(blockProbs.col(j));
+    }
+
+    condProb.rows(begin, end - 1) = arma::trans(blockProbs);
+  }
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::WeightedScatters(
+    const arma::mat& observations,
+    const arma::mat& condProb,
+    const std::vector<distribution::GaussianDistribution>& dists,
+    std::vector<arma::mat>& scatters) const
+{
+  CheckDistributions(observations, dists);
+
+  const size_t dimension = observations.n_rows;
+  const size_t numBlocks = (observations.n_cols + BlockSize - 1) / BlockSize;
+
+#ifdef _OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+
+  // With at least as many Gaussians as threads, each Gaussian is handled
+  // entirely by one thread, so no reduction (and no scratch copy of the
+  // scatter matrices) is needed.
+  if (dists.size() >= numThreads)
+  {
+    scatters.resize(dists.size());
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < dists.size(); ++i)
+    {
+      scatters[i].zeros(dimension, dimension);
+
+      arma::mat diffs;
+      arma::rowvec sqrtWeights;
+      for (size_t b = 0; b < numBlocks; ++b)
+      {
+        const size_t begin = b * BlockSize;
+        const size_t end = std::min(begin + BlockSize,
+            (size_t) observations.n_cols);
+
+        // The weighted scatter of the block is D * diag(p) * D^T, where D
+        // holds the centered points; scaling the columns of D by sqrt(p)
+        // turns that into a single symmetric product.
+        diffs = observations.cols(begin, end - 1);
+        diffs.each_col() -= dists[i].Mean();
+        sqrtWeights = arma::sqrt(arma::trans(
+            condProb.submat(begin, i, end - 1, i)));
+        diffs.each_row() %= sqrtWeights;
+
+        scatters[i] += diffs * arma::trans(diffs);
+      }
+    }
+
+    return;
+  }
+
+  // Otherwise, the blocks of points are split between the threads.  Each
+  // thread accumulates into its own scatter matrices (fewer than numThreads^2
+  // of them in total); they are summed in thread order at the end, so that the
+  // result is deterministic for a given number of threads.
+  std::vector<std::vector<arma::mat> > threadScatters(numThreads,
+      std::vector<arma::mat>(dists.size(),
+      arma::zeros<arma::mat>(dimension, dimension)));
+
+  #pragma omp parallel num_threads(numThreads)
+  {
+#ifdef _OPENMP
+    std::vector<arma::mat>& localScatters =
+        threadScatters[omp_get_thread_num()];
+#else
+    std::vector<arma::mat>& localScatters = threadScatters[0];
+#endif
+
+    arma::mat diffs;
+    arma::rowvec sqrtWeights;
+    #pragma omp for schedule(static)
+    for (size_t b = 0; b < numBlocks; ++b)
+    {
+      const size_t begin = b * BlockSize;
+      const size_t end = std::min(begin + BlockSize,
+          (size_t) observations.n_cols);
+
+      for (size_t i = 0; i < dists.size(); ++i)
+      {
+        diffs = observations.cols(begin, end - 1);
+        diffs.each_col() -= dists[i].Mean();
+        sqrtWeights = arma::sqrt(arma::trans(
+            condProb.submat(begin, i, end - 1, i)));
+        diffs.each_row() %= sqrtWeights;
+
+        localScatters[i] += diffs * arma::trans(diffs);
+      }
+    }
+  }
+
+  scatters = threadScatters[0];
+  for (size_t t = 1; t < numThreads; ++t)
+    for (size_t i = 0; i < dists.size(); ++i)
+      scatters[i] += threadScatters[t][i];
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::WeightedScatters(
+    const arma::mat& observations,
+    const arma::sp_mat& condProb,
+    const std::vector<distribution::GaussianDistribution>& dists,
+    std::vector<arma::mat>& scatters) const
+{
+  CheckDistributions(observations, dists);
+
+  const size_t dimension = observations.n_rows;
+  scatters.resize(dists.size());
+
+  // Each Gaussian is handled entirely by one thread, so no reduction is
+  // needed.  Column i of condProb holds the points with nonzero weight for
+  // Gaussian i; they are gathered in blocks, as in the dense version.
+  #pragma omp parallel for schedule(dynamic)
   for (size_t i = 0; i < dists.size(); ++i)
   {
-    dists[i].Probability(observations, phis);
-    likelihoods.row(i) = weights(i) * trans(phis);
+    scatters[i].zeros(dimension, dimension);
+
+    arma::mat diffs;
+    const size_t colBegin = condProb.col_ptrs[i];
+    const size_t colEnd = condProb.col_ptrs[i + 1];
+    for (size_t begin = colBegin; begin < colEnd; begin += BlockSize)
+    {
+      const size_t end = std::min(begin + BlockSize, colEnd);
+      diffs.set_size(dimension, end - begin);
+      for (size_t j = begin; j < end; ++j)
+      {
+        diffs.col(j - begin) = std::sqrt(condProb.values[j]) *
+            (observations.col(condProb.row_indices[j]) - dists[i].Mean());
+      }
+
+      scatters[i] += diffs * arma::trans(diffs);
+    }
   }
-  // Now sum over every point.
-  for (size_t j = 0; j < observations.n_cols; ++j)
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::
+CheckDistributions(
+    const arma::mat& observations,
+    const std::vector<distribution::GaussianDistribution>& dists) const
+{
+  for (size_t i = 0; i < dists.size(); ++i)
   {
-    if (accu(likelihoods.col(j)) == 0)
-      Log::Info << "Likelihood of point " << j << " is 0!  It is probably an "
-          << "outlier." << std::endl;
-    logLikelihood += log(accu(likelihoods.col(j)));
+    if (dists[i].Mean().n_elem != observations.n_rows ||
+        dists[i].Covariance().n_rows != observations.n_rows ||
+        dists[i].Covariance().n_cols != observations.n_rows)
+    {
+      Log::Fatal << "EMFit::Estimate(): Gaussian " << i << " has mean of size "
+          << dists[i].Mean().n_elem << " and covariance of size "
+          << dists[i].Covariance().n_rows << "x"
+          << dists[i].Covariance().n_cols << ", but the observations have "
+          << observations.n_rows << " dimensions." << std::endl;
+    }
   }
-  
-  return logLikelihood;
 }
 
 }; // namespace gmm
@@ -0,0 +1,155 @@
+/**
+ * @file em_tree_rules.hpp
+ *
+ * Defines the pruning rules necessary to perform the E-step of the EM algorithm
+ * for GMMs with a single-tree traversal over the points, pruning Gaussians
+ * whose conditional probability is negligible for every point in a node.
+ */
+#ifndef __MLPACK_METHODS_GMM_EM_TREE_RULES_HPP
+#define __MLPACK_METHODS_GMM_EM_TREE_RULES_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace gmm {
+
+/**
+ * The rules class for the single-tree E-step of EMFit.  The tree is built on
+ * the points (with hyper-rectangle bounds), and every Gaussian is considered at
+ * once, in the same way as PellegMooreKMeansRules; so the query index is
+ * ignored in BaseCase() and Score().
+ *
+ * For each node, the log-density of each candidate Gaussian (inherited from
+ * the parent node) is bounded over the node's bounding box, using the distance
+ * from the box to the mean and the extreme eigenvalues of the covariance:
+ *
+ *   ||x - mu||^2 / lambda_max <= (x - mu)^T Sigma^-1 (x - mu)
+ *                             <= ||x - mu||^2 / lambda_min.
+ *
+ * A Gaussian is pruned from a node if the upper bound of its weighted density
+ * is less than the pruning tolerance times the sum of the lower bounds of the
+ * weighted densities of all the candidates: then its conditional probability
+ * is less than the pruning tolerance for every point in the node, and it is
+ * taken to be zero.  If only one Gaussian is left, it owns every point in the
+ * node; otherwise, at the leaves, the conditional probabilities of the
+ * remaining candidates are computed for each point.
+ *
+ * The log-likelihood of the model is accumulated at the same time, ignoring
+ * the pruned Gaussians; so it is slightly less than the true log-likelihood.
+ */
+template<typename TreeType>
+class EMTreeRules
+{
+ public:
+  /**
+   * Create the EMTreeRules object.
+   *
+   * @param dataset The dataset that the tree is built on.
+   * @param dists Current Gaussians.
+   * @param weights Current a priori weights.
+   * @param pointWeights Weight of each point (in the order of the dataset); if
+   *      empty, each point has weight 1.  The conditional probabilities of a
+   *      point are multiplied by its weight.
+   * @param pruneTolerance Gaussians whose conditional probability is less than
+   *      this for every point in a node are pruned.
+   */
+  EMTreeRules(const typename TreeType::Mat& dataset,
+              const std::vector<distribution::GaussianDistribution>& dists,
+              const arma::vec& weights,
+              const arma::vec& pointWeights,
+              const double pruneTolerance);
+
+  /**
+   * The BaseCase() function for this single-tree algorithm does nothing.
+   * Instead, point-to-Gaussian evaluations are done for each leaf in Score().
+   *
+   * @param queryIndex Index of query point (fake, will be ignored).
+   * @param referenceIndex Index of reference point.
+   */
+  double BaseCase(const size_t queryIndex, const size_t referenceIndex);
+
+  /**
+   * Prune the candidate Gaussians for the node, and, if the node is owned by
+   * one Gaussian or is a leaf, compute the conditional probabilities of its
+   * points.  The root should be scored before the traversal, since the
+   * traverser only scores children.
+   *
+   * @param queryIndex Index of query point (fake, will be ignored).
+   * @param referenceNode Node containing points in the dataset.
+   * @return DBL_MAX if the node has been handled, or 0 if its children must be
+   *      visited.
+   */
+  double Score(const size_t queryIndex, TreeType& referenceNode);
+
+  /**
+   * Rescore to determine if a node can be pruned.  In this case, a node can
+   * never be pruned during rescoring, so this just returns oldScore.
+   *
+   * @param queryIndex Index of query point (fake, will be ignored).
+   * @param referenceNode Node containing points in the dataset.
+   * @param oldScore Resulting score from Score().
+   */
+  double Rescore(const size_t queryIndex,
+                 TreeType& referenceNode,
+                 const double oldScore);
+
+  /**
+   * After the traversal, build the sparse matrix of conditional probabilities
+   * (points x Gaussians, with points in the order of the dataset).
+   *
+   * @param condProb Matrix to store the conditional probabilities in.
+   */
+  void ConditionalProbabilities(arma::sp_mat& condProb) const;
+
+  //! Get the log-likelihood of the points seen so far.
+  double LogLikelihood() const { return logLikelihood; }
+
+  //! Get the number of point-to-Gaussian density evaluations performed.
+  size_t Evaluations() const { return evaluations; }
+  //! Modify the number of point-to-Gaussian density evaluations performed.
+  size_t& Evaluations() { return evaluations; }
+
+ private:
+  //! Store the conditional probability of a point for a Gaussian.
+  void Add(const size_t point, const size_t gaussian, const double value);
+
+  //! The dataset.
+  const typename TreeType::Mat& dataset;
+  //! The Gaussians.
+  const std::vector<distribution::GaussianDistribution>& dists;
+  //! The weight of each point (empty if all points have weight 1).
+  const arma::vec& pointWeights;
+  //! The log of the pruning tolerance.
+  double logPruneTolerance;
+
+  //! The log of the weight of each Gaussian.
+  arma::vec logWeights;
+  //! The log of the weight of each Gaussian, plus the log of its normalizing
+  //! constant.
+  arma::vec logConstants;
+  //! The smallest eigenvalue of each covariance (0 if the covariance is not
+  //! positive definite).
+  arma::vec minEigenvalues;
+  //! The largest eigenvalue of each covariance (infinity if the covariance is
+  //! not positive definite).
+  arma::vec maxEigenvalues;
+
+  //! The locations (point, Gaussian) of the nonzero conditional probabilities,
+  //! stored as pairs.
+  std::vector<arma::uword> locations;
+  //! The nonzero conditional probabilities.
+  std::vector<double> values;
+
+  //! The log-likelihood of the points seen so far.
+  double logLikelihood;
+  //! The number of point-to-Gaussian density evaluations performed.
+  size_t evaluations;
+};
+
+}; // namespace gmm
+}; // namespace mlpack
+
+// Include implementation.
+#include "em_tree_rules_impl.hpp"
+
+#endif
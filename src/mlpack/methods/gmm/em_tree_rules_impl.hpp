@@ -0,0 +1,242 @@
+/**
+ * @file em_tree_rules_impl.hpp
+ *
+ * Implementation of the pruning rules for the single-tree E-step of the EM
+ * algorithm for GMMs.
+ */
+#ifndef __MLPACK_METHODS_GMM_EM_TREE_RULES_IMPL_HPP
+#define __MLPACK_METHODS_GMM_EM_TREE_RULES_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "em_tree_rules.hpp"
+
+namespace mlpack {
+namespace gmm {
+
+template<typename TreeType>
+EMTreeRules<TreeType>::EMTreeRules(
+    const typename TreeType::Mat& dataset,
+    const std::vector<distribution::GaussianDistribution>& dists,
+    const arma::vec& weights,
+    const arma::vec& pointWeights,
+    const double pruneTolerance) :
+    dataset(dataset),
+    dists(dists),
+    pointWeights(pointWeights),
+    logPruneTolerance(std::log(pruneTolerance)),
+    logWeights(dists.size()),
+    logConstants(dists.size()),
+    minEigenvalues(dists.size()),
+    maxEigenvalues(dists.size()),
+    logLikelihood(0.0),
+    evaluations(0)
+{
+  // The bounds need the extreme eigenvalues of each covariance.  The log
+  // determinant must be the one LogProbability() uses, so it is taken from the
+  // distribution.
+  const double logTwoPi = std::log(2.0 * M_PI);
+  arma::vec eigenvalues;
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    logWeights[i] = std::log(weights[i]);
+    logConstants[i] = logWeights[i] - 0.5 * (dataset.n_rows * logTwoPi +
+        dists[i].LogDetCov());
+
+    // If the covariance is not positive definite, LogProbability() uses a
+    // perturbed covariance whose eigenvalues we don't know.  Then the only safe
+    // bounds are the trivial ones: the upper bound is the normalizing constant
+    // (the density at the mean) and there is no lower bound.
+    if (arma::eig_sym(eigenvalues, dists[i].Covariance()) &&
+        eigenvalues.min() > 0.0)
+    {
+      minEigenvalues[i] = eigenvalues.min();
+      maxEigenvalues[i] = eigenvalues.max();
+    }
+    else
+    {
+      minEigenvalues[i] = 0.0;
+      maxEigenvalues[i] = std::numeric_limits<double>::infinity();
+    }
+  }
+}
+
+template<typename TreeType>
+inline force_inline
+double EMTreeRules<TreeType>::BaseCase(
+    const size_t /* queryIndex */,
+    const size_t /* referenceIndex */)
+{
+  return 0.0;
+}
+
+template<typename TreeType>
+double EMTreeRules<TreeType>::Score(const size_t /* queryIndex */,
+                                    TreeType& referenceNode)
+{
+  // Start with the parent's candidates; for the root, every Gaussian is a
+  // candidate.  This means that the statistics never need to be reset between
+  // iterations.
+  arma::uvec& candidates = referenceNode.Stat().Candidates();
+  if (referenceNode.Parent() == NULL)
+    candidates = arma::linspace<arma::uvec>(0, dists.size() - 1, dists.size());
+  else
+    candidates = referenceNode.Parent()->Stat().Candidates();
+
+  if (candidates.n_elem > 1)
+  {
+    // Bound the weighted log-density of each candidate over the node.
+    arma::vec upperBounds(candidates.n_elem);
+    arma::vec lowerBounds(candidates.n_elem);
+    for (size_t i = 0; i < candidates.n_elem; ++i)
+    {
+      const size_t c = candidates[i];
+      const double minDistance = referenceNode.MinDistance(dists[c].Mean());
+      const double maxDistance = referenceNode.MaxDistance(dists[c].Mean());
+
+      upperBounds[i] = logConstants[c] - 0.5 * minDistance * minDistance /
+          maxEigenvalues[c];
+      // A covariance that is not positive definite gives no lower bound.
+      lowerBounds[i] = (minEigenvalues[c] > 0.0) ? logConstants[c] - 0.5 *
+          maxDistance * maxDistance / minEigenvalues[c] :
+          -std::numeric_limits<double>::infinity();
+    }
+
+    // The sum of the lower bounds is a lower bound on the density of the
+    // mixture at every point in the node.
+    const double maxLowerBound = lowerBounds.max();
+    if (maxLowerBound > -std::numeric_limits<double>::infinity())
+    {
+      const double logMinDensity = maxLowerBound +
+          std::log(accu(arma::exp(lowerBounds - maxLowerBound)));
+
+      // The Gaussian with the largest upper bound is never pruned, so that
+      // every point keeps at least one Gaussian, even if the tolerance is
+      // large.
+      arma::uword best;
+      upperBounds.max(best);
+
+      size_t kept = 0;
+      for (size_t i = 0; i < candidates.n_elem; ++i)
+      {
+        // If a normalizing constant is NaN, so is the bound; keep the
+        // Gaussian rather than pruning it.
+        if (i == best ||
+            !(upperBounds[i] - logMinDensity < logPruneTolerance))
+          candidates[kept++] = candidates[i];
+      }
+      candidates.resize(kept);
+    }
+  }
+
+  const size_t begin = referenceNode.Begin();
+  const size_t count = referenceNode.Count();
+  if (candidates.n_elem == 1)
+  {
+    // This node is owned by a single Gaussian.  We only need its density for
+    // the log-likelihood.
+    const size_t c = candidates[0];
+    arma::vec logProbs;
+    dists[c].LogProbability(dataset.cols(begin, begin + count - 1), logProbs);
+    evaluations += count;
+
+    logLikelihood += accu(logProbs) + count * logWeights[c];
+    for (size_t i = begin; i < begin + count; ++i)
+      Add(i, c, 1.0);
+
+    return DBL_MAX;
+  }
+
+  if (!referenceNode.IsLeaf())
+  {
+    // We're not sure yet, so we can't prune.  Recursion order doesn't make a
+    // difference, so we'll just return a score of 0.
+    return 0.0;
+  }
+
+  // Perform the base case for every point in the leaf, in the same way as
+  // EMFit::ConditionalProbabilities(), but only for the candidates.
+  const arma::mat block = dataset.cols(begin, begin + count - 1);
+  arma::mat logProbs(count, candidates.n_elem);
+  arma::vec logProb;
+  for (size_t i = 0; i < candidates.n_elem; ++i)
+  {
+    dists[candidates[i]].LogProbability(block, logProb);
+    logProbs.col(i) = logProb + logWeights[candidates[i]];
+  }
+  evaluations += count * candidates.n_elem;
+
+  for (size_t j = 0; j < count; ++j)
+  {
+    // If the probability for everything is 0, the point gets no conditional
+    // probabilities at all.
+    const double maxLogProb = logProbs.row(j).max();
+    if (maxLogProb == -std::numeric_limits<double>::infinity())
+    {
+      logLikelihood += maxLogProb;
+      continue;
+    }
+
+    const double logSum = maxLogProb +
+        std::log(accu(arma::exp(logProbs.row(j) - maxLogProb)));
+    logLikelihood += logSum;
+
+    for (size_t i = 0; i < candidates.n_elem; ++i)
+    {
+      const double value = std::exp(logProbs(j, i) - logSum);
+      if (value > 0.0)
+        Add(begin + j, candidates[i], value);
+    }
+  }
+
+  return DBL_MAX;
+}
+
+template<typename TreeType>
+double EMTreeRules<TreeType>::Rescore(
+    const size_t /* queryIndex */,
+    TreeType& /* referenceNode */,
+    const double oldScore)
+{
+  // There's no possible way that calling Rescore() can produce a prune now when
+  // it couldn't before.
+  return oldScore;
+}
+
+template<typename TreeType>
+void EMTreeRules<TreeType>::ConditionalProbabilities(arma::sp_mat& condProb)
+    const
+{
+  arma::umat locationMatrix(2, values.size());
+  arma::vec valueVector(values.size());
+  for (size_t i = 0; i < values.size(); ++i)
+  {
+    locationMatrix(0, i) = locations[2 * i];
+    locationMatrix(1, i) = locations[2 * i + 1];
+    valueVector[i] = values[i];
+  }
+
+  condProb = arma::sp_mat(locationMatrix, valueVector, dataset.n_cols,
+      dists.size());
+}
+
+template<typename TreeType>
+inline force_inline
+void EMTreeRules<TreeType>::Add(const size_t point,
+                                const size_t gaussian,
+                                const double value)
+{
+  // The conditional probability is multiplied by the weight of the point.
+  const double weighted = (pointWeights.n_elem == 0) ? value :
+      value * pointWeights[point];
+  if (weighted == 0.0)
+    return;
+
+  locations.push_back(point);
+  locations.push_back(gaussian);
+  values.push_back(weighted);
+}
+
+}; // namespace gmm
+}; // namespace mlpack
+
+#endif
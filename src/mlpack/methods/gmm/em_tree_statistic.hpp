@@ -0,0 +1,55 @@
+/**
+ * @file em_tree_statistic.hpp
+ *
+ * A StatisticType for trees which holds the Gaussians that may still have
+ * non-negligible conditional probability for the points in a node, for the
+ * tree-based E-step of EMFit.
+ */
+#ifndef __MLPACK_METHODS_GMM_EM_TREE_STATISTIC_HPP
+#define __MLPACK_METHODS_GMM_EM_TREE_STATISTIC_HPP
+
+namespace mlpack {
+namespace gmm {
+
+/**
+ * A statistic for trees which holds the list of candidate Gaussians for a node:
+ * that is, the Gaussians which could not be pruned for the points of the node
+ * (or any of its ancestors) during the tree-based E-step of EMFit.  This is
+ * the same idea as the blacklist of Pelleg-Moore k-means, but the candidates
+ * are held as a list of indices, because with many Gaussians most of them are
+ * pruned near the root.
+ */
+class EMTreeStatistic
+{
+ public:
+  //! Initialize the statistic without a node (this does nothing).
+  EMTreeStatistic() { }
+
+  //! Initialize the statistic for a node (this does nothing; the candidates
+  //! are filled in during each traversal).
+  template<typename TreeType>
+  EMTreeStatistic(TreeType& /* node */) { }
+
+  //! Get the candidate Gaussians.
+  const arma::uvec& Candidates() const { return candidates; }
+  //! Modify the candidate Gaussians.
+  arma::uvec& Candidates() { return candidates; }
+
+  //! Return the object as a string.
+  std::string ToString() const
+  {
+    std::ostringstream convert;
+    convert << "EMTreeStatistic [" << this << "]" << std::endl;
+    convert << "  Candidates: " << candidates.t();
+    return convert.str();
+  }
+
+ private:
+  //! The indices of the candidate Gaussians.
+  arma::uvec candidates;
+};
+
+}; // namespace gmm
+}; // namespace mlpack
+
+#endif
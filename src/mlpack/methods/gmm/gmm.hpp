@@ -186,17 +186,18 @@ class GMM
   GMM& operator=(const GMM& other);
 
   /**
-   * Load a GMM from an XML file.  The format of the XML file should be the same
-   * as is generated by the Save() method.
+   * Load a GMM from an XML or binary file.  The format of the file should be
+   * the same as is generated by the Save() method.
    *
-   * @param filename Name of XML file containing model to be loaded.
+   * @param filename Name of file containing model to be loaded.
    */
   void Load(const std::string& filename);
 
   /**
-   * Save a GMM to an XML file.
+   * Save a GMM to a file.  If the filename ends in ".bin", the compact binary
+   * format is used; otherwise the GMM is saved as XML.
    *
-   * @param filename Name of XML file to write to.
+   * @param filename Name of file to write to.
    */
   void Save(const std::string& filename) const;
 
@@ -296,6 +297,18 @@ class GMM
   double Probability(const arma::vec& observation,
                      const size_t component) const;
 
+  /**
+   * Calculate the log-probability of each observation (column) in the given
+   * matrix coming from this distribution.  Each component is evaluated for all
+   * of the observations at once, and the components are combined in log-space,
+   * so this does not underflow when Probability() would.
+   *
+   * @param observations List of observations.
+   * @param logProbabilities Output log-probabilities for each observation.
+   */
+  void LogProbability(const arma::mat& observations,
+                      arma::vec& logProbabilities) const;
+
   /**
    * Return a randomly generated observation according to the probability
    * distribution defined by this object.
@@ -2,7 +2,8 @@
  * @author Michael Fox
  * @file gmm_convert_main.cpp
  *
- * This program converts an older GMM XML file to the new format.
+ * This program converts an older GMM XML file to the new format, or converts a
+ * GMM file between the XML and binary formats.
  */
 #include <mlpack/core.hpp>
 #include "gmm.hpp"
@@ -14,11 +15,17 @@ using namespace std;
 
 PROGRAM_INFO("Gaussian Mixture Model (GMM) file converter",
     "This program takes a fitted GMM XML file from older MLPACK versions (1.0.9"
-    " and older) and converts it to the current format.");
+    " and older) and converts it to the current format."
+    "\n\n"
+    "It can also convert a GMM file in the current format between XML and the "
+    "compact binary format; the binary format is used if the output filename "
+    "ends in '.bin'.  For example, to convert 'gmm.xml' to a binary model:"
+    "\n\n"
+    "$ gmm_convert -i gmm.xml -o gmm.bin");
 
 PARAM_STRING_REQ("input_file", "File containing the fitted model.", "i");
-PARAM_STRING("output_file", "The file to write the model to (as XML).", "o",
-    "gmm.xml");
+PARAM_STRING("output_file", "The file to write the model to (as XML, or binary "
+    "if the extension is .bin).", "o", "gmm.xml");
 
 int main(int argc, char* argv[])
 {
@@ -29,6 +36,16 @@ int main(int argc, char* argv[])
   if (!load.ReadFile(inputFile))
     Log::Fatal << " Could not read file '" << inputFile << "'!\n";
 
+  // Files in the current format can be saved again directly; this converts
+  // between XML and binary.
+  if (load.HasParameter("type"))
+  {
+    GMM<> gmm;
+    gmm.Load(load);
+    gmm.Save(CLI::GetParam<string>("output_file"));
+    return 0;
+  }
+
   size_t gaussians, dimensionality;
   load.LoadParameter(gaussians, "gaussians");
   load.LoadParameter(dimensionality, "dimensionality");
@@ -52,7 +69,9 @@ int main(int argc, char* argv[])
     string covName = "covariance" + o.str();
 
     load.LoadParameter(gmm.Component(i).Mean(), meanName);
-    load.LoadParameter(gmm.Component(i).Covariance(), covName);
+    arma::mat covariance;
+    load.LoadParameter(covariance, covName);
+    gmm.Component(i).Covariance(covariance);
   }
 
   gmm.Save(CLI::GetParam<string>("output_file"));
@@ -208,6 +208,41 @@ double GMM<FittingType>::Probability(const arma::vec& observation,
   return weights[component] * dists[component].Probability(observation);
 }
 
+/**
+ * Return the log-probability of each of the given observations.
+ */
+template<typename FittingType>
+void GMM<FittingType>::LogProbability(const arma::mat& observations,
+                                      arma::vec& logProbabilities) const
+{
+  // Find the log-probability of each point under each component (with its
+  // prior).
+  arma::mat logProbs(observations.n_cols, gaussians);
+  for (size_t i = 0; i < gaussians; ++i)
+  {
+    arma::vec logProbAlias = logProbs.unsafe_col(i);
+    dists[i].LogProbability(observations, logProbAlias);
+    logProbAlias += std::log(weights[i]);
+  }
+
+  // Now sum over the components with the log-sum-exp trick.
+  logProbabilities.set_size(observations.n_cols);
+  for (size_t j = 0; j < observations.n_cols; ++j)
+  {
+    const double maxLogProb = logProbs.row(j).max();
+    if (maxLogProb == -std::numeric_limits<double>::infinity())
+    {
+      logProbabilities[j] = maxLogProb;
+      continue;
+    }
+
+    double sum = 0.0;
+    for (size_t i = 0; i < gaussians; ++i)
+      sum += std::exp(logProbs(j, i) - maxLogProb);
+    logProbabilities[j] = maxLogProb + std::log(sum);
+  }
+}
+
 /**
  * Return a randomly generated observation according to the probability
  * distribution defined by this object.
@@ -230,8 +265,7 @@ arma::vec GMM<FittingType>::Random() const
     }
   }
 
-  return trans(chol(dists[gaussian].Covariance())) *
-      arma::randn<arma::vec>(dimensionality) + dists[gaussian].Mean();
+  return dists[gaussian].Random();
 }
 
 /**
@@ -409,7 +443,15 @@ template<typename FittingType>
 void GMM<FittingType>::Classify(const arma::mat& observations,
                                 arma::Col<size_t>& labels) const
 {
-  // This is not the best way to do this!
+  // Compute the log-probability of every point under every component (with the
+  // prior), one batch LogProbability() call per component.
+  arma::mat logProbs(observations.n_cols, gaussians);
+  for (size_t j = 0; j < gaussians; ++j)
+  {
+    arma::vec logProbAlias = logProbs.unsafe_col(j);
+    dists[j].LogProbability(observations, logProbAlias);
+    logProbAlias += std::log(weights[j]);
+  }
 
   // We should not have to fill this with values, because each one should be
   // overwritten.
@@ -417,13 +459,12 @@ void GMM<FittingType>::Classify(const arma::mat& observations,
   for (size_t i = 0; i < observations.n_cols; ++i)
   {
     // Find maximum probability component.
-    double probability = 0;
+    double logProbability = -std::numeric_limits<double>::infinity();
     for (size_t j = 0; j < gaussians; ++j)
     {
-      double newProb = Probability(observations.unsafe_col(i), j);
-      if (newProb >= probability)
+      if (logProbs(i, j) >= logProbability)
       {
-        probability = newProb;
+        logProbability = logProbs(i, j);
         labels[i] = j;
       }
     }
@@ -440,18 +481,28 @@ double GMM<FittingType>::LogLikelihood(
     const arma::vec& weightsL) const
 {
   double loglikelihood = 0;
-  arma::vec phis;
-  arma::mat likelihoods(gaussians, data.n_cols);
+  arma::vec logPhis;
+  arma::mat logLikelihoods(gaussians, data.n_cols);
 
   for (size_t i = 0; i < gaussians; i++)
   {
-    distsL[i].Probability(data, phis);
-    likelihoods.row(i) = weightsL(i) * trans(phis);
+    distsL[i].LogProbability(data, logPhis);
+    logLikelihoods.row(i) = std::log(weightsL(i)) + trans(logPhis);
   }
 
-  // Now sum over every point.
+  // Now sum over every point, with the log-sum-exp trick.
   for (size_t j = 0; j < data.n_cols; j++)
-    loglikelihood += log(accu(likelihoods.col(j)));
+  {
+    const double maxLogLikelihood = logLikelihoods.col(j).max();
+    if (maxLogLikelihood == -std::numeric_limits<double>::infinity())
+    {
+      loglikelihood += maxLogLikelihood;
+      continue;
+    }
+
+    loglikelihood += maxLogLikelihood +
+        log(accu(arma::exp(logLikelihoods.col(j) - maxLogLikelihood)));
+  }
   return loglikelihood;
 }
 
@@ -21,7 +21,8 @@ PROGRAM_INFO("Gaussian Mixture Model (GMM) Training",
     "This program takes a parametric estimate of a Gaussian mixture model (GMM)"
     " using the EM algorithm to find the maximum likelihood estimate.  The "
     "model is saved to an XML file, which contains information about each "
-    "Gaussian."
+    "Gaussian.  If the output filename ends in '.bin', a compact binary format "
+    "is used instead, which is much faster to load for large models."
     "\n\n"
     "If GMM training fails with an error indicating that a covariance matrix "
     "could not be inverted, be sure that the 'no_force_positive' flag was not "
@@ -34,13 +35,19 @@ PROGRAM_INFO("Gaussian Mixture Model (GMM) Training",
     "iteration of the EM algorithm which ensure that the covariance matrices "
     "are positive definite.  Specifying the flag can cause faster runtime, "
     "but may also cause non-positive definite covariance matrices, which will "
-    "cause the program to crash.");
+    "cause the program to crash."
+    "\n\n"
+    "For models with many Gaussians, the 'prune_tolerance' option can be used to "
+    "speed up training: a kd-tree is built on the data, and Gaussians whose "
+    "probability of owning a region of the data is less than the tolerance are "
+    "ignored for that region.  This gives an approximation of the EM algorithm "
+    "which is exact for a tolerance of 0 (the default).");
 
 PARAM_STRING_REQ("input_file", "File containing the data on which the model "
     "will be fit.", "i");
 PARAM_INT("gaussians", "Number of Gaussians in the GMM.", "g", 1);
 PARAM_STRING("output_file", "The file to write the trained GMM parameters into "
-    "(as XML).", "o", "gmm.xml");
+    "(as XML, or binary if the extension is .bin).", "o", "gmm.xml");
 PARAM_INT("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
 PARAM_INT("trials", "Number of trials to perform in training GMM.", "t", 10);
 
@@ -50,6 +57,9 @@ PARAM_FLAG("no_force_positive", "Do not force the covariance matrices to be "
     "positive definite.", "P");
 PARAM_INT("max_iterations", "Maximum number of iterations of EM algorithm "
     "(passing 0 will run until convergence).", "n", 250);
+PARAM_DOUBLE("prune_tolerance", "If greater than 0, use a kd-tree to prune "
+    "Gaussians whose conditional probability is less than this for every point "
+    "in a region.", "R", 0.0);
 
 // Parameters for dataset modification.
 PARAM_DOUBLE("noise", "Variance of zero-mean Gaussian noise to add to data.",
@@ -100,6 +110,11 @@ int main(int argc, char* argv[])
   const size_t maxIterations = (size_t) CLI::GetParam<int>("max_iterations");
   const double tolerance = CLI::GetParam<double>("tolerance");
   const bool forcePositive = !CLI::HasParam("no_force_positive");
+  const double pruneTolerance = CLI::GetParam<double>("prune_tolerance");
+
+  if (pruneTolerance < 0.0 || pruneTolerance >= 1.0)
+    Log::Fatal << "Pruning tolerance (" << pruneTolerance << ") must be "
+        << "greater than or equal to 0.0 and less than 1.0!" << std::endl;
 
   // This gets a bit weird because we need different types depending on whether
   // --refined_start is specified.
@@ -128,6 +143,7 @@ int main(int argc, char* argv[])
     if (forcePositive)
     {
       EMFit<KMeansType> em(maxIterations, tolerance, k);
+      em.PruneTolerance() = pruneTolerance;
 
       GMM<EMFit<KMeansType> > gmm(size_t(gaussians), dataPoints.n_rows, em);
 
@@ -142,6 +158,7 @@ int main(int argc, char* argv[])
     else
     {
       EMFit<KMeansType, NoConstraint> em(maxIterations, tolerance, k);
+      em.PruneTolerance() = pruneTolerance;
 
       GMM<EMFit<KMeansType, NoConstraint> > gmm(size_t(gaussians),
           dataPoints.n_rows, em);
@@ -161,6 +178,7 @@ int main(int argc, char* argv[])
     if (forcePositive)
     {
       EMFit<> em(maxIterations, tolerance);
+      em.PruneTolerance() = pruneTolerance;
 
       // Calculate mixture of Gaussians.
       GMM<> gmm(size_t(gaussians), dataPoints.n_rows, em);
@@ -177,6 +195,7 @@ int main(int argc, char* argv[])
     {
       // Use no constraints on the covariance matrix.
       EMFit<KMeans<>, NoConstraint> em(maxIterations, tolerance);
+      em.PruneTolerance() = pruneTolerance;
 
       // Calculate mixture of Gaussians.
       GMM<EMFit<KMeans<>, NoConstraint> > gmm(size_t(gaussians),
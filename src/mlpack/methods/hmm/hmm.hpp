@@ -34,6 +34,10 @@ namespace hmm /** Hidden Markov Models. */ {
  *   // Return the probability of the given observation.
  *   double Probability(const DataType& observation) const;
  *
+ *   // Return the log-probability of each of the given observations.
+ *   void LogProbability(const arma::mat& observations,
+ *                       arma::vec& logProbabilities) const;
+ *
  *   // Estimate the distribution based on the given observations.
  *   void Estimate(const std::vector<DataType>& observations);
  *
@@ -48,7 +52,7 @@ namespace hmm /** Hidden Markov Models. */ {
  * would use the DiscreteDistribution class when the observations are
  * non-negative integers.  Other distributions could be Gaussians, a mixture of
  * Gaussians (GMM), or any other probability distribution implementing the
- * four Distribution functions.
+ * Distribution functions above.
  *
  * Usage of the HMM class generally involves either training an HMM or loading
  * an already-known HMM and taking probability measurements of sequences.
@@ -152,6 +156,11 @@ class HMM
    * log-likelihood of the model between iterations is less than the tolerance,
    * the Baum-Welch algorithm terminates.
    *
+   * If mlpack was compiled with OpenMP, the sequences are split between
+   * NumThreads() threads in each iteration.  Each block of BlockSize sequences
+   * accumulates its own statistics, and the blocks are added in order, so the
+   * trained model does not depend on the number of threads.
+   *
    * @note
    * Train() can be called multiple times with different sequences; each time it
    * is called, it uses the current parameters of the HMM as a starting point
@@ -316,6 +325,15 @@ class HMM
   //! Modify the tolerance of the Baum-Welch algorithm.
   double& Tolerance() { return tolerance; }
 
+  //! Get the number of threads used by the Baum-Welch algorithm.
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads used by the Baum-Welch algorithm (this only
+  //! has an effect if mlpack was compiled with OpenMP).
+  size_t& NumThreads() { return numThreads; }
+
+  //! The number of sequences handled at once (and by one thread) in Train().
+  static const size_t BlockSize = 8;
+
   /**
    * Returns a string representation of this object.
    */
@@ -362,6 +380,62 @@ class HMM
                 const arma::vec& scales,
                 arma::mat& backwardProb) const;
 
+  /**
+   * Compute the log-probability of every observation in the given data
+   * sequence under every emission distribution.  Each distribution is
+   * evaluated for the whole sequence with one call to LogProbability(), so the
+   * recursions over the sequence never have to call the distributions.  The
+   * returned matrix has rows equal to the number of hidden states and columns
+   * equal to the number of observations.
+   *
+   * @param dataSeq Data sequence to compute log-probabilities for.
+   * @param logEmissionProb Matrix in which log-probabilities will be saved.
+   */
+  void LogEmissionProbabilities(const arma::mat& dataSeq,
+                                arma::mat& logEmissionProb) const;
+
+  /**
+   * The Forward algorithm, given the probability of each observation under each
+   * emission distribution (the exponential of what LogEmissionProbabilities()
+   * returns).  Each step is one matrix-vector multiplication.
+   *
+   * @param emissionProb Emission probabilities of each observation.
+   * @param scales Vector in which scaling factors will be saved.
+   * @param forwardProb Matrix in which forward probabilities will be saved.
+   */
+  void EmissionForward(const arma::mat& emissionProb,
+                       arma::vec& scales,
+                       arma::mat& forwardProb) const;
+
+  /**
+   * The Backward algorithm, given the probability of each observation under
+   * each emission distribution and the scaling factors found by
+   * EmissionForward().  Each step is one matrix-vector multiplication.
+   *
+   * @param emissionProb Emission probabilities of each observation.
+   * @param scales Vector of scaling factors.
+   * @param backwardProb Matrix in which backward probabilities will be saved.
+   */
+  void EmissionBackward(const arma::mat& emissionProb,
+                        const arma::vec& scales,
+                        arma::mat& backwardProb) const;
+
+  /**
+   * The Viterbi algorithm, given the log-probability of each observation under
+   * each emission distribution.  The best previous state of each state at each
+   * time step is stored as an IndexType, which Predict() chooses to be the
+   * narrowest type that can hold every state index, so that the backpointers
+   * for long sequences take as little memory as possible.
+   *
+   * @param logEmissionProb Log-probabilities of each observation.
+   * @param stateSeq Vector in which the most probable state sequence will be
+   *    stored.
+   * @return Log-likelihood of most probable state sequence.
+   */
+  template<typename IndexType>
+  double Viterbi(const arma::mat& logEmissionProb,
+                 arma::Col<size_t>& stateSeq) const;
+
   //! Set of emission probability distributions; one for each state.
   std::vector<Distribution> emission;
 
@@ -377,6 +451,9 @@ class HMM
 
   //! Tolerance of Baum-Welch algorithm.
   double tolerance;
+
+  //! Number of threads used by the Baum-Welch algorithm.
+  size_t numThreads;
 };
 
 }; // namespace hmm
@@ -3,7 +3,8 @@
  * @author Ryan Curtin
  * @author Michael Fox
  *
- * Convert an HMM (XML) file from older MLPACK versions to current format.
+ * Convert an HMM (XML) file from older MLPACK versions to current format, or
+ * convert an HMM file between the XML and binary formats.
  */
 #include <mlpack/core.hpp>
 
@@ -15,10 +16,14 @@
 
 PROGRAM_INFO("Hidden Markov Model (HMM) File Converter", "This utility takes "
     "an already-trained HMM (--model_file) and converts it to the new format "
-    "(--output_file).");
+    "(--output_file).  If the model is already in the new format, it is "
+    "written again, so this utility can also convert between XML and the "
+    "compact binary format, which is used if the output filename ends in "
+    "'.bin'.");
 
-PARAM_STRING_REQ("model_file", "File containing HMM (XML).", "m");
-PARAM_STRING("output_file", "File to save HMM (XML) to.", "o", "output.xml");
+PARAM_STRING_REQ("model_file", "File containing HMM (XML or binary).", "m");
+PARAM_STRING("output_file", "File to save HMM to (XML, or binary if the "
+    "extension is .bin).", "o", "output.xml");
 
 using namespace mlpack;
 using namespace mlpack::hmm;
@@ -40,6 +45,18 @@ int main(int argc, char** argv)
   // Load model, but first we have to determine its type.
   SaveRestoreUtility sr, sr2;
   sr.ReadFile(modelFile);
+
+  // Models in the current format need no conversion; they can be written
+  // directly (possibly in a different format).
+  if (sr.HasParameter("emission_type"))
+  {
+    const string outputFile = CLI::GetParam<string>("output_file");
+    if (!sr.WriteFile(outputFile))
+      Log::Fatal << "Could not write file '" << outputFile << "'!" << endl;
+
+    return 0;
+  }
+
   string emissionType;
   sr.LoadParameter(emissionType, "hmm_type");
 
@@ -0,0 +1,104 @@
+/**
+ * @file hmm_filter.hpp
+ *
+ * Definition of the HMMFilter class, which filters a stream of observations
+ * with an HMM one observation at a time.
+ */
+#ifndef __MLPACK_METHODS_HMM_HMM_FILTER_HPP
+#define __MLPACK_METHODS_HMM_HMM_FILTER_HPP
+
+#include <mlpack/core.hpp>
+#include "hmm.hpp"
+
+namespace mlpack {
+namespace hmm {
+
+/**
+ * HMMFilter runs the forward algorithm of an HMM on a stream of observations,
+ * one observation at a time.  It holds the scaled forward probabilities of the
+ * last time step (that is, the probability of each hidden state given all the
+ * observations so far) and the log-likelihood of the observations so far, so
+ * each call to Push() costs one evaluation of each emission distribution and
+ * one multiplication by the transition matrix, no matter how many observations
+ * came before.  The results are the same as HMM::LogLikelihood() and the last
+ * column of the state probabilities given by HMM::Estimate(), but the whole
+ * sequence does not need to be known in advance.
+ *
+ * @code
+ * extern HMM<GaussianDistribution> hmm; // A trained HMM.
+ * HMMFilter<GaussianDistribution> filter(hmm);
+ *
+ * // Each event is scored as it arrives.
+ * arma::vec observation;
+ * while (NextEvent(observation))
+ * {
+ *   const double logLikelihood = filter.Push(observation);
+ *   const arma::vec& stateProb = filter.StateProbabilities();
+ * }
+ * @endcode
+ *
+ * The filter keeps a reference to the HMM, which must outlive it; if the HMM
+ * is changed (for instance, retrained), the filter should be Reset().
+ *
+ * To filter the predictors and responses of an HMMRegression, use
+ * HMMRegressionFilter.
+ *
+ * @tparam Distribution Type of emission distribution of the HMM.
+ */
+template<typename Distribution = distribution::DiscreteDistribution>
+class HMMFilter
+{
+ public:
+  /**
+   * Create a filter for the given HMM.  No observations have been seen yet, so
+   * the state probabilities are the initial state probabilities of the HMM.
+   *
+   * @param hmm HMM to filter observations with.
+   */
+  HMMFilter(const HMM<Distribution>& hmm);
+
+  /**
+   * Add the next observation of the sequence, updating the state probabilities
+   * and returning the log-likelihood of the whole sequence so far.  No memory
+   * is allocated.
+   *
+   * @param observation Next observation of the sequence.
+   * @return Log-likelihood of all the observations seen so far.
+   */
+  double Push(const arma::vec& observation);
+
+  //! Forget all the observations, starting a new sequence.
+  void Reset();
+
+  //! Get the probability of each hidden state, given the observations so far.
+  const arma::vec& StateProbabilities() const { return forward; }
+  //! Get the log-likelihood of the observations so far.
+  double LogLikelihood() const { return logLikelihood; }
+  //! Get the number of observations seen so far.
+  size_t Steps() const { return steps; }
+
+  //! Get the HMM used by the filter.
+  const HMM<Distribution>& Model() const { return hmm; }
+
+ private:
+  //! The HMM.
+  const HMM<Distribution>& hmm;
+
+  //! Scaled forward probabilities of the last observation.
+  arma::vec forward;
+  //! Space for the forward probabilities of the next observation.
+  arma::vec nextForward;
+
+  //! Log-likelihood of the observations so far.
+  double logLikelihood;
+  //! Number of observations so far.
+  size_t steps;
+};
+
+}; // namespace hmm
+}; // namespace mlpack
+
+// Include implementation.
+#include "hmm_filter_impl.hpp"
+
+#endif
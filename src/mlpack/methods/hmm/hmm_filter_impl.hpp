@@ -0,0 +1,63 @@
+/**
+ * @file hmm_filter_impl.hpp
+ *
+ * Implementation of the HMMFilter class.
+ */
+#ifndef __MLPACK_METHODS_HMM_HMM_FILTER_IMPL_HPP
+#define __MLPACK_METHODS_HMM_HMM_FILTER_IMPL_HPP
+
+// In case it hasn't already been included.
+#include "hmm_filter.hpp"
+
+namespace mlpack {
+namespace hmm {
+
+template<typename Distribution>
+HMMFilter<Distribution>::HMMFilter(const HMM<Distribution>& hmm) :
+    hmm(hmm),
+    forward(hmm.Initial()),
+    nextForward(hmm.Initial().n_elem),
+    logLikelihood(0.0),
+    steps(0)
+{ /* Nothing to do. */ }
+
+template<typename Distribution>
+double HMMFilter<Distribution>::Push(const arma::vec& observation)
+{
+  // This is one step of HMM::Forward().  First, find the probability of each
+  // state at this time step, given the previous observations.  Before any
+  // observations, these are the initial state probabilities.
+  if (steps == 0)
+    nextForward = hmm.Initial();
+  else
+    nextForward = hmm.Transition() * forward;
+
+  // Now multiply by the probability of each state emitting the observation.
+  for (size_t state = 0; state < nextForward.n_elem; ++state)
+    nextForward[state] *= hmm.Emission()[state].Probability(observation);
+
+  // Normalize; the scaling factor is the probability of this observation given
+  // the previous observations.
+  const double scale = accu(nextForward);
+  forward = nextForward;
+  forward /= scale;
+
+  logLikelihood += std::log(scale);
+  ++steps;
+
+  return logLikelihood;
+}
+
+template<typename Distribution>
+void HMMFilter<Distribution>::Reset()
+{
+  forward = hmm.Initial();
+  nextForward.set_size(forward.n_elem);
+  logLikelihood = 0.0;
+  steps = 0;
+}
+
+}; // namespace hmm
+}; // namespace mlpack
+
+#endif
@@ -19,7 +19,7 @@ PROGRAM_INFO("Hidden Markov Model (HMM) Sequence Generator", "This "
     "parameters, saving them to the specified files (--output_file and "
     "--state_file)");
 
-PARAM_STRING_REQ("model_file", "File containing HMM (XML).", "m");
+PARAM_STRING_REQ("model_file", "File containing HMM (XML or binary).", "m");
 PARAM_INT_REQ("length", "Length of sequence to generate.", "l");
 
 PARAM_INT("start_state", "Starting state of sequence.", "t", 0);
@@ -27,7 +27,8 @@ HMM<Distribution>::HMM(const size_t states,
     transition(arma::ones<arma::mat>(states, states) / (double) states),
     initial(arma::ones<arma::vec>(states) / (double) states),
     dimensionality(emissions.Dimensionality()),
-    tolerance(tolerance)
+    tolerance(tolerance),
+    numThreads(1)
 { /* nothing to do */ }
 
 /**
@@ -42,7 +43,8 @@ HMM<Distribution>::HMM(const arma::vec& initial,
     emission(emission),
     transition(transition),
     initial(initial),
-    tolerance(tolerance)
+    tolerance(tolerance),
+    numThreads(1)
 {
   // Set the dimensionality, if we can.
   if (emission.size() > 0)
@@ -81,10 +83,14 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
   // Maximum iterations?
   size_t iterations = 1000;
 
-  // Find length of all sequences and ensure they are the correct size.
+  // Find length of all sequences and ensure they are the correct size.  We
+  // also need to know where each sequence starts in the list of all
+  // observations.
   size_t totalLength = 0;
+  std::vector<size_t> sequenceStart(dataSeq.size());
   for (size_t seq = 0; seq < dataSeq.size(); seq++)
   {
+    sequenceStart[seq] = totalLength;
     totalLength += dataSeq[seq].n_cols;
 
     if (dataSeq[seq].n_rows != dimensionality)
@@ -94,70 +100,129 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
   }
 
   // These are used later for training of each distribution.  We initialize it
-  // all now so we don't have to do any allocation later on.
+  // all now so we don't have to do any allocation later on.  The list of
+  // emission observations, for Distribution::Estimate(), is the same in every
+  // iteration.
   std::vector<arma::vec> emissionProb(transition.n_cols,
       arma::vec(totalLength));
   arma::mat emissionList(dimensionality, totalLength);
+  for (size_t seq = 0; seq < dataSeq.size(); seq++)
+    if (dataSeq[seq].n_cols > 0)
+      emissionList.cols(sequenceStart[seq], sequenceStart[seq] +
+          dataSeq[seq].n_cols - 1) = dataSeq[seq];
+
+  // Each block of sequences gets its own estimates, which are added together
+  // in order after the E-step.  This way the result does not depend on the
+  // number of threads.
+  const size_t numBlocks = (dataSeq.size() + BlockSize - 1) / BlockSize;
+  std::vector<arma::vec> blockInitial(numBlocks,
+      arma::vec(transition.n_rows));
+  std::vector<arma::mat> blockTransition(numBlocks,
+      arma::mat(transition.n_rows, transition.n_cols));
+  arma::vec blockLoglik(numBlocks);
 
   // This should be the Baum-Welch algorithm (EM for HMM estimation). This
   // follows the procedure outlined in Elliot, Aggoun, and Moore's book "Hidden
   // Markov Models: Estimation and Control", pp. 36-40.
   for (size_t iter = 0; iter < iterations; iter++)
   {
-    // Clear new transition matrix and emission probabilities.
-    arma::vec newInitial(transition.n_rows);
-    newInitial.zeros();
-    arma::mat newTransition(transition.n_rows, transition.n_cols);
-    newTransition.zeros();
-
-    // Reset log likelihood.
-    loglik = 0;
-
-    // Sum over time.
-    size_t sumTime = 0;
-
-    // Loop over each sequence.
-    for (size_t seq = 0; seq < dataSeq.size(); seq++)
+    // Loop over each block of sequences.  The emission distributions may
+    // raise errors (with Log::Fatal, which throws) from LogProbability();
+    // those are caught in the loop and raised again after it.
+    bool failed = false;
+    std::string failure;
+    #pragma omp parallel for num_threads(numThreads) schedule(dynamic)
+    for (size_t b = 0; b < numBlocks; b++)
     {
-      arma::mat stateProb;
-      arma::mat forward;
-      arma::mat backward;
-      arma::vec scales;
-
-      // Add the log-likelihood of this sequence.  This is the E-step.
-      loglik += Estimate(dataSeq[seq], stateProb, forward, backward, scales);
-
-      // Now re-estimate the parameters.  This is the M-step.
-      //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
-      //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t]) b(i,
-      //           t + 1)))
-      //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t) b(i, t)
-      // We store the new estimates in a different matrix.
-      for (size_t t = 0; t < dataSeq[seq].n_cols; t++)
+      try
       {
-        for (size_t j = 0; j < transition.n_cols; j++)
+        // Clear new transition matrix and emission probabilities.
+        blockInitial[b].zeros();
+        blockTransition[b].zeros();
+        blockLoglik[b] = 0;
+
+        const size_t begin = b * BlockSize;
+        const size_t end = std::min(begin + BlockSize, dataSeq.size());
+        for (size_t seq = begin; seq < end; seq++)
         {
-          // Add to estimate of initial probability for state j.
-          newInitial[j] = stateProb(j, 0);
-
-          if (t < dataSeq[seq].n_cols - 1)
+          arma::mat emissionSeqProb;
+          arma::mat forward;
+          arma::mat backward;
+          arma::vec scales;
+
+          // Run the forward-backward algorithm and add the log-likelihood of
+          // this sequence.  This is the E-step.  The emission probabilities are
+          // kept for the M-step.
+          LogEmissionProbabilities(dataSeq[seq], emissionSeqProb);
+          emissionSeqProb = arma::exp(emissionSeqProb);
+          EmissionForward(emissionSeqProb, scales, forward);
+          EmissionBackward(emissionSeqProb, scales, backward);
+          const arma::mat stateProb = forward % backward;
+          blockLoglik[b] += accu(log(scales));
+
+          // Now re-estimate the parameters.  This is the M-step.
+          //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
+          //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t])
+          //           b(i, t + 1)))
+          //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t)
+          //           b(i, t)
+          // We store the new estimates in a different matrix.
+          blockInitial[b] += stateProb.col(0);
+
+          // Estimate of T_ij (probability of transition from state j to state
+          // i) for all i and j at once; the sum over t is a matrix
+          // multiplication.  We postpone multiplication of the old T_ij until
+          // later.
+          const size_t length = dataSeq[seq].n_cols;
+          if (length > 1)
           {
-            // Estimate of T_ij (probability of transition from state j to state
-            // i).  We postpone multiplication of the old T_ij until later.
-            for (size_t i = 0; i < transition.n_rows; i++)
-              newTransition(i, j) += forward(j, t) * backward(i, t + 1) *
-                  emission[i].Probability(dataSeq[seq].unsafe_col(t + 1)) /
-                  scales[t + 1];
+            arma::mat nextProb = backward.cols(1, length - 1) %
+                emissionSeqProb.cols(1, length - 1);
+            for (size_t t = 1; t < length; t++)
+              nextProb.col(t - 1) /= scales[t];
+
+            blockTransition[b] += nextProb * trans(forward.cols(0, length - 2));
           }
 
-          // Add to list of emission observations, for Distribution::Estimate().
-          emissionList.col(sumTime) = dataSeq[seq].col(t);
-          emissionProb[j][sumTime] = stateProb(j, t);
+          // Add to list of emission probabilities, for
+          // Distribution::Estimate().
+          for (size_t j = 0; j < transition.n_cols; j++)
+            emissionProb[j].subvec(sequenceStart[seq], sequenceStart[seq] +
+                length - 1) = trans(stateProb.row(j));
+        }
+      }
+      catch (std::exception& e)
+      {
+        // The exception can't be allowed to leave the parallel region, since
+        // that would terminate the program; it is reported after the loop.
+        #pragma omp critical
+        {
+          if (!failed)
+          {
+            failed = true;
+            failure = e.what();
+          }
         }
-        sumTime++;
       }
     }
 
+    if (failed)
+      Log::Fatal << "HMM::Train(): error in the E-step: " << failure << "."
+          << std::endl;
+
+    // Add the estimates of each block.
+    arma::vec newInitial(transition.n_rows);
+    newInitial.zeros();
+    arma::mat newTransition(transition.n_rows, transition.n_cols);
+    newTransition.zeros();
+    loglik = 0;
+    for (size_t b = 0; b < numBlocks; b++)
+    {
+      newInitial += blockInitial[b];
+      newTransition += blockTransition[b];
+      loglik += blockLoglik[b];
+    }
+
     // Normalize the new initial probabilities.
     if (dataSeq.size() == 0)
       initial = newInitial / dataSeq.size();
@@ -286,9 +351,14 @@ double HMM<Distribution>::Estimate(const arma::mat& dataSeq,
                                    arma::mat& backwardProb,
                                    arma::vec& scales) const
 {
-  // First run the forward-backward algorithm.
-  Forward(dataSeq, scales, forwardProb);
-  Backward(dataSeq, scales, backwardProb);
+  // First run the forward-backward algorithm.  The emission probabilities are
+  // only computed once, for both passes.
+  arma::mat emissionProb;
+  LogEmissionProbabilities(dataSeq, emissionProb);
+  emissionProb = arma::exp(emissionProb);
+
+  EmissionForward(emissionProb, scales, forwardProb);
+  EmissionBackward(emissionProb, scales, backwardProb);
 
   // Now assemble the state probability matrix based on the forward and backward
   // probabilities.
@@ -370,54 +440,86 @@ void HMM<Distribution>::Generate(const size_t length,
 template<typename Distribution>
 double HMM<Distribution>::Predict(const arma::mat& dataSeq,
                                   arma::Col<size_t>& stateSeq) const
+{
+  arma::mat logEmissionProb;
+  LogEmissionProbabilities(dataSeq, logEmissionProb);
+
+  // The backpointers take (states x sequence length) indices, so store them in
+  // the narrowest type that can hold the index of every state.
+  if (transition.n_rows <=
+      (size_t) std::numeric_limits<unsigned short>::max() + 1)
+    return Viterbi<unsigned short>(logEmissionProb, stateSeq);
+  else if (transition.n_rows <=
+      (size_t) std::numeric_limits<unsigned int>::max() + 1)
+    return Viterbi<unsigned int>(logEmissionProb, stateSeq);
+  else
+    return Viterbi<size_t>(logEmissionProb, stateSeq);
+}
+
+/**
+ * The Viterbi algorithm, given the log-probabilities of the emissions.
+ */
+template<typename Distribution>
+template<typename IndexType>
+double HMM<Distribution>::Viterbi(const arma::mat& logEmissionProb,
+                                  arma::Col<size_t>& stateSeq) const
 {
   // This is an implementation of the Viterbi algorithm for finding the most
-  // probable sequence of states to produce the observed data sequence.  We
-  // don't use log-likelihoods to save that little bit of time, but we'll
-  // calculate the log-likelihood at the end of it all.
-  stateSeq.set_size(dataSeq.n_cols);
-  arma::mat logStateProb(transition.n_rows, dataSeq.n_cols);
-  arma::mat stateSeqBack(transition.n_rows, dataSeq.n_cols);
+  // probable sequence of states to produce the observed data sequence.  We work
+  // in log-space, with the log-probabilities of all the emissions computed
+  // before the recursion starts.  Only the log-probabilities of the current
+  // time step are kept; the best previous state of each state at each time step
+  // is all we need to backtrack.
+  const size_t length = logEmissionProb.n_cols;
+  stateSeq.set_size(length);
+  arma::Mat<IndexType> stateSeqBack(transition.n_rows, length);
 
   // Store the logs of the transposed transition matrix.  This is because we
   // will be using the rows of the transition matrix.
-  arma::mat logTrans(log(trans(transition)));
+  const arma::mat logTrans(log(trans(transition)));
 
   // The calculation of the first state is slightly different; the probability
   // of the first state being state j is the maximum probability that the state
   // came to be j from another state.
-  logStateProb.col(0).zeros();
-  for (size_t state = 0; state < transition.n_rows; state++)
-  {
-    logStateProb(state, 0) = log(initial[state] *
-        emission[state].Probability(dataSeq.unsafe_col(0)));
-    stateSeqBack(state, 0) = state;
-  }
+  arma::vec logStateProb = log(initial) + logEmissionProb.col(0);
+  arma::vec nextLogStateProb(transition.n_rows);
 
-  // Store the best first state.
-  arma::uword index;
-  for (size_t t = 1; t < dataSeq.n_cols; t++)
+  for (size_t t = 1; t < length; t++)
   {
     // Assemble the state probability for this element.
     // Given that we are in state j, we use state with the highest probability
     // of being the previous state.
     for (size_t j = 0; j < transition.n_rows; j++)
     {
-      arma::vec prob = logStateProb.col(t - 1) + logTrans.col(j);
-      logStateProb(j, t) = prob.max(index) +
-          log(emission[j].Probability(dataSeq.unsafe_col(t)));
-        stateSeqBack(j, t) = index;
+      const double* logTransCol = logTrans.colptr(j);
+      size_t bestState = 0;
+      double bestLogProb = logStateProb[0] + logTransCol[0];
+      for (size_t i = 1; i < transition.n_rows; i++)
+      {
+        const double logProb = logStateProb[i] + logTransCol[i];
+        if (logProb > bestLogProb)
+        {
+          bestLogProb = logProb;
+          bestState = i;
+        }
+      }
+
+      nextLogStateProb[j] = bestLogProb + logEmissionProb(j, t);
+      stateSeqBack(j, t) = (IndexType) bestState;
     }
+
+    logStateProb = nextLogStateProb;
   }
 
   // Backtrack to find the most probable state sequence.
-  logStateProb.unsafe_col(dataSeq.n_cols - 1).max(index);
-  stateSeq[dataSeq.n_cols - 1] = index;
-  for (size_t t = 2; t <= dataSeq.n_cols; t++)
-    stateSeq[dataSeq.n_cols - t] =
-        stateSeqBack(stateSeq[dataSeq.n_cols - t + 1], dataSeq.n_cols - t + 1);
+  arma::uword index;
+  logStateProb.max(index);
+  stateSeq[length - 1] = index;
+  for (size_t t = 2; t <= length; t++)
+    stateSeq[length - t] =
+        stateSeqBack(stateSeq[length - t + 1], length - t + 1);
 
-  return logStateProb(stateSeq(dataSeq.n_cols - 1), dataSeq.n_cols - 1);
+  return logStateProb[index];
 }
 
 /**
@@ -484,37 +586,76 @@ template<typename Distribution>
 void HMM<Distribution>::Forward(const arma::mat& dataSeq,
                                 arma::vec& scales,
                                 arma::mat& forwardProb) const
+{
+  arma::mat emissionProb;
+  LogEmissionProbabilities(dataSeq, emissionProb);
+  emissionProb = arma::exp(emissionProb);
+
+  EmissionForward(emissionProb, scales, forwardProb);
+}
+
+template<typename Distribution>
+void HMM<Distribution>::Backward(const arma::mat& dataSeq,
+                                 const arma::vec& scales,
+                                 arma::mat& backwardProb) const
+{
+  arma::mat emissionProb;
+  LogEmissionProbabilities(dataSeq, emissionProb);
+  emissionProb = arma::exp(emissionProb);
+
+  EmissionBackward(emissionProb, scales, backwardProb);
+}
+
+/**
+ * Compute the log-probability of each observation under each emission
+ * distribution.
+ */
+template<typename Distribution>
+void HMM<Distribution>::LogEmissionProbabilities(
+    const arma::mat& dataSeq,
+    arma::mat& logEmissionProb) const
+{
+  // Each distribution fills a column, which is contiguous; then we transpose,
+  // so that the probabilities for each time step are contiguous.
+  arma::mat logProbs(dataSeq.n_cols, transition.n_rows);
+  for (size_t state = 0; state < transition.n_rows; state++)
+  {
+    arma::vec logProbAlias = logProbs.unsafe_col(state);
+    emission[state].LogProbability(dataSeq, logProbAlias);
+  }
+
+  logEmissionProb = trans(logProbs);
+}
+
+template<typename Distribution>
+void HMM<Distribution>::EmissionForward(const arma::mat& emissionProb,
+                                        arma::vec& scales,
+                                        arma::mat& forwardProb) const
 {
   // Our goal is to calculate the forward probabilities:
   //  P(X_k | o_{1:k}) for all possible states X_k, for each time point k.
-  forwardProb.zeros(transition.n_rows, dataSeq.n_cols);
-  scales.zeros(dataSeq.n_cols);
+  forwardProb.set_size(transition.n_rows, emissionProb.n_cols);
+  scales.set_size(emissionProb.n_cols);
 
   // The first entry in the forward algorithm uses the initial state
   // probabilities.  Note that MATLAB assumes that the starting state (at
   // t = -1) is state 0; this is not our assumption here.  To force that
   // behavior, you could append a single starting state to every single data
   // sequence and that should produce results in line with MATLAB.
-  for (size_t state = 0; state < transition.n_rows; state++)
-    forwardProb(state, 0) = initial(state) *
-        emission[state].Probability(dataSeq.unsafe_col(0));
+  forwardProb.col(0) = initial % emissionProb.col(0);
 
   // Then normalize the column.
   scales[0] = accu(forwardProb.col(0));
   forwardProb.col(0) /= scales[0];
 
-  // Now compute the probabilities for each successive observation.
-  for (size_t t = 1; t < dataSeq.n_cols; t++)
+  // Now compute the probabilities for each successive observation.  The
+  // forward probability of state j at time t is the sum over all states of the
+  // probability of the previous state transitioning to the current state,
+  // times the probability of state j emitting the given observation.
+  for (size_t t = 1; t < emissionProb.n_cols; t++)
   {
-    for (size_t j = 0; j < transition.n_rows; j++)
-    {
-      // The forward probability of state j at time t is the sum over all states
-      // of the probability of the previous state transitioning to the current
-      // state and emitting the given observation.
-      forwardProb(j, t) = accu(forwardProb.col(t - 1) %
-          trans(transition.row(j))) *
-          emission[j].Probability(dataSeq.unsafe_col(t));
-    }
+    forwardProb.col(t) = (transition * forwardProb.col(t - 1)) %
+        emissionProb.col(t);
 
     // Normalize probability.
     scales[t] = accu(forwardProb.col(t));
@@ -523,33 +664,28 @@ void HMM<Distribution>::Forward(const arma::mat& dataSeq,
 }
 
 template<typename Distribution>
-void HMM<Distribution>::Backward(const arma::mat& dataSeq,
-                                 const arma::vec& scales,
-                                 arma::mat& backwardProb) const
+void HMM<Distribution>::EmissionBackward(const arma::mat& emissionProb,
+                                         const arma::vec& scales,
+                                         arma::mat& backwardProb) const
 {
   // Our goal is to calculate the backward probabilities:
   //  P(X_k | o_{k + 1:T}) for all possible states X_k, for each time point k.
-  backwardProb.zeros(transition.n_rows, dataSeq.n_cols);
+  backwardProb.set_size(transition.n_rows, emissionProb.n_cols);
 
   // The last element probability is 1.
-  backwardProb.col(dataSeq.n_cols - 1).fill(1);
-
-  // Now step backwards through all other observations.
-  for (size_t t = dataSeq.n_cols - 2; t + 1 > 0; t--)
+  backwardProb.col(emissionProb.n_cols - 1).fill(1);
+
+  // Now step backwards through all other observations.  The backward
+  // probability of state j at time t is the sum over all states of the
+  // probability of the next state having been a transition from the current
+  // state multiplied by the probability of each of those states emitting the
+  // given observation.
+  const arma::mat transTransition = trans(transition);
+  for (size_t t = emissionProb.n_cols - 1; t > 0; t--)
   {
-    for (size_t j = 0; j < transition.n_rows; j++)
-    {
-      // The backward probability of state j at time t is the sum over all state
-      // of the probability of the next state having been a transition from the
-      // current state multiplied by the probability of each of those states
-      // emitting the given observation.
-      for (size_t state = 0; state < transition.n_rows; state++)
-        backwardProb(j, t) += transition(state, j) * backwardProb(state, t + 1)
-            * emission[state].Probability(dataSeq.unsafe_col(t + 1));
-
-      // Normalize by the weights from the forward algorithm.
-      backwardProb(j, t) /= scales[t + 1];
-    }
+    // Normalize by the weights from the forward algorithm.
+    backwardProb.col(t - 1) = transTransition * (backwardProb.col(t) %
+        emissionProb.col(t)) / scales[t];
   }
 }
 
@@ -17,7 +17,7 @@ PROGRAM_INFO("Hidden Markov Model (HMM) Sequence Log-Likelihood", "This "
     "computed log-likelihood is given directly to stdout.");
 
 PARAM_STRING_REQ("input_file", "File containing observations,", "i");
-PARAM_STRING_REQ("model_file", "File containing HMM (XML).", "m");
+PARAM_STRING_REQ("model_file", "File containing HMM (XML or binary).", "m");
 
 using namespace mlpack;
 using namespace mlpack::hmm;
@@ -0,0 +1,65 @@
+/**
+ * @file hmm_regression_filter.hpp
+ *
+ * Definition of the HMMRegressionFilter class, which filters a stream of
+ * predictors and responses with an HMMRegression.
+ */
+#ifndef __MLPACK_METHODS_HMM_HMM_REGRESSION_FILTER_HPP
+#define __MLPACK_METHODS_HMM_HMM_REGRESSION_FILTER_HPP
+
+#include <mlpack/core.hpp>
+#include "hmm_regression.hpp"
+#include "hmm_filter.hpp"
+
+namespace mlpack {
+namespace hmm {
+
+/**
+ * An HMMFilter for an HMMRegression, which takes each observation as a vector
+ * of predictors and a response, like the methods of HMMRegression do.  The
+ * predictors and the response are stacked into an observation held by the
+ * filter, so no memory is allocated for each observation.
+ */
+class HMMRegressionFilter :
+    public HMMFilter<distribution::RegressionDistribution>
+{
+ public:
+  /**
+   * Create a filter for the given HMMRegression.
+   *
+   * @param hmm HMMRegression to filter observations with.
+   */
+  HMMRegressionFilter(const HMMRegression& hmm) :
+      HMMFilter<distribution::RegressionDistribution>(hmm),
+      observation(hmm.Dimensionality())
+  { /* Nothing to do. */ }
+
+  // Stacked observations can still be given directly.
+  using HMMFilter<distribution::RegressionDistribution>::Push;
+
+  /**
+   * Add the next predictors and response of the sequence, updating the state
+   * probabilities and returning the log-likelihood of the whole sequence so
+   * far.
+   *
+   * @param predictors Predictors of the next observation.
+   * @param response Response of the next observation.
+   * @return Log-likelihood of all the observations seen so far.
+   */
+  double Push(const arma::vec& predictors, const double response)
+  {
+    // This is the same layout that HMMRegression::StackData() uses.
+    observation[0] = response;
+    observation.subvec(1, observation.n_elem - 1) = predictors;
+    return Push(observation);
+  }
+
+ private:
+  //! Space for the stacked response and predictors.
+  arma::vec observation;
+};
+
+}; // namespace hmm
+}; // namespace mlpack
+
+#endif
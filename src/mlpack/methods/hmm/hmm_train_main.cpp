@@ -43,10 +43,12 @@ PARAM_INT("gaussians", "Number of gaussians in each GMM (necessary when type is"
 PARAM_STRING("model_file", "Pre-existing HMM model (optional).", "m", "");
 PARAM_STRING("labels_file", "Optional file of hidden states, used for "
     "labeled training.", "l", "");
-PARAM_STRING("output_file", "File to save trained HMM to (XML).", "o",
-    "output_hmm.xml");
+PARAM_STRING("output_file", "File to save trained HMM to (XML, or binary if "
+    "the extension is .bin).", "o", "output_hmm.xml");
 PARAM_INT("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
 PARAM_DOUBLE("tolerance", "Tolerance of the Baum-Welch algorithm.", "T", 1e-5);
+PARAM_INT("threads", "Number of threads to use for unlabeled training (only "
+    "effective if mlpack was compiled with OpenMP).", "j", 1);
 
 using namespace mlpack;
 using namespace mlpack::hmm;
@@ -57,6 +59,24 @@ using namespace mlpack::math;
 using namespace arma;
 using namespace std;
 
+/**
+ * Train the given HMM on the training sequences, with the labels if there are
+ * any.  The given number of threads is used for unlabeled training.
+ */
+template<typename Distribution>
+void TrainHMM(HMM<Distribution>& hmm,
+              const vector<mat>& trainSeq,
+              const vector<arma::Col<size_t> >& labelSeq,
+              const bool labeled,
+              const size_t threads)
+{
+  hmm.NumThreads() = threads;
+  if (!labeled)
+    hmm.Train(trainSeq); // Unsupervised training.
+  else
+    hmm.Train(trainSeq, labelSeq); // Supervised training.
+}
+
 int main(int argc, char** argv)
 {
   // Parse command line options.
@@ -91,6 +111,14 @@ int main(int argc, char** argv)
         << " than or equal to 1." << endl;
   }
 
+  // Validate number of threads.
+  if (CLI::GetParam<int>("threads") < 1)
+  {
+    Log::Fatal << "Invalid number of threads: " << CLI::GetParam<int>("threads")
+        << ".  Must be greater than 0." << endl;
+  }
+  const size_t threads = (size_t) CLI::GetParam<int>("threads");
+
   // Load the dataset(s) and labels.
   vector<mat> trainSeq;
   vector<arma::Col<size_t> > labelSeq; // May be empty.
@@ -242,11 +270,8 @@ int main(int argc, char** argv)
           DiscreteDistribution(maxEmission), tolerance);
     }
 
-    // Do we have labels?
-    if (labelsFile == "")
-      hmm.Train(trainSeq); // Unsupervised training.
-    else
-      hmm.Train(trainSeq, labelSeq); // Supervised training.
+    // Now run the training.
+    TrainHMM(hmm, trainSeq, labelSeq, labelsFile != "", threads);
 
     // Finally, save the model.  This should later be integrated into the HMM
     // class itself.
@@ -286,10 +311,7 @@ int main(int argc, char** argv)
             << dimensionality << ")!" << endl;
 
     // Now run the training.
-    if (labelsFile == "")
-      hmm.Train(trainSeq); // Unsupervised training.
-    else
-      hmm.Train(trainSeq, labelSeq); // Supervised training.
+    TrainHMM(hmm, trainSeq, labelSeq, labelsFile != "", threads);
 
     // Finally, save the model.  This should later be integrated into th HMM
     // class itself.
@@ -340,15 +362,9 @@ int main(int argc, char** argv)
 
     // Now run the training.
     if (labelsFile == "")
-    {
       Log::Warn << "Unlabeled training of GMM HMMs is almost certainly not "
           << "going to produce good results!" << endl;
-      hmm.Train(trainSeq);
-    }
-    else
-    {
-      hmm.Train(trainSeq, labelSeq);
-    }
+    TrainHMM(hmm, trainSeq, labelSeq, labelsFile != "", threads);
 
     // Save model.
     SaveRestoreUtility sr;
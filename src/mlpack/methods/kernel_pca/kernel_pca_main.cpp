@@ -10,6 +10,7 @@
 #include <mlpack/methods/nystroem_method/kmeans_selection.hpp>
 #include <mlpack/methods/nystroem_method/nystroem_method.hpp>
 #include <mlpack/methods/kernel_pca/kernel_rules/nystroem_method.hpp>
+#include <mlpack/methods/kernel_pca/kernel_rules/randomized_method.hpp>
 
 #include "kernel_pca.hpp"
 
@@ -70,7 +71,13 @@ PROGRAM_INFO("Kernel Principal Components Analysis",
     " a subset of the data as basis to reconstruct the kernel matrix; to specify"
     " the sampling scheme, the --sampling parameter is used, the sampling scheme"
     " for the nystr\u00F6m method can be chosen from the following list: kmeans,"
-    " random, ordered.");
+    " random, ordered."
+    "\n\n"
+    "When only a few components are needed, the --randomized (-r) option can "
+    "be used instead.  This finds only the top --new_dimensionality "
+    "eigenvectors of the kernel matrix with randomized subspace iteration, "
+    "computing the kernel matrix a few rows at a time so that it is never held "
+    "in memory.");
 
 PARAM_STRING_REQ("input_file", "Input dataset to perform KPCA on.", "i");
 PARAM_STRING_REQ("output_file", "File to save modified dataset to.", "o");
@@ -86,6 +93,9 @@ PARAM_FLAG("center", "If set, the transformed data will be centered about the "
 
 PARAM_FLAG("nystroem_method", "If set, the nystroem method will be used.", "n");
 
+PARAM_FLAG("randomized", "If set, a randomized truncated eigendecomposition "
+    "will be used.", "r");
+
 PARAM_STRING("sampling", "Sampling scheme to use for the nystroem method: "
     "'kmeans', 'random', 'ordered'", "s", "kmeans");
 
@@ -102,6 +112,7 @@ template<typename KernelType>
 void RunKPCA(arma::mat& dataset,
              const bool centerTransformedData,
              const bool nystroem,
+             const bool randomized,
              const size_t newDim,
              const string& sampling,
              KernelType& kernel)
@@ -134,6 +145,12 @@ void RunKPCA(arma::mat& dataset,
         << "choices are 'kmeans', 'random' and 'ordered'" << endl;
     }
   }
+  else if (randomized)
+  {
+    KernelPCA<KernelType, RandomizedKernelRule<KernelType> > kpca(kernel,
+        centerTransformedData);
+    kpca.Apply(dataset, newDim);
+  }
   else
   {
     KernelPCA<KernelType> kpca(kernel, centerTransformedData);
@@ -170,21 +187,27 @@ int main(int argc, char** argv)
 
   const bool centerTransformedData = CLI::HasParam("center");
   const bool nystroem = CLI::HasParam("nystroem_method");
+  const bool randomized = CLI::HasParam("randomized");
+  if (nystroem && randomized)
+  {
+    Log::Fatal << "Only one of --nystroem_method and --randomized may be "
+        << "specified!" << endl;
+  }
   const string sampling = CLI::GetParam<string>("sampling");
 
   if (kernelType == "linear")
   {
     LinearKernel kernel;
-    RunKPCA<LinearKernel>(dataset, centerTransformedData, nystroem, newDim,
-        sampling, kernel);
+    RunKPCA<LinearKernel>(dataset, centerTransformedData, nystroem, randomized,
+        newDim, sampling, kernel);
   }
   else if (kernelType == "gaussian")
   {
     const double bandwidth = CLI::GetParam<double>("bandwidth");
 
     GaussianKernel kernel(bandwidth);
-    RunKPCA<GaussianKernel>(dataset, centerTransformedData, nystroem, newDim,
-        sampling, kernel);
+    RunKPCA<GaussianKernel>(dataset, centerTransformedData, nystroem,
+        randomized, newDim, sampling, kernel);
   }
   else if (kernelType == "polynomial")
   {
@@ -193,7 +216,7 @@ int main(int argc, char** argv)
 
     PolynomialKernel kernel(degree, offset);
     RunKPCA<PolynomialKernel>(dataset, centerTransformedData, nystroem,
-        newDim, sampling, kernel);
+        randomized, newDim, sampling, kernel);
   }
   else if (kernelType == "hyptan")
   {
@@ -202,15 +225,15 @@ int main(int argc, char** argv)
 
     HyperbolicTangentKernel kernel(scale, offset);
     RunKPCA<HyperbolicTangentKernel>(dataset, centerTransformedData, nystroem,
-        newDim, sampling, kernel);
+        randomized, newDim, sampling, kernel);
   }
   else if (kernelType == "laplacian")
   {
     const double bandwidth = CLI::GetParam<double>("bandwidth");
 
     LaplacianKernel kernel(bandwidth);
-    RunKPCA<LaplacianKernel>(dataset, centerTransformedData, nystroem, newDim,
-        sampling, kernel);
+    RunKPCA<LaplacianKernel>(dataset, centerTransformedData, nystroem,
+        randomized, newDim, sampling, kernel);
   }
   else if (kernelType == "epanechnikov")
   {
@@ -218,13 +241,13 @@ int main(int argc, char** argv)
 
     EpanechnikovKernel kernel(bandwidth);
     RunKPCA<EpanechnikovKernel>(dataset, centerTransformedData, nystroem,
-        newDim, sampling, kernel);
+        randomized, newDim, sampling, kernel);
   }
   else if (kernelType == "cosine")
   {
     CosineDistance kernel;
-    RunKPCA<CosineDistance>(dataset, centerTransformedData, nystroem, newDim,
-        sampling, kernel);
+    RunKPCA<CosineDistance>(dataset, centerTransformedData, nystroem,
+        randomized, newDim, sampling, kernel);
   }
   else
   {
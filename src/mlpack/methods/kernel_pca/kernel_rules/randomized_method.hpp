@@ -0,0 +1,143 @@
+/**
+ * @file randomized_method.hpp
+ *
+ * Use a randomized truncated eigendecomposition of the kernel matrix, which is
+ * never stored in full.
+ */
+#ifndef __MLPACK_METHODS_KERNEL_PCA_RANDOMIZED_METHOD_HPP
+#define __MLPACK_METHODS_KERNEL_PCA_RANDOMIZED_METHOD_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/kernels/kernel_matrix.hpp>
+
+namespace mlpack {
+namespace kpca {
+
+/**
+ * Find the top eigenvectors of the centered kernel matrix with randomized
+ * subspace iteration (see "Finding structure with randomness: Probabilistic
+ * algorithms for constructing approximate matrix decompositions", Halko,
+ * Martinsson and Tropp, 2011).  A random subspace of dimension rank +
+ * Oversampling is multiplied by the centered kernel matrix PowerIterations
+ * times (orthonormalizing in between), and the kernel matrix is then
+ * eigendecomposed on that subspace.
+ *
+ * The only operation done with the kernel matrix is multiplying it by a block
+ * of rank + Oversampling vectors.  This is done a few rows of the kernel
+ * matrix at a time, so the kernel matrix is never stored.  Each of the
+ * PowerIterations + 2 multiplications evaluates the kernel once for each pair
+ * of points and takes O(n^2 * (rank + Oversampling)) time; the memory used is
+ * O(n * (rank + Oversampling)).  NaiveKernelRule, on the other hand, needs
+ * O(n^2) memory and O(n^3) time.
+ *
+ * @tparam KernelType Type of kernel to use.
+ * @tparam PowerIterations Number of extra multiplications by the kernel
+ *     matrix; more iterations give more accurate eigenvectors when the
+ *     eigenvalues decay slowly.
+ * @tparam Oversampling Number of extra dimensions in the random subspace.
+ */
+template<
+  typename KernelType,
+  size_t PowerIterations = 2,
+  size_t Oversampling = 10
+>
+class RandomizedKernelRule
+{
+  public:
+    /**
+     * Find the top eigenvectors of the centered kernel matrix and project the
+     * data onto them.
+     *
+     * @param data Input data points.
+     * @param transformedData Matrix to output results into.
+     * @param eigval KPCA eigenvalues will be written to this vector.
+     * @param eigvec KPCA eigenvectors will be written to this matrix.
+     * @param rank Number of eigenvectors to find (0 for all of them).
+     * @param kernel Kernel to be used for computation.
+     */
+    static void ApplyKernelMatrix(const arma::mat& data,
+                                  arma::mat& transformedData,
+                                  arma::vec& eigval,
+                                  arma::mat& eigvec,
+                                  const size_t rank,
+                                  KernelType kernel = KernelType())
+  {
+    const size_t n = data.n_cols;
+    // A rank of 0 means all the eigenvectors.
+    const size_t k = (rank == 0) ? n : std::min(rank, n);
+    const size_t l = std::min(k + Oversampling, n);
+
+    // Find an orthonormal basis of the range of the centered kernel matrix
+    // applied to a random subspace.
+    arma::mat q, r, y;
+    KernelProduct(data, kernel, arma::randn<arma::mat>(n, l), y);
+    arma::qr_econ(q, r, y);
+    for (size_t i = 0; i < PowerIterations; ++i)
+    {
+      KernelProduct(data, kernel, q, y);
+      arma::qr_econ(q, r, y);
+    }
+
+    // Eigendecompose the kernel matrix restricted to the subspace; since it is
+    // symmetric, the restriction is q^T * K * q.
+    KernelProduct(data, kernel, q, y);
+    arma::mat b = arma::trans(q) * y;
+    b = 0.5 * (b + arma::trans(b));
+
+    arma::vec subspaceEigval;
+    arma::mat subspaceEigvec;
+    arma::eig_sym(subspaceEigval, subspaceEigvec, b);
+
+    // The eigenvalues are ordered smallest to largest; we need the k largest,
+    // from largest to smallest.
+    subspaceEigval = arma::flipud(subspaceEigval.subvec(l - k, l - 1));
+    subspaceEigvec = arma::fliplr(subspaceEigvec.cols(l - k, l - 1));
+
+    eigval = subspaceEigval;
+    eigvec = q * subspaceEigvec;
+
+    // The projection eigvec^T * K can be found from K * q, which we already
+    // have.
+    transformedData = arma::trans(subspaceEigvec) * arma::trans(y);
+    transformedData.each_col() /= arma::sqrt(eigval);
+  }
+
+  private:
+    /**
+     * Compute the product of the centered kernel matrix with x:
+     * H * K * H * x, where H = I - (1 / n) 1 1^T.  The kernel matrix is built
+     * a block of rows at a time.
+     */
+    static void KernelProduct(const arma::mat& data,
+                              KernelType& kernel,
+                              const arma::mat& x,
+                              arma::mat& product)
+    {
+      const size_t n = data.n_cols;
+
+      // Multiplying by H subtracts the mean of each column.
+      arma::mat centeredX = x;
+      centeredX.each_row() -= arma::mean(x, 0);
+
+      // Keep at most 64MB of the kernel matrix at once.
+      const size_t blockSize = std::max((size_t) 1,
+          std::min(n, (size_t) 8388608 / n));
+
+      product.set_size(n, x.n_cols);
+      arma::mat kernelBlock;
+      for (size_t begin = 0; begin < n; begin += blockSize)
+      {
+        const size_t end = std::min(begin + blockSize, n) - 1;
+        kernel::BuildKernelMatrix(data.cols(begin, end), data, kernel,
+            kernelBlock);
+        product.rows(begin, end) = kernelBlock * centeredX;
+      }
+
+      product.each_row() -= arma::mean(product, 0);
+    }
+};
+
+}; // namespace kpca
+}; // namespace mlpack
+
+#endif
@@ -14,6 +14,7 @@
 #include "pelleg_moore_kmeans.hpp"
 #include "dtnn_kmeans.hpp"
 #include "dual_tree_kmeans.hpp"
+#include "mini_batch_kmeans.hpp"
 
 using namespace mlpack;
 using namespace mlpack::kmeans;
@@ -40,7 +41,10 @@ PROGRAM_INFO("K-Means Clustering", "This program performs K-Means clustering "
     " approach can be used ('naive').  Other options include the Pelleg-Moore "
     "tree-based algorithm ('pelleg-moore'), Elkan's triangle-inequality based "
     "algorithm ('elkan'), and Hamerly's modification to Elkan's algorithm "
-    "('hamerly')."
+    "('hamerly').  For very large datasets, mini-batch k-means ('minibatch') "
+    "uses a random sample of points in each iteration instead of the whole "
+    "dataset; the size of the sample is given with the --batch_size (-b) "
+    "option."
     "\n\n"
     "As of October 2014, the --overclustering option has been removed.  If you "
     "want this support back, let us know -- file a bug at "
@@ -77,7 +81,23 @@ PARAM_DOUBLE("percentage", "Percentage of dataset to use for each refined start"
     " sampling (use when --refined_start is specified).", "p", 0.02);
 
 PARAM_STRING("algorithm", "Algorithm to use for the Lloyd iteration ('naive', "
-    "'pelleg-moore', 'elkan', 'hamerly', or 'dtnn').", "a", "naive");
+    "'pelleg-moore', 'elkan', 'hamerly', 'dtnn', or 'minibatch').", "a",
+    "naive");
+PARAM_INT("batch_size", "Number of points sampled in each iteration of "
+    "mini-batch k-means (use when --algorithm minibatch is specified).", "b",
+    1000);
+
+// MiniBatchKMeans, with the batch size given on the command line.  KMeans
+// constructs its Lloyd step with only the dataset and the metric.
+template<typename MetricType, typename MatType>
+class CLIMiniBatchKMeans : public MiniBatchKMeans<MetricType, MatType>
+{
+ public:
+  CLIMiniBatchKMeans(const MatType& dataset, MetricType& metric) :
+      MiniBatchKMeans<MetricType, MatType>(dataset, metric,
+          (size_t) CLI::GetParam<int>("batch_size"))
+  { /* Nothing to do. */ }
+};
 
 // Given the type of initial partition policy, figure out the empty cluster
 // policy and run k-means.
@@ -99,6 +119,11 @@ int main(int argc, char** argv)
 {
   CLI::ParseCommandLine(argc, argv);
 
+  const int batchSize = CLI::GetParam<int>("batch_size");
+  if (batchSize <= 0 && CLI::GetParam<string>("algorithm") == "minibatch")
+    Log::Fatal << "Batch size (--batch_size) must be positive (received "
+        << batchSize << ")." << endl;
+
   // Initialize random seed.
   if (CLI::GetParam<int>("seed") != 0)
     math::RandomSeed((size_t) CLI::GetParam<int>("seed"));
@@ -163,9 +188,13 @@ void FindLloydStepType(const InitialPartitionPolicy& ipp)
         DefaultDualTreeKMeans>(ipp);
   else if (algorithm == "naive")
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, NaiveKMeans>(ipp);
+  else if (algorithm == "minibatch")
+    RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy,
+        CLIMiniBatchKMeans>(ipp);
   else
     Log::Fatal << "Unknown algorithm: '" << algorithm << "'.  Supported options"
-        << " are 'naive', 'pelleg-moore', 'elkan', and 'hamerly'." << endl;
+        << " are 'naive', 'pelleg-moore', 'elkan', 'hamerly', and "
+        << "'minibatch'." << endl;
 }
 
 // Given the template parameters, sanitize/load input and run k-means.
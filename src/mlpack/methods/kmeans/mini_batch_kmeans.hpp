@@ -0,0 +1,114 @@
+/**
+ * @file mini_batch_kmeans.hpp
+ *
+ * An implementation of mini-batch k-means (Sculley, 2010), in which each Lloyd
+ * step uses only a random sample of the dataset.
+ */
+#ifndef __MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_HPP
+#define __MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_HPP
+
+#include "naive_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * This is an implementation of a single step of mini-batch k-means, as
+ * described in the following paper:
+ *
+ * @code
+ * @inproceedings{sculley2010web,
+ *   title={Web-scale k-means clustering},
+ *   author={Sculley, D.},
+ *   booktitle={Proceedings of the 19th International Conference on World Wide
+ *       Web (WWW '10)},
+ *   pages={1177--1178},
+ *   year={2010}
+ * }
+ * @endcode
+ *
+ * Each call to Iterate() samples BatchSize() points from the dataset (with
+ * replacement), assigns them to their closest centroids with NaiveKMeans, and
+ * moves each centroid towards the points assigned to it with a per-centroid
+ * learning rate of 1 / (number of points assigned to it so far).  This is the
+ * same as taking each centroid to be the mean of every point ever assigned to
+ * it, so it can be done one batch at a time instead of one point at a time.
+ *
+ * Because only a sample of the points is used, each step is much cheaper than
+ * a full Lloyd step, but the centroids only converge in expectation; the
+ * residual returned by Iterate() shrinks as the number of points seen grows.
+ * The counts given back are the number of points assigned to each cluster
+ * over all iterations, so a cluster is only treated as empty if no point has
+ * ever been assigned to it.
+ *
+ * @tparam MetricType Type of metric used with this implementation.
+ * @tparam MatType Matrix type (arma::mat or arma::sp_mat).
+ */
+template<typename MetricType, typename MatType>
+class MiniBatchKMeans
+{
+ public:
+  /**
+   * Construct the MiniBatchKMeans object with the given dataset and metric.
+   *
+   * @param dataset Dataset.
+   * @param metric Instantiated metric.
+   * @param batchSize Number of points to sample in each iteration.
+   */
+  MiniBatchKMeans(const MatType& dataset,
+                  MetricType& metric,
+                  const size_t batchSize = 1000);
+
+  /**
+   * Run a single mini-batch step, updating the given centroids into the
+   * newCentroids matrix.
+   *
+   * @param centroids Current cluster centroids.
+   * @param newCentroids New cluster centroids.
+   * @param counts Vector to store the number of points assigned to each
+   *     cluster (over all iterations) in.
+   */
+  double Iterate(const arma::mat& centroids,
+                 arma::mat& newCentroids,
+                 arma::Col<size_t>& counts);
+
+  size_t DistanceCalculations() const { return distanceCalculations; }
+
+  //! Get the number of points sampled in each iteration.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the number of points sampled in each iteration.
+  size_t& BatchSize() { return batchSize; }
+
+ private:
+  //! The dataset.
+  const MatType& dataset;
+  //! The instantiated metric.
+  MetricType& metric;
+
+  //! Number of points sampled in each iteration.
+  size_t batchSize;
+  //! Number of points assigned to each cluster over all iterations.
+  arma::Col<size_t> clusterCounts;
+
+  //! Number of distance calculations.
+  size_t distanceCalculations;
+
+  //! Copy the given points of a dense dataset into the batch.
+  static void Sample(const arma::mat& data,
+                     const arma::Col<size_t>& points,
+                     arma::mat& batch);
+
+  //! Copy the given points of a sparse dataset into the batch, which stays
+  //! sparse.
+  static void Sample(const arma::sp_mat& data,
+                     const arma::Col<size_t>& points,
+                     arma::sp_mat& batch);
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "mini_batch_kmeans_impl.hpp"
+
+#endif
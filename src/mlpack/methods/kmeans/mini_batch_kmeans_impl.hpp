@@ -0,0 +1,120 @@
+/**
+ * @file mini_batch_kmeans_impl.hpp
+ *
+ * Implementation of mini-batch k-means.
+ */
+#ifndef __MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_IMPL_HPP
+#define __MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "mini_batch_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename MatType>
+MiniBatchKMeans<MetricType, MatType>::MiniBatchKMeans(const MatType& dataset,
+                                                      MetricType& metric,
+                                                      const size_t batchSize) :
+    dataset(dataset),
+    metric(metric),
+    batchSize(batchSize),
+    distanceCalculations(0)
+{ /* Nothing to do. */ }
+
+template<typename MetricType, typename MatType>
+double MiniBatchKMeans<MetricType, MatType>::Iterate(
+    const arma::mat& centroids,
+    arma::mat& newCentroids,
+    arma::Col<size_t>& counts)
+{
+  if (clusterCounts.n_elem != centroids.n_cols)
+    clusterCounts.zeros(centroids.n_cols);
+
+  // Sample the batch.  It has the same type as the dataset, so sparse data
+  // stays sparse.
+  const size_t size = std::min(batchSize, (size_t) dataset.n_cols);
+  arma::Col<size_t> points(size);
+  for (size_t i = 0; i < size; ++i)
+    points[i] = math::RandInt(dataset.n_cols);
+
+  MatType batch;
+  Sample(dataset, points, batch);
+
+  // Find the mean of the points in the batch assigned to each centroid.
+  NaiveKMeans<MetricType, MatType> naive(batch, metric);
+  arma::mat batchCentroids;
+  arma::Col<size_t> batchCounts;
+  naive.Iterate(centroids, batchCentroids, batchCounts);
+  distanceCalculations += naive.DistanceCalculations();
+
+  // Each centroid becomes the mean of all the points ever assigned to it.
+  newCentroids = centroids;
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+  {
+    if (batchCounts[i] == 0)
+      continue;
+
+    clusterCounts[i] += batchCounts[i];
+    const double rate = (double) batchCounts[i] / (double) clusterCounts[i];
+    newCentroids.col(i) += rate * (batchCentroids.col(i) - centroids.col(i));
+  }
+
+  counts = clusterCounts;
+
+  // Calculate how much the centroids moved in this iteration.
+  double cNorm = 0.0;
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+  {
+    cNorm += std::pow(metric.Evaluate(centroids.col(i), newCentroids.col(i)),
+        2.0);
+  }
+  distanceCalculations += centroids.n_cols;
+
+  return std::sqrt(cNorm);
+}
+
+template<typename MetricType, typename MatType>
+void MiniBatchKMeans<MetricType, MatType>::Sample(
+    const arma::mat& data,
+    const arma::Col<size_t>& points,
+    arma::mat& batch)
+{
+  batch.set_size(data.n_rows, points.n_elem);
+  for (size_t i = 0; i < points.n_elem; ++i)
+    batch.col(i) = data.col(points[i]);
+}
+
+template<typename MetricType, typename MatType>
+void MiniBatchKMeans<MetricType, MatType>::Sample(
+    const arma::sp_mat& data,
+    const arma::Col<size_t>& points,
+    arma::sp_mat& batch)
+{
+  // Build the batch from its nonzero elements all at once; inserting columns
+  // one at a time would move the elements every time.
+  size_t nonzeros = 0;
+  for (size_t i = 0; i < points.n_elem; ++i)
+    nonzeros += data.col_ptrs[points[i] + 1] - data.col_ptrs[points[i]];
+
+  arma::umat locations(2, nonzeros);
+  arma::vec values(nonzeros);
+  size_t index = 0;
+  for (size_t i = 0; i < points.n_elem; ++i)
+  {
+    for (size_t k = data.col_ptrs[points[i]]; k < data.col_ptrs[points[i] + 1];
+         ++k, ++index)
+    {
+      locations(0, index) = data.row_indices[k];
+      locations(1, index) = i;
+      values[index] = data.values[k];
+    }
+  }
+
+  batch = arma::sp_mat(locations, values, data.n_rows, points.n_elem);
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
@@ -9,6 +9,8 @@
 #ifndef __MLPACK_METHODS_KMEANS_NAIVE_KMEANS_HPP
 #define __MLPACK_METHODS_KMEANS_NAIVE_KMEANS_HPP
 
+#include <mlpack/core/metrics/lmetric.hpp>
+
 namespace mlpack {
 namespace kmeans {
 
@@ -18,6 +20,14 @@ namespace kmeans {
  * looking for the mlpack::kmeans::KMeans class instead of this one.  This class
  * is used by KMeans as the actual implementation of the Lloyd iteration.
  *
+ * The points are processed in blocks, which are split between threads if
+ * OpenMP is available; each thread accumulates its own centroid sums, and these
+ * are added in thread order, so the results do not depend on scheduling.  When
+ * the metric is the Euclidean (or squared Euclidean) distance and the data is
+ * dense, the closest centroids to a block of points are found with one matrix
+ * multiplication, since ||x - c||^2 = ||x||^2 - 2 x^T c + ||c||^2 and the
+ * ||x||^2 term does not change which centroid is closest.
+ *
  * @param MetricType Type of metric used with this implementation.
  * @param MatType Matrix type (arma::mat or arma::sp_mat).
  */
@@ -39,6 +49,7 @@ class NaiveKMeans
    *
    * @param centroids Current cluster centroids.
    * @param newCentroids New cluster centroids.
+   * @param counts Vector to store the number of points in each cluster in.
    */
   double Iterate(const arma::mat& centroids,
                  arma::mat& newCentroids,
@@ -46,7 +57,59 @@ class NaiveKMeans
 
   size_t DistanceCalculations() const { return distanceCalculations; }
 
+  //! The number of points handled at once (and by one thread) in Iterate().
+  static const size_t BlockSize = 1024;
+
  private:
+  /**
+   * Find the closest centroid to each of the points in the given range of
+   * columns of the dataset, by evaluating the metric for every point and
+   * centroid.
+   */
+  template<typename Metric, typename Mat>
+  void AssignPoints(Metric& metric,
+                    const Mat& data,
+                    const size_t begin,
+                    const size_t end,
+                    const arma::mat& centroids,
+                    const arma::rowvec& centroidNorms,
+                    arma::mat& distances,
+                    arma::Col<size_t>& assignments);
+
+  /**
+   * Find the closest centroid to each of the points in the given range of
+   * columns of a dense dataset, for the Euclidean distance, with one matrix
+   * multiplication.
+   */
+  template<bool TakeRoot>
+  void AssignPoints(metric::LMetric<2, TakeRoot>& /* metric */,
+                    const arma::mat& data,
+                    const size_t begin,
+                    const size_t end,
+                    const arma::mat& centroids,
+                    const arma::rowvec& centroidNorms,
+                    arma::mat& distances,
+                    arma::Col<size_t>& assignments);
+
+  //! Add a point of a dense dataset to the sum of the points in a cluster.
+  static void AddPoint(const arma::mat& data,
+                       const size_t point,
+                       arma::mat& sums,
+                       const size_t cluster)
+  { sums.col(cluster) += data.col(point); }
+
+  //! Add a point of a sparse dataset to the sum of the points in a cluster,
+  //! visiting only the nonzero elements of the point.
+  static void AddPoint(const arma::sp_mat& data,
+                       const size_t point,
+                       arma::mat& sums,
+                       const size_t cluster)
+  {
+    for (arma::sp_mat::const_iterator it = data.begin_col(point);
+         it != data.end_col(point); ++it)
+      sums(it.row(), cluster) += (*it);
+  }
+
   //! The dataset.
   const MatType& dataset;
   //! The instantiated metric.
@@ -29,32 +29,80 @@ double NaiveKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
                                                  arma::mat& newCentroids,
                                                  arma::Col<size_t>& counts)
 {
-  newCentroids.zeros(centroids.n_rows, centroids.n_cols);
-  counts.zeros(centroids.n_cols);
+  const size_t numBlocks = (dataset.n_cols + BlockSize - 1) / BlockSize;
 
-  // Find the closest centroid to each point and update the new centroids.
-  for (size_t i = 0; i < dataset.n_cols; i++)
+  // Only the Euclidean distance uses these.
+  const arma::rowvec centroidNorms = arma::sum(arma::square(centroids), 0);
+
+#ifdef _OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+
+  // Each thread accumulates into its own sums and counts; they are added in
+  // thread order at the end, so that the result is deterministic for a given
+  // number of threads.
+  std::vector<arma::mat> threadCentroids(numThreads,
+      arma::zeros<arma::mat>(centroids.n_rows, centroids.n_cols));
+  std::vector<arma::Col<size_t> > threadCounts(numThreads,
+      arma::zeros<arma::Col<size_t> >(centroids.n_cols));
+
+  // A point with no closest centroid (which only happens if its distances are
+  // NaN) can't be reported inside the parallel region, so each thread records
+  // it here.
+  std::vector<char> threadFailed(numThreads, 0);
+
+  #pragma omp parallel num_threads(numThreads)
   {
-    // Find the closest centroid to this point.
-    double minDistance = std::numeric_limits<double>::infinity();
-    size_t closestCluster = centroids.n_cols; // Invalid value.
+#ifdef _OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+    arma::mat& localCentroids = threadCentroids[thread];
+    arma::Col<size_t>& localCounts = threadCounts[thread];
 
-    for (size_t j = 0; j < centroids.n_cols; j++)
+    arma::mat distances;
+    arma::Col<size_t> assignments;
+    #pragma omp for schedule(static)
+    for (size_t b = 0; b < numBlocks; ++b)
     {
-      const double distance = metric.Evaluate(dataset.col(i), centroids.col(j));
+      const size_t begin = b * BlockSize;
+      const size_t end = std::min(begin + BlockSize, (size_t) dataset.n_cols);
 
-      if (distance < minDistance)
+      // Find the closest centroid to each point in the block, and then add
+      // each point to its centroid.
+      AssignPoints(metric, dataset, begin, end, centroids, centroidNorms,
+          distances, assignments);
+
+      for (size_t i = begin; i < end; ++i)
       {
-        minDistance = distance;
-        closestCluster = j;
+        if (assignments[i - begin] == centroids.n_cols)
+        {
+          threadFailed[thread] = 1;
+          continue;
+        }
+
+        AddPoint(dataset, i, localCentroids, assignments[i - begin]);
+        localCounts[assignments[i - begin]]++;
       }
     }
+  }
 
-    Log::Assert(closestCluster != centroids.n_cols);
+  for (size_t t = 0; t < numThreads; ++t)
+  {
+    if (threadFailed[t])
+      Log::Fatal << "NaiveKMeans::Iterate(): some points have no closest "
+          << "centroid; the distances may be NaN." << std::endl;
+  }
 
-    // We now have the minimum distance centroid index.  Update that centroid.
-    newCentroids.col(closestCluster) += arma::vec(dataset.col(i));
-    counts(closestCluster)++;
+  newCentroids = threadCentroids[0];
+  counts = threadCounts[0];
+  for (size_t t = 1; t < numThreads; ++t)
+  {
+    newCentroids += threadCentroids[t];
+    counts += threadCounts[t];
   }
 
   // Now normalize the centroid.
@@ -78,6 +126,80 @@ double NaiveKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   return std::sqrt(cNorm);
 }
 
+template<typename MetricType, typename MatType>
+template<typename Metric, typename Mat>
+void NaiveKMeans<MetricType, MatType>::AssignPoints(
+    Metric& metric,
+    const Mat& data,
+    const size_t begin,
+    const size_t end,
+    const arma::mat& centroids,
+    const arma::rowvec& /* centroidNorms */,
+    arma::mat& /* distances */,
+    arma::Col<size_t>& assignments)
+{
+  assignments.set_size(end - begin);
+  for (size_t i = begin; i < end; ++i)
+  {
+    // Find the closest centroid to this point.
+    double minDistance = std::numeric_limits<double>::infinity();
+    size_t closestCluster = centroids.n_cols; // Invalid value.
+
+    for (size_t j = 0; j < centroids.n_cols; j++)
+    {
+      const double distance = metric.Evaluate(data.col(i), centroids.col(j));
+
+      if (distance < minDistance)
+      {
+        minDistance = distance;
+        closestCluster = j;
+      }
+    }
+
+    // If every distance is NaN, this is left invalid, for Iterate() to catch.
+    assignments[i - begin] = closestCluster;
+  }
+}
+
+template<typename MetricType, typename MatType>
+template<bool TakeRoot>
+void NaiveKMeans<MetricType, MatType>::AssignPoints(
+    metric::LMetric<2, TakeRoot>& /* metric */,
+    const arma::mat& data,
+    const size_t begin,
+    const size_t end,
+    const arma::mat& centroids,
+    const arma::rowvec& centroidNorms,
+    arma::mat& distances,
+    arma::Col<size_t>& assignments)
+{
+  // distances(j, i) is ||c_j||^2 - 2 c_j^T x_i, which is the squared distance
+  // between x_i and c_j, less ||x_i||^2.
+  distances = arma::trans(centroids) * data.cols(begin, end - 1);
+  distances *= -2.0;
+  distances.each_col() += arma::trans(centroidNorms);
+
+  assignments.set_size(end - begin);
+  for (size_t i = 0; i < end - begin; ++i)
+  {
+    double minDistance = std::numeric_limits<double>::infinity();
+    size_t closestCluster = centroids.n_cols; // Invalid value.
+
+    const double* column = distances.colptr(i);
+    for (size_t j = 0; j < centroids.n_cols; ++j)
+    {
+      if (column[j] < minDistance)
+      {
+        minDistance = column[j];
+        closestCluster = j;
+      }
+    }
+
+    // If every distance is NaN, this is left invalid, for Iterate() to catch.
+    assignments[i] = closestCluster;
+  }
+}
+
 } // namespace kmeans
 } // namespace mlpack
 
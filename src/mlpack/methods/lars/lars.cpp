@@ -14,6 +14,7 @@ LARS::LARS(const bool useCholesky,
            const double lambda2,
            const double tolerance) :
     matGram(matGramInternal),
+    cholSize(0),
     useCholesky(useCholesky),
     lasso((lambda1 != 0)),
     lambda1(lambda1),
@@ -28,6 +29,7 @@ LARS::LARS(const bool useCholesky,
            const double lambda2,
            const double tolerance) :
     matGram(gramMatrix),
+    cholSize(0),
     useCholesky(useCholesky),
     lasso((lambda1 != 0)),
     lambda1(lambda1),
@@ -38,10 +40,35 @@ LARS::LARS(const bool useCholesky,
 
 void LARS::Regress(const arma::mat& matX,
                    const arma::vec& y,
+                   const arma::vec& initialBeta,
                    arma::vec& beta,
                    const bool transposeData)
 {
-  Timer::Start("lars_regression");
+  // This matrix may end up holding the transpose -- if necessary.
+  arma::mat dataTrans;
+  // dataRef is row-major.
+  const arma::mat& dataRef = (transposeData ? dataTrans : matX);
+  if (transposeData)
+    dataTrans = trans(matX);
+
+  if (!WarmStart(dataRef, y, initialBeta, beta))
+    Regress(dataRef, y, beta, false);
+}
+
+void LARS::Regress(const arma::mat& matX,
+                   const arma::vec& y,
+                   arma::vec& beta,
+                   const bool transposeData)
+{
+  // The timers are not thread-safe, so when LARS is run in parallel (as in
+  // SparseCoding), it is not timed.
+#ifdef _OPENMP
+  const bool timed = !omp_in_parallel();
+#else
+  const bool timed = true;
+#endif
+  if (timed)
+    Timer::Start("lars_regression");
 
   // This matrix may end up holding the transpose -- if necessary.
   arma::mat dataTrans;
@@ -53,12 +80,20 @@ void LARS::Regress(const arma::mat& matX,
   // Compute X' * y.
   arma::vec vecXTy = trans(dataRef) * y;
 
+  // Clear the results of any previous call; the memory is kept, so that
+  // calling Regress() many times does not reallocate it.
+  betaPath.clear();
+  lambdaPath.clear();
+  activeSet.clear();
+  ignoreSet.clear();
+  cholSize = 0;
+
   // Set up active set variables.  In the beginning, the active set has size 0
   // (all dimensions are inactive).
-  isActive.resize(dataRef.n_cols, false);
+  isActive.assign(dataRef.n_cols, false);
 
   // Set up ignores set variables. Initialized empty.
-  isIgnored.resize(dataRef.n_cols, false);
+  isIgnored.assign(dataRef.n_cols, false);
 
   // Initialize yHat and beta.
   beta = arma::zeros(dataRef.n_cols);
@@ -87,13 +122,15 @@ void LARS::Regress(const arma::mat& matX,
   if (maxCorr < lambda1)
   {
     lambdaPath[0] = lambda1;
-    Timer::Stop("lars_regression");
+    if (timed)
+      Timer::Stop("lars_regression");
     return;
   }
 
   // Compute the Gram matrix.  If this is the elastic net problem, we will add
-  // lambda2 * I_n to the matrix.
-  if (matGram.n_elem == 0)
+  // lambda2 * I_n to the matrix.  If we computed it ourselves in a previous
+  // call, the data may have changed, so it is recomputed.
+  if (matGram.n_elem == 0 || &matGram == &matGramInternal)
   {
     // In this case, matGram should reference matGramInternal.
     matGramInternal = trans(dataRef) * dataRef;
@@ -151,8 +188,8 @@ void LARS::Regress(const arma::mat& matX,
     if (useCholesky)
     {
       // Check for singularity.
-      const double lastUtriElement = matUtriCholFactor(
-          matUtriCholFactor.n_cols - 1, matUtriCholFactor.n_rows - 1);
+      const double lastUtriElement = matUtriCholFactor(cholSize - 1,
+          cholSize - 1);
       if (std::abs(lastUtriElement) > tolerance)
       {
         // Ok, no singularity.
@@ -167,8 +204,9 @@ void LARS::Regress(const arma::mat& matX,
          *    = Solve(R % S, Solve(R^T, s)
          *    = s % Solve(R, Solve(R^T, s))
          */
-        unnormalizedBetaDirection = solve(trimatu(matUtriCholFactor),
-            solve(trimatl(trans(matUtriCholFactor)), s));
+        unnormalizedBetaDirection = s;
+        CholeskySolveTrans(unnormalizedBetaDirection);
+        CholeskySolve(unnormalizedBetaDirection);
 
         normalization = 1.0 / sqrt(dot(s, unnormalizedBetaDirection));
         betaDirection = normalization * unnormalizedBetaDirection;
@@ -177,12 +215,13 @@ void LARS::Regress(const arma::mat& matX,
       {
         // Singularity, so remove variable from active set, add to ignores set,
         // and look for new variable to add.
+        #pragma omp critical
         Log::Warn << "Encountered singularity when adding variable "
             << changeInd << " to active set; permanently removing."
             << std::endl;
         Deactivate(activeSet.size() - 1);
         Ignore(changeInd);
-        CholeskyDelete(matUtriCholFactor.n_rows - 1);
+        CholeskyDelete(cholSize - 1);
         continue;
       }
     }
@@ -210,6 +249,7 @@ void LARS::Regress(const arma::mat& matX,
         // and look for new variable to add.
         Deactivate(activeSet.size() - 1);
         Ignore(changeInd);
+        #pragma omp critical
         Log::Warn << "Encountered singularity when adding variable "
             << changeInd << " to active set; permanently removing."
             << std::endl;
@@ -319,7 +359,8 @@ void LARS::Regress(const arma::mat& matX,
   // Unfortunate copy...
   beta = betaPath.back();
 
-  Timer::Stop("lars_regression");
+  if (timed)
+    Timer::Stop("lars_regression");
 }
 
 // Private functions.
@@ -368,14 +409,9 @@ void LARS::InterpolateBeta()
 
 void LARS::CholeskyInsert(const arma::vec& newX, const arma::mat& X)
 {
-  if (matUtriCholFactor.n_rows == 0)
+  if (cholSize == 0)
   {
-    matUtriCholFactor = arma::mat(1, 1);
-
-    if (elasticNet)
-      matUtriCholFactor(0, 0) = sqrt(dot(newX, newX) + lambda2);
-    else
-      matUtriCholFactor(0, 0) = norm(newX, 2);
+    CholeskyInsert(dot(newX, newX), arma::vec());
   }
   else
   {
@@ -386,96 +422,176 @@ void LARS::CholeskyInsert(const arma::vec& newX, const arma::mat& X)
 
 void LARS::CholeskyInsert(double sqNormNewX, const arma::vec& newGramCol)
 {
-  int n = matUtriCholFactor.n_rows;
+  const size_t n = cholSize;
 
-  if (n == 0)
+  // Grow the buffer if the factor will not fit; its size is doubled so that
+  // this happens rarely.
+  if (matUtriCholFactor.n_rows < n + 1)
   {
-    matUtriCholFactor = arma::mat(1, 1);
+    const size_t newSize = std::max(2 * matUtriCholFactor.n_rows,
+        (arma::uword) 16);
+    arma::mat newBuffer(newSize, newSize);
+    if (n > 0)
+    {
+      newBuffer.submat(0, 0, n - 1, n - 1) =
+          matUtriCholFactor.submat(0, 0, n - 1, n - 1);
+    }
+    matUtriCholFactor = newBuffer;
+  }
 
-    if (elasticNet)
-      matUtriCholFactor(0, 0) = sqrt(sqNormNewX + lambda2);
-    else
-      matUtriCholFactor(0, 0) = sqrt(sqNormNewX);
+  if (elasticNet)
+    sqNormNewX += lambda2;
+
+  if (n == 0)
+  {
+    matUtriCholFactor(0, 0) = sqrt(sqNormNewX);
   }
   else
   {
-    arma::mat matNewR = arma::mat(n + 1, n + 1);
-
-    if (elasticNet)
-      sqNormNewX += lambda2;
-
-    arma::vec matUtriCholFactork = solve(trimatl(trans(matUtriCholFactor)),
-        newGramCol);
+    arma::vec matUtriCholFactork = newGramCol;
+    CholeskySolveTrans(matUtriCholFactork);
 
-    matNewR(arma::span(0, n - 1), arma::span(0, n - 1)) = matUtriCholFactor;
-    matNewR(arma::span(0, n - 1), n) = matUtriCholFactork;
-    matNewR(n, arma::span(0, n - 1)).fill(0.0);
-    matNewR(n, n) = sqrt(sqNormNewX - dot(matUtriCholFactork,
-                                          matUtriCholFactork));
-
-    matUtriCholFactor = matNewR;
+    for (size_t i = 0; i < n; ++i)
+    {
+      matUtriCholFactor(i, n) = matUtriCholFactork[i];
+      matUtriCholFactor(n, i) = 0.0;
+    }
+    matUtriCholFactor(n, n) = sqrt(sqNormNewX - dot(matUtriCholFactork,
+                                                    matUtriCholFactork));
   }
+
+  ++cholSize;
 }
 
-void LARS::GivensRotate(const arma::vec::fixed<2>& x,
-                        arma::vec::fixed<2>& rotatedX,
-                        arma::mat& matG)
+void LARS::CholeskyDelete(const size_t colToKill)
 {
-  if (x(1) == 0)
+  // Remove column colToKill by shifting the columns after it to the left.
+  size_t n = cholSize;
+  for (size_t j = colToKill; j < n - 1; ++j)
+    for (size_t i = 0; i <= j + 1; ++i)
+      matUtriCholFactor(i, j) = matUtriCholFactor(i, j + 1);
+  --n;
+
+  // The factor is now upper Hessenberg from column colToKill on; Givens
+  // rotations of consecutive rows make it upper triangular again, after which
+  // the last row is zero and can be dropped.
+  for (size_t k = colToKill; k < n; ++k)
   {
-    matG = arma::eye(2, 2);
-    rotatedX = x;
+    const double a = matUtriCholFactor(k, k);
+    const double b = matUtriCholFactor(k + 1, k);
+    if (b == 0)
+      continue;
+
+    const double r = sqrt(a * a + b * b);
+    const double c = a / r;
+    const double s = b / r;
+
+    matUtriCholFactor(k, k) = r;
+    matUtriCholFactor(k + 1, k) = 0.0;
+    for (size_t j = k + 1; j < n; ++j)
+    {
+      const double x = matUtriCholFactor(k, j);
+      const double y = matUtriCholFactor(k + 1, j);
+      matUtriCholFactor(k, j) = c * x + s * y;
+      matUtriCholFactor(k + 1, j) = -s * x + c * y;
+    }
   }
-  else
-  {
-    double r = norm(x, 2);
-    matG = arma::mat(2, 2);
-
-    double scaledX1 = x(0) / r;
-    double scaledX2 = x(1) / r;
 
-    matG(0, 0) = scaledX1;
-    matG(1, 0) = -scaledX2;
-    matG(0, 1) = scaledX2;
-    matG(1, 1) = scaledX1;
+  cholSize = n;
+}
 
-    rotatedX = arma::vec(2);
-    rotatedX(0) = r;
-    rotatedX(1) = 0;
+void LARS::CholeskySolveTrans(arma::vec& x) const
+{
+  // Forward substitution with the lower triangular matrix R^T.
+  for (size_t i = 0; i < cholSize; ++i)
+  {
+    double sum = x[i];
+    for (size_t j = 0; j < i; ++j)
+      sum -= matUtriCholFactor(j, i) * x[j];
+    x[i] = sum / matUtriCholFactor(i, i);
   }
 }
 
-void LARS::CholeskyDelete(const size_t colToKill)
+void LARS::CholeskySolve(arma::vec& x) const
 {
-  size_t n = matUtriCholFactor.n_rows;
-
-  if (colToKill == (n - 1))
+  // Back substitution with the upper triangular matrix R.
+  for (size_t i = cholSize; i > 0; --i)
   {
-    matUtriCholFactor = matUtriCholFactor(arma::span(0, n - 2),
-                                          arma::span(0, n - 2));
+    double sum = x[i - 1];
+    for (size_t j = i; j < cholSize; ++j)
+      sum -= matUtriCholFactor(i - 1, j) * x[j];
+    x[i - 1] = sum / matUtriCholFactor(i - 1, i - 1);
   }
-  else
-  {
-    matUtriCholFactor.shed_col(colToKill); // remove column colToKill
-    n--;
+}
 
-    for (size_t k = colToKill; k < n; k++)
+bool LARS::WarmStart(const arma::mat& dataRef,
+                     const arma::vec& y,
+                     const arma::vec& initialBeta,
+                     arma::vec& beta)
+{
+  // The active set of the LASSO can be checked from the optimality conditions;
+  // otherwise, there is nothing to check.
+  if (!lasso || initialBeta.n_elem != dataRef.n_cols)
+    return false;
+
+  const arma::uvec active = arma::find(initialBeta);
+
+  // Solve the problem restricted to the active set, assuming the signs of
+  // initialBeta:
+  //   (X_A^T X_A + lambda2 I) beta_A = X_A^T y - lambda1 sign(beta_A).
+  arma::vec activeBeta;
+  arma::vec residual = y;
+  if (active.n_elem > 0)
+  {
+    arma::mat activeData(dataRef.n_rows, active.n_elem);
+    arma::vec signs(active.n_elem);
+    for (size_t i = 0; i < active.n_elem; ++i)
     {
-      arma::mat matG;
-      arma::vec::fixed<2> rotatedVec;
-      GivensRotate(matUtriCholFactor(arma::span(k, k + 1), k), rotatedVec,
-          matG);
-      matUtriCholFactor(arma::span(k, k + 1), k) = rotatedVec;
-      if (k < n - 1)
-      {
-        matUtriCholFactor(arma::span(k, k + 1), arma::span(k + 1, n - 1)) =
-            matG * matUtriCholFactor(arma::span(k, k + 1),
-            arma::span(k + 1, n - 1));
-      }
+      activeData.col(i) = dataRef.col(active[i]);
+      signs[i] = (initialBeta[active[i]] > 0) ? 1.0 : -1.0;
     }
 
-    matUtriCholFactor.shed_row(n);
+    arma::mat activeGram = trans(activeData) * activeData;
+    if (elasticNet)
+      activeGram.diag() += lambda2;
+
+    if (!arma::solve(activeBeta, activeGram, trans(activeData) * y - lambda1 *
+        signs))
+      return false;
+
+    // The signs must be right...
+    for (size_t i = 0; i < active.n_elem; ++i)
+      if (activeBeta[i] * signs[i] <= 0)
+        return false;
+
+    residual -= activeData * activeBeta;
   }
+
+  // ...and no inactive dimension can be correlated with the residual by more
+  // than lambda1.
+  const arma::vec corr = trans(dataRef) * residual;
+  std::vector<bool> isInitiallyActive(dataRef.n_cols, false);
+  for (size_t i = 0; i < active.n_elem; ++i)
+    isInitiallyActive[active[i]] = true;
+  for (size_t i = 0; i < dataRef.n_cols; ++i)
+    if (!isInitiallyActive[i] && std::abs(corr[i]) > lambda1)
+      return false;
+
+  // This is the solution.
+  beta.zeros(dataRef.n_cols);
+  activeSet.clear();
+  for (size_t i = 0; i < active.n_elem; ++i)
+  {
+    beta[active[i]] = activeBeta[i];
+    activeSet.push_back(active[i]);
+  }
+
+  betaPath.assign(1, beta);
+  lambdaPath.assign(1, lambda1);
+  ignoreSet.clear();
+  cholSize = 0;
+
+  return true;
 }
 
 std::string LARS::ToString() const
@@ -136,6 +136,30 @@ class LARS
                arma::vec& beta,
                const bool transposeData = true);
 
+  /**
+   * Run LARS, warm-started from the given initial solution (for instance, the
+   * solution of a similar problem).  If lambda1 > 0, the problem is first
+   * solved restricted to the nonzero dimensions of initialBeta, with their
+   * signs.  If that solution satisfies the optimality conditions of the whole
+   * problem, it is the solution, and LARS does not need to be run; otherwise,
+   * LARS is run as usual.  In either case the solution is the same as the one
+   * Regress() would find, but when the active set does not change, this is
+   * much faster.
+   *
+   * @param data Column-major input data (or row-major input data if rowMajor =
+   *     true).
+   * @param responses A vector of targets.
+   * @param initialBeta Initial solution, whose nonzero elements are the guess
+   *     of the active set.
+   * @param beta Vector to store the solution (the coefficients) in.
+   * @param rowMajor Set to false if the data is row-major.
+   */
+  void Regress(const arma::mat& data,
+               const arma::vec& responses,
+               const arma::vec& initialBeta,
+               arma::vec& beta,
+               const bool transposeData = true);
+
   //! Access the set of active dimensions.
   const std::vector<size_t>& ActiveSet() const { return activeSet; }
 
@@ -147,8 +171,13 @@ class LARS
   //! the last element.
   const std::vector<double>& LambdaPath() const { return lambdaPath; }
 
-  //! Access the upper triangular cholesky factor
-  const arma::mat& MatUtriCholFactor() const { return matUtriCholFactor; }
+  //! Get the upper triangular cholesky factor.
+  arma::mat MatUtriCholFactor() const
+  {
+    if (cholSize == 0)
+      return arma::mat();
+    return matUtriCholFactor.submat(0, 0, cholSize - 1, cholSize - 1);
+  }
 
   // Returns a string representation of this object.
   std::string ToString() const;
@@ -160,9 +189,14 @@ class LARS
   //! Reference to the Gram matrix we will use.
   const arma::mat& matGram;
 
-  //! Upper triangular cholesky factor; initially 0x0 matrix.
+  //! Buffer holding the upper triangular cholesky factor in its top left
+  //! cholSize x cholSize block.  It only grows, so that when Regress() is
+  //! called many times, it does not need to be reallocated.
   arma::mat matUtriCholFactor;
 
+  //! Size of the cholesky factor.
+  size_t cholSize;
+
   //! Whether or not to use Cholesky decomposition when solving linear system.
   bool useCholesky;
 
@@ -232,11 +266,23 @@ class LARS
 
   void CholeskyInsert(double sqNormNewX, const arma::vec& newGramCol);
 
-  void GivensRotate(const arma::vec::fixed<2>& x,
-                    arma::vec::fixed<2>& rotatedX,
-                    arma::mat& G);
-
   void CholeskyDelete(const size_t colToKill);
+
+  //! Solve R^T x = b in place, where R is the cholesky factor.
+  void CholeskySolveTrans(arma::vec& x) const;
+
+  //! Solve R x = b in place, where R is the cholesky factor.
+  void CholeskySolve(arma::vec& x) const;
+
+  /**
+   * Solve the problem restricted to the nonzero dimensions of initialBeta,
+   * and return true (with the solution in beta) if that solves the whole
+   * problem.
+   */
+  bool WarmStart(const arma::mat& dataRef,
+                 const arma::vec& y,
+                 const arma::vec& initialBeta,
+                 arma::vec& beta);
 };
 
 }; // namespace regression
@@ -99,7 +99,9 @@ class LocalCoordinateCoding
               const double objTolerance = 0.01);
 
   /**
-   * Code each point via distance-weighted LARS.
+   * Code each point via distance-weighted LARS.  The points are coded in
+   * parallel, and if WarmStart() is set, each point's LARS run is warm-started
+   * from its current code.
    */
   void OptimizeCode();
 
@@ -130,6 +132,13 @@ class LocalCoordinateCoding
   //! Modify the codes.
   arma::mat& Codes() { return codes; }
 
+  //! Get whether the coding step is warm-started from the previous codes.
+  bool WarmStart() const { return warmStart; }
+  //! Modify whether the coding step is warm-started from the previous codes.
+  //! The codes found are the same either way, but warm starts are much faster
+  //! when the codes change little between iterations.
+  bool& WarmStart() { return warmStart; }
+
   // Returns a string representation of this object. 
   std::string ToString() const;
 
@@ -148,6 +157,9 @@ class LocalCoordinateCoding
 
   //! l1 regularization term.
   double lambda;
+
+  //! Whether or not to warm-start the coding step.
+  bool warmStart;
 };
 
 }; // namespace lcc
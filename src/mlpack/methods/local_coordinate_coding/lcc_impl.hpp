@@ -20,8 +20,9 @@ LocalCoordinateCoding<DictionaryInitializer>::LocalCoordinateCoding(
     const double lambda) :
     atoms(atoms),
     data(data),
-    codes(atoms, data.n_cols),
-    lambda(lambda)
+    codes(arma::zeros<arma::mat>(atoms, data.n_cols)),
+    lambda(lambda),
+    warmStart(false)
 {
   // Initialize the dictionary.
   DictionaryInitializer::Initialize(data, atoms, dictionary);
@@ -102,29 +103,50 @@ void LocalCoordinateCoding<DictionaryInitializer>::OptimizeCode()
       * data);
 
   arma::mat dictGram = trans(dictionary) * dictionary;
-  arma::mat dictGramTD(dictGram.n_rows, dictGram.n_cols);
 
-  for (size_t i = 0; i < data.n_cols; i++)
+  // Each point is coded independently, so the points are split between
+  // threads.  Each thread keeps its own weighted dictionary and Gram matrix,
+  // which are overwritten for each point, and one LARS object which refers to
+  // that Gram matrix; this way nothing is reallocated for each point.
+  #pragma omp parallel
   {
-    // report progress
-    if ((i % 100) == 0)
-    {
-      Log::Debug << "Optimization at point " << i << "." << std::endl;
-    }
-
-    arma::vec invW = invSqDists.unsafe_col(i);
-    arma::mat dictPrime = dictionary * diagmat(invW);
-
-    arma::mat dictGramTD = diagmat(invW) * dictGram * diagmat(invW);
+    arma::mat dictPrime(dictionary.n_rows, dictionary.n_cols);
+    arma::mat dictGramTD(dictGram.n_rows, dictGram.n_cols);
+    arma::vec initialBeta;
 
     bool useCholesky = false;
     regression::LARS lars(useCholesky, dictGramTD, 0.5 * lambda);
 
-    // Run LARS for this point, by making an alias of the point and passing
-    // that.
-    arma::vec beta = codes.unsafe_col(i);
-    lars.Regress(dictPrime, data.unsafe_col(i), beta, false);
-    beta %= invW; // Remember, beta is an alias of codes.col(i).
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t i = 0; i < data.n_cols; i++)
+    {
+      arma::vec invW = invSqDists.unsafe_col(i);
+
+      // dictPrime = dictionary * diagmat(invW), and
+      // dictGramTD = diagmat(invW) * dictGram * diagmat(invW).
+      for (size_t j = 0; j < dictionary.n_cols; ++j)
+      {
+        dictPrime.col(j) = invW[j] * dictionary.col(j);
+        for (size_t k = 0; k < dictionary.n_cols; ++k)
+          dictGramTD(k, j) = invW[k] * dictGram(k, j) * invW[j];
+      }
+
+      // Run LARS for this point, by making an alias of the point and passing
+      // that.
+      arma::vec beta = codes.unsafe_col(i);
+      if (warmStart)
+      {
+        // The code is beta % invW, so the previous solution of this problem
+        // is the code divided by invW.
+        initialBeta = beta / invW;
+        lars.Regress(dictPrime, data.unsafe_col(i), initialBeta, beta, false);
+      }
+      else
+      {
+        lars.Regress(dictPrime, data.unsafe_col(i), beta, false);
+      }
+      beta %= invW; // Remember, beta is an alias of codes.col(i).
+    }
   }
 }
 
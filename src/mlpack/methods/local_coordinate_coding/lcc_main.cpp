@@ -58,6 +58,10 @@ PARAM_STRING("codes_file", "Filename to save the output codes to.", "c",
 PARAM_FLAG("normalize", "If set, the input data matrix will be normalized "
     "before coding.", "N");
 
+PARAM_FLAG("warm_start", "If set, each coding step is warm-started from the "
+    "codes of the previous iteration; the results are the same, but it is "
+    "faster when the codes change little.", "W");
+
 PARAM_INT("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
 
 PARAM_DOUBLE("objective_tolerance", "Tolerance for objective function.", "o",
@@ -132,6 +136,7 @@ int main(int argc, char* argv[])
     }
 
     // Run LCC.
+    lcc.WarmStart() = CLI::HasParam("warm_start");
     lcc.Encode(maxIterations, objTolerance);
 
     // Save the results.
@@ -146,6 +151,7 @@ int main(int argc, char* argv[])
     LocalCoordinateCoding<> lcc(input, atoms, lambda);
 
     // Run LCC.
+    lcc.WarmStart() = CLI::HasParam("warm_start");
     lcc.Encode(maxIterations, objTolerance);
 
     // Save the results.
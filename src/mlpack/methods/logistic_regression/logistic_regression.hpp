@@ -16,8 +16,18 @@
 namespace mlpack {
 namespace regression {
 
+/**
+ * An implementation of L2-regularized logistic regression.  The model is
+ * trained by optimizing a LogisticRegressionFunction with the given optimizer.
+ * The predictors may be dense or sparse; for sparse data, use arma::sp_mat as
+ * the MatType, and the predictors will never be converted to a dense matrix.
+ *
+ * @tparam OptimizerType Optimizer to use to train the model.
+ * @tparam MatType Type of the predictors matrix (arma::mat or arma::sp_mat).
+ */
 template<
-  template<typename> class OptimizerType = mlpack::optimization::L_BFGS
+  template<typename> class OptimizerType = mlpack::optimization::L_BFGS,
+  typename MatType = arma::mat
 >
 class LogisticRegression
 {
@@ -32,7 +42,7 @@ class LogisticRegression
    * @param responses Outputs resulting from input training variables.
    * @param lambda L2-regularization parameter.
    */
-  LogisticRegression(const arma::mat& predictors,
+  LogisticRegression(const MatType& predictors,
                      const arma::vec& responses,
                      const double lambda = 0);
 
@@ -47,7 +57,7 @@ class LogisticRegression
    * @param initialPoint Initial model to train with.
    * @param lambda L2-regularization parameter.
    */
-  LogisticRegression(const arma::mat& predictors,
+  LogisticRegression(const MatType& predictors,
                      const arma::vec& responses,
                      const arma::mat& initialPoint,
                      const double lambda = 0);
@@ -63,7 +73,8 @@ class LogisticRegression
    *
    * @param optimizer Instantiated optimizer with instantiated error function.
    */
-  LogisticRegression(OptimizerType<LogisticRegressionFunction>& optimizer);
+  LogisticRegression(
+      OptimizerType<LogisticRegressionFunction<MatType> >& optimizer);
 
   /**
    * Construct a logistic regression model from the given parameters, without
@@ -97,7 +108,7 @@ class LogisticRegression
    * @param responses Vector to put output predictions of responses into.
    * @param decisionBoundary Decision boundary (default 0.5).
    */
-  void Predict(const arma::mat& predictors,
+  void Predict(const MatType& predictors,
                arma::vec& responses,
                const double decisionBoundary = 0.5) const;
 
@@ -115,7 +126,7 @@ class LogisticRegression
    * @param decisionBoundary Decision boundary (default 0.5).
    * @return Percentage of responses that are predicted correctly.
    */
-  double ComputeAccuracy(const arma::mat& predictors,
+  double ComputeAccuracy(const MatType& predictors,
                          const arma::vec& responses,
                          const double decisionBoundary = 0.5) const;
 
@@ -127,7 +138,7 @@ class LogisticRegression
    * @param predictors Input predictors.
    * @param responses Vector of responses.
    */
-  double ComputeError(const arma::mat& predictors,
+  double ComputeError(const MatType& predictors,
                       const arma::vec& responses) const;
 
   // Returns a string representation of this object. 
@@ -18,15 +18,23 @@ namespace regression {
  * The log-likelihood function for the logistic regression objective function.
  * This is used by various mlpack optimizers to train a logistic regression
  * model.
+ *
+ * The predictors may be dense (arma::mat) or sparse (arma::sp_mat).  With
+ * sparse predictors, the objective and gradient over many points are computed
+ * with sparse-dense matrix products, and the single-point functions only look
+ * at the nonzero features of the point.
+ *
+ * @tparam MatType Type of the predictors matrix (arma::mat or arma::sp_mat).
  */
+template<typename MatType = arma::mat>
 class LogisticRegressionFunction
 {
  public:
-  LogisticRegressionFunction(const arma::mat& predictors,
+  LogisticRegressionFunction(const MatType& predictors,
                              const arma::vec& responses,
                              const double lambda = 0);
 
-  LogisticRegressionFunction(const arma::mat& predictors,
+  LogisticRegressionFunction(const MatType& predictors,
                              const arma::vec& responses,
                              const arma::mat& initialPoint,
                              const double lambda = 0);
@@ -42,7 +50,7 @@ class LogisticRegressionFunction
   double& Lambda() { return lambda; }
 
   //! Return the matrix of predictors.
-  const arma::mat& Predictors() const { return predictors; }
+  const MatType& Predictors() const { return predictors; }
   //! Return the vector of responses.
   const arma::vec& Responses() const { return responses; }
 
@@ -75,6 +83,21 @@ class LogisticRegressionFunction
    */
   double Evaluate(const arma::mat& parameters, const size_t i) const;
 
+  /**
+   * Evaluate the logistic regression log-likelihood function with the given
+   * parameters, using only the points begin, begin + 1, ..., begin + batchSize
+   * - 1.  This is the sum of Evaluate(parameters, i) over those points, but
+   * the whole batch is handled with one matrix-vector product, so this is
+   * much faster for optimizers such as MiniBatchSGD.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param begin Index of the first point in the batch.
+   * @param batchSize Number of points in the batch.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize) const;
+
   /**
    * Evaluate the gradient of the logistic regression log-likelihood function
    * with the given parameters.
@@ -98,6 +121,50 @@ class LogisticRegressionFunction
                 const size_t i,
                 arma::mat& gradient) const;
 
+  /**
+   * Evaluate the gradient of the logistic regression log-likelihood function
+   * with the given parameters, with respect to only the points begin, begin +
+   * 1, ..., begin + batchSize - 1.  This is the sum of Gradient(parameters, i,
+   * gradient) over those points, computed with matrix-vector products.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param begin Index of the first point in the batch.
+   * @param gradient Vector to output gradient into.
+   * @param batchSize Number of points in the batch.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                arma::mat& gradient,
+                const size_t batchSize) const;
+
+  /**
+   * Evaluate the gradient of the logistic regression log-likelihood function
+   * with respect to only one point, as a sparse vector.  The intercept and the
+   * elements for the nonzero features of the point are stored; if lambda is
+   * not 0, the regularization term makes every element nonzero.  This is
+   * useful for optimizers such as ParallelSGD.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param i Index of point to use for objective function gradient evaluation.
+   * @param gradient Sparse vector to output gradient into.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t i,
+                arma::sp_mat& gradient) const;
+
+  /**
+   * Evaluate the logistic regression log-likelihood function and its gradient
+   * with the given parameters.  This gives the same results as Evaluate() and
+   * Gradient(), but the sigmoids are only computed once, in memory which is
+   * kept between calls.  L-BFGS uses this when it is available.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param gradient Vector to output gradient into.
+   * @return The objective function at the given parameters.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              arma::mat& gradient);
+
   //! Return the initial point for the optimization.
   const arma::mat& GetInitialPoint() const { return initialPoint; }
 
@@ -108,14 +175,59 @@ class LogisticRegressionFunction
   //! The initial point, from which to start the optimization.
   arma::mat initialPoint;
   //! The matrix of data points (predictors).
-  const arma::mat& predictors;
+  const MatType& predictors;
   //! The vector of responses to the input data points.
   const arma::vec& responses;
   //! The regularization parameter for L2-regularization.
   double lambda;
+
+  //! The sigmoids (then the errors) for each point; used by
+  //! EvaluateWithGradient() to avoid reallocations.
+  arma::vec sigmoids;
+
+  //! Compute the dot product of point i of the predictors with the
+  //! non-intercept parameters.
+  static double PointDot(const arma::mat& predictors,
+                         const size_t i,
+                         const arma::mat& parameters);
+  //! Compute the dot product of point i of the predictors with the
+  //! non-intercept parameters, looking only at the nonzero features.
+  static double PointDot(const arma::sp_mat& predictors,
+                         const size_t i,
+                         const arma::mat& parameters);
+
+  //! Add scale times point i of the predictors to the non-intercept part of
+  //! the gradient.
+  static void AddPoint(const arma::mat& predictors,
+                       const size_t i,
+                       const double scale,
+                       arma::mat& gradient);
+  //! Add scale times point i of the predictors to the non-intercept part of
+  //! the gradient, looking only at the nonzero features.
+  static void AddPoint(const arma::sp_mat& predictors,
+                       const size_t i,
+                       const double scale,
+                       arma::mat& gradient);
+
+  //! Store scale times point i of the predictors, plus an intercept element
+  //! of 'scale', in the sparse gradient.  Every feature is scanned.
+  static void PointGradient(const arma::mat& predictors,
+                            const size_t i,
+                            const double scale,
+                            arma::sp_mat& gradient);
+  //! Store scale times point i of the predictors, plus an intercept element
+  //! of 'scale', in the sparse gradient.  Only the nonzero features are
+  //! visited.
+  static void PointGradient(const arma::sp_mat& predictors,
+                            const size_t i,
+                            const double scale,
+                            arma::sp_mat& gradient);
 };
 
 }; // namespace regression
 }; // namespace mlpack
 
+// Include implementation.
+#include "logistic_regression_function_impl.hpp"
+
 #endif // __MLPACK_METHODS_LOGISTIC_REGRESSION_LOGISTIC_REGRESSION_FUNCTION_HPP
@@ -0,0 +1,412 @@
+/**
+ * @file logistic_regression_function_impl.hpp
+ * @author Sumedh Ghaisas
+ *
+ * Implementation of the LogisticRegressionFunction class.
+ */
+#ifndef __MLPACK_METHODS_LOGISTIC_REGRESSION_LOGISTIC_REGRESSION_FUNCTION_IMPL_HPP
+#define __MLPACK_METHODS_LOGISTIC_REGRESSION_LOGISTIC_REGRESSION_FUNCTION_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "logistic_regression_function.hpp"
+
+namespace mlpack {
+namespace regression {
+
+template<typename MatType>
+LogisticRegressionFunction<MatType>::LogisticRegressionFunction(
+    const MatType& predictors,
+    const arma::vec& responses,
+    const double lambda) :
+    predictors(predictors),
+    responses(responses),
+    lambda(lambda)
+{
+  initialPoint = arma::zeros<arma::mat>(predictors.n_rows + 1, 1);
+}
+
+template<typename MatType>
+LogisticRegressionFunction<MatType>::LogisticRegressionFunction(
+    const MatType& predictors,
+    const arma::vec& responses,
+    const arma::mat& initialPoint,
+    const double lambda) :
+    initialPoint(initialPoint),
+    predictors(predictors),
+    responses(responses),
+    lambda(lambda)
+{
+  //to check if initialPoint is compatible with predictors
+  if (initialPoint.n_rows != (predictors.n_rows + 1) ||
+      initialPoint.n_cols != 1)
+    this->initialPoint = arma::zeros<arma::mat>(predictors.n_rows + 1, 1);
+}
+
+/**
+ * Evaluate the logistic regression objective function given the estimated
+ * parameters.
+ */
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::Evaluate(
+    const arma::mat& parameters) const
+{
+  // The objective function is the log-likelihood function (w is the parameters
+  // vector for the model; y is the responses; x is the predictors; sig() is the
+  // sigmoid function):
+  //   f(w) = sum(y log(sig(w'x)) + (1 - y) log(sig(1 - w'x))).
+  // We want to minimize this function.  L2-regularization is just lambda
+  // multiplied by the squared l2-norm of the parameters then divided by two.
+
+  // For the regularization, we ignore the first term, which is the intercept
+  // term.
+  const double regularization = 0.5 * lambda *
+      arma::dot(parameters.col(0).subvec(1, parameters.n_elem - 1),
+                parameters.col(0).subvec(1, parameters.n_elem - 1));
+
+  // Calculate vectors of sigmoids.  The intercept term is parameters(0, 0) and
+  // does not need to be multiplied by any of the predictors.
+  arma::vec exponents = predictors.t() *
+      parameters.col(0).subvec(1, parameters.n_elem - 1);
+  exponents += parameters(0, 0);
+  const arma::vec sigmoid = 1.0 / (1.0 + arma::exp(-exponents));
+
+  // Assemble full objective function.  Often the objective function and the
+  // regularization as given are divided by the number of features, but this
+  // doesn't actually affect the optimization result, so we'll just ignore those
+  // terms for computational efficiency.
+  double result = 0.0;
+  for (size_t i = 0; i < responses.n_elem; ++i)
+  {
+    if (responses[i] == 1)
+      result += log(sigmoid[i]);
+    else
+      result += log(1.0 - sigmoid[i]);
+  }
+
+  // Invert the result, because it's a minimization.
+  return -result + regularization;
+}
+
+/**
+ * Evaluate the logistic regression objective function, but with only one point.
+ * This is useful for optimizers that use a separable objective function, such
+ * as SGD.
+ */
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::Evaluate(
+    const arma::mat& parameters,
+    const size_t i) const
+{
+  // Calculate the regularization term.  We must divide by the number of points,
+  // so that sum(Evaluate(parameters, [1:points])) == Evaluate(parameters).
+  const double regularization = lambda * (1.0 / (2.0 * predictors.n_cols)) *
+      arma::dot(parameters.col(0).subvec(1, parameters.n_elem - 1),
+                parameters.col(0).subvec(1, parameters.n_elem - 1));
+
+  // Calculate sigmoid.
+  const double exponent = parameters(0, 0) +
+      PointDot(predictors, i, parameters);
+  const double sigmoid = 1.0 / (1.0 + std::exp(-exponent));
+
+  if (responses[i] == 1)
+    return -log(sigmoid) + regularization;
+  else
+    return -log(1.0 - sigmoid) + regularization;
+}
+
+/**
+ * Evaluate the logistic regression objective function on a batch of points.
+ * This is useful for optimizers that use mini-batches, such as MiniBatchSGD.
+ */
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::Evaluate(
+    const arma::mat& parameters,
+    const size_t begin,
+    const size_t batchSize) const
+{
+  const size_t end = begin + batchSize - 1;
+
+  // Each point gets its share of the regularization term, as in the
+  // single-point Evaluate().
+  const double regularization = lambda *
+      (batchSize / (2.0 * predictors.n_cols)) *
+      arma::dot(parameters.col(0).subvec(1, parameters.n_elem - 1),
+                parameters.col(0).subvec(1, parameters.n_elem - 1));
+
+  // Calculate the sigmoids of the whole batch at once.
+  arma::vec exponents = arma::trans(predictors.cols(begin, end)) *
+      parameters.col(0).subvec(1, parameters.n_elem - 1);
+  exponents += parameters(0, 0);
+  const arma::vec sigmoid = 1.0 / (1.0 + arma::exp(-exponents));
+
+  double result = 0.0;
+  for (size_t i = 0; i < batchSize; ++i)
+  {
+    if (responses[begin + i] == 1)
+      result += log(sigmoid[i]);
+    else
+      result += log(1.0 - sigmoid[i]);
+  }
+
+  // Invert the result, because it's a minimization.
+  return -result + regularization;
+}
+
+//! Evaluate the gradient of the logistic regression objective function.
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::Gradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
+{
+  arma::vec exponents = predictors.t() *
+      parameters.col(0).subvec(1, parameters.n_elem - 1);
+  exponents += parameters(0, 0);
+  const arma::vec errors = responses - 1.0 / (1.0 + arma::exp(-exponents));
+
+  gradient.set_size(parameters.n_elem, 1);
+  gradient[0] = -arma::accu(errors);
+  gradient.col(0).subvec(1, parameters.n_elem - 1) = lambda *
+      parameters.col(0).subvec(1, parameters.n_elem - 1);
+  gradient.col(0).subvec(1, parameters.n_elem - 1) -= predictors * errors;
+}
+
+/**
+ * Evaluate the logistic regression objective function and its gradient at once.
+ * The sigmoids are shared between the two, so this is about half the work of
+ * calling Evaluate() and Gradient().
+ */
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::EvaluateWithGradient(
+    const arma::mat& parameters,
+    arma::mat& gradient)
+{
+  // Calculate the sigmoids into the workspace.  This only allocates memory the
+  // first time, or if the number of points changes.
+  sigmoids = predictors.t() * parameters.col(0).subvec(1,
+      parameters.n_elem - 1);
+  for (size_t i = 0; i < sigmoids.n_elem; ++i)
+    sigmoids[i] = 1.0 / (1.0 + std::exp(-parameters(0, 0) - sigmoids[i]));
+
+  // Sum the log-likelihood, and turn the sigmoids into the errors for the
+  // gradient.
+  double result = 0.0;
+  for (size_t i = 0; i < responses.n_elem; ++i)
+  {
+    if (responses[i] == 1)
+      result += log(sigmoids[i]);
+    else
+      result += log(1.0 - sigmoids[i]);
+
+    sigmoids[i] = responses[i] - sigmoids[i];
+  }
+
+  gradient.set_size(parameters.n_elem, 1);
+  gradient[0] = -arma::accu(sigmoids);
+  gradient.col(0).subvec(1, parameters.n_elem - 1) = lambda *
+      parameters.col(0).subvec(1, parameters.n_elem - 1);
+  gradient.col(0).subvec(1, parameters.n_elem - 1) -= predictors * sigmoids;
+
+  // Invert the result, because it's a minimization.  For the regularization, we
+  // ignore the first term, which is the intercept term.
+  return -result + 0.5 * lambda *
+      arma::dot(parameters.col(0).subvec(1, parameters.n_elem - 1),
+                parameters.col(0).subvec(1, parameters.n_elem - 1));
+}
+
+/**
+ * Evaluate the individual gradients of the logistic regression objective
+ * function with respect to individual points.  This is useful for optimizers
+ * that use a separable objective function, such as SGD.
+ */
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::Gradient(
+    const arma::mat& parameters,
+    const size_t i,
+    arma::mat& gradient) const
+{
+  const double sigmoid = 1.0 / (1.0 + std::exp(-parameters(0, 0)
+      - PointDot(predictors, i, parameters)));
+  const double error = responses[i] - sigmoid;
+
+  // Start with the regularization term, then add the contribution of the point.
+  gradient.set_size(parameters.n_elem, 1);
+  gradient[0] = -error;
+  gradient.col(0).subvec(1, parameters.n_elem - 1) = lambda *
+      parameters.col(0).subvec(1, parameters.n_elem - 1) / predictors.n_cols;
+  AddPoint(predictors, i, -error, gradient);
+}
+
+/**
+ * Evaluate the gradient of the logistic regression objective function with
+ * respect to a batch of points.  This is useful for optimizers that use
+ * mini-batches, such as MiniBatchSGD.
+ */
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::Gradient(
+    const arma::mat& parameters,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize) const
+{
+  const size_t end = begin + batchSize - 1;
+
+  arma::vec exponents = arma::trans(predictors.cols(begin, end)) *
+      parameters.col(0).subvec(1, parameters.n_elem - 1);
+  exponents += parameters(0, 0);
+  const arma::vec errors = responses.subvec(begin, end) -
+      1.0 / (1.0 + arma::exp(-exponents));
+
+  // Each point gets its share of the regularization term.
+  gradient.set_size(parameters.n_elem, 1);
+  gradient[0] = -arma::accu(errors);
+  gradient.col(0).subvec(1, parameters.n_elem - 1) = lambda *
+      (double(batchSize) / predictors.n_cols) *
+      parameters.col(0).subvec(1, parameters.n_elem - 1);
+  gradient.col(0).subvec(1, parameters.n_elem - 1) -=
+      predictors.cols(begin, end) * errors;
+}
+
+/**
+ * Evaluate the gradient of the logistic regression objective function with
+ * respect to one point, storing only its nonzero elements.  This is useful for
+ * optimizers that apply sparse updates, such as ParallelSGD.
+ */
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::Gradient(
+    const arma::mat& parameters,
+    const size_t i,
+    arma::sp_mat& gradient) const
+{
+  if (lambda != 0.0)
+  {
+    // The regularization term makes every element nonzero, so there is nothing
+    // to gain from building the sparse gradient directly.
+    arma::mat denseGradient;
+    Gradient(parameters, i, denseGradient);
+    gradient = arma::sp_mat(denseGradient);
+    return;
+  }
+
+  const double sigmoid = 1.0 / (1.0 + std::exp(-parameters(0, 0)
+      - PointDot(predictors, i, parameters)));
+
+  PointGradient(predictors, i, -(responses[i] - sigmoid), gradient);
+}
+
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::PointDot(
+    const arma::mat& predictors,
+    const size_t i,
+    const arma::mat& parameters)
+{
+  return arma::dot(predictors.unsafe_col(i),
+      parameters.col(0).subvec(1, parameters.n_elem - 1));
+}
+
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::PointDot(
+    const arma::sp_mat& predictors,
+    const size_t i,
+    const arma::mat& parameters)
+{
+  // The intercept is parameters[0], so feature d has parameter d + 1.
+  double result = 0.0;
+  for (arma::sp_mat::const_iterator it = predictors.begin_col(i);
+       it != predictors.end_col(i); ++it)
+    result += (*it) * parameters[it.row() + 1];
+
+  return result;
+}
+
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::AddPoint(
+    const arma::mat& predictors,
+    const size_t i,
+    const double scale,
+    arma::mat& gradient)
+{
+  gradient.col(0).subvec(1, gradient.n_elem - 1) += scale *
+      predictors.unsafe_col(i);
+}
+
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::AddPoint(
+    const arma::sp_mat& predictors,
+    const size_t i,
+    const double scale,
+    arma::mat& gradient)
+{
+  for (arma::sp_mat::const_iterator it = predictors.begin_col(i);
+       it != predictors.end_col(i); ++it)
+    gradient[it.row() + 1] += scale * (*it);
+}
+
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::PointGradient(
+    const arma::mat& predictors,
+    const size_t i,
+    const double scale,
+    arma::sp_mat& gradient)
+{
+  // Find which elements are nonzero: the intercept, and the features which
+  // are nonzero for this point.
+  size_t nonzeros = 1;
+  for (size_t d = 0; d < predictors.n_rows; ++d)
+    if (predictors(d, i) != 0.0)
+      ++nonzeros;
+
+  arma::umat locations(2, nonzeros);
+  arma::vec values(nonzeros);
+  locations.row(1).zeros();
+  locations(0, 0) = 0;
+  values[0] = scale;
+
+  size_t index = 1;
+  for (size_t d = 0; d < predictors.n_rows; ++d)
+  {
+    if (predictors(d, i) != 0.0)
+    {
+      locations(0, index) = d + 1;
+      values[index] = scale * predictors(d, i);
+      ++index;
+    }
+  }
+
+  gradient = arma::sp_mat(locations, values, predictors.n_rows + 1, 1);
+}
+
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::PointGradient(
+    const arma::sp_mat& predictors,
+    const size_t i,
+    const double scale,
+    arma::sp_mat& gradient)
+{
+  size_t nonzeros = 1;
+  for (arma::sp_mat::const_iterator it = predictors.begin_col(i);
+       it != predictors.end_col(i); ++it)
+    ++nonzeros;
+
+  arma::umat locations(2, nonzeros);
+  arma::vec values(nonzeros);
+  locations.row(1).zeros();
+  locations(0, 0) = 0;
+  values[0] = scale;
+
+  // The iterator visits the nonzero features in order, so the locations are
+  // already sorted.
+  size_t index = 1;
+  for (arma::sp_mat::const_iterator it = predictors.begin_col(i);
+       it != predictors.end_col(i); ++it, ++index)
+  {
+    locations(0, index) = it.row() + 1;
+    values[index] = scale * (*it);
+  }
+
+  gradient = arma::sp_mat(locations, values, predictors.n_rows + 1, 1);
+}
+
+}; // namespace regression
+}; // namespace mlpack
+
+#endif // __MLPACK_METHODS_LOGISTIC_REGRESSION_LOGISTIC_REGRESSION_FUNCTION_IMPL_HPP
@@ -8,6 +8,7 @@
 #include "logistic_regression.hpp"
 
 #include <mlpack/core/optimizers/sgd/sgd.hpp>
+#include <mlpack/core/optimizers/minibatch_sgd/minibatch_sgd.hpp>
 
 using namespace std;
 using namespace mlpack;
@@ -31,12 +32,15 @@ PROGRAM_INFO("L2-regularized Logistic Regression and Prediction",
     "specified when the --model_file parameter is given with --input_file or "
     "--input_responses.  The tolerance of the optimizer can be set with "
     "--tolerance; the maximum number of iterations of the optimizer can be set "
-    "with --max_iterations; and the type of the optimizer (SGD / L-BFGS) can be"
-    " set with " "the --optimizer option.  Both the SGD and L-BFGS optimizers "
+    "with --max_iterations; and the type of the optimizer (SGD / mini-batch SGD"
+    " / L-BFGS) can be set with the --optimizer option.  All of the optimizers "
     "have more options, but the C++ interface must be used for those.  For the "
-    "SGD optimizer, the --step_size parameter controls the step size taken at "
-    "each iteration by the optimizer.  If the objective function for your data "
-    "is oscillating between Inf and 0, the step size is probably too large.\n"
+    "SGD and mini-batch SGD optimizers, the --step_size parameter controls the "
+    "step size taken at each iteration by the optimizer.  If the objective "
+    "function for your data is oscillating between Inf and 0, the step size is "
+    "probably too large.  The mini-batch SGD optimizer handles --batch_size "
+    "points at each iteration, which is usually much faster than SGD on large "
+    "datasets.\n"
     "\n"
     "This implementation of logistic regression supports L2-regularization, "
     "which can help the parameter vector b from overfitting.  This parameter "
@@ -73,12 +77,14 @@ PARAM_DOUBLE("decision_boundary", "Decision boundary for prediction; if the "
     "taken to be 0; otherwise, the class is 1.", "d", 0.5);
 
 PARAM_DOUBLE("lambda", "L2-regularization parameter for training.", "l", 0.0);
-PARAM_STRING("optimizer", "Optimizer to use for training ('lbfgs' or 'sgd').",
-    "O", "lbfgs");
+PARAM_STRING("optimizer", "Optimizer to use for training ('lbfgs', 'sgd', or "
+    "'minibatch-sgd').", "O", "lbfgs");
 PARAM_DOUBLE("tolerance", "Convergence tolerance for optimizer.", "T", 1e-10);
 PARAM_INT("max_iterations", "Maximum iterations for optimizer (0 indicates no "
     "limit).", "M", 0);
-PARAM_DOUBLE("step_size", "Step size for SGD optimizer.", "s", 0.01);
+PARAM_DOUBLE("step_size", "Step size for SGD and mini-batch SGD optimizers.",
+    "s", 0.01);
+PARAM_INT("batch_size", "Batch size for mini-batch SGD optimizer.", "b", 1000);
 
 int main(int argc, char** argv)
 {
@@ -98,6 +104,7 @@ int main(int argc, char** argv)
   const size_t maxIterations = (size_t) CLI::GetParam<int>("max_iterations");
   const double decisionBoundary = CLI::GetParam<double>("decision_boundary");
   const double stepSize = CLI::GetParam<double>("step_size");
+  const int batchSize = CLI::GetParam<int>("batch_size");
 
   // One of inputFile and modelFile must be specified.
   if (inputFile.empty() && modelFile.empty())
@@ -121,9 +128,11 @@ int main(int argc, char** argv)
     Log::Fatal << "Tolerance must be positive (received " << tolerance << ")."
         << endl;
 
-  // Optimizer has to be L-BFGS or SGD.
-  if (optimizerType != "lbfgs" && optimizerType != "sgd")
-    Log::Fatal << "--optimizer must be 'lbfgs' or 'sgd'." << endl;
+  // Optimizer has to be L-BFGS, SGD, or mini-batch SGD.
+  if (optimizerType != "lbfgs" && optimizerType != "sgd" &&
+      optimizerType != "minibatch-sgd")
+    Log::Fatal << "--optimizer must be 'lbfgs', 'sgd', or 'minibatch-sgd'."
+        << endl;
 
   // Lambda must be positive.
   if (lambda < 0.0)
@@ -135,10 +144,15 @@ int main(int argc, char** argv)
     Log::Fatal << "Decision boundary (--decision_boundary) must be between 0.0 "
         << "and 1.0 (received " << decisionBoundary << ")." << endl;
 
-  if ((stepSize < 0.0) && (optimizerType == "sgd"))
+  if ((stepSize < 0.0) &&
+      (optimizerType == "sgd" || optimizerType == "minibatch-sgd"))
     Log::Fatal << "Step size (--step_size) must be positive (received "
         << stepSize << ")." << endl;
 
+  if ((batchSize <= 0) && (optimizerType == "minibatch-sgd"))
+    Log::Fatal << "Batch size (--batch_size) must be positive (received "
+        << batchSize << ")." << endl;
+
   // These are the matrices we might use.
   arma::mat regressors;
   arma::mat responses;
@@ -188,7 +202,7 @@ int main(int argc, char** argv)
   {
     // We need to train the model.  Prepare the optimizers.
     arma::vec responsesVec = responses.unsafe_col(0);
-    LogisticRegressionFunction lrf(regressors, responsesVec, lambda);
+    LogisticRegressionFunction<> lrf(regressors, responsesVec, lambda);
     // Set the initial point, if necessary.
     if (!model.empty())
     {
@@ -199,7 +213,7 @@ int main(int argc, char** argv)
 
     if (optimizerType == "lbfgs")
     {
-      L_BFGS<LogisticRegressionFunction> lbfgsOpt(lrf);
+      L_BFGS<LogisticRegressionFunction<> > lbfgsOpt(lrf);
       lbfgsOpt.MaxIterations() = maxIterations;
       lbfgsOpt.MinGradientNorm() = tolerance;
       Log::Info << "Training model with L-BFGS optimizer." << endl;
@@ -211,7 +225,7 @@ int main(int argc, char** argv)
     }
     else if (optimizerType == "sgd")
     {
-      SGD<LogisticRegressionFunction> sgdOpt(lrf);
+      SGD<LogisticRegressionFunction<> > sgdOpt(lrf);
       sgdOpt.MaxIterations() = maxIterations;
       sgdOpt.Tolerance() = tolerance;
       sgdOpt.StepSize() = stepSize;
@@ -222,6 +236,21 @@ int main(int argc, char** argv)
       // Extract the newly trained model.
       model = lr.Parameters();
     }
+    else if (optimizerType == "minibatch-sgd")
+    {
+      MiniBatchSGD<LogisticRegressionFunction<> > mbsgdOpt(lrf);
+      mbsgdOpt.BatchSize() = (size_t) batchSize;
+      mbsgdOpt.MaxIterations() = maxIterations;
+      mbsgdOpt.Tolerance() = tolerance;
+      mbsgdOpt.StepSize() = stepSize;
+      Log::Info << "Training model with mini-batch SGD optimizer (batch size "
+          << batchSize << ")." << endl;
+
+      // This will train the model.
+      LogisticRegression<MiniBatchSGD> lr(mbsgdOpt);
+      // Extract the newly trained model.
+      model = lr.Parameters();
+    }
   }
 
   if (!testSet.empty())
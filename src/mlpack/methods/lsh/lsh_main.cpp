@@ -64,6 +64,8 @@ PARAM_INT("second_hash_size", "The size of the second level hash table.", "M",
 PARAM_INT("bucket_size", "The size of a bucket in the second level hash.", "B",
     500);
 PARAM_INT("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
+PARAM_INT("threads", "Number of threads to use for search (only effective if "
+    "mlpack was compiled with OpenMP).", "t", 1);
 
 int main(int argc, char *argv[])
 {
@@ -105,6 +107,14 @@ int main(int argc, char *argv[])
   const size_t numTables = CLI::GetParam<int>("tables");
   const double hashWidth = CLI::GetParam<double>("hash_width");
 
+  // Sanity check on the number of threads.
+  if (CLI::GetParam<int>("threads") < 1)
+  {
+    Log::Fatal << "Invalid number of threads: " << CLI::GetParam<int>("threads")
+        << ".  Must be greater than 0." << endl;
+  }
+  const size_t threads = (size_t) CLI::GetParam<int>("threads");
+
   arma::Mat<size_t> neighbors;
   arma::mat distances;
 
@@ -137,6 +147,8 @@ int main(int argc, char *argv[])
 
   Timer::Stop("hash_building");
 
+  allkann->NumThreads() = threads;
+
   Log::Info << "Computing " << k << " distance approximate nearest neighbors "
       << endl;
   allkann->Search(k, neighbors, distances);
@@ -106,6 +106,10 @@ class LSHSearch
    * the number of points in the query dataset and k is the number of neighbors
    * being searched for.
    *
+   * The query points are hashed in blocks of BlockSize points, with one
+   * matrix multiplication per table for each block, and the blocks are split
+   * between NumThreads() threads.
+   *
    * @param k Number of neighbors to search for.
    * @param resultingNeighbors Matrix storing lists of neighbors for each query
    *     point.
@@ -126,6 +130,18 @@ class LSHSearch
   // Returns a string representation of this object. 
   std::string ToString() const;
 
+  //! Get the number of threads used for search.
+  size_t NumThreads() const { return numThreads; }
+  /**
+   * Modify the number of threads used for search.  This only has an effect if
+   * mlpack was compiled with OpenMP.  The results do not depend on the number
+   * of threads.
+   */
+  size_t& NumThreads() { return numThreads; }
+
+  //! The number of query points hashed at once (and by one thread) in Search().
+  static const size_t BlockSize = 1024;
+
  private:
   /**
    * This function builds a hash table with two levels of hashing as presented
@@ -143,19 +159,44 @@ class LSHSearch
   void BuildHash();
 
   /**
-   * This function takes a query and hashes it into each of the hash tables to
-   * get keys for the query and then the key is hashed to a bucket of the second
-   * hash table and all the points (if any) in those buckets are collected as
-   * the potential neighbor candidates.
+   * Hash the points with indices in [begin, end) into each of the first
+   * 'numTablesToSearch' hash tables, and then hash each of the keys into a
+   * bucket of the second hash table.  This takes one matrix multiplication for
+   * each table.
+   *
+   * @param points Set of points to hash.
+   * @param begin Index of the first point to hash.
+   * @param end One past the index of the last point to hash.
+   * @param numTablesToSearch Number of tables to hash the points into.
+   * @param buckets Matrix to store the buckets in; bucket (i, j) is the bucket
+   *    of point (begin + j) for table i.
+   */
+  void HashPoints(const arma::mat& points,
+                  const size_t begin,
+                  const size_t end,
+                  const size_t numTablesToSearch,
+                  arma::Mat<size_t>& buckets) const;
+
+  /**
+   * This function takes the buckets of a query in the second hash table (one
+   * for each table searched) and collects all the points in those buckets as
+   * the potential neighbor candidates.  Each candidate is only returned once;
+   * pointSeen is used to mark the candidates that have been found, and it is
+   * cleared again before returning, so the work done is proportional to the
+   * number of candidates and not to the size of the reference set.
    *
-   * @param queryIndex The index of the query currently being processed.
+   * @param queryBuckets The bucket of the query for each table searched.
+   * @param numTablesToSearch The number of tables to search.
+   * @param pointSeen Marks for each reference point; these must all be zero,
+   *    and will still be zero on return.
    * @param referenceIndices The list of neighbor candidates obtained from
    *    hashing the query into all the hash tables and eventually into
-   *    multiple buckets of the second hash table.
+   *    multiple buckets of the second hash table, in ascending order.
    */
-  void ReturnIndicesFromTable(const size_t queryIndex,
-                              arma::uvec& referenceIndices,
-                              size_t numTablesToSearch);
+  void ReturnIndicesFromTable(const size_t* queryBuckets,
+                              const size_t numTablesToSearch,
+                              std::vector<char>& pointSeen,
+                              std::vector<size_t>& referenceIndices) const;
 
   /**
    * This is a helper function that computes the distance of the query to the
@@ -214,16 +255,17 @@ class LSHSearch
   //! Instantiation of the metric.
   metric::SquaredEuclideanDistance metric;
 
-  //! The final hash table; should be (< secondHashSize) x bucketSize.
-  arma::Mat<size_t> secondHashTable;
+  //! The points in the buckets of the second hash, stored one bucket after
+  //! another; each bucket holds at most bucketSize points.
+  arma::Col<size_t> bucketContents;
 
-  //! The number of elements present in each hash bucket; should be
-  //! secondHashSize.
-  arma::Col<size_t> bucketContentSize;
+  //! For a particular hash value, the index in bucketContents of the first
+  //! point in its bucket; the bucket ends where the next one starts.  Should be
+  //! secondHashSize + 1.
+  arma::Col<size_t> bucketOffsets;
 
-  //! For a particular hash value, points to the row in secondHashTable
-  //! corresponding to this value.  Should be secondHashSize.
-  arma::Col<size_t> bucketRowInHashTable;
+  //! The number of threads to use for search.
+  size_t numThreads;
 
   //! The pointer to the nearest neighbor distances.
   arma::mat* distancePtr;
@@ -8,6 +8,7 @@
 #define __MLPACK_METHODS_NEIGHBOR_SEARCH_LSH_SEARCH_IMPL_HPP
 
 #include <mlpack/core.hpp>
+#include <algorithm>
 
 namespace mlpack {
 namespace neighbor {
@@ -28,7 +29,8 @@ LSHSearch(const arma::mat& referenceSet,
   numTables(numTables),
   hashWidth(hashWidthIn),
   secondHashSize(secondHashSize),
-  bucketSize(bucketSize)
+  bucketSize(bucketSize),
+  numThreads(1)
 {
   if (hashWidth == 0.0) // The user has not provided any value.
   {
@@ -64,7 +66,8 @@ LSHSearch(const arma::mat& referenceSet,
   numTables(numTables),
   hashWidth(hashWidthIn),
   secondHashSize(secondHashSize),
-  bucketSize(bucketSize)
+  bucketSize(bucketSize),
+  numThreads(1)
 {
   if (hashWidth == 0.0) // The user has not provided any value.
   {
@@ -139,65 +142,66 @@ BaseCase(const size_t queryIndex, const size_t referenceIndex)
 
 template<typename SortPolicy>
 void LSHSearch<SortPolicy>::
-ReturnIndicesFromTable(const size_t queryIndex,
-                       arma::uvec& referenceIndices,
-                       size_t numTablesToSearch)
+HashPoints(const arma::mat& points,
+           const size_t begin,
+           const size_t end,
+           const size_t numTablesToSearch,
+           arma::Mat<size_t>& buckets) const
 {
-  // Decide on the number of tables to look into.
-  if (numTablesToSearch == 0) // If no user input is given, search all.
-    numTablesToSearch = numTables;
+  buckets.set_size(numTablesToSearch, end - begin);
 
-  // Sanity check to make sure that the existing number of tables is not
-  // exceeded.
-  if (numTablesToSearch > numTables)
-    numTablesToSearch = numTables;
-
-  // Hash the query in each of the 'numTablesToSearch' hash tables using the
-  // 'numProj' projections for each table. This gives us 'numTablesToSearch'
-  // keys for the query where each key is a 'numProj' dimensional integer
-  // vector.
-
-  // Compute the projection of the query in each table.
-  arma::mat allProjInTables(numProj, numTablesToSearch);
   for (size_t i = 0; i < numTablesToSearch; i++)
   {
-    allProjInTables.unsafe_col(i) = projections[i].t() *
-        querySet.unsafe_col(queryIndex);
-  }
-  allProjInTables += offsets.cols(0, numTablesToSearch - 1);
-  allProjInTables /= hashWidth;
+    // For a single table, let the 'numProj' projections be denoted by 'proj_i'
+    // and the corresponding offset be 'offset_i'.  Then the key of a single
+    // point is obtained as:
+    // key = { floor( (<proj_i, point> + offset_i) / 'hashWidth' ) forall i }
+    // This gives a ('numProj' x (end - begin)) key matrix.
+    arma::mat hashMat = projections[i].t() * points.cols(begin, end - 1);
+    hashMat += arma::repmat(offsets.unsafe_col(i), 1, end - begin);
+    hashMat /= hashWidth;
 
-  // Compute the hash value of each key of the query into a bucket of the
-  // 'secondHashTable' using the 'secondHashWeights'.
-  arma::rowvec hashVec = secondHashWeights.t() * arma::floor(allProjInTables);
+    // Now hash every key to its bucket in the second hash table using the
+    // 'secondHashWeights'.
+    const arma::rowvec secondHashVec = secondHashWeights.t() *
+        arma::floor(hashMat);
 
-  for (size_t i = 0; i < hashVec.n_elem; i++)
-    hashVec[i] = (double) ((size_t) hashVec[i] % secondHashSize);
+    for (size_t j = 0; j < secondHashVec.n_elem; j++)
+      buckets(i, j) = (size_t) secondHashVec[j] % secondHashSize;
+  }
+}
 
-  Log::Assert(hashVec.n_elem == numTablesToSearch);
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::
+ReturnIndicesFromTable(const size_t* queryBuckets,
+                       const size_t numTablesToSearch,
+                       std::vector<char>& pointSeen,
+                       std::vector<size_t>& referenceIndices) const
+{
+  referenceIndices.clear();
 
   // For all the buckets that the query is hashed into, sequentially
-  // collect the indices in those buckets.
-  arma::Col<size_t> refPointsConsidered;
-  refPointsConsidered.zeros(referenceSet.n_cols);
-
-  for (size_t i = 0; i < hashVec.n_elem; i++) // For all tables.
+  // collect the indices in those buckets that we have not seen yet.
+  for (size_t i = 0; i < numTablesToSearch; i++) // For all tables.
   {
-    size_t hashInd = (size_t) hashVec[i];
-
-    if (bucketContentSize[hashInd] > 0)
+    const size_t hashInd = queryBuckets[i];
+    for (size_t j = bucketOffsets[hashInd]; j < bucketOffsets[hashInd + 1];
+         j++)
     {
-      // Pick the indices in the bucket corresponding to 'hashInd'.
-      size_t tableRow = bucketRowInHashTable[hashInd];
-      assert(tableRow < secondHashSize);
-      assert(tableRow < secondHashTable.n_rows);
-
-      for (size_t j = 0; j < bucketContentSize[hashInd]; j++)
-        refPointsConsidered[secondHashTable(tableRow, j)]++;
+      const size_t index = bucketContents[j];
+      if (!pointSeen[index])
+      {
+        pointSeen[index] = 1;
+        referenceIndices.push_back(index);
+      }
     }
   }
 
-  referenceIndices = arma::find(refPointsConsidered > 0);
+  // Reset the marks for the next query, and visit the candidates in order.
+  for (size_t i = 0; i < referenceIndices.size(); i++)
+    pointSeen[referenceIndices[i]] = 0;
+
+  std::sort(referenceIndices.begin(), referenceIndices.end());
 }
 
 
@@ -217,26 +221,51 @@ Search(const size_t k,
   distancePtr->fill(SortPolicy::WorstDistance());
   neighborPtr->fill(referenceSet.n_cols);
 
+  // Decide on the number of tables to look into.  If no user input is given,
+  // search all; also make sure that the existing number of tables is not
+  // exceeded.
+  const size_t tablesToSearch = ((numTablesToSearch == 0) ||
+      (numTablesToSearch > numTables)) ? numTables : numTablesToSearch;
+
   size_t avgIndicesReturned = 0;
 
   Timer::Start("computing_neighbors");
 
-  // Go through every query point sequentially.
-  for (size_t i = 0; i < querySet.n_cols; i++)
+  // Every query point is handled by exactly one thread, and each thread only
+  // writes to the columns of the query points it handles.
+  const size_t numBlocks = (querySet.n_cols + BlockSize - 1) / BlockSize;
+  #pragma omp parallel num_threads(numThreads) reduction(+:avgIndicesReturned)
   {
-    // Hash every query into every hash table and eventually into the
-    // 'secondHashTable' to obtain the neighbor candidates.
-    arma::uvec refIndices;
-    ReturnIndicesFromTable(i, refIndices, numTablesToSearch);
-
-    // An informative book-keeping for the number of neighbor candidates
-    // returned on average.
-    avgIndicesReturned += refIndices.n_elem;
-
-    // Sequentially go through all the candidates and save the best 'k'
-    // candidates.
-    for (size_t j = 0; j < refIndices.n_elem; j++)
-      BaseCase(i, (size_t) refIndices[j]);
+    std::vector<char> pointSeen(referenceSet.n_cols, 0);
+    std::vector<size_t> refIndices;
+    arma::Mat<size_t> queryBuckets;
+
+    #pragma omp for schedule(dynamic)
+    for (size_t b = 0; b < numBlocks; ++b)
+    {
+      const size_t begin = b * BlockSize;
+      const size_t end = std::min(begin + BlockSize, (size_t) querySet.n_cols);
+
+      // Hash every query in the block into every hash table and eventually
+      // into the second hash table.
+      HashPoints(querySet, begin, end, tablesToSearch, queryBuckets);
+
+      for (size_t i = begin; i < end; i++)
+      {
+        // Obtain the neighbor candidates from the buckets of the query.
+        ReturnIndicesFromTable(queryBuckets.colptr(i - begin), tablesToSearch,
+            pointSeen, refIndices);
+
+        // An informative book-keeping for the number of neighbor candidates
+        // returned on average.
+        avgIndicesReturned += refIndices.size();
+
+        // Sequentially go through all the candidates and save the best 'k'
+        // candidates.
+        for (size_t j = 0; j < refIndices.size(); j++)
+          BaseCase(i, refIndices[j]);
+      }
+    }
   }
 
   Timer::Stop("computing_neighbors");
@@ -252,7 +281,7 @@ BuildHash()
 {
   // The first level hash for a single table outputs a 'numProj'-dimensional
   // integer key for each point in the set -- (key, pointID)
-  // The key creation details are presented below
+  // The key creation details are presented in HashPoints().
   //
   // The second level hash is performed by hashing the key to
   // an integer in the range [0, 'secondHashSize').
@@ -271,43 +300,15 @@ BuildHash()
   secondHashWeights = arma::floor(arma::randu(numProj) *
                                   (double) secondHashSize);
 
-  // The 'secondHashTable' is initially an empty matrix of size
-  // ('secondHashSize' x 'bucketSize'). But by only filling the buckets
-  // as points land in them allows us to shrink the size of the
-  // 'secondHashTable' at the end of the hashing.
-
-  // Fill the second hash table n = referenceSet.n_cols.  This is because no
-  // point has index 'n' so the presence of this in the bucket denotes that
-  // there are no more points in this bucket.
-  secondHashTable.set_size(secondHashSize, bucketSize);
-  secondHashTable.fill(referenceSet.n_cols);
-
-  // Keep track of the size of each bucket in the hash.  At the end of hashing
-  // most buckets will be empty.
-  bucketContentSize.zeros(secondHashSize);
-
-  // Instead of putting the points in the row corresponding to the bucket, we
-  // chose the next empty row and keep track of the row in which the bucket
-  // lies. This allows us to stack together and slice out the empty buckets at
-  // the end of the hashing.
-  bucketRowInHashTable.set_size(secondHashSize);
-  bucketRowInHashTable.fill(secondHashSize);
-
-  // Keep track of number of non-empty rows in the 'secondHashTable'.
-  size_t numRowsInTable = 0;
-
   // Step II: The offsets for all projections in all tables.
   // Since the 'offsets' are in [0, hashWidth], we obtain the 'offsets'
   // as randu(numProj, numTables) * hashWidth.
   offsets.randu(numProj, numTables);
   offsets *= hashWidth;
 
-  // Step III: Create each hash table in the first level hash one by one and
-  // putting them directly into the 'secondHashTable' for memory efficiency.
+  // Step III: Obtain the 'numProj' projections for each table.
   for (size_t i = 0; i < numTables; i++)
   {
-    // Step IV: Obtain the 'numProj' projections for each table.
-
     // For L2 metric, 2-stable distributions are used, and
     // the normal Z ~ N(0, 1) is a 2-stable distribution.
     arma::mat projMat;
@@ -315,79 +316,59 @@ BuildHash()
 
     // Save the projection matrix for querying.
     projections.push_back(projMat);
+  }
 
-    // Step V: create the 'numProj'-dimensional key for each point in each
-    // table.
-
-    // The following code performs the task of hashing each point to a
-    // 'numProj'-dimensional integer key.  Hence you get a ('numProj' x
-    // 'referenceSet.n_cols') key matrix.
-    //
-    // For a single table, let the 'numProj' projections be denoted by 'proj_i'
-    // and the corresponding offset be 'offset_i'.  Then the key of a single
-    // point is obtained as:
-    // key = { floor( (<proj_i, point> + offset_i) / 'hashWidth' ) forall i }
-    arma::mat offsetMat = arma::repmat(offsets.unsafe_col(i), 1,
-                                       referenceSet.n_cols);
-    arma::mat hashMat = projMat.t() * referenceSet;
-    hashMat += offsetMat;
-    hashMat /= hashWidth;
-
-    // Step VI: Putting the points in the 'secondHashTable' by hashing the key.
-    // Now we hash every key, point ID to its corresponding bucket.
-    arma::rowvec secondHashVec = secondHashWeights.t()
-      * arma::floor(hashMat);
-
-    // This gives us the bucket for the corresponding point ID.
-    for (size_t j = 0; j < secondHashVec.n_elem; j++)
-      secondHashVec[j] = (double)((size_t) secondHashVec[j] % secondHashSize);
-
-    Log::Assert(secondHashVec.n_elem == referenceSet.n_cols);
-
-    // Insert the point in the corresponding row to its bucket in the
-    // 'secondHashTable'.
-    for (size_t j = 0; j < secondHashVec.n_elem; j++)
+  // Step IV: Hash every point into every table, and then into the second hash
+  // table.
+  arma::Mat<size_t> referenceBuckets;
+  HashPoints(referenceSet, 0, referenceSet.n_cols, numTables,
+      referenceBuckets);
+
+  // Step V: Count the number of points in each bucket.  A bucket holds at most
+  // 'bucketSize' points; points that land in a full bucket are dropped.  The
+  // buckets are stored one after another in 'bucketContents', so we only need
+  // as much memory as there are points in the buckets.  The count of bucket i
+  // is stored in bucketOffsets[i + 1] for now.
+  bucketOffsets.zeros(secondHashSize + 1);
+  for (size_t i = 0; i < numTables; i++)
+  {
+    for (size_t j = 0; j < referenceSet.n_cols; j++)
     {
-      // This is the bucket number.
-      size_t hashInd = (size_t) secondHashVec[j];
-      // The point ID is 'j'.
-
-      // If this is currently an empty bucket, start a new row keep track of
-      // which row corresponds to the bucket.
-      if (bucketContentSize[hashInd] == 0)
-      {
-        // Start a new row for hash.
-        bucketRowInHashTable[hashInd] = numRowsInTable;
-        secondHashTable(numRowsInTable, 0) = j;
-
-        numRowsInTable++;
-      }
+      const size_t hashInd = referenceBuckets(i, j);
+      if (bucketOffsets[hashInd + 1] < bucketSize)
+        bucketOffsets[hashInd + 1]++;
+    }
+  }
 
-      else
-      {
-        // If bucket is already present in the 'secondHashTable', find the
-        // corresponding row and insert the point ID in this row unless the
-        // bucket is full, in which case, do nothing.
-        if (bucketContentSize[hashInd] < bucketSize)
-          secondHashTable(bucketRowInHashTable[hashInd],
-                          bucketContentSize[hashInd]) = j;
-      }
+  size_t numBuckets = 0;
+  size_t maxBucketSize = 0;
+  for (size_t i = 0; i < secondHashSize; i++)
+  {
+    if (bucketOffsets[i + 1] > 0)
+      numBuckets++;
+    if (bucketOffsets[i + 1] > maxBucketSize)
+      maxBucketSize = bucketOffsets[i + 1];
 
-      // Increment the count of the points in this bucket.
-      if (bucketContentSize[hashInd] < bucketSize)
-        bucketContentSize[hashInd]++;
-    } // Loop over all points in the reference set.
-  } // Loop over tables.
+    bucketOffsets[i + 1] += bucketOffsets[i];
+  }
 
-  // Step VII: Condensing the 'secondHashTable'.
-  size_t maxBucketSize = 0;
-  for (size_t i = 0; i < bucketContentSize.n_elem; i++)
-    if (bucketContentSize[i] > maxBucketSize)
-      maxBucketSize = bucketContentSize[i];
+  // Step VI: Put each point ID in its bucket, in the same order they were
+  // counted.
+  bucketContents.set_size(bucketOffsets[secondHashSize]);
+  arma::Col<size_t> bucketEnd = bucketOffsets.subvec(0, secondHashSize - 1);
+  for (size_t i = 0; i < numTables; i++)
+  {
+    for (size_t j = 0; j < referenceSet.n_cols; j++)
+    {
+      const size_t hashInd = referenceBuckets(i, j);
+      if (bucketEnd[hashInd] < bucketOffsets[hashInd + 1])
+        bucketContents[bucketEnd[hashInd]++] = j;
+    }
+  }
 
-  Log::Info << "Final hash table size: (" << numRowsInTable << " x "
-            << maxBucketSize << ")" << std::endl;
-  secondHashTable.resize(numRowsInTable, maxBucketSize);
+  Log::Info << "Final hash table size: " << bucketContents.n_elem << " points "
+      << "in " << numBuckets << " buckets (largest bucket: " << maxBucketSize
+      << " points)." << std::endl;
 }
 
 template<typename SortPolicy>
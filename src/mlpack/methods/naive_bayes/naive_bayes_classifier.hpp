@@ -28,6 +28,12 @@ namespace naive_bayes /** The Naive Bayes Classifier. */ {
  * For classifying a data point (x_1, x_2, ..., x_n), it computes the following:
  * arg max_y(P(Y = y)*P(X_1 = x_1 | Y = y) * ... * P(X_n = x_n | Y = y))
  *
+ * Training makes one pass over the data, which is split between threads if
+ * OpenMP is available; classification scores blocks of points against every
+ * class with matrix multiplications.  The data may be dense (arma::mat) or
+ * sparse (arma::sp_mat); for sparse data, the work is proportional to the
+ * number of nonzero elements (plus the size of the model).
+ *
  * Example use:
  *
  * @code
@@ -37,20 +43,30 @@ namespace naive_bayes /** The Naive Bayes Classifier. */ {
  *
  * nbc.Classify(testing_data, results);
  * @endcode
+ *
+ * The model can also be updated with new data after it has been trained,
+ * without seeing the old data again (with Train(), with incremental set to
+ * true), and models trained separately on different shards of a dataset can be
+ * combined (with Merge()).  In both cases, the result is the same (up to
+ * rounding) as training on all of the data at once.
  */
 template<typename MatType = arma::mat>
 class NaiveBayesClassifier
 {
  private:
-  //! Sample mean for each class.
-  MatType means;
+  //! Sample mean for each class.  These are dense even for sparse data.
+  arma::mat means;
 
   //! Sample variances for each class.
-  MatType variances;
+  arma::mat variances;
 
   //! Class probabilities.
   arma::vec probabilities;
 
+  //! Number of points the model has been trained on.  Together with the class
+  //! probabilities, this gives the number of points of each class.
+  size_t trainingPoints;
+
  public:
   /**
    * Initializes the classifier as per the input and then trains it by
@@ -68,15 +84,60 @@ class NaiveBayesClassifier
    * @param data Training data points.
    * @param labels Labels corresponding to training data points.
    * @param classes Number of classes in this classifier.
-   * @param incrementalVariance If true, an incremental algorithm is used to
-   *     calculate the variance; this can prevent loss of precision in some
-   *     cases, but will be somewhat slower to calculate.
+   * @param incrementalVariance Ignored; the variances are always calculated
+   *     with a numerically stable one-pass algorithm.  This is kept for
+   *     compatibility.
    */
   NaiveBayesClassifier(const MatType& data,
                        const arma::Col<size_t>& labels,
                        const size_t classes,
                        const bool incrementalVariance = false);
 
+  /**
+   * Initialize an untrained classifier with the given dimensionality and number
+   * of classes.  Train() can then be used to train it, in one batch or in many.
+   *
+   * @param dimensionality Dimensionality of the data.
+   * @param classes Number of classes in this classifier.
+   */
+  NaiveBayesClassifier(const size_t dimensionality = 0,
+                       const size_t classes = 0);
+
+  /**
+   * Train the classifier on the given data.  If incremental is true, the model
+   * is updated with the new data: the means, variances, and class
+   * probabilities become those of all the data the model has been trained on.
+   * Otherwise, the model is retrained from scratch.  The dimensionality and the
+   * number of classes are those of the model.
+   *
+   * @param data Training data points.
+   * @param labels Labels corresponding to training data points.
+   * @param incremental Whether or not to keep what the model has already
+   *     learned.
+   */
+  void Train(const MatType& data,
+             const arma::Col<size_t>& labels,
+             const bool incremental = true);
+
+  /**
+   * Update the classifier with a single point, with Welford's algorithm.  This
+   * takes O(dimensionality + classes) time.
+   *
+   * @param point Training data point.
+   * @param label Label of the point.
+   */
+  void Train(const arma::vec& point, const size_t label);
+
+  /**
+   * Merge another classifier, trained on different data, into this one.  The
+   * result is the classifier that would have been trained on both sets of
+   * data.  The classifiers must have the same dimensionality and number of
+   * classes.
+   *
+   * @param other Classifier to merge into this one.
+   */
+  void Merge(const NaiveBayesClassifier& other);
+
   /**
    * Given a bunch of data points, this function evaluates the class of each of
    * those data points, and puts it in the vector 'results'.
@@ -91,22 +152,129 @@ class NaiveBayesClassifier
    * @param data List of data points.
    * @param results Vector that class predictions will be placed into.
    */
-  void Classify(const MatType& data, arma::Col<size_t>& results);
+  void Classify(const MatType& data, arma::Col<size_t>& results) const;
 
   //! Get the sample means for each class.
-  const MatType& Means() const { return means; }
+  const arma::mat& Means() const { return means; }
   //! Modify the sample means for each class.
-  MatType& Means() { return means; }
+  arma::mat& Means() { return means; }
 
   //! Get the sample variances for each class.
-  const MatType& Variances() const { return variances; }
+  const arma::mat& Variances() const { return variances; }
   //! Modify the sample variances for each class.
-  MatType& Variances() { return variances; }
+  arma::mat& Variances() { return variances; }
 
   //! Get the prior probabilities for each class.
   const arma::vec& Probabilities() const { return probabilities; }
   //! Modify the prior probabilities for each class.
   arma::vec& Probabilities() { return probabilities; }
+
+  //! Get the number of points the model has been trained on.
+  size_t TrainingPoints() const { return trainingPoints; }
+
+  //! The number of points handled at once in training (by each thread) and in
+  //! classification.
+  static const size_t BlockSize = 1024;
+
+ private:
+  /**
+   * Compute the number of points, the mean, and the sum of squared deviations
+   * from the mean of each class in the given data.  The points are split
+   * between threads, if OpenMP is available.
+   *
+   * @param data Training data points.
+   * @param labels Labels corresponding to training data points.
+   * @param counts Vector to store the number of points of each class in.
+   * @param classMeans Matrix to store the means of each class in.
+   * @param squares Matrix to store the sums of squared deviations in.
+   */
+  void BatchStatistics(const MatType& data,
+                       const arma::Col<size_t>& labels,
+                       arma::vec& counts,
+                       arma::mat& classMeans,
+                       arma::mat& squares) const;
+
+  /**
+   * Recover the number of points and the sum of squared deviations of each
+   * class from the model.
+   *
+   * @param counts Vector to store the number of points of each class in.
+   * @param squares Matrix to store the sums of squared deviations in.
+   */
+  void Statistics(arma::vec& counts, arma::mat& squares) const;
+
+  /**
+   * Set the variances, class probabilities, and number of training points
+   * from the number of points and the sums of squared deviations of each
+   * class.  The means must already be set.
+   *
+   * @param counts Number of points of each class.
+   * @param squares Sums of squared deviations of each class.
+   */
+  void SetStatistics(const arma::vec& counts, const arma::mat& squares);
+
+  /**
+   * Compute the number of points, the mean, and the sum of squared deviations
+   * from the mean of each class, over the points in [begin, end).  The points
+   * are handled in blocks small enough to stay in cache, and the statistics of
+   * each block are merged into the running statistics.
+   *
+   * @param data Training data points.
+   * @param labels Labels corresponding to training data points.
+   * @param begin Index of first point.
+   * @param end Index of one past the last point.
+   * @param counts Vector to store the number of points of each class in.
+   * @param classMeans Matrix to store the means of each class in.
+   * @param squares Matrix to store the sums of squared deviations in.
+   */
+  static void RangeStatistics(const arma::mat& data,
+                              const arma::Col<size_t>& labels,
+                              const size_t begin,
+                              const size_t end,
+                              arma::vec& counts,
+                              arma::mat& classMeans,
+                              arma::mat& squares);
+
+  /**
+   * Compute the number of points, the mean, and the sum of squared deviations
+   * from the mean of each class, over the points in [begin, end) of sparse
+   * data.  Only the nonzero elements are visited.
+   *
+   * @param data Training data points.
+   * @param labels Labels corresponding to training data points.
+   * @param begin Index of first point.
+   * @param end Index of one past the last point.
+   * @param counts Vector to store the number of points of each class in.
+   * @param classMeans Matrix to store the means of each class in.
+   * @param squares Matrix to store the sums of squared deviations in.
+   */
+  static void RangeStatistics(const arma::sp_mat& data,
+                              const arma::Col<size_t>& labels,
+                              const size_t begin,
+                              const size_t end,
+                              arma::vec& counts,
+                              arma::mat& classMeans,
+                              arma::mat& squares);
+
+  /**
+   * Merge the statistics of a second set of points into the statistics of a
+   * first set, using the pairwise update of Chan, Golub, and LeVeque ("Updating
+   * formulae and a pairwise algorithm for computing sample variances", 1979).
+   *
+   * @param counts Number of points of each class in the first set.
+   * @param classMeans Means of each class in the first set.
+   * @param squares Sums of squared deviations of each class in the first set.
+   * @param otherCounts Number of points of each class in the second set.
+   * @param otherMeans Means of each class in the second set.
+   * @param otherSquares Sums of squared deviations of each class in the
+   *     second set.
+   */
+  static void MergeStatistics(arma::vec& counts,
+                              arma::mat& classMeans,
+                              arma::mat& squares,
+                              const arma::vec& otherCounts,
+                              const arma::mat& otherMeans,
+                              const arma::mat& otherSquares);
 };
 
 }; // namespace naive_bayes
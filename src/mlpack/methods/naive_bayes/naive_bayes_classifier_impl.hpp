@@ -24,130 +24,424 @@ NaiveBayesClassifier<MatType>::NaiveBayesClassifier(
     const MatType& data,
     const arma::Col<size_t>& labels,
     const size_t classes,
-    const bool incrementalVariance)
+    const bool /* incrementalVariance */) :
+    trainingPoints(0)
 {
-  const size_t dimensionality = data.n_rows;
-
   // Update the variables according to the number of features and classes
   // present in the data.
+  probabilities.zeros(classes);
+  means.zeros(data.n_rows, classes);
+  variances.zeros(data.n_rows, classes);
+
+  Train(data, labels, false);
+}
+
+template<typename MatType>
+NaiveBayesClassifier<MatType>::NaiveBayesClassifier(
+    const size_t dimensionality,
+    const size_t classes) :
+    trainingPoints(0)
+{
   probabilities.zeros(classes);
   means.zeros(dimensionality, classes);
   variances.zeros(dimensionality, classes);
+}
+
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::Train(const MatType& data,
+                                          const arma::Col<size_t>& labels,
+                                          const bool incremental)
+{
+  if (data.n_rows != means.n_rows)
+    Log::Fatal << "NaiveBayesClassifier::Train(): data dimensionality ("
+        << data.n_rows << ") must be the same as the model dimensionality ("
+        << means.n_rows << ")!" << std::endl;
+
+  if (labels.n_elem != data.n_cols)
+    Log::Fatal << "NaiveBayesClassifier::Train(): number of labels ("
+        << labels.n_elem << ") must be the same as the number of points ("
+        << data.n_cols << ")!" << std::endl;
+
+  if (labels.n_elem > 0 && labels.max() >= means.n_cols)
+    Log::Fatal << "NaiveBayesClassifier::Train(): label " << labels.max()
+        << " is not less than the number of classes (" << means.n_cols << ")!"
+        << std::endl;
 
   Log::Info << "Training Naive Bayes classifier on " << data.n_cols
-      << " examples with " << dimensionality << " features each." << std::endl;
+      << " examples with " << data.n_rows << " features each." << std::endl;
 
-  // Calculate the class probabilities as well as the sample mean and variance
-  // for each of the features with respect to each of the labels.
-  if (incrementalVariance)
+  arma::vec counts;
+  arma::mat squares;
+  if (incremental && trainingPoints > 0)
   {
-    // Use incremental algorithm.
-    for (size_t j = 0; j < data.n_cols; ++j)
-    {
-      const size_t label = labels[j];
-      ++probabilities[label];
+    // Merge the statistics of the new data into those of the model.
+    arma::vec batchCounts;
+    arma::mat batchMeans, batchSquares;
+    BatchStatistics(data, labels, batchCounts, batchMeans, batchSquares);
 
-      arma::vec delta = data.col(j) - means.col(label);
-      means.col(label) += delta / probabilities[label];
-      variances.col(label) += delta % (data.col(j) - means.col(label));
-    }
+    Statistics(counts, squares);
+    MergeStatistics(counts, means, squares, batchCounts, batchMeans,
+        batchSquares);
+  }
+  else
+  {
+    BatchStatistics(data, labels, counts, means, squares);
+  }
+
+  SetStatistics(counts, squares);
+}
+
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::Train(const arma::vec& point,
+                                          const size_t label)
+{
+  if (point.n_elem != means.n_rows)
+    Log::Fatal << "NaiveBayesClassifier::Train(): point dimensionality ("
+        << point.n_elem << ") must be the same as the model dimensionality ("
+        << means.n_rows << ")!" << std::endl;
+
+  if (label >= means.n_cols)
+    Log::Fatal << "NaiveBayesClassifier::Train(): label " << label << " is not "
+        << "less than the number of classes (" << means.n_cols << ")!"
+        << std::endl;
+
+  // Only the statistics of one class change, so only those are recovered from
+  // the model.
+  const double oldCount = std::floor(probabilities[label] * trainingPoints +
+      0.5);
+  arma::vec squares = variances.col(label);
+  if (oldCount > 1)
+    squares *= (oldCount - 1);
+  else
+    squares.zeros();
+
+  // Welford's update.
+  const double count = oldCount + 1;
+  const arma::vec delta = point - means.col(label);
+  means.col(label) += delta / count;
+  squares += delta % (point - means.col(label));
+
+  if (count > 1)
+    squares /= (count - 1);
+  for (size_t i = 0; i < squares.n_elem; ++i)
+    if (squares[i] <= 0.0)
+      squares[i] = 1e-50;
+  variances.col(label) = squares;
 
-    for (size_t i = 0; i < classes; ++i)
+  probabilities *= trainingPoints;
+  probabilities[label] += 1;
+  ++trainingPoints;
+  probabilities /= trainingPoints;
+}
+
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::Merge(const NaiveBayesClassifier& other)
+{
+  if (other.means.n_rows != means.n_rows || other.means.n_cols != means.n_cols)
+    Log::Fatal << "NaiveBayesClassifier::Merge(): dimensionality and number of "
+        << "classes (" << other.means.n_rows << ", " << other.means.n_cols
+        << ") must be the same as this classifier's (" << means.n_rows << ", "
+        << means.n_cols << ")!" << std::endl;
+
+  arma::vec counts, otherCounts;
+  arma::mat squares, otherSquares;
+  Statistics(counts, squares);
+  other.Statistics(otherCounts, otherSquares);
+
+  MergeStatistics(counts, means, squares, otherCounts, other.means,
+      otherSquares);
+  SetStatistics(counts, squares);
+}
+
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::Classify(const MatType& data,
+                                             arma::Col<size_t>& results) const
+{
+  // Check that the number of features in the test data is same as in the
+  // training data.
+  Log::Assert(data.n_rows == means.n_rows);
+
+  results.set_size(data.n_cols); // No need to fill with anything yet.
+
+  Log::Info << "Running Naive Bayes classifier on " << data.n_cols
+      << " data points with " << data.n_rows << " features each." << std::endl;
+
+  // The log-probability of point x for class i is
+  //
+  //   log P(Y = i) - 0.5 sum_d log(2 pi v_id) - 0.5 sum_d (x_d - m_id)^2 / v_id
+  //
+  // and expanding the square splits it into a part that only depends on the
+  // class (computed once here), and two matrix products of the points with the
+  // means and variances, which for sparse points only involve the nonzero
+  // elements.
+  arma::mat invVar = 1.0 / variances;
+  arma::mat meanInvVar = means % invVar;
+
+  // Expanding the square loses precision when the mean is huge compared to
+  // the standard deviation (such as for features which are constant within a
+  // class, whose variance is 1e-50); those terms are left out of the products
+  // and computed directly for each point.
+  std::vector<std::pair<size_t, size_t> > exactTerms;
+  arma::mat exactInvVar(invVar);
+  for (size_t i = 0; i < means.n_cols; ++i)
+  {
+    for (size_t d = 0; d < means.n_rows; ++d)
     {
-      if (probabilities[i] > 2)
-        variances.col(i) /= (probabilities[i] - 1);
+      if (means(d, i) * meanInvVar(d, i) > 1e10)
+      {
+        exactTerms.push_back(std::make_pair(d, i));
+        invVar(d, i) = 0.0;
+        meanInvVar(d, i) = 0.0;
+      }
     }
   }
-  else
+
+  const arma::rowvec logNormalizers = arma::trans(arma::log(probabilities)) -
+      0.5 * (data.n_rows * std::log(2 * M_PI) +
+      arma::sum(arma::log(variances), 0) + arma::sum(means % meanInvVar, 0));
+
+  // Each block of points is scored against every class at once.
+  const size_t numBlocks = (data.n_cols + BlockSize - 1) / BlockSize;
+
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
   {
-    // Don't use incremental algorithm.  This is a two-pass algorithm.  It is
-    // possible to calculate the means and variances using a faster one-pass
-    // algorithm but there are some precision and stability issues.  If this is
-    // too slow, it's an option to use the faster algorithm by default and then
-    // have this (and the incremental algorithm) be other options.
-
-    // Calculate the means.
-    for (size_t j = 0; j < data.n_cols; ++j)
+    const size_t begin = b * BlockSize;
+    const size_t end = std::min(begin + BlockSize, (size_t) data.n_cols);
+    const MatType block = data.cols(begin, end - 1);
+
+    arma::mat scores = arma::trans(block) * meanInvVar;
+    scores -= 0.5 * (arma::trans(block % block) * invVar);
+    scores.each_row() += logNormalizers;
+
+    for (size_t k = 0; k < exactTerms.size(); ++k)
     {
-      const size_t label = labels[j];
-      ++probabilities[label];
-      means.col(label) += data.col(j);
+      const size_t d = exactTerms[k].first;
+      const size_t i = exactTerms[k].second;
+      for (size_t j = 0; j < block.n_cols; ++j)
+      {
+        const double diff = block(d, j) - means(d, i);
+        scores(j, i) -= 0.5 * diff * diff * exactInvVar(d, i);
+      }
     }
 
-    // Normalize means.
-    for (size_t i = 0; i < classes; ++i)
-      if (probabilities[i] != 0.0)
-        means.col(i) /= probabilities[i];
-
-    // Calculate variances.
-    for (size_t j = 0; j < data.n_cols; ++j)
+    // Find the index of the class with maximum probability for each point.
+    for (size_t j = 0; j < block.n_cols; ++j)
     {
-      const size_t label = labels[j];
-      variances.col(label) += square(data.col(j) - means.col(label));
+      arma::uword maxIndex = 0;
+      const arma::rowvec pointScores = scores.row(j);
+      pointScores.max(maxIndex);
+      results[begin + j] = maxIndex;
     }
+  }
+}
+
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::BatchStatistics(
+    const MatType& data,
+    const arma::Col<size_t>& labels,
+    arma::vec& counts,
+    arma::mat& classMeans,
+    arma::mat& squares) const
+{
+  const size_t dimensionality = means.n_rows;
+  const size_t classes = means.n_cols;
+
+  // Each thread computes the statistics of one contiguous range of points, and
+  // then the statistics of the ranges are merged in order, so the result is
+  // deterministic for a given number of threads.  Merging the statistics of
+  // two sets of points is numerically stable, so this is as precise as the
+  // incremental algorithm.
+#ifdef _OPENMP
+  const size_t numThreads = std::max((size_t) 1, std::min(
+      (size_t) omp_get_max_threads(), (size_t) data.n_cols / BlockSize));
+#else
+  const size_t numThreads = 1;
+#endif
+
+  std::vector<arma::vec> threadCounts(numThreads);
+  std::vector<arma::mat> threadMeans(numThreads);
+  std::vector<arma::mat> threadSquares(numThreads);
+
+  #pragma omp parallel for num_threads(numThreads) schedule(static, 1)
+  for (size_t t = 0; t < numThreads; ++t)
+  {
+    threadCounts[t].zeros(classes);
+    threadMeans[t].zeros(dimensionality, classes);
+    threadSquares[t].zeros(dimensionality, classes);
+
+    const size_t begin = t * data.n_cols / numThreads;
+    const size_t end = (t + 1) * data.n_cols / numThreads;
+    RangeStatistics(data, labels, begin, end, threadCounts[t], threadMeans[t],
+        threadSquares[t]);
+  }
 
-    // Normalize variances.
-    for (size_t i = 0; i < classes; ++i)
-      if (probabilities[i] > 1)
-        variances.col(i) /= (probabilities[i] - 1);
+  counts = threadCounts[0];
+  classMeans = threadMeans[0];
+  squares = threadSquares[0];
+  for (size_t t = 1; t < numThreads; ++t)
+  {
+    MergeStatistics(counts, classMeans, squares, threadCounts[t],
+        threadMeans[t], threadSquares[t]);
   }
+}
+
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::Statistics(arma::vec& counts,
+                                               arma::mat& squares) const
+{
+  counts.set_size(probabilities.n_elem);
+  for (size_t i = 0; i < counts.n_elem; ++i)
+    counts[i] = std::floor(probabilities[i] * trainingPoints + 0.5);
+
+  // The variances of classes with at most one point are not normalized, and
+  // their sum of squared deviations is 0.
+  squares.zeros(variances.n_rows, variances.n_cols);
+  for (size_t i = 0; i < counts.n_elem; ++i)
+    if (counts[i] > 1)
+      squares.col(i) = variances.col(i) * (counts[i] - 1);
+}
 
-  // Ensure that the variances are invertible.
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::SetStatistics(const arma::vec& counts,
+                                                  const arma::mat& squares)
+{
+  // Normalize variances.
+  variances = squares;
+  for (size_t i = 0; i < counts.n_elem; ++i)
+    if (counts[i] > 1)
+      variances.col(i) /= (counts[i] - 1);
+
+  // Ensure that the variances are invertible.  (For sparse data, rounding can
+  // make a zero sum of squared deviations very slightly negative.)
   for (size_t i = 0; i < variances.n_elem; ++i)
-    if (variances[i] == 0.0)
+    if (variances[i] <= 0.0)
       variances[i] = 1e-50;
 
-  probabilities /= data.n_cols;
+  trainingPoints = (size_t) arma::accu(counts);
+  probabilities = counts;
+  if (trainingPoints > 0)
+    probabilities /= trainingPoints;
 }
 
 template<typename MatType>
-void NaiveBayesClassifier<MatType>::Classify(const MatType& data,
-                                             arma::Col<size_t>& results)
+void NaiveBayesClassifier<MatType>::RangeStatistics(
+    const arma::mat& data,
+    const arma::Col<size_t>& labels,
+    const size_t begin,
+    const size_t end,
+    arma::vec& counts,
+    arma::mat& classMeans,
+    arma::mat& squares)
 {
-  // Check that the number of features in the test data is same as in the
-  // training data.
-  Log::Assert(data.n_rows == means.n_rows);
+  arma::vec blockCounts(counts.n_elem);
+  arma::mat blockMeans(classMeans.n_rows, classMeans.n_cols);
+  arma::mat blockSquares(squares.n_rows, squares.n_cols);
 
-  arma::vec probs = arma::log(probabilities);
-  arma::mat invVar = 1.0 / variances;
+  for (size_t blockBegin = begin; blockBegin < end; blockBegin += BlockSize)
+  {
+    const size_t blockEnd = std::min(blockBegin + BlockSize, end);
 
-  arma::mat testProbs = arma::repmat(probs.t(), data.n_cols, 1);
+    // The block is small enough to stay in cache, so it is cheap to make two
+    // passes over it: one for the means, and one for the squared deviations.
+    blockCounts.zeros();
+    blockMeans.zeros();
+    blockSquares.zeros();
+    for (size_t j = blockBegin; j < blockEnd; ++j)
+    {
+      const size_t label = labels[j];
+      ++blockCounts[label];
+      blockMeans.col(label) += data.col(j);
+    }
 
-  results.set_size(data.n_cols); // No need to fill with anything yet.
+    for (size_t i = 0; i < blockCounts.n_elem; ++i)
+      if (blockCounts[i] != 0.0)
+        blockMeans.col(i) /= blockCounts[i];
 
-  Log::Info << "Running Naive Bayes classifier on " << data.n_cols
-      << " data points with " << data.n_rows << " features each." << std::endl;
+    for (size_t j = blockBegin; j < blockEnd; ++j)
+    {
+      const size_t label = labels[j];
+      blockSquares.col(label) += arma::square(data.col(j) -
+          blockMeans.col(label));
+    }
+
+    MergeStatistics(counts, classMeans, squares, blockCounts, blockMeans,
+        blockSquares);
+  }
+}
 
-  // Calculate the joint probability for each of the data points for each of the
-  // means.n_cols.
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::RangeStatistics(
+    const arma::sp_mat& data,
+    const arma::Col<size_t>& labels,
+    const size_t begin,
+    const size_t end,
+    arma::vec& counts,
+    arma::mat& classMeans,
+    arma::mat& squares)
+{
+  // Resetting dense statistics for every block would cost more than the
+  // nonzero elements of the block, so the whole range is handled at once, with
+  // two passes over its nonzero elements.  First, the means, and the number of
+  // nonzero elements of each dimension in each class.
+  arma::mat nonzeros(squares.n_rows, squares.n_cols);
+  nonzeros.zeros();
+  for (size_t j = begin; j < end; ++j)
+  {
+    const size_t label = labels[j];
+    ++counts[label];
+    for (size_t k = data.col_ptrs[j]; k < data.col_ptrs[j + 1]; ++k)
+    {
+      classMeans(data.row_indices[k], label) += data.values[k];
+      ++nonzeros(data.row_indices[k], label);
+    }
+  }
+
+  for (size_t i = 0; i < counts.n_elem; ++i)
+    if (counts[i] != 0.0)
+      classMeans.col(i) /= counts[i];
 
-  // Loop over every class.
-  for (size_t i = 0; i < means.n_cols; i++)
+  // Then the squared deviations.  Every zero element contributes mean^2, so
+  // the sum is (count - nonzeros) * mean^2 plus (x - mean)^2 for each nonzero
+  // element.  Every term is nonnegative, so nothing cancels, even if the mean
+  // is far from the origin.
+  squares = -nonzeros;
+  squares.each_row() += arma::trans(counts);
+  squares %= arma::square(classMeans);
+  for (size_t j = begin; j < end; ++j)
   {
-    // This is an adaptation of gmm::phi() for the case where the covariance is
-    // a diagonal matrix.
-    arma::mat diffs = data - arma::repmat(means.col(i), 1, data.n_cols);
-    arma::mat rhs = -0.5 * arma::diagmat(invVar.col(i)) * diffs;
-    arma::vec exponents(diffs.n_cols);
-    for (size_t j = 0; j < diffs.n_cols; ++j)
-      exponents(j) = std::exp(arma::accu(diffs.col(j) % rhs.unsafe_col(j)));
-
-    testProbs.col(i) += log(pow(2 * M_PI, (double) data.n_rows / -2.0) *
-        pow(det(arma::diagmat(invVar.col(i))), -0.5) * exponents);
+    const size_t label = labels[j];
+    for (size_t k = data.col_ptrs[j]; k < data.col_ptrs[j + 1]; ++k)
+    {
+      const size_t d = data.row_indices[k];
+      const double deviation = data.values[k] - classMeans(d, label);
+      squares(d, label) += deviation * deviation;
+    }
   }
+}
 
-  // Now calculate the label.
-  for (size_t i = 0; i < data.n_cols; ++i)
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::MergeStatistics(
+    arma::vec& counts,
+    arma::mat& classMeans,
+    arma::mat& squares,
+    const arma::vec& otherCounts,
+    const arma::mat& otherMeans,
+    const arma::mat& otherSquares)
+{
+  for (size_t i = 0; i < counts.n_elem; ++i)
   {
-    // Find the index of the class with maximum probability for this point.
-    arma::uword maxIndex = 0;
-    arma::vec pointProbs = testProbs.row(i).t();
-    pointProbs.max(maxIndex);
+    if (otherCounts[i] == 0.0)
+      continue;
 
-    results[i] = maxIndex;
-  }
+    const double count = counts[i] + otherCounts[i];
+    const arma::vec delta = otherMeans.col(i) - classMeans.col(i);
 
-  return;
+    classMeans.col(i) += (otherCounts[i] / count) * delta;
+    squares.col(i) += otherSquares.col(i) +
+        (counts[i] * otherCounts[i] / count) * arma::square(delta);
+    counts[i] = count;
+  }
 }
 
 }; // namespace naive_bayes
@@ -20,9 +20,9 @@ PROGRAM_INFO("Parametric Naive Bayes Classifier",
     " but labels can also be passed in separately as their own file "
     "(--labels_file)."
     "\n\n"
-    "The '--incremental_variance' option can be used to force the training to "
-    "use an incremental algorithm for calculating variance.  This is slower, "
-    "but can help avoid loss of precision in some cases.");
+    "The variances are always calculated with a numerically stable one-pass "
+    "algorithm, so the '--incremental_variance' option no longer has any "
+    "effect; it is kept for compatibility.");
 
 PARAM_STRING_REQ("train_file", "A file containing the training set.", "t");
 PARAM_STRING_REQ("test_file", "A file containing the test set.", "T");
@@ -59,6 +59,12 @@ PROGRAM_INFO("Neighborhood Components Analysis (NCA)",
     "documentation (in lbfgs.hpp) or the vast set of published literature on "
     "L-BFGS.\n"
     "\n"
+    "For large datasets, L-BFGS can be made much faster with --cutoff, which "
+    "ignores the pairs of points whose distance under the current scaling is "
+    "larger than the cutoff (their terms in the objective are at most "
+    "exp(-cutoff)).  The remaining pairs are found with a tree-based range "
+    "search at each iteration.\n"
+    "\n"
     "By default, the SGD optimizer is used.");
 
 PARAM_STRING_REQ("input_file", "Input dataset to run NCA on.", "i");
@@ -89,6 +95,8 @@ PARAM_INT("max_line_search_trials", "Maximum number of line search trials for "
     "L-BFGS.", "T", 50);
 PARAM_DOUBLE("min_step", "Minimum step of line search for L-BFGS.", "m", 1e-20);
 PARAM_DOUBLE("max_step", "Maximum step of line search for L-BFGS.", "M", 1e20);
+PARAM_DOUBLE("cutoff", "Ignore pairs of points further apart than this distance"
+    " when computing the objective for L-BFGS (0 means no cutoff).", "c", 0.0);
 
 PARAM_INT("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
 
@@ -146,6 +154,10 @@ int main(int argc, char* argv[])
     if (CLI::HasParam("max_step"))
       Log::Warn << "Parameter --max_step ignored (not using 'lbfgs' optimizer)."
           << std::endl;
+
+    if (CLI::HasParam("cutoff"))
+      Log::Warn << "Parameter --cutoff ignored (not using 'lbfgs' optimizer)."
+          << std::endl;
   }
   else if (optimizerType == "lbfgs")
   {
@@ -169,6 +181,11 @@ int main(int argc, char* argv[])
   const int maxLineSearchTrials = CLI::GetParam<int>("max_line_search_trials");
   const double minStep = CLI::GetParam<double>("min_step");
   const double maxStep = CLI::GetParam<double>("max_step");
+  const double cutoff = CLI::GetParam<double>("cutoff");
+
+  if (cutoff < 0.0)
+    Log::Fatal << "Invalid cutoff: " << cutoff << "; must be nonnegative."
+        << std::endl;
 
   // Load data.
   arma::mat data;
@@ -241,6 +258,7 @@ int main(int argc, char* argv[])
     nca.Optimizer().MaxLineSearchTrials() = maxLineSearchTrials;
     nca.Optimizer().MinStep() = minStep;
     nca.Optimizer().MaxStep() = maxStep;
+    nca.Optimizer().Function().Cutoff() = cutoff;
 
     nca.LearnDistance(distance);
   }
@@ -9,6 +9,7 @@
 #define __MLPACK_METHODS_NCA_NCA_SOFTMAX_ERROR_FUNCTION_HPP
 
 #include <mlpack/core.hpp>
+#include <mlpack/methods/range_search/range_search.hpp>
 
 namespace mlpack {
 namespace nca {
@@ -31,7 +32,22 @@ namespace nca {
  * In addition to the standard Evaluate() and Gradient() functions which MLPACK
  * optimizers use, overloads of Evaluate() and Gradient() are given which only
  * operate on one point in the dataset.  This is useful for optimizers like
- * stochastic gradient descent (see mlpack::optimization::SGD).
+ * stochastic gradient descent (see mlpack::optimization::SGD).  Overloads
+ * which operate on a contiguous batch of points are also given, for optimizers
+ * like mini-batch SGD (see mlpack::optimization::MiniBatchSGD); these stretch
+ * the dataset only once for the whole batch.
+ *
+ * The non-separable Evaluate() and Gradient() take O(n^2) time, but for most
+ * pairs of points exp(-|| A x_i - A x_j ||^2) is negligible (or underflows to
+ * 0).  If a cutoff is given, only the pairs whose distance is at most the
+ * cutoff are considered; these are found with a tree-based range search on the
+ * stretched dataset (see mlpack::range::RangeSearch), and the sums are then
+ * computed in parallel over the points.  A pair at the cutoff distance has
+ * weight exp(-cutoff), so a cutoff of 30 ignores only terms smaller than about
+ * 1e-13 (relative to a term at distance 0).  A point with no other points
+ * within the cutoff contributes nothing to the objective or gradient.  The
+ * cutoff is only supported for the squared Euclidean distance, and it does not
+ * change the separable Evaluate() and Gradient().
  */
 template<typename MetricType = metric::SquaredEuclideanDistance>
 class SoftmaxErrorFunction
@@ -46,10 +62,15 @@ class SoftmaxErrorFunction
    * @param dataset Matrix containing the dataset.
    * @param labels Vector of class labels for each point in the dataset.
    * @param kernel Instantiated kernel (optional).
+   * @param cutoff Maximum distance between two points for their term to be
+   *     included in the non-separable objective and gradient; 0 means that all
+   *     pairs are used.  A positive cutoff requires MetricType to be
+   *     metric::SquaredEuclideanDistance.
    */
   SoftmaxErrorFunction(const arma::mat& dataset,
                        const arma::Col<size_t>& labels,
-                       MetricType metric = MetricType());
+                       MetricType metric = MetricType(),
+                       const double cutoff = 0.0);
 
   /**
    * Evaluate the softmax function for the given covariance matrix.  This is the
@@ -72,6 +93,19 @@ class SoftmaxErrorFunction
    */
   double Evaluate(const arma::mat& covariance, const size_t i);
 
+  /**
+   * Evaluate the softmax objective function for the given covariance matrix on
+   * the points begin, begin + 1, ..., begin + batchSize - 1.  This is the sum
+   * of Evaluate(covariance, i) over those points.
+   *
+   * @param covariance Covariance matrix of Mahalanobis distance.
+   * @param begin Index of the first point in the batch.
+   * @param batchSize Number of points in the batch.
+   */
+  double Evaluate(const arma::mat& covariance,
+                  const size_t begin,
+                  const size_t batchSize);
+
   /**
    * Evaluate the gradient of the softmax function for the given covariance
    * matrix.  This is the non-separable implementation, where the objective
@@ -97,6 +131,21 @@ class SoftmaxErrorFunction
                 const size_t i,
                 arma::mat& gradient);
 
+  /**
+   * Evaluate the gradient of the softmax function for the given covariance
+   * matrix on the points begin, begin + 1, ..., begin + batchSize - 1.  This
+   * is the sum of Gradient(covariance, i, gradient) over those points.
+   *
+   * @param covariance Covariance matrix of Mahalanobis distance.
+   * @param begin Index of the first point in the batch.
+   * @param gradient Matrix to store the calculated gradient in.
+   * @param batchSize Number of points in the batch.
+   */
+  void Gradient(const arma::mat& covariance,
+                const size_t begin,
+                arma::mat& gradient,
+                const size_t batchSize);
+
   /**
    * Get the initial point.
    */
@@ -108,6 +157,11 @@ class SoftmaxErrorFunction
    */
   size_t NumFunctions() const { return dataset.n_cols; }
 
+  //! Get the distance cutoff for the non-separable objective (0 if unused).
+  double Cutoff() const { return cutoff; }
+  //! Modify the distance cutoff for the non-separable objective (0 if unused).
+  double& Cutoff() { return cutoff; }
+
   // convert the obkect into a string
   std::string ToString() const;
 
@@ -119,6 +173,8 @@ class SoftmaxErrorFunction
 
   //! The instantiated metric.
   MetricType metric;
+  //! The distance cutoff for the non-separable objective (0 if unused).
+  double cutoff;
 
   //! Last coordinates.  Used for the non-separable Evaluate() and Gradient().
   arma::mat lastCoordinates;
@@ -129,9 +185,15 @@ class SoftmaxErrorFunction
   //! Holds denominators for calculation of p_ij, for the non-separable
   //! Evaluate() and Gradient().
   arma::vec denominators;
+  //! With a cutoff, the points within the cutoff of each point.
+  std::vector<std::vector<size_t> > neighbors;
+  //! With a cutoff, exp(-d(x_i, x_j)) for each point j in neighbors[i].
+  std::vector<std::vector<double> > neighborEvals;
 
   //! False if nothing has ever been precalculated (only at construction time).
   bool precalculated;
+  //! The cutoff used for the last precalculation.
+  double lastCutoff;
 
   /**
    * Precalculate the denominators and numerators that will make up the p_ij,
@@ -142,11 +204,27 @@ class SoftmaxErrorFunction
    * This will update last_coordinates_ and stretched_dataset_, and also
    * calculate the p_i and denominators_ which are used in the calculation of
    * p_i or p_ij.  The calculation will be O((n * (n + 1)) / 2), which is not
-   * great.
+   * great, unless a cutoff is used; then neighbors and neighborEvals are
+   * filled by a range search.
    *
    * @param coordinates Coordinates matrix to use for precalculation.
    */
   void Precalculate(const arma::mat& coordinates);
+
+  /**
+   * Fill neighbors and neighborEvals with a range search on the stretched
+   * dataset, and sum the numerators and denominators of p_i over only those
+   * neighbors.  This is called by Precalculate() when a cutoff is used.
+   */
+  void PrecalculateWithCutoff();
+
+  /**
+   * Compute the sum of weighted outer products for the non-separable
+   * Gradient() using only the neighbors found by PrecalculateWithCutoff().
+   *
+   * @param sum Matrix to store the sum in.
+   */
+  void GradientSumWithCutoff(arma::mat& sum) const;
 };
 
 }; // namespace nca
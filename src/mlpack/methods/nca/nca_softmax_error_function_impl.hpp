@@ -10,6 +10,8 @@
 // In case it hasn't been included already.
 #include "nca_softmax_error_function.hpp"
 
+#include <boost/type_traits/is_same.hpp>
+
 namespace mlpack {
 namespace nca {
 
@@ -18,12 +20,23 @@ template<typename MetricType>
 SoftmaxErrorFunction<MetricType>::SoftmaxErrorFunction(
     const arma::mat& dataset,
     const arma::Col<size_t>& labels,
-    MetricType metric) :
+    MetricType metric,
+    const double cutoff) :
     dataset(dataset),
     labels(labels),
     metric(metric),
-    precalculated(false)
-{ /* nothing to do */ }
+    cutoff(cutoff),
+    precalculated(false),
+    lastCutoff(cutoff)
+{
+  // Catch this here instead of at the first call to Evaluate().
+  if (cutoff > 0.0 &&
+      !boost::is_same<MetricType, metric::SquaredEuclideanDistance>::value)
+  {
+    Log::Fatal << "SoftmaxErrorFunction: a cutoff can only be used with the "
+        << "squared Euclidean distance." << std::endl;
+  }
+}
 
 //! The non-separable implementation, which uses Precalculate() to save time.
 template<typename MetricType>
@@ -41,41 +54,56 @@ template<typename MetricType>
 double SoftmaxErrorFunction<MetricType>::Evaluate(const arma::mat& coordinates,
                                                   const size_t i)
 {
-  // Unfortunately each evaluation will take O(N) time because it requires a
-  // scan over all points in the dataset.  Our objective is to compute p_i.
-  double denominator = 0;
-  double numerator = 0;
+  return Evaluate(coordinates, i, 1);
+}
 
+//! The separated objective function on a batch of points.
+template<typename MetricType>
+double SoftmaxErrorFunction<MetricType>::Evaluate(const arma::mat& coordinates,
+                                                  const size_t begin,
+                                                  const size_t batchSize)
+{
   // It's quicker to do this now than one point at a time later.
   stretchedDataset = coordinates * dataset;
 
-  for (size_t k = 0; k < dataset.n_cols; ++k)
+  double result = 0;
+  for (size_t i = begin; i < begin + batchSize; ++i)
   {
-    // Don't consider the case where the points are the same.
-    if (k == i)
-      continue;
+    // Unfortunately each evaluation will take O(N) time because it requires a
+    // scan over all points in the dataset.  Our objective is to compute p_i.
+    double denominator = 0;
+    double numerator = 0;
 
-    // We want to evaluate exp(-D(A x_i, A x_k)).
-    double eval = std::exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
-                                            stretchedDataset.unsafe_col(k)));
+    for (size_t k = 0; k < dataset.n_cols; ++k)
+    {
+      // Don't consider the case where the points are the same.
+      if (k == i)
+        continue;
 
-    // If they are in the same
-    if (labels[i] == labels[k])
-      numerator += eval;
+      // We want to evaluate exp(-D(A x_i, A x_k)).
+      double eval = std::exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
+                                              stretchedDataset.unsafe_col(k)));
 
-    denominator += eval;
-  }
+      // If they are in the same class, add to the numerator.
+      if (labels[i] == labels[k])
+        numerator += eval;
 
-  // Now the result is just a simple division, but we have to be sure that the
-  // denominator is not 0.
-  if (denominator == 0.0)
-  {
-    Log::Warn << "Denominator of p_" << i << " is 0!" << std::endl;
-    return 0;
+      denominator += eval;
+    }
+
+    // Now the result is just a simple division, but we have to be sure that
+    // the denominator is not 0.
+    if (denominator == 0.0)
+    {
+      Log::Warn << "Denominator of p_" << i << " is 0!" << std::endl;
+      continue;
+    }
+
+    result -= (numerator / denominator); // Negate because the optimizer is a
+                                         // minimizer.
   }
 
-  return -(numerator / denominator); // Negate because the optimizer is a
-                                     // minimizer.
+  return result;
 }
 
 //! The non-separable implementation, where Precalculate() is used.
@@ -86,6 +114,14 @@ void SoftmaxErrorFunction<MetricType>::Gradient(const arma::mat& coordinates,
   // Calculate the denominators and numerators, if necessary.
   Precalculate(coordinates);
 
+  if (cutoff > 0.0)
+  {
+    arma::mat sum;
+    GradientSumWithCutoff(sum);
+    gradient = -2 * coordinates * sum;
+    return;
+  }
+
   // Now, we handle the summation over i:
   //   sum_i (p_i sum_k (p_ik x_ik x_ik^T) -
   //       sum_{j in class of i} (p_ij x_ij x_ij^T)
@@ -132,68 +168,82 @@ void SoftmaxErrorFunction<MetricType>::Gradient(const arma::mat& coordinates,
                                                 const size_t i,
                                                 arma::mat& gradient)
 {
-  // We will need to calculate p_i before this evaluation is done, so these two
-  // variables will hold the information necessary for that.
-  double numerator = 0;
-  double denominator = 0;
-
-  // The gradient involves two matrix terms which are eventually combined into
-  // one.
-  arma::mat firstTerm;
-  arma::mat secondTerm;
-
-  firstTerm.zeros(coordinates.n_rows, coordinates.n_cols);
-  secondTerm.zeros(coordinates.n_rows, coordinates.n_cols);
+  Gradient(coordinates, i, gradient, 1);
+}
 
+//! The separable implementation on a batch of points.
+template<typename MetricType>
+void SoftmaxErrorFunction<MetricType>::Gradient(const arma::mat& coordinates,
+                                                const size_t begin,
+                                                arma::mat& gradient,
+                                                const size_t batchSize)
+{
   // Compute the stretched dataset.
   stretchedDataset = coordinates * dataset;
 
-  for (size_t k = 0; k < dataset.n_cols; ++k)
+  // For each point i, the gradient is
+  //   -2 A (p_i sum_k (p_ik x_ik x_ik^T) - sum_{k in class of i} (p_ik x_ik
+  //       x_ik^T)),
+  // which is -2 A sum_k (w_ik x_ik x_ik^T) for the weights
+  //   w_ik = (p_i - 1) p_ik   if k is in the class of i,
+  //   w_ik = p_i p_ik         otherwise.
+  // The weighted outer products are summed over the whole batch with one
+  // matrix product per point.  For x_ik we are not using stretched points.
+  arma::mat sum;
+  sum.zeros(dataset.n_rows, dataset.n_rows);
+  arma::vec weights(dataset.n_cols);
+  arma::mat differences;
+  for (size_t i = begin; i < begin + batchSize; ++i)
   {
-    // Don't consider the case where the points are the same.
-    if (i == k)
-      continue;
+    // We will need to calculate p_i before the weights are known.
+    double numerator = 0;
+    double denominator = 0;
+
+    for (size_t k = 0; k < dataset.n_cols; ++k)
+    {
+      // Don't consider the case where the points are the same.
+      if (i == k)
+      {
+        weights[k] = 0;
+        continue;
+      }
+
+      // Calculate the numerator of p_ik.
+      const double eval = exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
+                                               stretchedDataset.unsafe_col(k)));
+      weights[k] = eval;
 
-    // Calculate the numerator of p_ik.
-    double eval = exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
-                                       stretchedDataset.unsafe_col(k)));
+      if (labels[i] == labels[k])
+        numerator += eval;
+      denominator += eval;
+    }
 
-    // If the points are in the same class, we must add to the second term of
-    // the gradient as well as the numerator of p_i.  We will divide by the
-    // denominator of p_ik later.  For x_ik we are not using stretched points.
-    arma::vec x_ik = dataset.col(i) - dataset.col(k);
-    if (labels[i] == labels[k])
+    if (denominator == 0)
     {
-      numerator += eval;
-      secondTerm += eval * x_ik * trans(x_ik);
+      Log::Warn << "Denominator of p_" << i << " is 0!" << std::endl;
+      // If the denominator is zero, then all p_ik should be zero and there is
+      // no gradient contribution from this point.
+      continue;
     }
 
-    // We always have to add to the denominator of p_i and the first term of the
-    // gradient computation.  We will divide by the denominator of p_ik later.
-    denominator += eval;
-    firstTerm += eval * x_ik * trans(x_ik);
-  }
+    // Calculate p_i, and then the weights.
+    const double p = numerator / denominator;
+    for (size_t k = 0; k < dataset.n_cols; ++k)
+    {
+      if (labels[i] == labels[k])
+        weights[k] *= (p - 1) / denominator;
+      else
+        weights[k] *= p / denominator;
+    }
 
-  // Calculate p_i.
-  double p = 0;
-  if (denominator == 0)
-  {
-    Log::Warn << "Denominator of p_" << i << " is 0!" << std::endl;
-    // If the denominator is zero, then all p_ik should be zero and there is
-    // no gradient contribution from this point.
-    gradient.zeros(coordinates.n_rows, coordinates.n_rows);
-    return;
-  }
-  else
-  {
-    p = numerator / denominator;
-    firstTerm /= denominator;
-    secondTerm /= denominator;
+    differences = dataset;
+    differences.each_col() -= dataset.col(i);
+    sum += differences * arma::diagmat(weights) * arma::trans(differences);
   }
 
-  // Now multiply the first term by p_i, and add the two together and multiply
-  // all by 2 * A.  We negate it though, because our optimizer is a minimizer.
-  gradient = -2 * coordinates * (p * firstTerm - secondTerm);
+  // Multiply by 2 * A.  We negate it though, because our optimizer is a
+  // minimizer.
+  gradient = -2 * coordinates * sum;
 }
 
 template<typename MetricType>
@@ -211,38 +261,47 @@ void SoftmaxErrorFunction<MetricType>::Precalculate(
 
   // Make sure the calculation is necessary.
   if ((accu(coordinates == lastCoordinates) == coordinates.n_elem) &&
-      precalculated)
+      precalculated && (cutoff == lastCutoff))
     return; // No need to calculate; we already have this stuff saved.
 
   // Coordinates are different; save the new ones, and stretch the dataset.
   lastCoordinates = coordinates;
+  lastCutoff = cutoff;
   stretchedDataset = coordinates * dataset;
 
   // For each point i, we must evaluate the softmax function:
   //   p_ij = exp( -K(x_i, x_j) ) / ( sum_{k != i} ( exp( -K(x_i, x_k) )))
   //   p_i = sum_{j in class of i} p_ij
   // We will do this by keeping track of the denominators for each i as well as
-  // the numerators (the sum for all j in class of i).  This will be on the
-  // order of O((n * (n + 1)) / 2), which really isn't all that great.
+  // the numerators (the sum for all j in class of i).  Without a cutoff, this
+  // will be on the order of O((n * (n + 1)) / 2), which really isn't all that
+  // great.
   p.zeros(stretchedDataset.n_cols);
   denominators.zeros(stretchedDataset.n_cols);
-  for (size_t i = 0; i < stretchedDataset.n_cols; i++)
+  if (cutoff > 0.0)
+  {
+    PrecalculateWithCutoff();
+  }
+  else
   {
-    for (size_t j = (i + 1); j < stretchedDataset.n_cols; j++)
+    for (size_t i = 0; i < stretchedDataset.n_cols; i++)
     {
-      // Evaluate exp(-d(x_i, x_j)).
-      double eval = exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
-                                         stretchedDataset.unsafe_col(j)));
-
-      // Add this to the denominators of both p_i and p_j: K(i, j) = K(j, i).
-      denominators[i] += eval;
-      denominators[j] += eval;
-
-      // If i and j are the same class, add to numerator of both.
-      if (labels[i] == labels[j])
+      for (size_t j = (i + 1); j < stretchedDataset.n_cols; j++)
       {
-        p[i] += eval;
-        p[j] += eval;
+        // Evaluate exp(-d(x_i, x_j)).
+        double eval = exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
+                                           stretchedDataset.unsafe_col(j)));
+
+        // Add this to the denominators of both p_i and p_j: K(i, j) = K(j, i).
+        denominators[i] += eval;
+        denominators[j] += eval;
+
+        // If i and j are the same class, add to numerator of both.
+        if (labels[i] == labels[j])
+        {
+          p[i] += eval;
+          p[j] += eval;
+        }
       }
     }
   }
@@ -267,6 +326,108 @@ void SoftmaxErrorFunction<MetricType>::Precalculate(
   precalculated = true;
 }
 
+template<typename MetricType>
+void SoftmaxErrorFunction<MetricType>::PrecalculateWithCutoff()
+{
+  // The constructor checks this too, but the cutoff may have been set since
+  // with Cutoff().
+  if (!boost::is_same<MetricType, metric::SquaredEuclideanDistance>::value)
+  {
+    Log::Fatal << "SoftmaxErrorFunction: a cutoff can only be used with the "
+        << "squared Euclidean distance." << std::endl;
+  }
+
+  // Find the pairs of points within the cutoff with a range search on the
+  // stretched dataset.  The range search uses the Euclidean distance, not the
+  // squared Euclidean distance, so the range is [0, sqrt(cutoff)].  The tree is
+  // rebuilt for each new set of coordinates, which takes O(n log n) time.
+  range::RangeSearch<> rangeSearch(stretchedDataset);
+  rangeSearch.Search(math::Range(0.0, std::sqrt(cutoff)), neighbors,
+      neighborEvals);
+
+  // Turn the distances into exp(-d(x_i, x_j)), and sum them into the numerator
+  // and denominator of p_i.  Each point has its own list of neighbors (the
+  // lists are symmetric), so the points can be handled in parallel.
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (size_t i = 0; i < stretchedDataset.n_cols; ++i)
+  {
+    for (size_t j = 0; j < neighbors[i].size(); ++j)
+    {
+      const double distance = neighborEvals[i][j];
+      const double eval = std::exp(-distance * distance);
+      neighborEvals[i][j] = eval;
+
+      denominators[i] += eval;
+      if (labels[i] == labels[neighbors[i][j]])
+        p[i] += eval;
+    }
+  }
+}
+
+template<typename MetricType>
+void SoftmaxErrorFunction<MetricType>::GradientSumWithCutoff(arma::mat& sum)
+    const
+{
+  // This is the same sum as in the non-separable Gradient(), but instead of
+  // adding the terms for i and k together for each pair, we add the terms for
+  // each point i and each of its neighbors k:
+  //   ((p_i - 1) p_ik) x_ik x_ik^T   if class of i is the same as class of k,
+  //   (p_i p_ik) x_ik x_ik^T         otherwise.
+  // Each thread sums over its own points; the sums are added in thread order at
+  // the end, so that the result is deterministic for a given number of
+  // threads.
+#ifdef _OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+  std::vector<arma::mat> threadSums(numThreads,
+      arma::zeros<arma::mat>(dataset.n_rows, dataset.n_rows));
+
+  #pragma omp parallel num_threads(numThreads)
+  {
+#ifdef _OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+    arma::mat& localSum = threadSums[thread];
+
+    arma::mat differences;
+    arma::vec weights;
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+    {
+      // Points with no neighbors within the cutoff have p_i = 0.
+      const size_t numNeighbors = neighbors[i].size();
+      if (numNeighbors == 0)
+        continue;
+
+      // We are not using stretched points here.
+      differences.set_size(dataset.n_rows, numNeighbors);
+      weights.set_size(numNeighbors);
+      for (size_t j = 0; j < numNeighbors; ++j)
+      {
+        const size_t k = neighbors[i][j];
+        differences.col(j) = dataset.col(k) - dataset.col(i);
+
+        const double p_ik = neighborEvals[i][j] / denominators[i];
+        if (labels[i] == labels[k])
+          weights[j] = (p[i] - 1) * p_ik;
+        else
+          weights[j] = p[i] * p_ik;
+      }
+
+      localSum += differences * arma::diagmat(weights) *
+          arma::trans(differences);
+    }
+  }
+
+  sum = threadSums[0];
+  for (size_t t = 1; t < numThreads; ++t)
+    sum += threadSums[t];
+}
+
 template<typename MetricType>
 std::string SoftmaxErrorFunction<MetricType>::ToString() const{
   std::ostringstream convert;
@@ -37,11 +37,15 @@ PROGRAM_INFO("All K-Furthest-Neighbors",
     "neighbors output file corresponds to the index of the point in the "
     "reference set which is the i'th furthest neighbor from the point in the "
     "query set with index j.  Row i and column j in the distances output file "
-    "corresponds to the distance between those two points.");
+    "corresponds to the distance between those two points."
+    "\n\n"
+    "The kd-tree built on the reference set can be saved with "
+    "--save_tree_file, and loaded in later runs with --tree_file instead of "
+    "being built again.");
 
 // Define our input parameters that this program will take.
-PARAM_STRING_REQ("reference_file", "File containing the reference dataset.",
-    "r");
+PARAM_STRING("reference_file", "File containing the reference dataset "
+    "(required, unless --tree_file is given).", "r", "");
 PARAM_INT_REQ("k", "Number of furthest neighbors to find.", "k");
 PARAM_STRING_REQ("distances_file", "File to output distances into.", "d");
 PARAM_STRING_REQ("neighbors_file", "File to output neighbors into.", "n");
@@ -54,6 +58,16 @@ PARAM_FLAG("single_mode", "If true, single-tree search is used (as opposed to "
     "dual-tree search).", "s");
 PARAM_FLAG("r_tree", "If true, use an R-Tree to perform the search "
     "(experimental, may be slow.).", "T");
+PARAM_INT("threads", "Number of threads to use for tree-based search (only "
+    "effective if mlpack was compiled with OpenMP).", "t", 1);
+PARAM_STRING("tree_file", "File containing a reference tree saved with "
+    "--save_tree_file; the tree is loaded instead of being built.", "f", "");
+PARAM_STRING("save_tree_file", "If specified, the reference kd-tree is saved "
+    "to this file, for use with --tree_file.", "F", "");
+
+// The type of tree used for kd-tree search.
+typedef BinarySpaceTree<bound::HRectBound<2>,
+    NeighborSearchStat<FurthestNeighborSort> > TreeType;
 
 int main(int argc, char *argv[])
 {
@@ -73,20 +87,62 @@ int main(int argc, char *argv[])
   bool naive = CLI::HasParam("naive");
   bool singleMode = CLI::HasParam("single_mode");
 
+  const string treeFile = CLI::GetParam<string>("tree_file");
+  const string saveTreeFile = CLI::GetParam<string>("save_tree_file");
+
+  if (referenceFile == "" && treeFile == "")
+    Log::Fatal << "Either --reference_file or --tree_file must be given!" << endl;
+
+  // A saved tree holds its own (reordered) reference set, and it is a kd-tree
+  // built on the original points.
+  if ((treeFile != "" || saveTreeFile != "") &&
+      (naive || CLI::HasParam("r_tree")))
+  {
+    Log::Fatal << "--tree_file and --save_tree_file cannot be used with "
+        << "--naive or --r_tree." << endl;
+  }
+
   arma::mat referenceData;
   arma::mat queryData; // So it doesn't go out of scope.
-  data::Load(referenceFile, referenceData, true);
+  MappedTree<TreeType>* mappedTree = NULL;
+  if (treeFile != "")
+  {
+    if (referenceFile != "")
+      Log::Warn << "--reference_file ignored because --tree_file is given."
+          << endl;
+    // The saved tree keeps the leaf size it was built with; --leaf_size still
+    // applies to a query tree.
+    if (CLI::HasParam("leaf_size"))
+      Log::Warn << "--leaf_size ignored for the reference tree because "
+          << "--tree_file is given." << endl;
+
+    Timer::Start("tree_loading");
+    mappedTree = new MappedTree<TreeType>(treeFile);
+    Timer::Stop("tree_loading");
+
+    Log::Info << "Loaded reference tree from '" << treeFile << "' ("
+        << mappedTree->Dataset().n_rows << " x "
+        << mappedTree->Dataset().n_cols << ")." << endl;
+  }
+  else
+  {
+    data::Load(referenceFile, referenceData, true);
+
+    Log::Info << "Loaded reference data from '" << referenceFile << "' ("
+        << referenceData.n_rows << " x " << referenceData.n_cols << ")."
+        << endl;
+  }
 
-  Log::Info << "Loaded reference data from '" << referenceFile << "' ("
-      << referenceData.n_rows << " x " << referenceData.n_cols << ")." << endl;
+  const size_t numReferences = (mappedTree != NULL) ?
+      mappedTree->Dataset().n_cols : referenceData.n_cols;
 
   // Sanity check on k value: must be greater than 0, must be less than the
   // number of reference points.
-  if (k > referenceData.n_cols)
+  if (k > numReferences)
   {
     Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less ";
     Log::Fatal << "than or equal to the number of reference points (";
-    Log::Fatal << referenceData.n_cols << ")." << endl;
+    Log::Fatal << numReferences << ")." << endl;
   }
 
   // Sanity check on leaf size.
@@ -97,6 +153,14 @@ int main(int argc, char *argv[])
   }
   size_t leafSize = lsInt;
 
+  // Sanity check on the number of threads.
+  if (CLI::GetParam<int>("threads") < 1)
+  {
+    Log::Fatal << "Invalid number of threads: " << CLI::GetParam<int>("threads")
+        << ".  Must be greater than 0." << endl;
+  }
+  const size_t threads = (size_t) CLI::GetParam<int>("threads");
+
   // Naive mode overrides single mode.
   if (singleMode && naive)
   {
@@ -116,18 +180,37 @@ int main(int argc, char *argv[])
     std::vector<size_t> oldFromNewRefs;
 
     // Build trees by hand, so we can save memory: if we pass a tree to
-    // NeighborSearch, it does not copy the matrix.
-    Log::Info << "Building reference tree..." << endl;
-    Timer::Start("reference_tree_building");
+    // NeighborSearch, it does not copy the matrix.  If the reference tree was
+    // saved, it is used directly.
+    TreeType* refTree = NULL;
+    if (mappedTree != NULL)
+    {
+      refTree = &mappedTree->Tree();
+    }
+    else
+    {
+      Log::Info << "Building reference tree..." << endl;
+      Timer::Start("reference_tree_building");
+
+      refTree = new TreeType(referenceData, oldFromNewRefs, leafSize);
 
-    BinarySpaceTree<bound::HRectBound<2>,
-        NeighborSearchStat<FurthestNeighborSort> >
-        refTree(referenceData, oldFromNewRefs, leafSize);
-    BinarySpaceTree<bound::HRectBound<2>,
-        NeighborSearchStat<FurthestNeighborSort> >*
-        queryTree = NULL; // Empty for now.
+      Timer::Stop("reference_tree_building");
+    }
+
+    const arma::mat& references = (mappedTree != NULL) ?
+        mappedTree->Dataset() : referenceData;
+    const std::vector<size_t>& refMapping = (mappedTree != NULL) ?
+        mappedTree->OldFromNew() : oldFromNewRefs;
 
-    Timer::Stop("reference_tree_building");
+    if (saveTreeFile != "")
+    {
+      Log::Info << "Saving reference tree to '" << saveTreeFile << "'..."
+          << endl;
+      if (!MappedTree<TreeType>::Save(*refTree, refMapping, saveTreeFile))
+        Log::Fatal << "Could not save reference tree!" << endl;
+    }
+
+    TreeType* queryTree = NULL; // Empty for now.
 
     std::vector<size_t> oldFromNewQueries;
 
@@ -149,25 +232,24 @@ int main(int argc, char *argv[])
       // NeighborSearch, it does not copy the matrix.
       Timer::Start("query_tree_building");
 
-      queryTree = new BinarySpaceTree<bound::HRectBound<2>,
-          NeighborSearchStat<FurthestNeighborSort> >(queryData, oldFromNewQueries,
-          leafSize);
+      queryTree = new TreeType(queryData, oldFromNewQueries, leafSize);
 
       Timer::Stop("query_tree_building");
 
-      allkfn = new AllkFN(&refTree, queryTree, referenceData, queryData,
+      allkfn = new AllkFN(refTree, queryTree, references, queryData,
           singleMode);
 
       Log::Info << "Tree built." << endl;
     }
     else
     {
-      allkfn = new AllkFN(&refTree, referenceData, singleMode);
+      allkfn = new AllkFN(refTree, references, singleMode);
 
       Log::Info << "Trees built." << endl;
     }
 
     Log::Info << "Computing " << k << " furthest neighbors..." << endl;
+    allkfn->NumThreads() = threads;
     allkfn->Search(k, neighbors, distances);
 
     Log::Info << "Neighbors computed." << endl;
@@ -181,12 +263,12 @@ int main(int argc, char *argv[])
 
     // Map the points back to their original locations.
     if ((CLI::GetParam<string>("query_file") != "") && !singleMode)
-      Unmap(neighbors, distances, oldFromNewRefs, oldFromNewQueries, neighborsOut,
+      Unmap(neighbors, distances, refMapping, oldFromNewQueries, neighborsOut,
           distancesOut);
     else if ((CLI::GetParam<string>("query_file") != "") && singleMode)
-      Unmap(neighbors, distances, oldFromNewRefs, neighborsOut, distancesOut);
+      Unmap(neighbors, distances, refMapping, neighborsOut, distancesOut);
     else
-      Unmap(neighbors, distances, oldFromNewRefs, oldFromNewRefs, neighborsOut,
+      Unmap(neighbors, distances, refMapping, refMapping, neighborsOut,
           distancesOut);
 
     // Clean up.
@@ -194,6 +276,11 @@ int main(int argc, char *argv[])
       delete queryTree;
 
     delete allkfn;
+
+    if (mappedTree)
+      delete mappedTree;
+    else
+      delete refTree;
     
       // Save output.
   data::Save(distancesFile, distancesOut);
@@ -273,6 +360,7 @@ int main(int argc, char *argv[])
     //arma::Mat<size_t> neighborsOut;
     
     Log::Info << "Computing " << k << " nearest neighbors..." << endl;
+    allkfn->NumThreads() = threads;
     allkfn->Search(k, neighbors, distances);
     
     Log::Info << "Neighbors computed." << endl;
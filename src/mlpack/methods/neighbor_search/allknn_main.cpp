@@ -39,11 +39,21 @@ PROGRAM_INFO("All K-Nearest-Neighbors",
     "neighbors output file corresponds to the index of the point in the "
     "reference set which is the i'th nearest neighbor from the point in the "
     "query set with index j.  Row i and column j in the distances output file "
-    "corresponds to the distance between those two points.");
+    "corresponds to the distance between those two points."
+    "\n\n"
+    "Building the reference tree can take a long time for large reference "
+    "sets.  With --save_tree_file, the kd-tree built on the reference set is "
+    "saved (along with the reference set itself) so that later runs can load "
+    "it with --tree_file instead of building it again:"
+    "\n\n"
+    "$ allknn --k=5 --reference_file=input.csv --save_tree_file=input.tree\n"
+    "  --distances_file=distances.csv --neighbors_file=neighbors.csv\n"
+    "$ allknn --k=5 --tree_file=input.tree --query_file=queries.csv\n"
+    "  --distances_file=distances.csv --neighbors_file=neighbors.csv");
 
 // Define our input parameters that this program will take.
-PARAM_STRING_REQ("reference_file", "File containing the reference dataset.",
-    "r");
+PARAM_STRING("reference_file", "File containing the reference dataset "
+    "(required, unless --tree_file is given).", "r", "");
 PARAM_STRING_REQ("distances_file", "File to output distances into.", "d");
 PARAM_STRING_REQ("neighbors_file", "File to output neighbors into.", "n");
 
@@ -62,6 +72,16 @@ PARAM_FLAG("r_tree", "If true, use an R-Tree to perform the search "
 PARAM_FLAG("random_basis", "Before tree-building, project the data onto a "
     "random orthogonal basis.", "R");
 PARAM_INT("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
+PARAM_INT("threads", "Number of threads to use for tree-based search (only "
+    "effective if mlpack was compiled with OpenMP).", "t", 1);
+PARAM_STRING("tree_file", "File containing a reference tree saved with "
+    "--save_tree_file; the tree is loaded instead of being built.", "f", "");
+PARAM_STRING("save_tree_file", "If specified, the reference kd-tree is saved "
+    "to this file, for use with --tree_file.", "F", "");
+
+// The type of tree used for kd-tree search.
+typedef BinarySpaceTree<bound::HRectBound<2>,
+    NeighborSearchStat<NearestNeighborSort> > TreeType;
 
 int main(int argc, char *argv[])
 {
@@ -80,6 +100,9 @@ int main(int argc, char *argv[])
   const string distancesFile = CLI::GetParam<string>("distances_file");
   const string neighborsFile = CLI::GetParam<string>("neighbors_file");
 
+  const string treeFile = CLI::GetParam<string>("tree_file");
+  const string saveTreeFile = CLI::GetParam<string>("save_tree_file");
+
   int lsInt = CLI::GetParam<int>("leaf_size");
 
   size_t k = CLI::GetParam<int>("k");
@@ -88,12 +111,60 @@ int main(int argc, char *argv[])
   bool singleMode = CLI::HasParam("single_mode");
   const bool randomBasis = CLI::HasParam("random_basis");
 
+  if (referenceFile == "" && treeFile == "")
+    Log::Fatal << "Either --reference_file or --tree_file must be given!" << endl;
+
+  // A saved tree holds its own (reordered) reference set, and it is a kd-tree
+  // built on the original points.
+  if (treeFile != "")
+  {
+    if (referenceFile != "")
+      Log::Warn << "--reference_file ignored because --tree_file is given."
+          << endl;
+    // The saved tree keeps the leaf size it was built with; --leaf_size still
+    // applies to a query tree.
+    if (CLI::HasParam("leaf_size"))
+      Log::Warn << "--leaf_size ignored for the reference tree because "
+          << "--tree_file is given." << endl;
+    if (naive || CLI::HasParam("cover_tree") || CLI::HasParam("r_tree") ||
+        randomBasis)
+    {
+      Log::Fatal << "--tree_file cannot be used with --naive, --cover_tree, "
+          << "--r_tree, or --random_basis." << endl;
+    }
+  }
+
+  if (saveTreeFile != "" && (naive || CLI::HasParam("cover_tree") ||
+      CLI::HasParam("r_tree") || randomBasis))
+  {
+    Log::Fatal << "--save_tree_file cannot be used with --naive, --cover_tree, "
+        << "--r_tree, or --random_basis." << endl;
+  }
+
   arma::mat referenceData;
   arma::mat queryData; // So it doesn't go out of scope.
-  data::Load(referenceFile, referenceData, true);
+  MappedTree<TreeType>* mappedTree = NULL;
+  if (treeFile != "")
+  {
+    Timer::Start("tree_loading");
+    mappedTree = new MappedTree<TreeType>(treeFile);
+    Timer::Stop("tree_loading");
+
+    Log::Info << "Loaded reference tree from '" << treeFile << "' ("
+        << mappedTree->Dataset().n_rows << " x "
+        << mappedTree->Dataset().n_cols << ")." << endl;
+  }
+  else
+  {
+    data::Load(referenceFile, referenceData, true);
 
-  Log::Info << "Loaded reference data from '" << referenceFile << "' ("
-      << referenceData.n_rows << " x " << referenceData.n_cols << ")." << endl;
+    Log::Info << "Loaded reference data from '" << referenceFile << "' ("
+        << referenceData.n_rows << " x " << referenceData.n_cols << ")."
+        << endl;
+  }
+
+  const size_t numReferences = (mappedTree != NULL) ?
+      mappedTree->Dataset().n_cols : referenceData.n_cols;
 
   if (queryFile != "")
   {
@@ -104,11 +175,11 @@ int main(int argc, char *argv[])
 
   // Sanity check on k value: must be greater than 0, must be less than the
   // number of reference points.  Since it is unsigned, we only test the upper bound.
-  if (k > referenceData.n_cols)
+  if (k > numReferences)
   {
     Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less ";
     Log::Fatal << "than or equal to the number of reference points (";
-    Log::Fatal << referenceData.n_cols << ")." << endl;
+    Log::Fatal << numReferences << ")." << endl;
   }
 
   // Sanity check on leaf size.
@@ -119,6 +190,14 @@ int main(int argc, char *argv[])
   }
   size_t leafSize = lsInt;
 
+  // Sanity check on the number of threads.
+  if (CLI::GetParam<int>("threads") < 1)
+  {
+    Log::Fatal << "Invalid number of threads: " << CLI::GetParam<int>("threads")
+        << ".  Must be greater than 0." << endl;
+  }
+  const size_t threads = (size_t) CLI::GetParam<int>("threads");
+
   // Naive mode overrides single mode.
   if (singleMode && naive)
   {
@@ -185,18 +264,37 @@ int main(int argc, char *argv[])
       std::vector<size_t> oldFromNewRefs;
 
       // Build trees by hand, so we can save memory: if we pass a tree to
-      // NeighborSearch, it does not copy the matrix.
-      Log::Info << "Building reference tree..." << endl;
-      Timer::Start("tree_building");
+      // NeighborSearch, it does not copy the matrix.  If the reference tree
+      // was saved, it is used directly.
+      TreeType* refTree = NULL;
+      if (mappedTree != NULL)
+      {
+        refTree = &mappedTree->Tree();
+      }
+      else
+      {
+        Log::Info << "Building reference tree..." << endl;
+        Timer::Start("tree_building");
 
-      BinarySpaceTree<bound::HRectBound<2>,
-	  NeighborSearchStat<NearestNeighborSort> >
-	  refTree(referenceData, oldFromNewRefs, leafSize);
-      BinarySpaceTree<bound::HRectBound<2>,
-	  NeighborSearchStat<NearestNeighborSort> >*
-	  queryTree = NULL; // Empty for now.
+        refTree = new TreeType(referenceData, oldFromNewRefs, leafSize);
 
-      Timer::Stop("tree_building");
+        Timer::Stop("tree_building");
+      }
+
+      const arma::mat& references = (mappedTree != NULL) ?
+          mappedTree->Dataset() : referenceData;
+      const std::vector<size_t>& refMapping = (mappedTree != NULL) ?
+          mappedTree->OldFromNew() : oldFromNewRefs;
+
+      if (saveTreeFile != "")
+      {
+        Log::Info << "Saving reference tree to '" << saveTreeFile << "'..."
+            << endl;
+        if (!MappedTree<TreeType>::Save(*refTree, refMapping, saveTreeFile))
+          Log::Fatal << "Could not save reference tree!" << endl;
+      }
+
+      TreeType* queryTree = NULL; // Empty for now.
 
       std::vector<size_t> oldFromNewQueries;
 
@@ -216,21 +314,19 @@ int main(int argc, char *argv[])
 	{
 	  Timer::Start("tree_building");
 
-	  queryTree = new BinarySpaceTree<bound::HRectBound<2>,
-	      NeighborSearchStat<NearestNeighborSort> >(queryData,
-	      oldFromNewQueries, leafSize);
+	  queryTree = new TreeType(queryData, oldFromNewQueries, leafSize);
 
 	  Timer::Stop("tree_building");
 	}
 
-	allknn = new AllkNN(&refTree, queryTree, referenceData, queryData,
+	allknn = new AllkNN(refTree, queryTree, references, queryData,
 	    singleMode);
 
 	Log::Info << "Tree built." << endl;
       }
       else
       {
-	allknn = new AllkNN(&refTree, referenceData, singleMode);
+	allknn = new AllkNN(refTree, references, singleMode);
 
 	Log::Info << "Trees built." << endl;
       }
@@ -239,6 +335,7 @@ int main(int argc, char *argv[])
       arma::Mat<size_t> neighborsOut;
 
       Log::Info << "Computing " << k << " nearest neighbors..." << endl;
+      allknn->NumThreads() = threads;
       allknn->Search(k, neighborsOut, distancesOut);
 
       Log::Info << "Neighbors computed." << endl;
@@ -249,12 +346,12 @@ int main(int argc, char *argv[])
 
       // Map the results back to the correct places.
       if ((CLI::GetParam<string>("query_file") != "") && !singleMode)
-	Unmap(neighborsOut, distancesOut, oldFromNewRefs, oldFromNewQueries,
+	Unmap(neighborsOut, distancesOut, refMapping, oldFromNewQueries,
 	    neighbors, distances);
       else if ((CLI::GetParam<string>("query_file") != "") && singleMode)
-	Unmap(neighborsOut, distancesOut, oldFromNewRefs, neighbors, distances);
+	Unmap(neighborsOut, distancesOut, refMapping, neighbors, distances);
       else
-	Unmap(neighborsOut, distancesOut, oldFromNewRefs, oldFromNewRefs,
+	Unmap(neighborsOut, distancesOut, refMapping, refMapping,
 	    neighbors, distances);
 
       // Clean up.
@@ -262,6 +359,11 @@ int main(int argc, char *argv[])
 	delete queryTree;
 
       delete allknn;
+
+      if (mappedTree)
+        delete mappedTree;
+      else
+        delete refTree;
     } else { // R tree.
       // Make sure to notify the user that they are using an r tree.
       Log::Info << "Using R tree for nearest-neighbor calculation." << endl;
@@ -333,6 +435,7 @@ int main(int argc, char *argv[])
       //arma::Mat<size_t> neighborsOut;
 
       Log::Info << "Computing " << k << " nearest neighbors..." << endl;
+      allknn->NumThreads() = threads;
       allknn->Search(k, neighbors, distances);
 
       Log::Info << "Neighbors computed." << endl;
@@ -389,6 +492,7 @@ int main(int argc, char *argv[])
     }
 
     Log::Info << "Computing " << k << " nearest neighbors..." << endl;
+    allknn->NumThreads() = threads; // Cover trees are searched serially.
     allknn->Search(k, neighbors, distances);
 
     Log::Info << "Neighbors computed." << endl;
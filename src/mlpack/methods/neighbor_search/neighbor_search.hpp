@@ -206,6 +206,18 @@ class NeighborSearch
   //! Modify the number of node combination scores.
   size_t& Scores() { return scores; }
 
+  //! Get the number of threads used for tree-based search.
+  size_t NumThreads() const { return numThreads; }
+  /**
+   * Modify the number of threads used for tree-based search.  If this is
+   * greater than 1 and mlpack was compiled with OpenMP, single-tree search is
+   * split over query points and dual-tree search is split over disjoint query
+   * subtrees, each with its own NeighborSearchRules object.  The returned
+   * distances are the same as those of the serial search.  Trees with self
+   * children (i.e. the cover tree) are always searched serially.
+   */
+  size_t& NumThreads() { return numThreads; }
+
  private:
   //! Copy of reference dataset (if we need it, because tree building modifies
   //! it).
@@ -246,6 +258,25 @@ class NeighborSearch
   //! The total number of scores (applicable for non-naive search).
   size_t scores;
 
+  //! The number of threads to use for tree-based search.
+  size_t numThreads;
+
+  /**
+   * Perform single-tree search in parallel over the query points, storing the
+   * results in the given matrices (which must already be initialized).
+   */
+  void ParallelSingleTreeSearch(arma::Mat<size_t>& neighbors,
+                                arma::mat& distances);
+
+  /**
+   * Perform dual-tree search in parallel.  The query tree is split into
+   * disjoint subtrees, and each subtree is traversed against the whole
+   * reference tree by its own traverser.  The results are stored in the given
+   * matrices (which must already be initialized).
+   */
+  void ParallelDualTreeSearch(arma::Mat<size_t>& neighbors,
+                              arma::mat& distances);
+
 }; // class NeighborSearch
 
 }; // namespace neighbor
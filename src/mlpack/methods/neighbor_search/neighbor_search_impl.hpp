@@ -59,7 +59,8 @@ NeighborSearch(const typename TreeType::Mat& referenceSetIn,
     singleMode(!naive && singleMode), // No single mode if naive.
     metric(metric),
     baseCases(0),
-    scores(0)
+    scores(0),
+    numThreads(1)
 {
   // C++11 will allow us to call out to other constructors so we can avoid this
   // copypasta problem.
@@ -112,7 +113,8 @@ NeighborSearch(const typename TreeType::Mat& referenceSetIn,
     singleMode(!naive && singleMode), // No single mode if naive.
     metric(metric),
     baseCases(0),
-    scores(0)
+    scores(0),
+    numThreads(1)
 {
   // We'll time tree building, but only if we are building trees.
   Timer::Start("tree_building");
@@ -158,7 +160,8 @@ NeighborSearch<SortPolicy, MetricType, TreeType>::NeighborSearch(
     singleMode(singleMode),
     metric(metric),
     baseCases(0),
-    scores(0)
+    scores(0),
+    numThreads(1)
 {
   // Nothing else to initialize.
 }
@@ -180,7 +183,8 @@ NeighborSearch<SortPolicy, MetricType, TreeType>::NeighborSearch(
     singleMode(singleMode),
     metric(metric),
     baseCases(0),
-    scores(0)
+    scores(0),
+    numThreads(1)
 {
   Timer::Start("tree_building");
 
@@ -266,18 +270,31 @@ void NeighborSearch<SortPolicy, MetricType, TreeType>::Search(
     // If this is the case, it is suggested that you use the naive method.
     Log::Assert(!(referenceTree->IsLeaf()));
 
-    // Create the traverser.
-    typename TreeType::template SingleTreeTraverser<RuleType> traverser(rules);
+    if (numThreads > 1 && !tree::TreeTraits<TreeType>::HasSelfChildren)
+    {
+      ParallelSingleTreeSearch(*neighborPtr, *distancePtr);
+    }
+    else
+    {
+      // Create the traverser.
+      typename TreeType::template SingleTreeTraverser<RuleType>
+          traverser(rules);
 
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+      // Now have it traverse for each point.
+      for (size_t i = 0; i < querySet.n_cols; ++i)
+        traverser.Traverse(i, *referenceTree);
 
-    scores += rules.Scores();
-    baseCases += rules.BaseCases();
+      scores += rules.Scores();
+      baseCases += rules.BaseCases();
 
-    Log::Info << rules.Scores() << " node combinations were scored.\n";
-    Log::Info << rules.BaseCases() << " base cases were calculated.\n";
+      Log::Info << rules.Scores() << " node combinations were scored.\n";
+      Log::Info << rules.BaseCases() << " base cases were calculated.\n";
+    }
+  }
+  else if (numThreads > 1 && !tree::TreeTraits<TreeType>::HasSelfChildren)
+  {
+    // Dual-tree recursion, split over query subtrees.
+    ParallelDualTreeSearch(*neighborPtr, *distancePtr);
   }
   else // Dual-tree recursion.
   {
@@ -366,6 +383,111 @@ void NeighborSearch<SortPolicy, MetricType, TreeType>::Search(
 } // Search
 
 
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearch<SortPolicy, MetricType, TreeType>::ParallelSingleTreeSearch(
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  typedef NeighborSearchRules<SortPolicy, MetricType, TreeType> RuleType;
+
+  // The search doesn't work if the root node is also a leaf node.
+  Log::Assert(!(referenceTree->IsLeaf()));
+
+  size_t totalScores = 0;
+  size_t totalBaseCases = 0;
+
+  // Each thread gets its own rules and traverser, so the per-query caches are
+  // never shared.  Every query point is handled by exactly one thread, and
+  // each thread only writes to the columns of the query points it handles.
+  #pragma omp parallel num_threads(numThreads) \
+      reduction(+:totalScores, totalBaseCases)
+  {
+    MetricType threadMetric(metric);
+    RuleType rules(referenceSet, querySet, neighbors, distances, threadMetric);
+    typename TreeType::template SingleTreeTraverser<RuleType> traverser(rules);
+
+    #pragma omp for schedule(dynamic, 64)
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+      traverser.Traverse(i, *referenceTree);
+
+    totalScores += rules.Scores();
+    totalBaseCases += rules.BaseCases();
+  }
+
+  scores += totalScores;
+  baseCases += totalBaseCases;
+
+  Log::Info << totalScores << " node combinations were scored.\n";
+  Log::Info << totalBaseCases << " base cases were calculated.\n";
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearch<SortPolicy, MetricType, TreeType>::ParallelDualTreeSearch(
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  typedef NeighborSearchRules<SortPolicy, MetricType, TreeType> RuleType;
+
+  // Split the query tree into disjoint subtrees.  A node is only split if it
+  // holds no points itself, so every query point belongs to exactly one
+  // subtree.  The decomposition depends only on the tree and not on the number
+  // of threads, so the results do not depend on the number of threads either.
+  // Subtrees are kept to roughly 1/256th of the query set so that the dynamic
+  // schedule below can balance the load.
+  const size_t taskSize = std::max((size_t) 1,
+      (size_t) (queryTree->NumDescendants() / 256));
+
+  std::vector<TreeType*> subtrees;
+  std::vector<TreeType*> nodes(1, queryTree);
+  while (!nodes.empty())
+  {
+    TreeType* node = nodes.back();
+    nodes.pop_back();
+
+    if (node->IsLeaf() || node->NumPoints() > 0 ||
+        node->NumDescendants() <= taskSize)
+    {
+      subtrees.push_back(node);
+    }
+    else
+    {
+      for (size_t i = 0; i < node->NumChildren(); ++i)
+        nodes.push_back(&node->Child(i));
+    }
+  }
+
+  Log::Info << "Searching " << subtrees.size() << " query subtrees with "
+      << numThreads << " threads.\n";
+
+  size_t totalScores = 0;
+  size_t totalBaseCases = 0;
+
+  // Each subtree is traversed against the entire reference tree with its own
+  // rules object.  The only shared state that is written is the columns of the
+  // neighbor and distance matrices and the statistics of the query nodes, and
+  // those are disjoint between subtrees.  The statistics of the ancestors of
+  // the subtrees are only read.
+  #pragma omp parallel for num_threads(numThreads) schedule(dynamic, 1) \
+      reduction(+:totalScores, totalBaseCases)
+  for (size_t i = 0; i < subtrees.size(); ++i)
+  {
+    MetricType threadMetric(metric);
+    RuleType rules(referenceSet, querySet, neighbors, distances, threadMetric);
+    typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
+
+    traverser.Traverse(*subtrees[i], *referenceTree);
+
+    totalScores += rules.Scores();
+    totalBaseCases += rules.BaseCases();
+  }
+
+  scores += totalScores;
+  baseCases += totalBaseCases;
+
+  Log::Info << totalScores << " node combinations were scored.\n";
+  Log::Info << totalBaseCases << " base cases were calculated.\n";
+}
+
 //Return a String of the Object.
 template<typename SortPolicy, typename MetricType, typename TreeType>
 std::string NeighborSearch<SortPolicy, MetricType, TreeType>::ToString() const
@@ -45,11 +45,15 @@ PROGRAM_INFO("Range Search",
     " resultant CSV-like files may not be loadable by many programs.  However, "
     "at this time a better way to store this non-square result is not known.  "
     "As a result, any output files will be written as CSVs in this manner, "
-    "regardless of the given extension.");
+    "regardless of the given extension."
+    "\n\n"
+    "The kd-tree built on the reference set can be saved with "
+    "--save_tree_file, and loaded in later runs with --tree_file instead of "
+    "being built again.  Trees saved by allknn and allkfn can be used too.");
 
 // Define our input parameters that this program will take.
-PARAM_STRING_REQ("reference_file", "File containing the reference dataset.",
-    "r");
+PARAM_STRING("reference_file", "File containing the reference dataset "
+    "(required, unless --tree_file is given).", "r", "");
 PARAM_STRING_REQ("distances_file", "File to output distances into.", "d");
 PARAM_STRING_REQ("neighbors_file", "File to output neighbors into.", "n");
 
@@ -64,7 +68,12 @@ PARAM_FLAG("single_mode", "If true, single-tree search is used (as opposed to "
     "dual-tree search).", "s");
 PARAM_FLAG("cover_tree", "If true, use a cover tree for range searching "
     "(instead of a kd-tree).", "c");
+PARAM_STRING("tree_file", "File containing a reference tree saved with "
+    "--save_tree_file; the tree is loaded instead of being built.", "f", "");
+PARAM_STRING("save_tree_file", "If specified, the reference kd-tree is saved "
+    "to this file, for use with --tree_file.", "F", "");
 
+typedef BinarySpaceTree<bound::HRectBound<2>, RangeSearchStat> TreeType;
 typedef RangeSearch<> RSType;
 typedef CoverTree<metric::EuclideanDistance, tree::FirstPointIsRoot,
     RangeSearchStat> CoverTreeType;
@@ -90,12 +99,48 @@ int main(int argc, char *argv[])
   const bool singleMode = CLI::HasParam("single_mode");
   bool coverTree = CLI::HasParam("cover_tree");
 
+  const string treeFile = CLI::GetParam<string>("tree_file");
+  const string saveTreeFile = CLI::GetParam<string>("save_tree_file");
+
+  if (referenceFile == "" && treeFile == "")
+    Log::Fatal << "Either --reference_file or --tree_file must be given!" << endl;
+
+  // A saved tree holds its own (reordered) reference set, and it is a kd-tree
+  // built on the original points.
+  if ((treeFile != "" || saveTreeFile != "") && (naive || coverTree))
+  {
+    Log::Fatal << "--tree_file and --save_tree_file cannot be used with "
+        << "--naive or --cover_tree." << endl;
+  }
+
   arma::mat referenceData;
   arma::mat queryData; // So it doesn't go out of scope.
-  if (!data::Load(referenceFile, referenceData))
-    Log::Fatal << "Reference file " << referenceFile << "not found." << endl;
+  MappedTree<TreeType>* mappedTree = NULL;
+  if (treeFile != "")
+  {
+    if (referenceFile != "")
+      Log::Warn << "--reference_file ignored because --tree_file is given."
+          << endl;
+    // The saved tree keeps the leaf size it was built with; --leaf_size still
+    // applies to a query tree.
+    if (CLI::HasParam("leaf_size"))
+      Log::Warn << "--leaf_size ignored for the reference tree because "
+          << "--tree_file is given." << endl;
+
+    Timer::Start("tree_loading");
+    mappedTree = new MappedTree<TreeType>(treeFile);
+    Timer::Stop("tree_loading");
+
+    Log::Info << "Loaded reference tree from '" << treeFile << "'." << endl;
+  }
+  else
+  {
+    if (!data::Load(referenceFile, referenceData))
+      Log::Fatal << "Reference file " << referenceFile << "not found." << endl;
 
-  Log::Info << "Loaded reference data from '" << referenceFile << "'." << endl;
+    Log::Info << "Loaded reference data from '" << referenceFile << "'."
+        << endl;
+  }
 
   // Sanity check on range value: max must be greater than min.
   if (max <= min)
@@ -175,16 +220,37 @@ int main(int argc, char *argv[])
     vector<size_t> oldFromNewRefs;
 
     // Build trees by hand, so we can save memory: if we pass a tree to
-    // NeighborSearch, it does not copy the matrix.
-    Log::Info << "Building reference tree..." << endl;
-    Timer::Start("tree_building");
+    // NeighborSearch, it does not copy the matrix.  If the reference tree was
+    // saved, it is used directly.
+    TreeType* refTree = NULL;
+    if (mappedTree != NULL)
+    {
+      refTree = &mappedTree->Tree();
+    }
+    else
+    {
+      Log::Info << "Building reference tree..." << endl;
+      Timer::Start("tree_building");
+
+      refTree = new TreeType(referenceData, oldFromNewRefs, leafSize);
+
+      Timer::Stop("tree_building");
+    }
+
+    const arma::mat& references = (mappedTree != NULL) ?
+        mappedTree->Dataset() : referenceData;
+    const vector<size_t>& refMapping = (mappedTree != NULL) ?
+        mappedTree->OldFromNew() : oldFromNewRefs;
 
-    BinarySpaceTree<bound::HRectBound<2>, RangeSearchStat>
-        refTree(referenceData, oldFromNewRefs, leafSize);
-    BinarySpaceTree<bound::HRectBound<2>, RangeSearchStat>*
-        queryTree = NULL; // Empty for now.
+    if (saveTreeFile != "")
+    {
+      Log::Info << "Saving reference tree to '" << saveTreeFile << "'..."
+          << endl;
+      if (!MappedTree<TreeType>::Save(*refTree, refMapping, saveTreeFile))
+        Log::Fatal << "Could not save reference tree!" << endl;
+    }
 
-    Timer::Stop("tree_building");
+    TreeType* queryTree = NULL; // Empty for now.
 
     vector<size_t> oldFromNewQueries;
 
@@ -204,19 +270,18 @@ int main(int argc, char *argv[])
       // NeighborSearch, it does not copy the matrix.
       Timer::Start("tree_building");
 
-      queryTree = new BinarySpaceTree<bound::HRectBound<2>,
-          RangeSearchStat>(queryData, oldFromNewQueries, leafSize);
+      queryTree = new TreeType(queryData, oldFromNewQueries, leafSize);
 
       Timer::Stop("tree_building");
 
-      rangeSearch = new RSType(&refTree, queryTree, referenceData, queryData,
+      rangeSearch = new RSType(refTree, queryTree, references, queryData,
           singleMode);
 
       Log::Info << "Tree built." << endl;
     }
     else
     {
-      rangeSearch = new RSType(&refTree, referenceData, singleMode);
+      rangeSearch = new RSType(refTree, references, singleMode);
 
       Log::Info << "Trees built." << endl;
     }
@@ -253,7 +318,7 @@ int main(int argc, char *argv[])
         for (size_t j = 0; j < distancesOut[i].size(); ++j)
         {
           neighbors[oldFromNewQueries[i]][j] =
-              oldFromNewRefs[neighborsOut[i][j]];
+              refMapping[neighborsOut[i][j]];
         }
       }
     }
@@ -262,13 +327,13 @@ int main(int argc, char *argv[])
       for (size_t i = 0; i < distances.size(); ++i)
       {
         // Map distances (copy a column).
-        distances[oldFromNewRefs[i]] = distancesOut[i];
+        distances[refMapping[i]] = distancesOut[i];
 
         // Map indices of neighbors.
-        neighbors[oldFromNewRefs[i]].resize(neighborsOut[i].size());
+        neighbors[refMapping[i]].resize(neighborsOut[i].size());
         for (size_t j = 0; j < distancesOut[i].size(); ++j)
         {
-          neighbors[oldFromNewRefs[i]][j] = oldFromNewRefs[neighborsOut[i][j]];
+          neighbors[refMapping[i]][j] = refMapping[neighborsOut[i][j]];
         }
       }
     }
@@ -277,6 +342,11 @@ int main(int argc, char *argv[])
     if (queryTree)
       delete queryTree;
     delete rangeSearch;
+
+    if (mappedTree)
+      delete mappedTree;
+    else
+      delete refTree;
   }
 
   // Save output.  We have to do this by hand.
@@ -46,11 +46,15 @@ PROGRAM_INFO("All K-Rank-Approximate-Nearest-Neighbors",
     "neighbors output file corresponds to the index of the point in the "
     "reference set which is the i'th nearest neighbor from the point in the "
     "query set with index j.  Row i and column j in the distances output file "
-    "corresponds to the distance between those two points.");
+    "corresponds to the distance between those two points."
+    "\n\n"
+    "With --save_tree_file, the kd-tree built on the reference set is saved "
+    "(along with the reference set itself) so that later runs can load it "
+    "with --tree_file instead of building it again.");
 
 // Define our input parameters that this program will take.
-PARAM_STRING_REQ("reference_file", "File containing the reference dataset.",
-                 "r");
+PARAM_STRING("reference_file", "File containing the reference dataset "
+             "(required, unless --tree_file is given).", "r", "");
 PARAM_STRING("distances_file", "File to output distances into.", "d", "");
 PARAM_STRING("neighbors_file", "File to output neighbors into.", "n", "");
 
@@ -76,6 +80,15 @@ PARAM_FLAG("first_leaf_exact", "The flag to trigger sampling only after "
            "exactly exploring the first leaf.", "X");
 PARAM_INT("single_sample_limit", "The limit on the maximum number of "
     "samples (and hence the largest node you can approximate).", "S", 20);
+PARAM_STRING("tree_file", "File containing a reference tree saved with "
+             "--save_tree_file; the tree is loaded instead of being built.",
+             "f", "");
+PARAM_STRING("save_tree_file", "If specified, the reference kd-tree is saved "
+             "to this file, for use with --tree_file.", "F", "");
+
+// The type of tree used for tree-based search.
+typedef BinarySpaceTree<bound::HRectBound<2, false>,
+    RAQueryStat<NearestNeighborSort> > TreeType;
 
 int main(int argc, char *argv[])
 {
@@ -88,6 +101,9 @@ int main(int argc, char *argv[])
   string distancesFile = CLI::GetParam<string>("distances_file");
   string neighborsFile = CLI::GetParam<string>("neighbors_file");
 
+  const string treeFile = CLI::GetParam<string>("tree_file");
+  const string saveTreeFile = CLI::GetParam<string>("save_tree_file");
+
   int lsInt = CLI::GetParam<int>("leaf_size");
   size_t singleSampleLimit = CLI::GetParam<int>("single_sample_limit");
 
@@ -101,27 +117,67 @@ int main(int argc, char *argv[])
   bool sampleAtLeaves = CLI::HasParam("sample_at_leaves");
   bool firstLeafExact = CLI::HasParam("first_leaf_exact");
 
+  if (referenceFile == "" && treeFile == "")
+    Log::Fatal << "Either --reference_file or --tree_file must be given!" << endl;
+
+  // A saved tree holds its own (reordered) reference set.
+  if (treeFile != "")
+  {
+    if (referenceFile != "")
+      Log::Warn << "--reference_file ignored because --tree_file is given."
+          << endl;
+    // The saved tree keeps the leaf size it was built with; --leaf_size still
+    // applies to a query tree.
+    if (CLI::HasParam("leaf_size"))
+      Log::Warn << "--leaf_size ignored for the reference tree because "
+          << "--tree_file is given." << endl;
+    if (naive || CLI::HasParam("cover_tree"))
+      Log::Fatal << "--tree_file cannot be used with --naive or --cover_tree."
+          << endl;
+  }
+
+  if (saveTreeFile != "" && (naive || CLI::HasParam("cover_tree")))
+    Log::Fatal << "--save_tree_file cannot be used with --naive or "
+        << "--cover_tree." << endl;
+
   arma::mat referenceData;
   arma::mat queryData; // So it doesn't go out of scope.
-  data::Load(referenceFile, referenceData, true);
+  MappedTree<TreeType>* mappedTree = NULL;
+  if (treeFile != "")
+  {
+    Timer::Start("tree_loading");
+    mappedTree = new MappedTree<TreeType>(treeFile);
+    Timer::Stop("tree_loading");
+
+    Log::Info << "Loaded reference tree from '" << treeFile << "' ("
+        << mappedTree->Dataset().n_rows << " x "
+        << mappedTree->Dataset().n_cols << ")." << endl;
+  }
+  else
+  {
+    data::Load(referenceFile, referenceData, true);
+
+    Log::Info << "Loaded reference data from '" << referenceFile << "' ("
+        << referenceData.n_rows << " x " << referenceData.n_cols << ")."
+        << endl;
+  }
 
-  Log::Info << "Loaded reference data from '" << referenceFile << "' ("
-      << referenceData.n_rows << " x " << referenceData.n_cols << ")." << endl;
+  const size_t numReferences = (mappedTree != NULL) ?
+      mappedTree->Dataset().n_cols : referenceData.n_cols;
 
   // Sanity check on k value: must be greater than 0, must be less than the
   // number of reference points.
-  if (k > referenceData.n_cols)
+  if (k > numReferences)
   {
     Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less ";
     Log::Fatal << "than or equal to the number of reference points (";
-    Log::Fatal << referenceData.n_cols << ")." << endl;
+    Log::Fatal << numReferences << ")." << endl;
   }
 
   // Sanity check on the value of 'tau' with respect to 'k' so that
   // 'k' neighbors are not requested from the top-'rank_error' neighbors
   // where 'rank_error' <= 'k'.
-  size_t rank_error = (size_t) ceil(tau *
-      (double) referenceData.n_cols / 100.0);
+  size_t rank_error = (size_t) ceil(tau * (double) numReferences / 100.0);
   if (rank_error <= k)
     Log::Fatal << "Invalid 'tau' (" << tau << ") - k (" << k << ") " <<
       "combination. Increase 'tau' or decrease 'k'." << endl;
@@ -182,18 +238,37 @@ int main(int argc, char *argv[])
       std::vector<size_t> oldFromNewRefs;
 
       // Build trees by hand, so we can save memory: if we pass a tree to
-      // NeighborSearch, it does not copy the matrix.
-      Log::Info << "Building reference tree..." << endl;
-      Timer::Start("tree_building");
+      // NeighborSearch, it does not copy the matrix.  If the reference tree
+      // was saved, it is used directly.
+      TreeType* refTree = NULL;
+      if (mappedTree != NULL)
+      {
+        refTree = &mappedTree->Tree();
+      }
+      else
+      {
+        Log::Info << "Building reference tree..." << endl;
+        Timer::Start("tree_building");
+
+        refTree = new TreeType(referenceData, oldFromNewRefs, leafSize);
+
+        Timer::Stop("tree_building");
+      }
 
-      BinarySpaceTree<bound::HRectBound<2, false>,
-          RAQueryStat<NearestNeighborSort> >
-          refTree(referenceData, oldFromNewRefs, leafSize);
-      BinarySpaceTree<bound::HRectBound<2, false>,
-          RAQueryStat<NearestNeighborSort> >*
-          queryTree = NULL; // Empty for now.
+      const arma::mat& references = (mappedTree != NULL) ?
+          mappedTree->Dataset() : referenceData;
+      const std::vector<size_t>& refMapping = (mappedTree != NULL) ?
+          mappedTree->OldFromNew() : oldFromNewRefs;
 
-      Timer::Stop("tree_building");
+      if (saveTreeFile != "")
+      {
+        Log::Info << "Saving reference tree to '" << saveTreeFile << "'..."
+            << endl;
+        if (!MappedTree<TreeType>::Save(*refTree, refMapping, saveTreeFile))
+          Log::Fatal << "Could not save reference tree!" << endl;
+      }
+
+      TreeType* queryTree = NULL; // Empty for now.
 
       std::vector<size_t> oldFromNewQueries;
 
@@ -215,19 +290,17 @@ int main(int argc, char *argv[])
         // NeighborSearch, it does not copy the matrix.
         Timer::Start("tree_building");
 
-        queryTree = new BinarySpaceTree<bound::HRectBound<2, false>,
-            RAQueryStat<NearestNeighborSort> >
-            (queryData, oldFromNewQueries, leafSize);
+        queryTree = new TreeType(queryData, oldFromNewQueries, leafSize);
         Timer::Stop("tree_building");
 
-        allkrann = new AllkRANN(&refTree, queryTree, referenceData, queryData,
+        allkrann = new AllkRANN(refTree, queryTree, references, queryData,
                                 singleMode);
 
         Log::Info << "Tree built." << endl;
       }
       else
       {
-        allkrann = new AllkRANN(&refTree, referenceData, singleMode);
+        allkrann = new AllkRANN(refTree, references, singleMode);
         Log::Info << "Trees built." << endl;
       }
 
@@ -258,7 +331,7 @@ int main(int argc, char *argv[])
           for (size_t j = 0; j < distancesOut.n_rows; ++j)
           {
             neighbors(j, oldFromNewQueries[i])
-              = oldFromNewRefs[neighborsOut(j, i)];
+              = refMapping[neighborsOut(j, i)];
           }
         }
       }
@@ -267,13 +340,13 @@ int main(int argc, char *argv[])
         for (size_t i = 0; i < distancesOut.n_cols; ++i)
         {
           // Map distances (copy a column).
-          distances.col(oldFromNewRefs[i]) = distancesOut.col(i);
+          distances.col(refMapping[i]) = distancesOut.col(i);
 
           // Map indices of neighbors.
           for (size_t j = 0; j < distancesOut.n_rows; ++j)
           {
-            neighbors(j, oldFromNewRefs[i])
-              = oldFromNewRefs[neighborsOut(j, i)];
+            neighbors(j, refMapping[i])
+              = refMapping[neighborsOut(j, i)];
           }
         }
       }
@@ -283,6 +356,11 @@ int main(int argc, char *argv[])
         delete queryTree;
 
       delete allkrann;
+
+      if (mappedTree)
+        delete mappedTree;
+      else
+        delete refTree;
     }
     else // Cover trees.
     {
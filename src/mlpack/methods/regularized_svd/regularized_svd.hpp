@@ -48,6 +48,10 @@ namespace svd {
  * // Use the Apply() method to get a factorization.
  * rSVD.Apply(data, rank, u, v);
  * @endcode
+ *
+ * The optimizer can be changed with the OptimizerType template parameter; for
+ * large datasets, RegularizedSVD<optimization::ParallelSGD> (see
+ * parallel_sgd.hpp) trains with all of the available cores.
  */
 
 template<
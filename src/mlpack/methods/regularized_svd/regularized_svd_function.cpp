@@ -26,6 +26,19 @@ RegularizedSVDFunction::RegularizedSVDFunction(const arma::mat& data,
 }
 
 double RegularizedSVDFunction::Evaluate(const arma::mat& parameters) const
+{
+  return Evaluate(parameters, 0, data.n_cols);
+}
+
+double RegularizedSVDFunction::Evaluate(const arma::mat& parameters,
+                                        const size_t i) const
+{
+  return Evaluate(parameters, i, 1);
+}
+
+double RegularizedSVDFunction::Evaluate(const arma::mat& parameters,
+                                        const size_t begin,
+                                        const size_t batchSize) const
 {
   // The cost for the optimization is as follows:
   //          f(u, v) = sum((rating(i, j) - u(i).t() * v(j))^2)
@@ -36,7 +49,7 @@ double RegularizedSVDFunction::Evaluate(const arma::mat& parameters) const
 
   double cost = 0.0;
 
-  for(size_t i = 0; i < data.n_cols; i++)
+  for(size_t i = begin; i < begin + batchSize; i++)
   {
     // Indices for accessing the the correct parameter columns.
     const size_t user = data(0, i);
@@ -60,30 +73,16 @@ double RegularizedSVDFunction::Evaluate(const arma::mat& parameters) const
   return cost;
 }
 
-double RegularizedSVDFunction::Evaluate(const arma::mat& parameters,
-                                        const size_t i) const
+void RegularizedSVDFunction::Gradient(const arma::mat& parameters,
+                                      arma::mat& gradient) const
 {
-  // Indices for accessing the the correct parameter columns.
-  const size_t user = data(0, i);
-  const size_t item = data(1, i) + numUsers;
-  
-  // Calculate the squared error in the prediction.
-  const double rating = data(2, i);
-  double ratingError = rating - arma::dot(parameters.col(user),
-                                          parameters.col(item));
-  double ratingErrorSquared = ratingError * ratingError;
-  
-  // Calculate the regularization penalty corresponding to the parameters.
-  double userVecNorm = arma::norm(parameters.col(user), 2);
-  double itemVecNorm = arma::norm(parameters.col(item), 2);
-  double regularizationError = lambda * (userVecNorm * userVecNorm +
-                                         itemVecNorm * itemVecNorm);
-                                         
-  return (ratingErrorSquared + regularizationError);
+  Gradient(parameters, 0, gradient, data.n_cols);
 }
 
 void RegularizedSVDFunction::Gradient(const arma::mat& parameters,
-                                      arma::mat& gradient) const
+                                      const size_t begin,
+                                      arma::mat& gradient,
+                                      const size_t batchSize) const
 {
   // For an example with rating corresponding to user 'i' and item 'j', the
   // gradients for the parameters is as follows:
@@ -91,12 +90,12 @@ void RegularizedSVDFunction::Gradient(const arma::mat& parameters,
   //           grad(v(j)) = lambda * v(j) - error * u(i)
   // 'error' is the prediction error for that example, which is:
   //           rating(i, j) - u(i).t() * v(j)
-  // The full gradient is calculated by summing the contributions over all the
-  // training examples.
+  // The gradient is calculated by summing the contributions over all the
+  // training examples in the batch.
 
   gradient.zeros(rank, numUsers + numItems);
 
-  for(size_t i = 0; i < data.n_cols; i++)
+  for(size_t i = begin; i < begin + batchSize; i++)
   {
     // Indices for accessing the the correct parameter columns.
     const size_t user = data(0, i);
@@ -116,6 +115,40 @@ void RegularizedSVDFunction::Gradient(const arma::mat& parameters,
   }
 }
 
+void RegularizedSVDFunction::Gradient(const arma::mat& parameters,
+                                      const size_t i,
+                                      arma::sp_mat& gradient) const
+{
+  // Indices for accessing the the correct parameter columns.
+  const size_t user = data(0, i);
+  const size_t item = data(1, i) + numUsers;
+
+  // Prediction error for the example.
+  const double rating = data(2, i);
+  double ratingError = rating - arma::dot(parameters.col(user),
+                                          parameters.col(item));
+
+  // The gradient is the same as the contribution of this example to the full
+  // gradient, but only the user and item columns are stored.  The user column
+  // comes first, so the locations are sorted.
+  arma::umat locations(2, 2 * rank);
+  arma::vec values(2 * rank);
+  for (size_t j = 0; j < rank; ++j)
+  {
+    locations(0, j) = j;
+    locations(1, j) = user;
+    values[j] = 2 * (lambda * parameters(j, user) -
+                     ratingError * parameters(j, item));
+
+    locations(0, rank + j) = j;
+    locations(1, rank + j) = item;
+    values[rank + j] = 2 * (lambda * parameters(j, item) -
+                            ratingError * parameters(j, user));
+  }
+
+  gradient = arma::sp_mat(locations, values, rank, numUsers + numItems);
+}
+
 }; // namespace svd
 }; // namespace mlpack
 
@@ -47,6 +47,18 @@ class RegularizedSVDFunction
    */
   double Evaluate(const arma::mat& parameters,
                   const size_t i) const;
+
+  /**
+   * Evaluates the cost function for the training examples begin, begin + 1,
+   * ..., begin + batchSize - 1.  Useful for the MiniBatchSGD optimizer.
+   *
+   * @param parameters Parameters(user/item matrices) of the decomposition.
+   * @param begin Index of the first training example in the batch.
+   * @param batchSize Number of training examples in the batch.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize) const;
   
   /**
    * Evaluates the full gradient of the cost function over all the training
@@ -57,6 +69,34 @@ class RegularizedSVDFunction
    */
   void Gradient(const arma::mat& parameters,
                 arma::mat& gradient) const;
+
+  /**
+   * Evaluates the gradient of the cost function over the training examples
+   * begin, begin + 1, ..., begin + batchSize - 1.  Useful for the
+   * MiniBatchSGD optimizer.
+   *
+   * @param parameters Parameters(user/item matrices) of the decomposition.
+   * @param begin Index of the first training example in the batch.
+   * @param gradient Calculated gradient for the parameters.
+   * @param batchSize Number of training examples in the batch.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                arma::mat& gradient,
+                const size_t batchSize) const;
+
+  /**
+   * Evaluates the gradient of the cost function for one training example, as
+   * a sparse matrix.  Only the columns of the user and the item of the
+   * example are nonzero.  Useful for the ParallelSGD optimizer.
+   *
+   * @param parameters Parameters(user/item matrices) of the decomposition.
+   * @param i Index of the training example to be used.
+   * @param gradient Calculated sparse gradient for the parameters.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t i,
+                arma::sp_mat& gradient) const;
   
   //! Return the initial point for the optimization.
   const arma::mat& GetInitialPoint() const { return initialPoint; }
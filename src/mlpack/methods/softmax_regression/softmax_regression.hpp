@@ -42,8 +42,8 @@ namespace regression {
  * const size_t numIterations = 100; // Maximum number of iterations.
  *
  * // Use an instantiated optimizer for the training.
- * SoftmaxRegressionFunction srf(train_data, labels, inputSize, numClasses);
- * L_BFGS<SoftmaxRegressionFunction> optimizer(srf, numBasis, numIterations);
+ * SoftmaxRegressionFunction<> srf(train_data, labels, inputSize, numClasses);
+ * L_BFGS<SoftmaxRegressionFunction<> > optimizer(srf, numBasis, numIterations);
  * SoftmaxRegression<L_BFGS> regressor2(optimizer);
  *
  * arma::mat test_data; // Test data matrix.
@@ -53,10 +53,18 @@ namespace regression {
  * regressor1.Predict(test_data, predictions1);
  * regressor2.Predict(test_data, predictions2);
  * @endcode
+ *
+ * Sparse data can be used by giving arma::sp_mat as the MatType; for instance,
+ * SoftmaxRegression<L_BFGS, arma::sp_mat>.  The training and test data are
+ * then never converted to dense matrices.
+ *
+ * @tparam OptimizerType Optimizer to use to train the model.
+ * @tparam MatType Type of the data matrix (arma::mat or arma::sp_mat).
  */
 
 template<
-  template<typename> class OptimizerType = mlpack::optimization::L_BFGS
+  template<typename> class OptimizerType = mlpack::optimization::L_BFGS,
+  typename MatType = arma::mat
 >
 class SoftmaxRegression
 {
@@ -74,7 +82,7 @@ class SoftmaxRegression
    * @param numClasses Number of classes for classification.
    * @param lambda L2-regularization constant.
    */
-  SoftmaxRegression(const arma::mat& data,
+  SoftmaxRegression(const MatType& data,
                     const arma::vec& labels,
                     const size_t inputSize,
                     const size_t numClasses,
@@ -89,7 +97,8 @@ class SoftmaxRegression
    *
    * @param optimizer Instantiated optimizer with instantiated error function.
    */
-  SoftmaxRegression(OptimizerType<SoftmaxRegressionFunction>& optimizer);
+  SoftmaxRegression(
+      OptimizerType<SoftmaxRegressionFunction<MatType> >& optimizer);
   
   /**
    * Predict the class labels for the provided feature points. The function
@@ -99,7 +108,7 @@ class SoftmaxRegression
    * @param testData Matrix of data points for which predictions are to be made.
    * @param predictions Vector to store the predictions in.
    */
-  void Predict(const arma::mat& testData, arma::vec& predictions);
+  void Predict(const MatType& testData, arma::vec& predictions);
   
   /**
    * Computes accuracy of the learned model given the feature data and the
@@ -109,7 +118,7 @@ class SoftmaxRegression
    * @param testData Matrix of data points using which predictions are made.
    * @param labels Vector of labels associated with the data.
    */
-  double ComputeAccuracy(const arma::mat& testData, const arma::vec& labels);
+  double ComputeAccuracy(const MatType& testData, const arma::vec& labels);
                     
   //! Sets the size of the input vector.
   void InputSize(const size_t input)
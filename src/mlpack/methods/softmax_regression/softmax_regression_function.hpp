@@ -13,6 +13,15 @@
 namespace mlpack {
 namespace regression {
 
+/**
+ * The objective function for softmax regression.  The data may be dense
+ * (arma::mat) or sparse (arma::sp_mat); with sparse data, the class scores and
+ * the gradient are computed with sparse-dense matrix products, so the data is
+ * never converted to a dense matrix.
+ *
+ * @tparam MatType Type of the data matrix (arma::mat or arma::sp_mat).
+ */
+template<typename MatType = arma::mat>
 class SoftmaxRegressionFunction
 {
  public:
@@ -26,7 +35,7 @@ class SoftmaxRegressionFunction
    * @param numClasses Number of classes for classification.
    * @param lambda L2-regularization constant.
    */
-  SoftmaxRegressionFunction(const arma::mat& data,
+  SoftmaxRegressionFunction(const MatType& data,
                             const arma::vec& labels,
                             const size_t inputSize,
                             const size_t numClasses,
@@ -64,6 +73,19 @@ class SoftmaxRegressionFunction
    * @param gradient Matrix where gradient values will be stored.
    */
   void Gradient(const arma::mat& parameters, arma::mat& gradient) const;
+
+  /**
+   * Evaluates the objective function and its gradient given the current set of
+   * parameters.  This gives the same results as Evaluate() and Gradient(), but
+   * the class probabilities are only computed once, in memory which is kept
+   * between calls.  L-BFGS uses this when it is available.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param gradient Matrix where gradient values will be stored.
+   * @return The objective function at the given parameters.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              arma::mat& gradient);
   
   //! Return the initial point for the optimization.
   const arma::mat& GetInitialPoint() const { return initialPoint; }
@@ -106,7 +128,7 @@ class SoftmaxRegressionFunction
                             
  private:
   //! Training data matrix.
-  const arma::mat& data;
+  const MatType& data;
   //! Labels associated with the training data.
   const arma::vec& labels;
   //! Label matrix for the provided data.
@@ -119,9 +141,16 @@ class SoftmaxRegressionFunction
   size_t numClasses;
   //! L2-regularization constant.
   double lambda;
+
+  //! The class probabilities of each training example; used by
+  //! EvaluateWithGradient() to avoid reallocations.
+  arma::mat probabilities;
 };
 
 }; // namespace regression
 }; // namespace mlpack
 
+// Include implementation.
+#include "softmax_regression_function_impl.hpp"
+
 #endif
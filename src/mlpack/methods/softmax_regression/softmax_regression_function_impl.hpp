@@ -1,19 +1,25 @@
 /**
- * @file softmax_regression_function.cpp
+ * @file softmax_regression_function_impl.hpp
  * @author Siddharth Agrawal
  *
  * Implementation of function to be optimized for softmax regression.
  */
- #include "softmax_regression_function.hpp"
+#ifndef __MLPACK_METHODS_SOFTMAX_REGRESSION_SOFTMAX_REGRESSION_FUNCTION_IMPL_HPP
+#define __MLPACK_METHODS_SOFTMAX_REGRESSION_SOFTMAX_REGRESSION_FUNCTION_IMPL_HPP
 
-using namespace mlpack;
-using namespace mlpack::regression;
+// In case it hasn't been included yet.
+#include "softmax_regression_function.hpp"
 
-SoftmaxRegressionFunction::SoftmaxRegressionFunction(const arma::mat& data,
-                                                     const arma::vec& labels,
-                                                     const size_t inputSize,
-                                                     const size_t numClasses,
-                                                     const double lambda) :
+namespace mlpack {
+namespace regression {
+
+template<typename MatType>
+SoftmaxRegressionFunction<MatType>::SoftmaxRegressionFunction(
+    const MatType& data,
+    const arma::vec& labels,
+    const size_t inputSize,
+    const size_t numClasses,
+    const double lambda) :
     data(data),
     labels(labels),
     inputSize(inputSize),
@@ -32,7 +38,8 @@ SoftmaxRegressionFunction::SoftmaxRegressionFunction(const arma::mat& data,
  * normal distribution. The weights cannot be initialized to zero, as that will
  * lead to each class output being the same.
  */
-const arma::mat SoftmaxRegressionFunction::InitializeWeights()
+template<typename MatType>
+const arma::mat SoftmaxRegressionFunction<MatType>::InitializeWeights()
 {
   // Initialize values to 0.005 * r. 'r' is a matrix of random values taken from
   // a Gaussian distribution with mean zero and variance one.
@@ -48,8 +55,10 @@ const arma::mat SoftmaxRegressionFunction::InitializeWeights()
  * labels. The output is in the form of a matrix, which leads to simpler
  * calculations in the Evaluate() and Gradient() methods.
  */
-void SoftmaxRegressionFunction::GetGroundTruthMatrix(const arma::vec& labels,
-                                                     arma::sp_mat& groundTruth)
+template<typename MatType>
+void SoftmaxRegressionFunction<MatType>::GetGroundTruthMatrix(
+    const arma::vec& labels,
+    arma::sp_mat& groundTruth)
 {
   // Calculate the ground truth matrix according to the labels passed. The
   // ground truth matrix is a matrix of dimensions 'numClasses * numExamples',
@@ -80,7 +89,9 @@ void SoftmaxRegressionFunction::GetGroundTruthMatrix(const arma::vec& labels,
 /**
  * Evaluates the objective function given the parameters.
  */
-double SoftmaxRegressionFunction::Evaluate(const arma::mat& parameters) const
+template<typename MatType>
+double SoftmaxRegressionFunction<MatType>::Evaluate(
+    const arma::mat& parameters) const
 {
   // The objective function is the negative log likelihood of the model
   // calculated over all the training examples. Mathematically it is as follows:
@@ -121,8 +132,10 @@ double SoftmaxRegressionFunction::Evaluate(const arma::mat& parameters) const
 /**
  * Calculates and stores the gradient values given a set of parameters.
  */
-void SoftmaxRegressionFunction::Gradient(const arma::mat& parameters,
-                                         arma::mat& gradient) const
+template<typename MatType>
+void SoftmaxRegressionFunction<MatType>::Gradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
 {
   // Calculate the class probabilities for each training example. The
   // probabilities for each of the classes are given by:
@@ -140,3 +153,56 @@ void SoftmaxRegressionFunction::Gradient(const arma::mat& parameters,
   gradient = (probabilities - groundTruth) * data.t() / data.n_cols +
       lambda * parameters;
 }
+
+/**
+ * Evaluates the objective function and the gradient together, sharing the
+ * class probabilities.
+ */
+template<typename MatType>
+double SoftmaxRegressionFunction<MatType>::EvaluateWithGradient(
+    const arma::mat& parameters,
+    arma::mat& gradient)
+{
+  // Calculate the class probabilities as in Evaluate(), but in place in the
+  // workspace.  This only allocates memory the first time, or if the size of
+  // the data changes.
+  probabilities = parameters * data;
+  probabilities = arma::exp(probabilities);
+  for (size_t i = 0; i < probabilities.n_cols; i++)
+  {
+    double* column = probabilities.colptr(i);
+    double sum = 0;
+    for (size_t j = 0; j < numClasses; j++)
+      sum += column[j];
+    for (size_t j = 0; j < numClasses; j++)
+      column[j] /= sum;
+  }
+
+  // The ground truth matrix has a single 1 in each column, at the label of the
+  // example, so the log likelihood only needs the probability of that label.
+  // Subtracting the ground truth from the probabilities then gives the error
+  // used by the gradient.
+  double logLikelihood = 0;
+  for (size_t i = 0; i < probabilities.n_cols; i++)
+  {
+    const size_t label = (size_t) labels(i);
+    logLikelihood += std::log(probabilities(label, i));
+    probabilities(label, i) -= 1.0;
+  }
+  logLikelihood /= data.n_cols;
+
+  const double weightDecay = 0.5 * lambda * arma::accu(parameters %
+      parameters);
+
+  // Calculate the parameter gradients.
+  gradient = probabilities * data.t();
+  gradient /= data.n_cols;
+  gradient += lambda * parameters;
+
+  return -logLikelihood + weightDecay;
+}
+
+}; // namespace regression
+}; // namespace mlpack
+
+#endif
@@ -203,3 +203,66 @@ void SparseAutoencoderFunction::Gradient(const arma::mat& parameters,
   gradient.submat(0, l2, l1 - 1, l2) = arma::sum(delHid, 1) / data.n_cols;
   gradient.submat(l3, 0, l3, l2 - 1) = (arma::sum(delOut, 1) / data.n_cols).t();
 }
+
+/**
+ * Evaluates the objective function and the gradient together, sharing the
+ * feedforward pass.
+ */
+double SparseAutoencoderFunction::EvaluateWithGradient(
+    const arma::mat& parameters,
+    arma::mat& gradient)
+{
+  // Compute the limits for the parameters w1, w2, b1 and b2, which are used as
+  // in Evaluate() and Gradient().
+  const size_t l1 = hiddenSize;
+  const size_t l2 = visibleSize;
+  const size_t l3 = 2 * hiddenSize;
+
+  // Compute activations of the hidden and output layers.  The results are
+  // stored in the workspace matrices, so memory is only allocated the first
+  // time (or if the size of the data changes), and the biases are added to
+  // each column instead of being repeated into a full matrix.
+  hiddenLayer = parameters.submat(0, 0, l1 - 1, l2 - 1) * data;
+  hiddenLayer.each_col() += parameters.submat(0, l2, l1 - 1, l2);
+  Sigmoid(hiddenLayer, hiddenLayer);
+
+  outputLayer = parameters.submat(l1, 0, l3 - 1, l2 - 1).t() * hiddenLayer;
+  outputLayer.each_col() += parameters.submat(l3, 0, l3, l2 - 1).t();
+  Sigmoid(outputLayer, outputLayer);
+
+  // Average activations of the hidden layer.
+  const arma::vec rhoCap = arma::sum(hiddenLayer, 1) / data.n_cols;
+  // Difference between the reconstructed data and the original data.
+  delOut = outputLayer - data;
+
+  // Calculate the cost terms as in Evaluate().
+  const double sumOfSquaresError = 0.5 * arma::dot(delOut, delOut) /
+      data.n_cols;
+  const double weightDecay = 0.5 * lambda * arma::accu(
+      parameters.submat(0, 0, l3 - 1, l2 - 1) %
+      parameters.submat(0, 0, l3 - 1, l2 - 1));
+  const double klDivergence = beta * arma::accu(rho * arma::log(rho / rhoCap) +
+      (1 - rho) * arma::log((1 - rho) / (1 - rhoCap)));
+
+  // Compute the delta values as in Gradient(), overwriting the difference with
+  // the delta values of the output layer.
+  const arma::vec klDivGrad = beta * (-(rho / rhoCap) + (1 - rho) /
+      (1 - rhoCap));
+  delOut %= outputLayer % (1 - outputLayer);
+  delHid = parameters.submat(l1, 0, l3 - 1, l2 - 1) * delOut;
+  delHid.each_col() += klDivGrad;
+  delHid %= hiddenLayer % (1 - hiddenLayer);
+
+  gradient.zeros(2 * hiddenSize + 1, visibleSize + 1);
+
+  // Compute the gradient values using the activations and the delta values.
+  gradient.submat(0, 0, l1 - 1, l2 - 1) = delHid * data.t() / data.n_cols +
+      lambda * parameters.submat(0, 0, l1 - 1, l2 - 1);
+  gradient.submat(l1, 0, l3 - 1, l2 - 1) =
+      (delOut * hiddenLayer.t() / data.n_cols +
+      lambda * parameters.submat(l1, 0, l3 - 1, l2 - 1).t()).t();
+  gradient.submat(0, l2, l1 - 1, l2) = arma::sum(delHid, 1) / data.n_cols;
+  gradient.submat(l3, 0, l3, l2 - 1) = (arma::sum(delOut, 1) / data.n_cols).t();
+
+  return sumOfSquaresError + weightDecay + klDivergence;
+}
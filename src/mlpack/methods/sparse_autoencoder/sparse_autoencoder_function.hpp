@@ -65,6 +65,20 @@ class SparseAutoencoderFunction
    */
   void Gradient(const arma::mat& parameters, arma::mat& gradient) const;
 
+  /**
+   * Evaluates the objective function and its gradient given the current set of
+   * parameters.  This gives the same results as Evaluate() and Gradient(), but
+   * the feedforward pass is only done once, and the activations and delta
+   * values are stored in memory which is kept between calls.  L-BFGS uses this
+   * when it is available.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param gradient Matrix where gradient values will be stored.
+   * @return The objective function at the given parameters.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              arma::mat& gradient);
+
   /**
    * Returns the elementwise sigmoid of the passed matrix, where the sigmoid
    * function of a real number 'x' is [1 / (1 + exp(-x))].
@@ -154,6 +168,17 @@ class SparseAutoencoderFunction
   double beta;
   //! Sparsity parameter.
   double rho;
+
+  //! Activations of the hidden layer; used by EvaluateWithGradient() to avoid
+  //! reallocations.
+  arma::mat hiddenLayer;
+  //! Activations of the output layer; used by EvaluateWithGradient().
+  arma::mat outputLayer;
+  //! Reconstruction error, then delta values of the output layer; used by
+  //! EvaluateWithGradient().
+  arma::mat delOut;
+  //! Delta values of the hidden layer; used by EvaluateWithGradient().
+  arma::mat delHid;
 };
 
 }; // namespace nn
@@ -133,7 +133,9 @@ class SparseCoding
               const double newtonTolerance = 1e-6);
 
   /**
-   * Sparse code each point via LARS.
+   * Sparse code each point via LARS.  The points are coded in parallel, and if
+   * WarmStart() is set, each point's LARS run is warm-started from its current
+   * code.
    */
   void OptimizeCode();
 
@@ -176,6 +178,13 @@ class SparseCoding
   //! Modify the sparse codes.
   arma::mat& Codes() { return codes; }
 
+  //! Get whether the coding step is warm-started from the previous codes.
+  bool WarmStart() const { return warmStart; }
+  //! Modify whether the coding step is warm-started from the previous codes.
+  //! The codes found are the same either way, but warm starts are much faster
+  //! when the codes change little between iterations.
+  bool& WarmStart() { return warmStart; }
+
   // Returns a string representation of this object. 
   std::string ToString() const;
 
@@ -197,6 +206,9 @@ class SparseCoding
 
   //! l2 regularization term.
   double lambda2;
+
+  //! Whether or not to warm-start the coding step.
+  bool warmStart;
 };
 
 }; // namespace sparse_coding
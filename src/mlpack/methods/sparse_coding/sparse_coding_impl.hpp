@@ -21,9 +21,10 @@ SparseCoding<DictionaryInitializer>::SparseCoding(const arma::mat& data,
                                                   const double lambda2) :
     atoms(atoms),
     data(data),
-    codes(atoms, data.n_cols),
+    codes(arma::zeros<arma::mat>(atoms, data.n_cols)),
     lambda1(lambda1),
-    lambda2(lambda2)
+    lambda2(lambda2),
+    warmStart(false)
 {
   // Initialize the dictionary.
   DictionaryInitializer::Initialize(data, atoms, dictionary);
@@ -98,20 +99,32 @@ void SparseCoding<DictionaryInitializer>::OptimizeCode()
   // lambda2 > 0.
   arma::mat matGram = trans(dictionary) * dictionary;
 
-  for (size_t i = 0; i < data.n_cols; ++i)
+  // Each point is coded independently, so the points are split between
+  // threads.  Each thread uses one LARS object for all of its points, so that
+  // its buffers are only allocated once.
+  #pragma omp parallel
   {
-    // Report progress.
-    if ((i % 100) == 0)
-      Log::Debug << "Optimization at point " << i << "." << std::endl;
-
     bool useCholesky = true;
     regression::LARS lars(useCholesky, matGram, lambda1, lambda2);
+    arma::vec initialCode;
 
-    // Create an alias of the code (using the same memory), and then LARS will
-    // place the result directly into that; then we will not need to have an
-    // extra copy.
-    arma::vec code = codes.unsafe_col(i);
-    lars.Regress(dictionary, data.unsafe_col(i), code, false);
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t i = 0; i < data.n_cols; ++i)
+    {
+      // Create an alias of the code (using the same memory), and then LARS
+      // will place the result directly into that; then we will not need to
+      // have an extra copy.
+      arma::vec code = codes.unsafe_col(i);
+      if (warmStart)
+      {
+        initialCode = code;
+        lars.Regress(dictionary, data.unsafe_col(i), initialCode, code, false);
+      }
+      else
+      {
+        lars.Regress(dictionary, data.unsafe_col(i), code, false);
+      }
+    }
   }
 }
 
@@ -58,6 +58,10 @@ PARAM_STRING("codes_file", "Filename to save the output sparse codes to.", "c",
 PARAM_FLAG("normalize", "If set, the input data matrix will be normalized "
     "before coding.", "N");
 
+PARAM_FLAG("warm_start", "If set, each coding step is warm-started from the "
+    "codes of the previous iteration; the results are the same, but it is "
+    "faster when the codes change little.", "W");
+
 PARAM_INT("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
 
 PARAM_DOUBLE("objective_tolerance", "Tolerance for convergence of the objective"
@@ -135,6 +139,7 @@ int main(int argc, char* argv[])
     }
 
     // Run sparse coding.
+    sc.WarmStart() = CLI::HasParam("warm_start");
     sc.Encode(maxIterations, objTolerance, newtonTolerance);
 
     // Save the results.
@@ -149,6 +154,7 @@ int main(int argc, char* argv[])
     SparseCoding<> sc(matX, atoms, lambda1, lambda2);
 
     // Run sparse coding.
+    sc.WarmStart() = CLI::HasParam("warm_start");
     sc.Encode(maxIterations, objTolerance, newtonTolerance);
 
     // Save the results.
@@ -23,6 +23,11 @@ problems.  It should only be necessary to include <mlpack/core.hpp> and not\
 #include <stdint.h>
 #include <iostream>
 
+// OpenMP is optional; code that uses its runtime functions must check _OPENMP.
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 // Defining _USE_MATH_DEFINES should set M_PI.
 #define _USE_MATH_DEFINES
 #include <math.h>
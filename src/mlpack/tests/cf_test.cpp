@@ -175,4 +175,56 @@ BOOST_AUTO_TEST_CASE(RecommendationAccuracyTest)
   BOOST_REQUIRE_LT(failures, 100);
 }
 
+/**
+ * Make sure that the recommendations computed in the latent space are the same
+ * as the recommendations computed with the dense rating matrix W * H.
+ */
+BOOST_AUTO_TEST_CASE(CFLatentRecommendationsMatchDenseTest)
+{
+  const size_t numRecs = 5;
+
+  arma::mat dataset;
+  data::Load("GroupLens100k.csv", dataset);
+
+  CF<> c(dataset);
+
+  arma::Mat<size_t> recommendations;
+  c.GetRecommendations(numRecs, recommendations);
+
+  // Compute the recommendations the dense way.
+  const arma::mat rating = c.Rating();
+  neighbor::AllkNN a(rating, rating);
+  arma::Mat<size_t> neighborhood;
+  arma::mat distances;
+  a.Search(c.NumUsersForSimilarity(), neighborhood, distances);
+
+  size_t mismatches = 0;
+  for (size_t i = 0; i < rating.n_cols; ++i)
+  {
+    arma::vec average = arma::zeros<arma::vec>(rating.n_rows);
+    for (size_t j = 0; j < neighborhood.n_rows; ++j)
+      average += rating.col(neighborhood(j, i));
+    average /= neighborhood.n_rows;
+
+    // Exclude items that have been rated.
+    for (size_t j = 0; j < average.n_elem; ++j)
+      if (c.CleanedData()(j, i) != 0.0)
+        average[j] = -DBL_MAX;
+
+    arma::uvec order = arma::sort_index(average, "descend");
+    for (size_t j = 0; j < numRecs; ++j)
+    {
+      if (recommendations(j, i) != order[j])
+      {
+        ++mismatches;
+        break;
+      }
+    }
+  }
+
+  // Floating-point differences may break near-ties between neighbors
+  // differently, but that should be rare.
+  BOOST_REQUIRE_LT(mismatches, rating.n_cols / 50);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -212,6 +212,56 @@ BOOST_AUTO_TEST_CASE(TestGrow)
   BOOST_REQUIRE_CLOSE(alpha, min(rootAlpha, rAlpha), 1e-10);
 }
 
+// Check that every split in the tree is the one that FindSplit() chooses when
+// it sorts the points of the node itself, and that every point lies inside its
+// node.
+void CheckSplits(const DTree& node, const arma::mat& data)
+{
+  for (size_t i = node.Start(); i < node.End(); ++i)
+    for (size_t d = 0; d < data.n_rows; ++d)
+      BOOST_REQUIRE((data(d, i) >= node.minVals[d]) &&
+                    (data(d, i) <= node.maxVals[d]));
+
+  if (node.Left() == NULL)
+    return;
+
+  size_t splitDim;
+  double splitValue, leftError, rightError;
+  BOOST_REQUIRE(node.FindSplit(data, splitDim, splitValue, leftError,
+      rightError, 5));
+  BOOST_REQUIRE_EQUAL(splitDim, node.SplitDim());
+  BOOST_REQUIRE_CLOSE(splitValue, node.SplitValue(), 1e-10);
+
+  CheckSplits(*node.Left(), data);
+  CheckSplits(*node.Right(), data);
+}
+
+// Make sure that growing the tree with presorted points gives the same splits
+// as sorting the points in each node.
+BOOST_AUTO_TEST_CASE(TestGrowPresorted)
+{
+  arma::mat testData = arma::randu<arma::mat>(4, 2000);
+  // Some repeated values.
+  testData.row(1) = arma::floor(10 * testData.row(1));
+
+  arma::Col<size_t> oTest(testData.n_cols);
+  for (size_t i = 0; i < oTest.n_elem; ++i)
+    oTest[i] = i;
+
+  const arma::mat originalData(testData);
+
+  DTree testDTree(testData);
+  testDTree.Grow(testData, oTest, false, 10, 5);
+
+  BOOST_REQUIRE_GT(testDTree.SubtreeLeaves(), 1);
+  CheckSplits(testDTree, testData);
+
+  // The points must still be the same points.
+  for (size_t i = 0; i < testData.n_cols; ++i)
+    for (size_t d = 0; d < testData.n_rows; ++d)
+      BOOST_REQUIRE_EQUAL(testData(d, i), originalData(d, oTest[i]));
+}
+
 BOOST_AUTO_TEST_CASE(TestPruneAndUpdate)
 {
   arma::mat testData(3, 5);
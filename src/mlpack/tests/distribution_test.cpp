@@ -45,6 +45,27 @@ BOOST_AUTO_TEST_CASE(DiscreteDistributionProbabilityTest)
   BOOST_REQUIRE_CLOSE(d.Probability("4"), 0.2, 1e-5);
 }
 
+/**
+ * Make sure we get the log-probabilities of many observations right.
+ */
+BOOST_AUTO_TEST_CASE(DiscreteDistributionLogProbabilityTest)
+{
+  DiscreteDistribution d(5);
+
+  d.Probabilities() = "0.2 0.4 0.1 0.1 0.2";
+
+  arma::vec logProbabilities;
+  d.LogProbability(arma::mat("0 1 2 3 4 1"), logProbabilities);
+
+  BOOST_REQUIRE_EQUAL(logProbabilities.n_elem, 6);
+  BOOST_REQUIRE_CLOSE(logProbabilities[0], log(0.2), 1e-5);
+  BOOST_REQUIRE_CLOSE(logProbabilities[1], log(0.4), 1e-5);
+  BOOST_REQUIRE_CLOSE(logProbabilities[2], log(0.1), 1e-5);
+  BOOST_REQUIRE_CLOSE(logProbabilities[3], log(0.1), 1e-5);
+  BOOST_REQUIRE_CLOSE(logProbabilities[4], log(0.2), 1e-5);
+  BOOST_REQUIRE_CLOSE(logProbabilities[5], log(0.4), 1e-5);
+}
+
 /**
  * Make sure we get random observations correct.
  */
@@ -187,16 +208,16 @@ BOOST_AUTO_TEST_CASE(GaussianUnivariateProbabilityTest)
       1e-5);
 
   // A few more cases...
-  g.Covariance().fill(2.0);
+  g.Covariance(arma::mat("2.0"));
   BOOST_REQUIRE_CLOSE(g.Probability(arma::vec("0.0")), 0.282094791773878, 1e-5);
   BOOST_REQUIRE_CLOSE(g.Probability(arma::vec("1.0")), 0.219695644733861, 1e-5);
   BOOST_REQUIRE_CLOSE(g.Probability(arma::vec("-1.0")), 0.219695644733861,
       1e-5);
 
   g.Mean().fill(1.0);
-  g.Covariance().fill(1.0);
+  g.Covariance(arma::mat("1.0"));
   BOOST_REQUIRE_CLOSE(g.Probability(arma::vec("1.0")), 0.398942280401433, 1e-5);
-  g.Covariance().fill(2.0);
+  g.Covariance(arma::mat("2.0"));
   BOOST_REQUIRE_CLOSE(g.Probability(arma::vec("-1.0")), 0.103776874355149,
       1e-5);
 }
@@ -215,7 +236,7 @@ BOOST_AUTO_TEST_CASE(GaussianMultivariateProbabilityTest)
 
   BOOST_REQUIRE_CLOSE(g.Probability(x), 0.159154943091895, 1e-5);
 
-  g.Covariance() = "2 0; 0 2";
+  g.Covariance(arma::mat("2 0; 0 2"));
 
   BOOST_REQUIRE_CLOSE(g.Probability(x), 0.0795774715459477, 1e-5);
 
@@ -229,34 +250,36 @@ BOOST_AUTO_TEST_CASE(GaussianMultivariateProbabilityTest)
   g.Mean() *= -1;
   BOOST_REQUIRE_CLOSE(g.Probability(-x), 0.0795774715459477, 1e-5);
 
+  // Covariance matrices must be symmetric, since they are factorized with a
+  // Cholesky decomposition.
   g.Mean() = "1 1";
-  g.Covariance() = "2 1.5; 1 4";
+  g.Covariance(arma::mat("2 1.5; 1.5 4"));
 
-  BOOST_REQUIRE_CLOSE(g.Probability(x), 0.0624257046546403, 1e-5);
+  BOOST_REQUIRE_CLOSE(g.Probability(x), 0.0663721994061873, 1e-5);
   g.Mean() *= -1;
-  BOOST_REQUIRE_CLOSE(g.Probability(-x), 0.0624257046546403, 1e-5);
+  BOOST_REQUIRE_CLOSE(g.Probability(-x), 0.0663721994061873, 1e-5);
 
   g.Mean() = "1 1";
   x = "-1 4";
 
-  BOOST_REQUIRE_CLOSE(g.Probability(x), 0.00144014867515135, 1e-5);
-  BOOST_REQUIRE_CLOSE(g.Probability(-x), 0.00133352162064845, 1e-5);
+  BOOST_REQUIRE_CLOSE(g.Probability(x), 0.000721472623563794, 1e-5);
+  BOOST_REQUIRE_CLOSE(g.Probability(-x), 0.000858517854286745, 1e-5);
 
   // Higher-dimensional case.
   x = "0 1 2 3 4";
   g.Mean() = "5 6 3 3 2";
-  g.Covariance() = "6 1 1 0 2;"
-                   "0 7 1 0 1;"
-                   "1 1 4 1 1;"
-                   "1 0 1 7 0;"
-                   "2 0 1 1 6";
+  g.Covariance(arma::mat("6 1 1 1 2;"
+                         "1 7 1 0 0;"
+                         "1 1 4 1 1;"
+                         "1 0 1 7 0;"
+                         "2 0 1 0 6"));
 
-  BOOST_REQUIRE_CLOSE(g.Probability(x), 1.02531207499358e-6, 1e-5);
-  BOOST_REQUIRE_CLOSE(g.Probability(-x), 1.06784794079363e-8, 1e-5);
+  BOOST_REQUIRE_CLOSE(g.Probability(x), 1.46731435311288e-6, 1e-5);
+  BOOST_REQUIRE_CLOSE(g.Probability(-x), 7.74041434948924e-9, 1e-5);
 
   g.Mean() *= -1;
-  BOOST_REQUIRE_CLOSE(g.Probability(-x), 1.02531207499358e-6, 1e-5);
-  BOOST_REQUIRE_CLOSE(g.Probability(x), 1.06784794079363e-8, 1e-5);
+  BOOST_REQUIRE_CLOSE(g.Probability(-x), 1.46731435311288e-6, 1e-5);
+  BOOST_REQUIRE_CLOSE(g.Probability(x), 7.74041434948924e-9, 1e-5);
 
 }
 
@@ -268,7 +291,7 @@ BOOST_AUTO_TEST_CASE(GaussianMultipointMultivariateProbabilityTest)
 {
   // Same case as before.
   arma::vec mean = "5 6 3 3 2";
-  arma::mat cov = "6 1 1 0 2; 0 7 1 0 1; 1 1 4 1 1; 1 0 1 7 0; 2 0 1 1 6";
+  arma::mat cov = "6 1 1 1 2; 1 7 1 0 0; 1 1 4 1 1; 1 0 1 7 0; 2 0 1 0 6";
 
   arma::mat points = "0 3 2 2 3 4;"
                      "1 2 2 1 0 0;"
@@ -282,12 +305,77 @@ BOOST_AUTO_TEST_CASE(GaussianMultipointMultivariateProbabilityTest)
 
   BOOST_REQUIRE_EQUAL(phis.n_elem, 6);
 
-  BOOST_REQUIRE_CLOSE(phis(0), 1.02531207499358e-6, 1e-5);
-  BOOST_REQUIRE_CLOSE(phis(1), 1.82353695848039e-7, 1e-5);
-  BOOST_REQUIRE_CLOSE(phis(2), 1.29759261892949e-6, 1e-5);
-  BOOST_REQUIRE_CLOSE(phis(3), 1.33218060268258e-6, 1e-5);
-  BOOST_REQUIRE_CLOSE(phis(4), 1.12120427975708e-6, 1e-5);
-  BOOST_REQUIRE_CLOSE(phis(5), 4.57951032485297e-7, 1e-5);
+  BOOST_REQUIRE_CLOSE(phis(0), 1.46731435311288e-6, 1e-5);
+  BOOST_REQUIRE_CLOSE(phis(1), 1.35420603235580e-7, 1e-5);
+  BOOST_REQUIRE_CLOSE(phis(2), 1.06294961587817e-6, 1e-5);
+  BOOST_REQUIRE_CLOSE(phis(3), 1.70272060009058e-6, 1e-5);
+  BOOST_REQUIRE_CLOSE(phis(4), 1.01529990973370e-6, 1e-5);
+  BOOST_REQUIRE_CLOSE(phis(5), 3.38009287750920e-7, 1e-5);
+}
+
+/**
+ * Make sure that the batch LogProbability() matches the log of the single-point
+ * Probability(), and that it does not underflow where Probability() does.
+ */
+BOOST_AUTO_TEST_CASE(GaussianMultipointLogProbabilityTest)
+{
+  arma::vec mean = "5 6 3 3 2";
+  arma::mat cov = "6 1 1 1 2; 1 7 1 0 0; 1 1 4 1 1; 1 0 1 7 0; 2 0 1 0 6";
+
+  arma::mat points = "0 3 2 2 3 4;"
+                     "1 2 2 1 0 0;"
+                     "2 3 0 5 5 6;"
+                     "3 7 8 0 1 1;"
+                     "4 8 1 1 0 0;";
+
+  GaussianDistribution g(mean, cov);
+  arma::vec logPhis;
+  g.LogProbability(points, logPhis);
+
+  BOOST_REQUIRE_EQUAL(logPhis.n_elem, 6);
+  for (size_t i = 0; i < points.n_cols; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(logPhis(i), std::log(g.Probability(points.col(i))),
+        1e-5);
+    BOOST_REQUIRE_CLOSE(g.LogProbability(points.col(i)), logPhis(i), 1e-5);
+  }
+
+  // A point far away from a high-dimensional Gaussian has a probability that
+  // underflows, but its log-probability is still finite.
+  GaussianDistribution h(100);
+  arma::mat farPoints = 40.0 * arma::ones<arma::mat>(100, 2);
+  arma::vec logFar;
+  h.LogProbability(farPoints, logFar);
+
+  BOOST_REQUIRE_EQUAL(h.Probability(farPoints.col(0)), 0.0);
+  BOOST_REQUIRE_CLOSE(logFar(0), -50.0 * std::log(2 * M_PI) - 80000.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(logFar(1), logFar(0), 1e-5);
+}
+
+/**
+ * A singular covariance can't be factorized as it is, but the log-probability
+ * should still be finite (and the stored covariance should not be changed).
+ */
+BOOST_AUTO_TEST_CASE(GaussianSingularCovarianceTest)
+{
+  arma::vec mean = "1 2 3";
+  // The third dimension is the sum of the first two, so this is singular.
+  arma::mat cov = "2 1 3; 1 2 3; 3 3 6";
+
+  GaussianDistribution g(mean, cov);
+  for (size_t i = 0; i < cov.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(g.Covariance()[i], cov[i], 1e-5);
+
+  arma::mat points = "1 2; 2 1; 3 3";
+  arma::vec logPhis;
+  g.LogProbability(points, logPhis);
+
+  BOOST_REQUIRE_EQUAL(logPhis.n_elem, 2);
+  for (size_t i = 0; i < points.n_cols; ++i)
+  {
+    BOOST_REQUIRE(arma::is_finite(logPhis(i)));
+    BOOST_REQUIRE_CLOSE(g.LogProbability(points.col(i)), logPhis(i), 1e-5);
+  }
 }
 
 /**
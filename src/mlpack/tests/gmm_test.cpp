@@ -13,6 +13,7 @@
 #include <mlpack/methods/gmm/positive_definite_constraint.hpp>
 #include <mlpack/methods/gmm/diagonal_constraint.hpp>
 #include <mlpack/methods/gmm/eigenvalue_ratio_constraint.hpp>
+#include <mlpack/methods/gmm/em_tree_rules.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
@@ -41,6 +42,30 @@ BOOST_AUTO_TEST_CASE(GMMProbabilityTest)
   BOOST_REQUIRE_CLOSE(gmm.Probability("1.4 0"), 0.024676682176, 1e-5);
 }
 
+/**
+ * Test GMM::LogProbability() for a set of observations (the same as the last
+ * test).
+ */
+BOOST_AUTO_TEST_CASE(GMMLogProbabilityTest)
+{
+  GMM<> gmm(2, 2);
+  gmm.Component(0) = distribution::GaussianDistribution("0 0", "1 0; 0 1");
+  gmm.Component(1) = distribution::GaussianDistribution("3 3", "2 1; 1 2");
+  gmm.Weights() = "0.3 0.7";
+
+  arma::mat observations("0 1 2 3 -1 1.4; 0 1 2 3 5.3 0");
+  arma::vec logProbabilities;
+  gmm.LogProbability(observations, logProbabilities);
+
+  BOOST_REQUIRE_EQUAL(logProbabilities.n_elem, 6);
+  BOOST_REQUIRE_CLOSE(logProbabilities[0], log(0.05094887202), 1e-5);
+  BOOST_REQUIRE_CLOSE(logProbabilities[1], log(0.03451996667), 1e-5);
+  BOOST_REQUIRE_CLOSE(logProbabilities[2], log(0.04696302254), 1e-5);
+  BOOST_REQUIRE_CLOSE(logProbabilities[3], log(0.06432759685), 1e-5);
+  BOOST_REQUIRE_CLOSE(logProbabilities[4], log(2.503171278804e-6), 1e-5);
+  BOOST_REQUIRE_CLOSE(logProbabilities[5], log(0.024676682176), 1e-5);
+}
+
 /**
  * Test GMM::Probability() for a single observation being from a particular
  * component.
@@ -490,7 +515,7 @@ BOOST_AUTO_TEST_CASE(GMMLoadSaveTest)
   for (size_t i = 0; i < gmm.Gaussians(); ++i)
   {
     gmm.Component(i).Mean().randu();
-    gmm.Component(i).Covariance().randu();
+    gmm.Component(i).Covariance(arma::randu<arma::mat>(4, 4));
   }
 
   gmm.Save("test-gmm-save.xml");
@@ -524,6 +549,77 @@ BOOST_AUTO_TEST_CASE(GMMLoadSaveTest)
   }
 }
 
+/**
+ * Save a GMM in the binary format and make sure that it loads back exactly, and
+ * that an XML file converted to binary gives the same model.
+ */
+BOOST_AUTO_TEST_CASE(GMMLoadSaveBinaryTest)
+{
+  GMM<> gmm(10, 4);
+  gmm.Weights().randu();
+
+  for (size_t i = 0; i < gmm.Gaussians(); ++i)
+  {
+    gmm.Component(i).Mean().randu();
+    arma::mat covariance = arma::randu<arma::mat>(4, 4);
+    covariance = covariance * trans(covariance) + arma::eye<arma::mat>(4, 4);
+    gmm.Component(i).Covariance(covariance);
+  }
+
+  gmm.Save("test-gmm-save.bin");
+
+  GMM<> gmm2;
+  gmm2.Load("test-gmm-save.bin");
+
+  // Now convert through XML: load the XML file and write it as binary.
+  gmm.Save("test-gmm-save.xml");
+  util::SaveRestoreUtility sr;
+  sr.ReadFile("test-gmm-save.xml");
+  sr.WriteFile("test-gmm-save-converted.bin");
+
+  GMM<> gmm3;
+  gmm3.Load("test-gmm-save-converted.bin");
+
+  // Remove clutter.
+  remove("test-gmm-save.bin");
+  remove("test-gmm-save.xml");
+  remove("test-gmm-save-converted.bin");
+
+  BOOST_REQUIRE_EQUAL(gmm.Gaussians(), gmm2.Gaussians());
+  BOOST_REQUIRE_EQUAL(gmm.Dimensionality(), gmm2.Dimensionality());
+  BOOST_REQUIRE_EQUAL(gmm.Gaussians(), gmm3.Gaussians());
+  BOOST_REQUIRE_EQUAL(gmm.Dimensionality(), gmm3.Dimensionality());
+
+  // The binary format stores the doubles exactly.
+  for (size_t i = 0; i < gmm.Gaussians(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(gmm.Weights()[i], gmm2.Weights()[i]);
+    BOOST_REQUIRE_CLOSE(gmm.Weights()[i], gmm3.Weights()[i], 1e-5);
+  }
+
+  for (size_t i = 0; i < gmm.Gaussians(); ++i)
+  {
+    for (size_t j = 0; j < gmm.Dimensionality(); ++j)
+    {
+      BOOST_REQUIRE_EQUAL(gmm.Component(i).Mean()[j],
+          gmm2.Component(i).Mean()[j]);
+      BOOST_REQUIRE_CLOSE(gmm.Component(i).Mean()[j],
+          gmm3.Component(i).Mean()[j], 1e-5);
+    }
+
+    for (size_t j = 0; j < gmm.Dimensionality(); ++j)
+    {
+      for (size_t k = 0; k < gmm.Dimensionality(); ++k)
+      {
+        BOOST_REQUIRE_EQUAL(gmm.Component(i).Covariance()(j, k),
+            gmm2.Component(i).Covariance()(j, k));
+        BOOST_REQUIRE_CLOSE(gmm.Component(i).Covariance()(j, k),
+            gmm3.Component(i).Covariance()(j, k), 1e-5);
+      }
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE(NoConstraintTest)
 {
   // Generate random matrices and make sure they end up the same.
@@ -759,4 +855,202 @@ BOOST_AUTO_TEST_CASE(UseExistingModelTest)
 }
 
 
+/**
+ * Generate a dataset from many well-separated Gaussians on a grid, for the
+ * tree-based E-step tests.  The Gaussians and their weights are returned too.
+ */
+void GenerateGridGaussians(
+    arma::mat& data,
+    std::vector<distribution::GaussianDistribution>& dists,
+    arma::vec& weights)
+{
+  const size_t side = 4;
+  const size_t pointsPerGaussian = 100;
+
+  dists.clear();
+  data.set_size(2, side * side * pointsPerGaussian);
+  for (size_t i = 0; i < side; ++i)
+  {
+    for (size_t j = 0; j < side; ++j)
+    {
+      arma::vec mean(2);
+      mean[0] = 10.0 * i;
+      mean[1] = 10.0 * j;
+      arma::mat covariance("1.0 0.2; 0.2 0.6");
+
+      distribution::GaussianDistribution g(mean, covariance);
+      const size_t begin = dists.size() * pointsPerGaussian;
+      for (size_t k = 0; k < pointsPerGaussian; ++k)
+        data.col(begin + k) = g.Random();
+
+      dists.push_back(g);
+    }
+  }
+
+  weights.ones(dists.size());
+  weights /= dists.size();
+}
+
+/**
+ * Make sure that the tree-based E-step gives the same conditional
+ * probabilities as evaluating every Gaussian on every point, up to the pruning
+ * tolerance, and that it prunes most of the evaluations for well-separated
+ * Gaussians.
+ */
+BOOST_AUTO_TEST_CASE(EMTreeRulesTest)
+{
+  arma::mat data;
+  std::vector<distribution::GaussianDistribution> dists;
+  arma::vec weights;
+  GenerateGridGaussians(data, dists, weights);
+
+  // Compute the conditional probabilities naively.
+  arma::mat logProbs(data.n_cols, dists.size());
+  arma::vec logProb;
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    dists[i].LogProbability(data, logProb);
+    logProbs.col(i) = logProb + std::log(weights[i]);
+  }
+
+  // Build the tree and run the rules.
+  typedef EMFit<>::TreeType TreeType;
+  arma::mat dataset(data);
+  std::vector<size_t> oldFromNew;
+  TreeType tree(dataset, oldFromNew);
+
+  const double pruneTolerance = 1e-6;
+  EMTreeRules<TreeType> rules(dataset, dists, weights, arma::vec(),
+      pruneTolerance);
+  if (rules.Score(0, tree) != DBL_MAX)
+  {
+    TreeType::SingleTreeTraverser<EMTreeRules<TreeType> > traverser(rules);
+    traverser.Traverse(0, tree);
+  }
+
+  arma::sp_mat condProb;
+  rules.ConditionalProbabilities(condProb);
+
+  BOOST_REQUIRE_EQUAL(condProb.n_rows, data.n_cols);
+  BOOST_REQUIRE_EQUAL(condProb.n_cols, dists.size());
+  BOOST_REQUIRE_LT(rules.Evaluations(), data.n_cols * dists.size() / 4);
+
+  double logLikelihood = 0.0;
+  for (size_t j = 0; j < data.n_cols; ++j)
+  {
+    const arma::rowvec row = logProbs.row(oldFromNew[j]);
+    const double logSum = row.max() +
+        std::log(accu(arma::exp(row - row.max())));
+    logLikelihood += logSum;
+
+    double probSum = 0.0;
+    for (size_t i = 0; i < dists.size(); ++i)
+    {
+      const double prob = std::exp(row[i] - logSum);
+      probSum += condProb(j, i);
+      BOOST_REQUIRE_SMALL(condProb(j, i) - prob, 1e-5);
+    }
+
+    BOOST_REQUIRE_CLOSE(probSum, 1.0, 1e-5);
+  }
+
+  BOOST_REQUIRE_CLOSE(rules.LogLikelihood(), logLikelihood, 1e-3);
+}
+
+/**
+ * Make sure that the tree-based E-step agrees with the naive computation when
+ * some covariances are singular or indefinite (as they can be with
+ * --no_force_positive), and that those Gaussians don't break the pruning.
+ */
+BOOST_AUTO_TEST_CASE(EMTreeRulesSingularCovarianceTest)
+{
+  arma::mat data;
+  std::vector<distribution::GaussianDistribution> dists;
+  arma::vec weights;
+  GenerateGridGaussians(data, dists, weights);
+
+  dists[0].Covariance(arma::mat("1.0 1.0; 1.0 1.0"));
+  dists[5].Covariance(arma::mat("1.0 0.0; 0.0 0.0"));
+  dists[10].Covariance(arma::mat("1.0 0.0; 0.0 -0.1"));
+
+  arma::mat logProbs(data.n_cols, dists.size());
+  arma::vec logProb;
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    dists[i].LogProbability(data, logProb);
+    logProbs.col(i) = logProb + std::log(weights[i]);
+  }
+
+  typedef EMFit<>::TreeType TreeType;
+  arma::mat dataset(data);
+  std::vector<size_t> oldFromNew;
+  TreeType tree(dataset, oldFromNew);
+
+  EMTreeRules<TreeType> rules(dataset, dists, weights, arma::vec(), 1e-6);
+  if (rules.Score(0, tree) != DBL_MAX)
+  {
+    TreeType::SingleTreeTraverser<EMTreeRules<TreeType> > traverser(rules);
+    traverser.Traverse(0, tree);
+  }
+
+  arma::sp_mat condProb;
+  rules.ConditionalProbabilities(condProb);
+
+  double logLikelihood = 0.0;
+  for (size_t j = 0; j < data.n_cols; ++j)
+  {
+    const arma::rowvec row = logProbs.row(oldFromNew[j]);
+    const double logSum = row.max() +
+        std::log(accu(arma::exp(row - row.max())));
+    logLikelihood += logSum;
+
+    for (size_t i = 0; i < dists.size(); ++i)
+      BOOST_REQUIRE_SMALL(condProb(j, i) - std::exp(row[i] - logSum), 1e-5);
+  }
+
+  BOOST_REQUIRE(arma::is_finite(rules.LogLikelihood()));
+  BOOST_REQUIRE_CLOSE(rules.LogLikelihood(), logLikelihood, 1e-3);
+}
+
+/**
+ * Make sure that EM with the tree-based E-step gives (almost) the same model as
+ * EM without it, from the same starting model.
+ */
+BOOST_AUTO_TEST_CASE(GMMTrainEMTreeTest)
+{
+  arma::mat data;
+  std::vector<distribution::GaussianDistribution> trueDists;
+  arma::vec trueWeights;
+  GenerateGridGaussians(data, trueDists, trueWeights);
+
+  // Start from a perturbed model.
+  std::vector<distribution::GaussianDistribution> dists(trueDists);
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    dists[i].Mean() += 0.5 * arma::randn<arma::vec>(2);
+    dists[i].Covariance(arma::mat("1.5 0.0; 0.0 1.5"));
+  }
+  arma::vec weights(trueWeights);
+
+  std::vector<distribution::GaussianDistribution> treeDists(dists);
+  arma::vec treeWeights(weights);
+
+  EMFit<> em(10, 1e-10);
+  em.Estimate(data, dists, weights, true);
+
+  EMFit<> treeEm(10, 1e-10);
+  treeEm.PruneTolerance() = 1e-8;
+  treeEm.Estimate(data, treeDists, treeWeights, true);
+
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    BOOST_REQUIRE_CLOSE(treeWeights[i], weights[i], 1e-3);
+    for (size_t d = 0; d < 2; ++d)
+      BOOST_REQUIRE_SMALL(treeDists[i].Mean()[d] - dists[i].Mean()[d], 1e-5);
+    for (size_t d = 0; d < 4; ++d)
+      BOOST_REQUIRE_SMALL(treeDists[i].Covariance()[d] -
+          dists[i].Covariance()[d], 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
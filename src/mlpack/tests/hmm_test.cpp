@@ -5,6 +5,8 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/hmm/hmm.hpp>
+#include <mlpack/methods/hmm/hmm_filter.hpp>
+#include <mlpack/methods/hmm/hmm_regression_filter.hpp>
 #include <mlpack/methods/gmm/gmm.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -300,6 +302,55 @@ BOOST_AUTO_TEST_CASE(SimpleBaumWelchDiscreteHMM_2)
   BOOST_REQUIRE_CLOSE(hmm.Emission()[1].Probability("3"), 0.8, 2.5);
 }
 
+/**
+ * Make sure that Baum-Welch training gives exactly the same model no matter how
+ * many threads are used.
+ */
+BOOST_AUTO_TEST_CASE(BaumWelchThreadsTest)
+{
+  HMM<DiscreteDistribution> hmm(3, DiscreteDistribution(4));
+  hmm.Transition() = arma::mat("0.5 0.2 0.1; 0.3 0.6 0.2; 0.2 0.2 0.7");
+  hmm.Emission()[0].Probabilities() = "0.70 0.10 0.10 0.10";
+  hmm.Emission()[1].Probabilities() = "0.10 0.70 0.10 0.10";
+  hmm.Emission()[2].Probabilities() = "0.10 0.10 0.40 0.40";
+
+  // Generate some sequences of different lengths, so that the blocks of
+  // sequences have different amounts of work.
+  std::vector<arma::mat> observations(100);
+  for (size_t i = 0; i < observations.size(); ++i)
+  {
+    arma::Col<size_t> states;
+    hmm.Generate(20 + math::RandInt(100), observations[i], states,
+        (size_t) math::RandInt(3));
+  }
+
+  // Start both models from the same guess.
+  HMM<DiscreteDistribution> hmm1(3, DiscreteDistribution(4));
+  hmm1.Transition() = arma::mat("0.4 0.3 0.3; 0.3 0.4 0.3; 0.3 0.3 0.4");
+  for (size_t i = 0; i < 3; ++i)
+  {
+    hmm1.Emission()[i].Probabilities() = arma::randu<arma::vec>(4);
+    hmm1.Emission()[i].Probabilities() /=
+        accu(hmm1.Emission()[i].Probabilities());
+  }
+  HMM<DiscreteDistribution> hmm4(hmm1);
+
+  hmm1.Tolerance() = 1e-3;
+  hmm4.Tolerance() = 1e-3;
+  hmm4.NumThreads() = 4;
+
+  hmm1.Train(observations);
+  hmm4.Train(observations);
+
+  for (size_t i = 0; i < hmm1.Transition().n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(hmm1.Transition()[i], hmm4.Transition()[i]);
+
+  for (size_t i = 0; i < 3; ++i)
+    for (size_t j = 0; j < 4; ++j)
+      BOOST_REQUIRE_EQUAL(hmm1.Emission()[i].Probabilities()[j],
+          hmm4.Emission()[i].Probabilities()[j]);
+}
+
 BOOST_AUTO_TEST_CASE(DiscreteHMMLabeledTrainTest)
 {
   // Generate a random Markov model with 3 hidden states and 6 observations.
@@ -580,6 +631,43 @@ BOOST_AUTO_TEST_CASE(GaussianHMMSimpleTest)
   }
 }
 
+/**
+ * In high dimensions, the emission probabilities underflow to 0, but the
+ * Viterbi algorithm works with log-probabilities and should still find the
+ * right states.
+ */
+BOOST_AUTO_TEST_CASE(GaussianHMMHighDimensionalPredictTest)
+{
+  const size_t dims = 1000;
+  GaussianDistribution g1(arma::zeros<arma::vec>(dims),
+      arma::eye<arma::mat>(dims, dims));
+  GaussianDistribution g2(arma::ones<arma::vec>(dims),
+      arma::eye<arma::mat>(dims, dims));
+
+  // Make sure this test is testing what it is supposed to.
+  BOOST_REQUIRE_EQUAL(g1.Probability(g1.Random()), 0.0);
+
+  arma::vec initial("0.5 0.5");
+  arma::mat transition("0.9 0.1; 0.1 0.9");
+
+  std::vector<GaussianDistribution> emission;
+  emission.push_back(g1);
+  emission.push_back(g2);
+
+  HMM<GaussianDistribution> hmm(initial, transition, emission);
+
+  arma::mat observations;
+  arma::Col<size_t> classes;
+  hmm.Generate(200, observations, classes);
+
+  arma::Col<size_t> predictedClasses;
+  const double logLikelihood = hmm.Predict(observations, predictedClasses);
+
+  BOOST_REQUIRE(logLikelihood > -std::numeric_limits<double>::infinity());
+  for (size_t i = 0; i < classes.n_elem; i++)
+    BOOST_REQUIRE_EQUAL(predictedClasses[i], classes[i]);
+}
+
 /**
  * Ensure that Gaussian HMMs can be trained properly, for the labeled training
  * case and also for the unlabeled training case.
@@ -992,7 +1080,8 @@ BOOST_AUTO_TEST_CASE(GMMHMMLoadSaveTest)
     for (size_t i = 0; i < hmm.Emission()[j].Gaussians(); ++i)
     {
       hmm.Emission()[j].Component(i).Mean().randu();
-      hmm.Emission()[j].Component(i).Covariance().randu();
+      hmm.Emission()[j].Component(i).Covariance(
+          arma::randu<arma::mat>(3, 3));
     }
   }
 
@@ -1048,7 +1137,7 @@ BOOST_AUTO_TEST_CASE(GaussianHMMLoadSaveTest)
   for(size_t j = 0; j < hmm.Emission().size(); ++j)
   {
     hmm.Emission()[j].Mean().randu();
-    hmm.Emission()[j].Covariance().randu();
+    hmm.Emission()[j].Covariance(arma::randu<arma::mat>(2, 2));
   }
 
   util::SaveRestoreUtility sr;
@@ -1132,5 +1221,134 @@ BOOST_AUTO_TEST_CASE(DiscreteHMMLoadSaveTest)
   }
 }
 
+/**
+ * Make sure that pushing observations into an HMMFilter one at a time gives the
+ * same log-likelihood and state probabilities as computing them on the whole
+ * sequence so far.
+ */
+BOOST_AUTO_TEST_CASE(GaussianHMMFilterTest)
+{
+  std::vector<GaussianDistribution> emission;
+  emission.push_back(GaussianDistribution("0.0 0.0", "1.0 0.3; 0.3 1.0"));
+  emission.push_back(GaussianDistribution("1.5 -1.0", "0.6 0.0; 0.0 1.4"));
+  emission.push_back(GaussianDistribution("-2.0 1.0", "2.0 -0.5; -0.5 1.0"));
+
+  arma::vec initial("0.2 0.5 0.3");
+  arma::mat transition("0.8 0.1 0.2;"
+                       "0.1 0.7 0.1;"
+                       "0.1 0.2 0.7");
+
+  HMM<GaussianDistribution> hmm(initial, transition, emission);
+
+  arma::mat observations;
+  arma::Col<size_t> states;
+  hmm.Generate(100, observations, states);
+
+  HMMFilter<GaussianDistribution> filter(hmm);
+  BOOST_REQUIRE_EQUAL(filter.Steps(), 0);
+  BOOST_REQUIRE_SMALL(filter.LogLikelihood(), 1e-10);
+
+  // Do this twice, to make sure that Reset() works.
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    for (size_t t = 0; t < observations.n_cols; ++t)
+    {
+      const double logLikelihood = filter.Push(observations.col(t));
+      BOOST_REQUIRE_EQUAL(filter.Steps(), t + 1);
+      BOOST_REQUIRE_CLOSE(logLikelihood, filter.LogLikelihood(), 1e-10);
+
+      // Check against the whole sequence every so often.
+      if (t % 10 != 0 && t != observations.n_cols - 1)
+        continue;
+
+      const arma::mat prefix = observations.cols(0, t);
+      BOOST_REQUIRE_CLOSE(logLikelihood, hmm.LogLikelihood(prefix), 1e-5);
+
+      // The smoothed state probabilities of the last observation only depend
+      // on the observations before it, so they are the filtered probabilities.
+      arma::mat stateProb;
+      hmm.Estimate(prefix, stateProb);
+      for (size_t j = 0; j < initial.n_elem; ++j)
+      {
+        if (stateProb(j, t) < 1e-10)
+          BOOST_REQUIRE_SMALL(filter.StateProbabilities()[j], 1e-8);
+        else
+          BOOST_REQUIRE_CLOSE(filter.StateProbabilities()[j], stateProb(j, t),
+              1e-5);
+      }
+    }
+
+    filter.Reset();
+    BOOST_REQUIRE_EQUAL(filter.Steps(), 0);
+    BOOST_REQUIRE_SMALL(filter.LogLikelihood(), 1e-10);
+    for (size_t j = 0; j < initial.n_elem; ++j)
+      BOOST_REQUIRE_CLOSE(filter.StateProbabilities()[j], initial[j], 1e-10);
+  }
+}
+
+/**
+ * Make sure that pushing predictors and responses into an HMMRegressionFilter
+ * gives the same log-likelihood as HMMRegression::LogLikelihood() and the same
+ * expected response as HMMRegression::Filter(), on the sequence so far.
+ */
+BOOST_AUTO_TEST_CASE(HMMRegressionFilterTest)
+{
+  // Two regimes: y = 2x + 1 and y = -x + 3, with some noise.
+  arma::mat x1 = arma::randu<arma::mat>(1, 100);
+  arma::vec y1 = 2.0 * arma::trans(x1) + 1.0 +
+      0.1 * arma::randn<arma::vec>(100);
+  arma::mat x2 = arma::randu<arma::mat>(1, 100);
+  arma::vec y2 = -arma::trans(x2) + 3.0 +
+      0.1 * arma::randn<arma::vec>(100);
+
+  std::vector<RegressionDistribution> emission;
+  emission.push_back(RegressionDistribution(x1, y1));
+  emission.push_back(RegressionDistribution(x2, y2));
+
+  arma::vec initial("0.6 0.4");
+  arma::mat transition("0.9 0.2;"
+                       "0.1 0.8");
+  HMMRegression hmmr(initial, transition, emission);
+
+  // A short sequence which switches regimes halfway through.
+  const size_t length = 20;
+  arma::mat predictors = arma::randu<arma::mat>(1, length);
+  arma::vec responses(length);
+  for (size_t t = 0; t < length; ++t)
+  {
+    responses[t] = (t < length / 2) ? 2.0 * predictors(0, t) + 1.0 :
+        -predictors(0, t) + 3.0;
+    responses[t] += 0.1 * math::RandNormal();
+  }
+
+  HMMRegressionFilter filter(hmmr);
+  for (size_t t = 0; t < length; ++t)
+  {
+    const double logLikelihood = filter.Push(predictors.col(t),
+        responses[t]);
+    BOOST_REQUIRE_EQUAL(filter.Steps(), t + 1);
+
+    const arma::mat predictorPrefix = predictors.cols(0, t);
+    const arma::vec responsePrefix = responses.subvec(0, t);
+    BOOST_REQUIRE_CLOSE(logLikelihood,
+        hmmr.LogLikelihood(predictorPrefix, responsePrefix), 1e-5);
+
+    // The expected response given the observations so far is the average of
+    // the predictions of each regime, weighted by the state probabilities.
+    arma::vec filterSeq;
+    hmmr.Filter(predictorPrefix, responsePrefix, filterSeq);
+    BOOST_REQUIRE_EQUAL(filterSeq.n_elem, t + 1);
+
+    double expected = 0.0;
+    arma::vec prediction;
+    for (size_t j = 0; j < emission.size(); ++j)
+    {
+      hmmr.Emission()[j].Predict(predictors.col(t), prediction);
+      expected += filter.StateProbabilities()[j] * prediction[0];
+    }
+    BOOST_REQUIRE_CLOSE(expected, filterSeq[t], 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
 
@@ -7,6 +7,7 @@
 #include <mlpack/core.hpp>
 #include <mlpack/core/kernels/gaussian_kernel.hpp>
 #include <mlpack/methods/kernel_pca/kernel_rules/nystroem_method.hpp>
+#include <mlpack/methods/kernel_pca/kernel_rules/randomized_method.hpp>
 #include <mlpack/methods/kernel_pca/kernel_pca.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -145,4 +146,78 @@ BOOST_AUTO_TEST_CASE(CircleTransformationTestNystroem)
   BOOST_REQUIRE_EQUAL(ranges[1].Contains(ranges[2]), false);
 }
 
+/**
+ * The randomized kernel rule should also turn a circle dataset into a linearly
+ * separable dataset in one dimension.
+ */
+BOOST_AUTO_TEST_CASE(CircleTransformationTestRandomized)
+{
+  // Three concentric rings in three dimensions, as in the tests above.
+  arma::mat dataset;
+  dataset.randn(3, 750);
+  dataset *= 0.05;
+
+  for (size_t i = 250; i < 750; ++i)
+  {
+    const double pointNorm = norm(dataset.col(i), 2);
+    const double push = (i < 500) ? 2.0 : 5.0;
+    dataset.col(i) += push * (dataset.col(i) / pointNorm);
+  }
+
+  KernelPCA<GaussianKernel, RandomizedKernelRule<GaussianKernel> > p;
+  p.Apply(dataset, 1);
+  BOOST_REQUIRE_EQUAL(dataset.n_rows, 1);
+
+  Range ranges[3];
+  for (size_t i = 0; i < 750; ++i)
+    ranges[i / 250] |= dataset(0, i);
+
+  // None of these ranges should overlap -- the classes should be linearly
+  // separable.
+  BOOST_REQUIRE_EQUAL(ranges[0].Contains(ranges[1]), false);
+  BOOST_REQUIRE_EQUAL(ranges[0].Contains(ranges[2]), false);
+  BOOST_REQUIRE_EQUAL(ranges[1].Contains(ranges[2]), false);
+}
+
+/**
+ * The top eigenvalues and components found by the randomized kernel rule
+ * should be very close to the ones found by the naive kernel rule.
+ */
+BOOST_AUTO_TEST_CASE(RandomizedMatchesNaiveTest)
+{
+  arma::mat dataset;
+  dataset.randn(3, 400);
+  dataset.row(0) *= 3.0;
+  dataset.row(1) *= 1.5;
+  dataset.row(2) *= 0.5;
+
+  GaussianKernel kernel(2.0);
+  KernelPCA<GaussianKernel> naive(kernel);
+  KernelPCA<GaussianKernel, RandomizedKernelRule<GaussianKernel> >
+      randomized(kernel);
+
+  arma::mat naiveData, randomizedData, naiveEigvec, randomizedEigvec;
+  arma::vec naiveEigval, randomizedEigval;
+  naive.Apply(dataset, naiveData, naiveEigval, naiveEigvec, 3);
+  randomized.Apply(dataset, randomizedData, randomizedEigval,
+      randomizedEigvec, 3);
+
+  BOOST_REQUIRE_EQUAL(randomizedEigval.n_elem, 3);
+  BOOST_REQUIRE_EQUAL(randomizedEigvec.n_rows, 400);
+  BOOST_REQUIRE_EQUAL(randomizedEigvec.n_cols, 3);
+  BOOST_REQUIRE_EQUAL(randomizedData.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(randomizedData.n_cols, 400);
+
+  for (size_t i = 0; i < 3; ++i)
+    BOOST_REQUIRE_CLOSE(randomizedEigval[i], naiveEigval[i], 0.1);
+
+  // The components may have opposite signs.
+  const arma::rowvec naiveComponent = naiveData.row(0);
+  arma::rowvec randomizedComponent = randomizedData.row(0);
+  if (arma::dot(naiveComponent, randomizedComponent) < 0)
+    randomizedComponent *= -1;
+  BOOST_REQUIRE_SMALL(arma::norm(naiveComponent - randomizedComponent, 2) /
+      arma::norm(naiveComponent, 2), 0.01);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -56,4 +56,35 @@ BOOST_AUTO_TEST_CASE(IsNormalizedTest)
       false);
 }
 
+BOOST_AUTO_TEST_CASE(UsesDistanceAndDotProductTest)
+{
+  // Types that are not kernels, or for which nothing is known, should use
+  // neither.
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<int>::UsesDistance, false);
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<int>::UsesDotProduct, false);
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<CosineDistance>::UsesDistance,
+      false);
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<CosineDistance>::UsesDotProduct,
+      false);
+
+  // Kernels that depend only on the distance.
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<EpanechnikovKernel>::UsesDistance,
+      true);
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<GaussianKernel>::UsesDistance, true);
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<LaplacianKernel>::UsesDistance, true);
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<SphericalKernel>::UsesDistance, true);
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<TriangularKernel>::UsesDistance,
+      true);
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<GaussianKernel>::UsesDotProduct,
+      false);
+
+  // Kernels that depend only on the dot product.
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<LinearKernel>::UsesDotProduct, true);
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<PolynomialKernel>::UsesDotProduct,
+      true);
+  BOOST_REQUIRE_EQUAL(
+      (bool) KernelTraits<HyperbolicTangentKernel>::UsesDotProduct, true);
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<LinearKernel>::UsesDistance, false);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -12,6 +12,7 @@
 #include <mlpack/methods/kmeans/pelleg_moore_kmeans.hpp>
 #include <mlpack/methods/kmeans/dtnn_kmeans.hpp>
 #include <mlpack/methods/kmeans/dual_tree_kmeans.hpp>
+#include <mlpack/methods/kmeans/mini_batch_kmeans.hpp>
 
 #include <mlpack/core/tree/cover_tree/cover_tree.hpp>
 
@@ -488,6 +489,77 @@ BOOST_AUTO_TEST_CASE(SparseKMeansTest)
   BOOST_REQUIRE_EQUAL(assignments[11], clusterTwo);
 }
 
+/**
+ * Make sure that the blocked Euclidean Lloyd step for dense data gives the same
+ * results as the point-by-point step (which is used for sparse data), over
+ * several blocks.
+ */
+BOOST_AUTO_TEST_CASE(NaiveKMeansBlockedTest)
+{
+  arma::mat dataset(10, 3000);
+  dataset.randu();
+  arma::sp_mat sparseDataset(dataset);
+
+  arma::mat centroids(10, 17);
+  centroids.randu();
+
+  metric::EuclideanDistance metric;
+  NaiveKMeans<metric::EuclideanDistance, arma::mat> dense(dataset, metric);
+  NaiveKMeans<metric::EuclideanDistance, arma::sp_mat> sparse(sparseDataset,
+      metric);
+
+  arma::mat denseCentroids, sparseCentroids;
+  arma::Col<size_t> denseCounts, sparseCounts;
+  const double denseNorm = dense.Iterate(centroids, denseCentroids,
+      denseCounts);
+  const double sparseNorm = sparse.Iterate(centroids, sparseCentroids,
+      sparseCounts);
+
+  BOOST_REQUIRE_CLOSE(denseNorm, sparseNorm, 1e-5);
+  BOOST_REQUIRE_EQUAL(accu(denseCounts), dataset.n_cols);
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(denseCounts[i], sparseCounts[i]);
+  for (size_t i = 0; i < centroids.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(denseCentroids[i], sparseCentroids[i], 1e-5);
+}
+
+/**
+ * Make sure that a mini-batch step on sparse data (where the batch stays
+ * sparse) gives the same result as on the same data stored densely, when the
+ * same points are sampled.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchKMeansSparseTest)
+{
+  arma::sp_mat sparseDataset;
+  sparseDataset.sprandu(10, 3000, 0.2);
+  arma::mat dataset(sparseDataset);
+
+  arma::mat centroids(10, 5);
+  centroids.randu();
+
+  metric::EuclideanDistance metric;
+  MiniBatchKMeans<metric::EuclideanDistance, arma::mat> dense(dataset, metric,
+      500);
+  MiniBatchKMeans<metric::EuclideanDistance, arma::sp_mat> sparse(
+      sparseDataset, metric, 500);
+
+  arma::mat denseCentroids, sparseCentroids;
+  arma::Col<size_t> denseCounts, sparseCounts;
+  math::RandomSeed(17);
+  const double denseNorm = dense.Iterate(centroids, denseCentroids,
+      denseCounts);
+  math::RandomSeed(17);
+  const double sparseNorm = sparse.Iterate(centroids, sparseCentroids,
+      sparseCounts);
+
+  BOOST_REQUIRE_CLOSE(denseNorm, sparseNorm, 1e-5);
+  BOOST_REQUIRE_EQUAL(accu(sparseCounts), 500);
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(denseCounts[i], sparseCounts[i]);
+  for (size_t i = 0; i < centroids.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(denseCentroids[i], sparseCentroids[i], 1e-5);
+}
+
 #endif // Exclude Armadillo 3.4.
 #endif // ARMA_HAS_SPMAT
 
@@ -690,4 +762,36 @@ BOOST_AUTO_TEST_CASE(DualTreeKMeansTest)
   }
 }
 
+/**
+ * Make sure that mini-batch k-means finds three well-separated clusters.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchKMeansTest)
+{
+  arma::mat means("0 10 20;"
+                  "0 10 0;"
+                  "0 0 10");
+
+  arma::mat dataset(3, 3000);
+  arma::Col<size_t> labels(3000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    labels[i] = i % 3;
+    dataset.col(i) = means.col(i % 3) + 0.5 * arma::randn<arma::vec>(3);
+  }
+
+  // Start near (but not at) the true means.
+  arma::mat centroids = means + 2.0 * arma::randu<arma::mat>(3, 3) - 1.0;
+
+  KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+      MiniBatchKMeans> kmeans(200);
+  arma::Col<size_t> assignments;
+  kmeans.Cluster(dataset, 3, assignments, centroids, false, true);
+
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], labels[i]);
+
+  for (size_t i = 0; i < means.n_elem; ++i)
+    BOOST_REQUIRE_SMALL(centroids[i] - means[i], 0.1);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
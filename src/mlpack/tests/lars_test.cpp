@@ -155,4 +155,45 @@ BOOST_AUTO_TEST_CASE(NoCholeskySingularityTest)
   }
 }
 
+// Make sure that one LARS object can be used for many problems, and that warm
+// starts give the same solution as LARS, whether or not the initial active set
+// is right.
+BOOST_AUTO_TEST_CASE(LARSReuseAndWarmStartTest)
+{
+  arma::mat X;
+  arma::vec y;
+
+  for (size_t useCholesky = 0; useCholesky < 2; ++useCholesky)
+  {
+    LARS reusedLars(useCholesky == 1, 0.5, 0.1);
+    for (size_t i = 0; i < 20; ++i)
+    {
+      GenerateProblem(X, y, 100, 10);
+      y += 0.1 * arma::randn<arma::vec>(100);
+
+      LARS lars(useCholesky == 1, 0.5, 0.1);
+      arma::vec betaOpt;
+      lars.Regress(X, y, betaOpt);
+
+      arma::vec reusedBeta;
+      reusedLars.Regress(X, y, reusedBeta);
+      for (size_t j = 0; j < betaOpt.n_elem; ++j)
+        BOOST_REQUIRE_SMALL(reusedBeta[j] - betaOpt[j], 1e-10);
+
+      // Warm start from the solution, from zero, and from something wrong.
+      arma::vec initialBetas[3];
+      initialBetas[0] = betaOpt;
+      initialBetas[1] = arma::zeros<arma::vec>(betaOpt.n_elem);
+      initialBetas[2] = arma::randn<arma::vec>(betaOpt.n_elem);
+      for (size_t k = 0; k < 3; ++k)
+      {
+        arma::vec warmBeta;
+        reusedLars.Regress(X, y, initialBetas[k], warmBeta);
+        for (size_t j = 0; j < betaOpt.n_elem; ++j)
+          BOOST_REQUIRE_SMALL(warmBeta[j] - betaOpt[j], 1e-8);
+      }
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
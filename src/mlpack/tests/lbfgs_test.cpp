@@ -112,4 +112,79 @@ BOOST_AUTO_TEST_CASE(RosenbrockWoodFunctionTest)
   }
 }
 
+/**
+ * The Rosenbrock function, counting the calls to each method, and with an
+ * EvaluateWithGradient() method.
+ */
+class CountingRosenbrockFunction
+{
+ public:
+  CountingRosenbrockFunction() :
+      evaluations(0), gradients(0), evaluationsWithGradient(0) { }
+
+  double Evaluate(const arma::mat& coordinates)
+  {
+    ++evaluations;
+    return f.Evaluate(coordinates);
+  }
+
+  void Gradient(const arma::mat& coordinates, arma::mat& gradient)
+  {
+    ++gradients;
+    f.Gradient(coordinates, gradient);
+  }
+
+  double EvaluateWithGradient(const arma::mat& coordinates,
+                              arma::mat& gradient)
+  {
+    ++evaluationsWithGradient;
+    f.Gradient(coordinates, gradient);
+    return f.Evaluate(coordinates);
+  }
+
+  const arma::mat& GetInitialPoint() const { return f.GetInitialPoint(); }
+
+  RosenbrockFunction f;
+  size_t evaluations;
+  size_t gradients;
+  size_t evaluationsWithGradient;
+};
+
+/**
+ * Make sure that EvaluateWithGradient() is detected, and that L-BFGS uses it
+ * instead of Evaluate() and Gradient().
+ */
+BOOST_AUTO_TEST_CASE(EvaluateWithGradientTest)
+{
+  BOOST_REQUIRE(HasEvaluateWithGradient<CountingRosenbrockFunction>::value);
+  BOOST_REQUIRE(!HasEvaluateWithGradient<RosenbrockFunction>::value);
+
+  // The fallback gives the same results as Evaluate() and Gradient().
+  RosenbrockFunction rf;
+  arma::mat gradient, fallbackGradient;
+  const arma::mat point = "-1.0; 2.0";
+  rf.Gradient(point, gradient);
+  BOOST_REQUIRE_CLOSE(EvaluateWithGradient(rf, point, fallbackGradient),
+      rf.Evaluate(point), 1e-5);
+  BOOST_REQUIRE_CLOSE(fallbackGradient[0], gradient[0], 1e-5);
+  BOOST_REQUIRE_CLOSE(fallbackGradient[1], gradient[1], 1e-5);
+
+  CountingRosenbrockFunction f;
+  L_BFGS<CountingRosenbrockFunction> lbfgs(f);
+  lbfgs.MaxIterations() = 10000;
+
+  arma::mat coords = f.GetInitialPoint();
+  if (!lbfgs.Optimize(coords))
+    BOOST_FAIL("L-BFGS optimization reported failure.");
+
+  BOOST_REQUIRE_CLOSE(coords[0], 1.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(coords[1], 1.0, 1e-5);
+
+  // Gradient() is never called, and Evaluate() is only called for the final
+  // objective.
+  BOOST_REQUIRE_GT(f.evaluationsWithGradient, 0);
+  BOOST_REQUIRE_EQUAL(f.gradients, 0);
+  BOOST_REQUIRE_EQUAL(f.evaluations, 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -326,6 +326,176 @@ BOOST_AUTO_TEST_CASE(LoadRawBinaryTest)
   remove("test_file.bin");
 }
 
+/**
+ * Load a matrix chunk by chunk, and return the chunks put side by side.
+ */
+arma::mat LoadInChunks(const std::string& filename,
+                       const size_t chunkSize,
+                       const bool mapped)
+{
+  data::ChunkedLoader<double> loader(filename, chunkSize, false, mapped);
+  BOOST_REQUIRE(loader.IsOpen());
+
+  arma::mat result(loader.Dimensionality(), 0);
+  arma::mat chunk;
+  while (loader.NextChunk(chunk))
+  {
+    BOOST_REQUIRE_EQUAL(chunk.n_rows, loader.Dimensionality());
+    BOOST_REQUIRE_LE(chunk.n_cols, chunkSize);
+    BOOST_REQUIRE_GT(chunk.n_cols, 0);
+    result = join_rows(result, chunk);
+  }
+
+  BOOST_REQUIRE_EQUAL(loader.PointsRead(), result.n_cols);
+  BOOST_REQUIRE_EQUAL(loader.NumPoints(), result.n_cols);
+  return result;
+}
+
+/**
+ * Make sure that chunked loading of a CSV gives the same matrix as data::Load().
+ */
+BOOST_AUTO_TEST_CASE(ChunkedLoadCSVTest)
+{
+  arma::mat test;
+  test.randu(5, 103);
+  BOOST_REQUIRE(data::Save("test_file.csv", test) == true);
+
+  arma::mat loaded;
+  BOOST_REQUIRE(data::Load("test_file.csv", loaded) == true);
+
+  // Try chunk sizes which do and don't divide the number of points.
+  const size_t chunkSizes[] = { 1, 10, 103, 5000 };
+  for (size_t c = 0; c < 4; ++c)
+  {
+    arma::mat chunked = LoadInChunks("test_file.csv", chunkSizes[c], false);
+
+    BOOST_REQUIRE_EQUAL(chunked.n_rows, loaded.n_rows);
+    BOOST_REQUIRE_EQUAL(chunked.n_cols, loaded.n_cols);
+    for (size_t i = 0; i < loaded.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(chunked[i], loaded[i], 1e-5);
+  }
+
+  remove("test_file.csv");
+}
+
+/**
+ * Make sure that chunked loading of Armadillo binary data is the same as
+ * data::Load(), both when the file is mapped and when it is not.
+ */
+BOOST_AUTO_TEST_CASE(ChunkedLoadArmaBinaryTest)
+{
+  arma::mat test;
+  test.randu(4, 97);
+  BOOST_REQUIRE(data::Save("test_file.bin", test) == true);
+
+  arma::mat loaded;
+  BOOST_REQUIRE(data::Load("test_file.bin", loaded) == true);
+  BOOST_REQUIRE_EQUAL(loaded.n_rows, test.n_rows);
+  BOOST_REQUIRE_EQUAL(loaded.n_cols, test.n_cols);
+  for (size_t i = 0; i < test.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(loaded[i], test[i]);
+
+  for (size_t mapped = 0; mapped < 2; ++mapped)
+  {
+    arma::mat chunked = LoadInChunks("test_file.bin", 10, (mapped == 1));
+
+    BOOST_REQUIRE_EQUAL(chunked.n_rows, test.n_rows);
+    BOOST_REQUIRE_EQUAL(chunked.n_cols, test.n_cols);
+    for (size_t i = 0; i < test.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(chunked[i], test[i]);
+  }
+
+  remove("test_file.bin");
+}
+
+/**
+ * Make sure that chunked loading of raw binary data gives one-dimensional
+ * points, like data::Load().
+ */
+BOOST_AUTO_TEST_CASE(ChunkedLoadRawBinaryTest)
+{
+  arma::mat test = "1 2;"
+                   "3 4;"
+                   "5 6;"
+                   "7 8;";
+
+  arma::mat testTrans = trans(test);
+  BOOST_REQUIRE(testTrans.quiet_save("test_file.bin", arma::raw_binary)
+      == true);
+
+  arma::mat chunked = LoadInChunks("test_file.bin", 3, true);
+
+  BOOST_REQUIRE_EQUAL(chunked.n_rows, 1);
+  BOOST_REQUIRE_EQUAL(chunked.n_cols, 8);
+  for (int i = 0; i < 8; i++)
+    BOOST_REQUIRE_CLOSE(chunked[i], (double) (i + 1), 1e-5);
+
+  remove("test_file.bin");
+}
+
+/**
+ * Make sure that Reset() goes back to the start of the file.
+ */
+BOOST_AUTO_TEST_CASE(ChunkedLoadResetTest)
+{
+  std::fstream f;
+  f.open("test_file.csv", std::fstream::out);
+
+  f << "1, 2, 3" << std::endl;
+  f << "4, 5, 6" << std::endl;
+  f << std::endl;
+  f << "7, 8, 9" << std::endl;
+
+  f.close();
+
+  data::ChunkedLoader<double> loader("test_file.csv", 2);
+  BOOST_REQUIRE(loader.IsOpen());
+  BOOST_REQUIRE_EQUAL(loader.Dimensionality(), 3);
+
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    arma::mat chunk;
+    BOOST_REQUIRE(loader.NextChunk(chunk));
+    BOOST_REQUIRE_EQUAL(chunk.n_cols, 2);
+    for (size_t i = 0; i < 6; ++i)
+      BOOST_REQUIRE_CLOSE(chunk[i], (double) (i + 1), 1e-5);
+
+    BOOST_REQUIRE(loader.NextChunk(chunk));
+    BOOST_REQUIRE_EQUAL(chunk.n_cols, 1);
+    for (size_t i = 0; i < 3; ++i)
+      BOOST_REQUIRE_CLOSE(chunk[i], (double) (i + 7), 1e-5);
+
+    BOOST_REQUIRE(!loader.NextChunk(chunk));
+    BOOST_REQUIRE_EQUAL(chunk.n_cols, 0);
+    BOOST_REQUIRE_EQUAL(loader.NumPoints(), 3);
+
+    loader.Reset();
+  }
+
+  remove("test_file.csv");
+}
+
+/**
+ * Make sure that a CSV with a bad line fails to load in chunks.
+ */
+BOOST_AUTO_TEST_CASE(ChunkedLoadBadCSVTest)
+{
+  std::fstream f;
+  f.open("test_file.csv", std::fstream::out);
+
+  f << "1, 2, 3" << std::endl;
+  f << "4, 5" << std::endl;
+
+  f.close();
+
+  data::ChunkedLoader<double> loader("test_file.csv", 10);
+  arma::mat chunk;
+  BOOST_REQUIRE(!loader.NextChunk(chunk));
+  BOOST_REQUIRE(!loader.IsOpen());
+
+  remove("test_file.csv");
+}
+
 /**
  * Make sure load as PGM is successful.
  */
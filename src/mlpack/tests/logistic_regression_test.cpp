@@ -7,6 +7,7 @@
 #include <mlpack/core.hpp>
 #include <mlpack/methods/logistic_regression/logistic_regression.hpp>
 #include <mlpack/core/optimizers/sgd/sgd.hpp>
+#include <mlpack/core/optimizers/minibatch_sgd/minibatch_sgd.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
@@ -29,7 +30,8 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionEvaluate)
   arma::vec responses("1 1 0");
 
   // Create a LogisticRegressionFunction.
-  LogisticRegressionFunction lrf(data, responses, 0.0 /* no regularization */);
+  LogisticRegressionFunction<> lrf(data, responses,
+      0.0 /* no regularization */);
 
   // These were hand-calculated using Octave.
   BOOST_REQUIRE_CLOSE(lrf.Evaluate(arma::vec("1 1 1")), 7.0562141665, 1e-5);
@@ -57,7 +59,8 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionRandomEvaluate)
   for (size_t i = 0; i < points; ++i)
     responses[i] = math::RandInt(0, 2);
 
-  LogisticRegressionFunction lrf(data, responses, 0.0 /* no regularization */);
+  LogisticRegressionFunction<> lrf(data, responses,
+      0.0 /* no regularization */);
 
   // Run a bunch of trials.
   for (size_t i = 0; i < trials; ++i)
@@ -99,9 +102,9 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionRegularizationEvaluate)
   for (size_t i = 0; i < points; ++i)
     responses[i] = math::RandInt(0, 2);
 
-  LogisticRegressionFunction lrfNoReg(data, responses, 0.0);
-  LogisticRegressionFunction lrfSmallReg(data, responses, 0.5);
-  LogisticRegressionFunction lrfBigReg(data, responses, 20.0);
+  LogisticRegressionFunction<> lrfNoReg(data, responses, 0.0);
+  LogisticRegressionFunction<> lrfSmallReg(data, responses, 0.5);
+  LogisticRegressionFunction<> lrfBigReg(data, responses, 20.0);
 
   for (size_t i = 0; i < trials; ++i)
   {
@@ -133,7 +136,8 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionGradient)
   arma::vec responses("1 1 0");
 
   // Create a LogisticRegressionFunction.
-  LogisticRegressionFunction lrf(data, responses, 0.0 /* no regularization */);
+  LogisticRegressionFunction<> lrf(data, responses,
+      0.0 /* no regularization */);
   arma::vec gradient;
 
   // If the model is at the optimum, then the gradient should be zero.
@@ -182,7 +186,8 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionSeparableEvaluate)
   arma::vec responses("1 1 0");
 
   // Create a LogisticRegressionFunction.
-  LogisticRegressionFunction lrf(data, responses, 0.0 /* no regularization */);
+  LogisticRegressionFunction<> lrf(data, responses,
+      0.0 /* no regularization */);
 
   // These were hand-calculated using Octave.
   BOOST_REQUIRE_CLOSE(lrf.Evaluate(arma::vec("1 1 1"), 0), 4.85873516e-2, 1e-5);
@@ -231,9 +236,9 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionRegularizationSeparableEvaluate)
   for (size_t i = 0; i < points; ++i)
     responses[i] = math::RandInt(0, 2);
 
-  LogisticRegressionFunction lrfNoReg(data, responses, 0.0);
-  LogisticRegressionFunction lrfSmallReg(data, responses, 0.5);
-  LogisticRegressionFunction lrfBigReg(data, responses, 20.0);
+  LogisticRegressionFunction<> lrfNoReg(data, responses, 0.0);
+  LogisticRegressionFunction<> lrfSmallReg(data, responses, 0.5);
+  LogisticRegressionFunction<> lrfBigReg(data, responses, 20.0);
 
   // Check that the number of functions is correct.
   BOOST_REQUIRE_EQUAL(lrfNoReg.NumFunctions(), points);
@@ -273,7 +278,8 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionSeparableGradient)
   arma::vec responses("1 1 0");
 
   // Create a LogisticRegressionFunction.
-  LogisticRegressionFunction lrf(data, responses, 0.0 /* no regularization */);
+  LogisticRegressionFunction<> lrf(data, responses,
+      0.0 /* no regularization */);
   arma::vec gradient;
 
   // If the model is at the optimum, then the gradient should be zero.
@@ -337,6 +343,98 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionSeparableGradient)
   BOOST_REQUIRE_SMALL(gradient[2], 1e-15);
 }
 
+/**
+ * Make sure the batch Evaluate() and Gradient() give the sums of the
+ * single-point Evaluate() and Gradient() over the batch.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionBatchEvaluateAndGradient)
+{
+  const size_t points = 200;
+  const size_t dimension = 7;
+
+  arma::mat data;
+  data.randu(dimension, points);
+  arma::vec responses(points);
+  for (size_t i = 0; i < points; ++i)
+    responses[i] = (data(0, i) > 0.5) ? 1.0 : 0.0;
+
+  LogisticRegressionFunction<> lrf(data, responses, 0.7);
+
+  // The function should advertise its batch overloads.
+  BOOST_REQUIRE_EQUAL(
+      (bool) HasBatchEvaluate<LogisticRegressionFunction<> >::value, true);
+  BOOST_REQUIRE_EQUAL(
+      (bool) HasBatchGradient<LogisticRegressionFunction<> >::value, true);
+
+  const arma::vec parameters = arma::randu<arma::vec>(dimension + 1) - 0.5;
+
+  const size_t begins[] = { 0, 13, 150, 199 };
+  const size_t batchSizes[] = { 200, 40, 50, 1 };
+  for (size_t b = 0; b < 4; ++b)
+  {
+    double objective = 0;
+    arma::mat gradient, pointGradient;
+    gradient.zeros(dimension + 1, 1);
+    for (size_t i = begins[b]; i < begins[b] + batchSizes[b]; ++i)
+    {
+      objective += lrf.Evaluate(parameters, i);
+      lrf.Gradient(parameters, i, pointGradient);
+      gradient += pointGradient;
+    }
+
+    BOOST_REQUIRE_CLOSE(lrf.Evaluate(parameters, begins[b], batchSizes[b]),
+        objective, 1e-5);
+
+    arma::mat batchGradient;
+    lrf.Gradient(parameters, begins[b], batchGradient, batchSizes[b]);
+    BOOST_REQUIRE_EQUAL(batchGradient.n_elem, dimension + 1);
+    for (size_t j = 0; j < dimension + 1; ++j)
+      BOOST_REQUIRE_CLOSE(batchGradient[j], gradient[j], 1e-5);
+  }
+
+  // The batch over every point is the full objective.
+  BOOST_REQUIRE_CLOSE(lrf.Evaluate(parameters, 0, points),
+      lrf.Evaluate(parameters), 1e-5);
+}
+
+/**
+ * EvaluateWithGradient() gives the same results as Evaluate() and Gradient(),
+ * including when it is called again with the same workspace.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionEvaluateWithGradient)
+{
+  const size_t points = 200;
+  const size_t dimension = 7;
+
+  arma::mat data;
+  data.randu(dimension, points);
+  arma::vec responses(points);
+  for (size_t i = 0; i < points; ++i)
+    responses[i] = (data(0, i) > 0.5) ? 1.0 : 0.0;
+
+  for (size_t l = 0; l < 2; ++l)
+  {
+    LogisticRegressionFunction<> lrf(data, responses, (l == 0) ? 0.0 : 0.7);
+    BOOST_REQUIRE(
+        HasEvaluateWithGradient<LogisticRegressionFunction<> >::value);
+
+    for (size_t trial = 0; trial < 3; ++trial)
+    {
+      const arma::mat parameters = arma::randu<arma::vec>(dimension + 1) - 0.5;
+
+      arma::mat gradient, fusedGradient;
+      lrf.Gradient(parameters, gradient);
+      BOOST_REQUIRE_CLOSE(lrf.EvaluateWithGradient(parameters, fusedGradient),
+          lrf.Evaluate(parameters), 1e-5);
+
+      BOOST_REQUIRE_EQUAL(fusedGradient.n_rows, dimension + 1);
+      BOOST_REQUIRE_EQUAL(fusedGradient.n_cols, 1);
+      for (size_t j = 0; j < dimension + 1; ++j)
+        BOOST_REQUIRE_CLOSE(fusedGradient[j] + 1.0, gradient[j] + 1.0, 1e-5);
+    }
+  }
+}
+
 /**
  * Test Gradient() function when regularization is used.
  */
@@ -354,9 +452,9 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionRegularizationGradient)
   for (size_t i = 0; i < points; ++i)
     responses[i] = math::RandInt(0, 2);
 
-  LogisticRegressionFunction lrfNoReg(data, responses, 0.0);
-  LogisticRegressionFunction lrfSmallReg(data, responses, 0.5);
-  LogisticRegressionFunction lrfBigReg(data, responses, 20.0);
+  LogisticRegressionFunction<> lrfNoReg(data, responses, 0.0);
+  LogisticRegressionFunction<> lrfSmallReg(data, responses, 0.5);
+  LogisticRegressionFunction<> lrfBigReg(data, responses, 20.0);
 
   for (size_t i = 0; i < trials; ++i)
   {
@@ -416,9 +514,9 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionRegularizationSeparableGradient)
   for (size_t i = 0; i < points; ++i)
     responses[i] = math::RandInt(0, 2);
 
-  LogisticRegressionFunction lrfNoReg(data, responses, 0.0);
-  LogisticRegressionFunction lrfSmallReg(data, responses, 0.5);
-  LogisticRegressionFunction lrfBigReg(data, responses, 20.0);
+  LogisticRegressionFunction<> lrfNoReg(data, responses, 0.0);
+  LogisticRegressionFunction<> lrfSmallReg(data, responses, 0.5);
+  LogisticRegressionFunction<> lrfBigReg(data, responses, 20.0);
 
   for (size_t i = 0; i < trials; ++i)
   {
@@ -497,8 +595,8 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionSGDSimpleTest)
 
   // Create a logistic regression object using a custom SGD object with a much
   // smaller tolerance.
-  LogisticRegressionFunction lrf(data, responses, 0.001);
-  SGD<LogisticRegressionFunction> sgd(lrf, 0.005, 500000, 1e-10);
+  LogisticRegressionFunction<> lrf(data, responses, 0.001);
+  SGD<LogisticRegressionFunction<> > sgd(lrf, 0.005, 500000, 1e-10);
   LogisticRegression<SGD> lr(sgd);
 
   // Test sigmoid function.
@@ -546,8 +644,8 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionSGDRegularizationSimpleTest)
 
   // Create a logistic regression object using custom SGD with a much smaller
   // tolerance.
-  LogisticRegressionFunction lrf(data, responses, 0.001);
-  SGD<LogisticRegressionFunction> sgd(lrf, 0.005, 500000, 1e-10);
+  LogisticRegressionFunction<> lrf(data, responses, 0.001);
+  SGD<LogisticRegressionFunction<> > sgd(lrf, 0.005, 500000, 1e-10);
   LogisticRegression<SGD> lr(sgd);
 
   // Test sigmoid function.
@@ -655,6 +753,46 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionSGDGaussianTest)
   BOOST_REQUIRE_CLOSE(testAcc, 100.0, 0.6); // 0.6% error tolerance.
 }
 
+// Test training of logistic regression on two Gaussians and ensure it's
+// properly separable using mini-batch SGD with momentum.
+BOOST_AUTO_TEST_CASE(LogisticRegressionMiniBatchSGDGaussianTest)
+{
+  // Generate a two-Gaussian dataset.  The batches are contiguous, so the
+  // classes are interleaved.
+  GaussianDistribution g1(arma::vec("1.0 1.0 1.0"), arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("9.0 9.0 9.0"), arma::eye<arma::mat>(3, 3));
+
+  arma::mat data(3, 1000);
+  arma::vec responses(1000);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    data.col(i) = (i % 2 == 0) ? g1.Random() : g2.Random();
+    responses[i] = (i % 2 == 0) ? 0 : 1;
+  }
+
+  // Now train a logistic regression object on it.
+  LogisticRegressionFunction<> lrf(data, responses, 0.5);
+  MiniBatchSGD<LogisticRegressionFunction<> > mbsgd(lrf, 50, 0.01, 0.5);
+  LogisticRegression<MiniBatchSGD> lr(mbsgd);
+
+  // Ensure that the error is close to zero.
+  const double acc = lr.ComputeAccuracy(data, responses);
+
+  BOOST_REQUIRE_CLOSE(acc, 100.0, 0.3); // 0.3% error tolerance.
+
+  // Create a test set.
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    data.col(i) = (i % 2 == 0) ? g1.Random() : g2.Random();
+    responses[i] = (i % 2 == 0) ? 0 : 1;
+  }
+
+  // Ensure that the error is close to zero.
+  const double testAcc = lr.ComputeAccuracy(data, responses);
+
+  BOOST_REQUIRE_CLOSE(testAcc, 100.0, 0.6); // 0.6% error tolerance.
+}
+
 /**
  * Test constructor that takes an already-instantiated optimizer.
  */
@@ -666,8 +804,8 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionInstantiatedOptimizer)
   arma::vec responses("1 1 0");
 
   // Create an optimizer and function.
-  LogisticRegressionFunction lrf(data, responses, 0.0005);
-  L_BFGS<LogisticRegressionFunction> lbfgsOpt(lrf);
+  LogisticRegressionFunction<> lrf(data, responses, 0.0005);
+  L_BFGS<LogisticRegressionFunction<> > lbfgsOpt(lrf);
   lbfgsOpt.MinGradientNorm() = 1e-50;
   LogisticRegression<L_BFGS> lr(lbfgsOpt);
 
@@ -681,7 +819,7 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionInstantiatedOptimizer)
   BOOST_REQUIRE_SMALL(sigmoids[2], 0.1);
 
   // Now do the same with SGD.
-  SGD<LogisticRegressionFunction> sgdOpt(lrf);
+  SGD<LogisticRegressionFunction<> > sgdOpt(lrf);
   sgdOpt.StepSize() = 0.15;
   sgdOpt.Tolerance() = 1e-75;
   LogisticRegression<SGD> lr2(sgdOpt);
@@ -696,4 +834,118 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionInstantiatedOptimizer)
   BOOST_REQUIRE_SMALL(sigmoids[2], 0.1);
 }
 
+/**
+ * The sparse LogisticRegressionFunction gives the same results as the dense one
+ * on the same data.
+ */
+BOOST_AUTO_TEST_CASE(SparseLogisticRegressionFunctionTest)
+{
+  const size_t points = 200;
+  const size_t dimension = 20;
+
+  arma::sp_mat data;
+  data.sprandu(dimension, points, 0.2);
+  const arma::mat denseData(data);
+  arma::vec responses(points);
+  for (size_t i = 0; i < points; ++i)
+    responses[i] = (denseData(0, i) + denseData(1, i) > 0.3) ? 1.0 : 0.0;
+
+  const arma::mat parameters = arma::randu<arma::mat>(dimension + 1, 1) - 0.5;
+  for (size_t l = 0; l < 2; ++l)
+  {
+    const double lambda = (l == 0) ? 0.0 : 0.7;
+    LogisticRegressionFunction<arma::sp_mat> sparseLrf(data, responses,
+        lambda);
+    LogisticRegressionFunction<> lrf(denseData, responses, lambda);
+
+    BOOST_REQUIRE_CLOSE(sparseLrf.Evaluate(parameters),
+        lrf.Evaluate(parameters), 1e-5);
+    BOOST_REQUIRE_CLOSE(sparseLrf.Evaluate(parameters, 10, 50),
+        lrf.Evaluate(parameters, 10, 50), 1e-5);
+
+    arma::mat sparseGradient, gradient;
+    sparseLrf.Gradient(parameters, sparseGradient);
+    lrf.Gradient(parameters, gradient);
+    BOOST_REQUIRE_EQUAL(sparseGradient.n_elem, gradient.n_elem);
+    for (size_t j = 0; j < gradient.n_elem; ++j)
+      BOOST_REQUIRE_CLOSE(sparseGradient[j] + 1.0, gradient[j] + 1.0, 1e-5);
+
+    BOOST_REQUIRE_CLOSE(sparseLrf.EvaluateWithGradient(parameters,
+        sparseGradient), lrf.Evaluate(parameters), 1e-5);
+    for (size_t j = 0; j < gradient.n_elem; ++j)
+      BOOST_REQUIRE_CLOSE(sparseGradient[j] + 1.0, gradient[j] + 1.0, 1e-5);
+
+    sparseLrf.Gradient(parameters, 10, sparseGradient, 50);
+    lrf.Gradient(parameters, 10, gradient, 50);
+    for (size_t j = 0; j < gradient.n_elem; ++j)
+      BOOST_REQUIRE_CLOSE(sparseGradient[j] + 1.0, gradient[j] + 1.0, 1e-5);
+
+    for (size_t i = 0; i < points; ++i)
+    {
+      BOOST_REQUIRE_CLOSE(sparseLrf.Evaluate(parameters, i),
+          lrf.Evaluate(parameters, i), 1e-5);
+
+      sparseLrf.Gradient(parameters, i, sparseGradient);
+      lrf.Gradient(parameters, i, gradient);
+      for (size_t j = 0; j < gradient.n_elem; ++j)
+        BOOST_REQUIRE_CLOSE(sparseGradient[j] + 1.0, gradient[j] + 1.0, 1e-5);
+
+      // The sparse gradient only stores the nonzero features of the point when
+      // there is no regularization.
+      arma::sp_mat pointGradient;
+      sparseLrf.Gradient(parameters, i, pointGradient);
+      if (l == 0)
+        BOOST_REQUIRE_EQUAL(pointGradient.n_nonzero,
+            data.col(i).n_nonzero + 1);
+      for (size_t j = 0; j < gradient.n_elem; ++j)
+        BOOST_REQUIRE_CLOSE((double) pointGradient(j, 0) + 1.0,
+            gradient[j] + 1.0, 1e-5);
+    }
+  }
+}
+
+/**
+ * Train logistic regression on sparse data, where the two classes have
+ * different nonzero features, with L-BFGS and SGD.
+ */
+BOOST_AUTO_TEST_CASE(SparseLogisticRegressionTest)
+{
+  const size_t points = 1000;
+  const size_t dimension = 100;
+
+  // The first half of the features are only nonzero for points in class 0, and
+  // the second half only for points in class 1.
+  arma::mat denseData(dimension, points);
+  denseData.zeros();
+  arma::vec responses(points);
+  for (size_t i = 0; i < points; ++i)
+  {
+    responses[i] = (i % 2 == 0) ? 0.0 : 1.0;
+    const size_t offset = (i % 2 == 0) ? 0 : dimension / 2;
+    for (size_t k = 0; k < 5; ++k)
+      denseData(offset + math::RandInt(0, dimension / 2), i) =
+          math::Random(0.5, 1.5);
+  }
+  const arma::sp_mat data(denseData);
+
+  LogisticRegression<L_BFGS, arma::sp_mat> lr(data, responses, 0.001);
+  BOOST_REQUIRE_CLOSE(lr.ComputeAccuracy(data, responses), 100.0, 0.3);
+
+  // The model is the same one we get from the dense data.
+  LogisticRegression<> denseLr(denseData, responses, 0.001);
+  arma::vec predictions, densePredictions;
+  lr.Predict(data, predictions);
+  denseLr.Predict(denseData, densePredictions);
+  for (size_t i = 0; i < points; ++i)
+    BOOST_REQUIRE_EQUAL(predictions[i], densePredictions[i]);
+
+  // The error of the sparse model is the same on either kind of data.
+  LogisticRegression<> copyLr(lr.Parameters(), 0.001);
+  BOOST_REQUIRE_CLOSE(lr.ComputeError(data, responses),
+      copyLr.ComputeError(denseData, responses), 1e-5);
+
+  LogisticRegression<SGD, arma::sp_mat> sgdLr(data, responses, 0.001);
+  BOOST_REQUIRE_CLOSE(sgdLr.ComputeAccuracy(data, responses), 100.0, 0.3);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -9,6 +9,7 @@
 #include "old_boost_test_definitions.hpp"
 
 #include <mlpack/methods/lsh/lsh_search.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 
 using namespace std;
 using namespace mlpack;
@@ -108,4 +109,76 @@ BOOST_AUTO_TEST_CASE(LSHSearchTest)
   }
 }
 
+/**
+ * With a huge hash width, every point falls into the same bucket of every
+ * table, so (as long as the buckets are big enough) LSH search is exact, and
+ * should return the same results as naive search.
+ */
+BOOST_AUTO_TEST_CASE(LSHSearchExactTest)
+{
+  math::RandomSeed(0);
+
+  arma::mat rdata = arma::randu<arma::mat>(4, 300);
+  arma::mat qdata = arma::randu<arma::mat>(4, 2500);
+
+  LSHSearch<> lsh(rdata, qdata, 3, 2, 1e10, 99901, 300);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  lsh.Search(3, neighbors, distances);
+
+  AllkNN allknn(rdata, qdata, true);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  allknn.Search(3, trueNeighbors, trueDistances);
+
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, qdata.n_cols);
+
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[i], trueNeighbors[i]);
+    BOOST_REQUIRE_CLOSE(distances[i], std::pow(trueDistances[i], 2.0), 1e-5);
+  }
+}
+
+/**
+ * Make sure that searching with multiple threads gives the same results as
+ * searching with one thread, and that the distances returned are right.
+ */
+BOOST_AUTO_TEST_CASE(LSHSearchThreadsTest)
+{
+  math::RandomSeed(0);
+
+  arma::mat rdata = arma::randu<arma::mat>(5, 2000);
+
+  LSHSearch<> lsh(rdata, 5, 10);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  lsh.Search(5, neighbors, distances);
+
+  lsh.NumThreads() = 4;
+  arma::Mat<size_t> threadNeighbors;
+  arma::mat threadDistances;
+  lsh.Search(5, threadNeighbors, threadDistances);
+
+  for (size_t i = 0; i < neighbors.n_cols; ++i)
+  {
+    for (size_t j = 0; j < neighbors.n_rows; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(neighbors(j, i), threadNeighbors(j, i));
+      BOOST_REQUIRE_EQUAL(distances(j, i), threadDistances(j, i));
+
+      // No neighbor was found if the index is the number of points.
+      if (neighbors(j, i) == rdata.n_cols)
+        continue;
+
+      BOOST_REQUIRE_NE(neighbors(j, i), i);
+      BOOST_REQUIRE_CLOSE(distances(j, i), metric::SquaredEuclideanDistance::
+          Evaluate(rdata.col(i), rdata.col(neighbors(j, i))), 1e-5);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
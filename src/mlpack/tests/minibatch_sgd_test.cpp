@@ -0,0 +1,107 @@
+/**
+ * @file minibatch_sgd_test.cpp
+ *
+ * Test file for mini-batch SGD and the batch function interface.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/optimizers/minibatch_sgd/minibatch_sgd.hpp>
+#include <mlpack/core/optimizers/sgd/test_function.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "old_boost_test_definitions.hpp"
+
+using namespace std;
+using namespace arma;
+using namespace mlpack;
+using namespace mlpack::optimization;
+using namespace mlpack::optimization::test;
+
+BOOST_AUTO_TEST_SUITE(MiniBatchSGDTest);
+
+/**
+ * A function without batch overloads should be evaluated one function at a
+ * time, giving the sums of the single-function results.
+ */
+BOOST_AUTO_TEST_CASE(BatchFunctionFallbackTest)
+{
+  // The casts avoid binding a reference to the static constants, which are not
+  // defined anywhere (see kernel_traits_test.cpp).
+  BOOST_REQUIRE_EQUAL((bool) HasBatchEvaluate<SGDTestFunction>::value, false);
+  BOOST_REQUIRE_EQUAL((bool) HasBatchGradient<SGDTestFunction>::value, false);
+
+  SGDTestFunction f;
+  arma::mat coordinates = f.GetInitialPoint();
+
+  BOOST_REQUIRE_CLOSE(EvaluateBatch(f, coordinates, 0, 3),
+      f.Evaluate(coordinates, 0) + f.Evaluate(coordinates, 1) +
+      f.Evaluate(coordinates, 2), 1e-5);
+  BOOST_REQUIRE_CLOSE(EvaluateBatch(f, coordinates, 1, 2),
+      f.Evaluate(coordinates, 1) + f.Evaluate(coordinates, 2), 1e-5);
+
+  arma::mat gradient, pointGradient, sum;
+  sum.zeros(3, 1);
+  for (size_t i = 1; i < 3; ++i)
+  {
+    f.Gradient(coordinates, i, pointGradient);
+    sum += pointGradient;
+  }
+
+  GradientBatch(f, coordinates, 1, gradient, 2);
+  BOOST_REQUIRE_EQUAL(gradient.n_elem, 3);
+  for (size_t i = 0; i < 3; ++i)
+    BOOST_REQUIRE_CLOSE(gradient[i] + 1.0, sum[i] + 1.0, 1e-5);
+}
+
+/**
+ * With a batch size of 1 and no momentum, mini-batch SGD is SGD, so it should
+ * find the same solution as in the SGD tests.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchSGDBatchSizeOneTest)
+{
+  SGDTestFunction f;
+  MiniBatchSGD<SGDTestFunction> s(f, 1, 0.0003, 0.0, 5000000, 1e-9, true);
+
+  arma::mat coordinates = f.GetInitialPoint();
+  double result = s.Optimize(coordinates);
+
+  BOOST_REQUIRE_CLOSE(result, -1.0, 0.05);
+  BOOST_REQUIRE_SMALL(coordinates[0], 1e-3);
+  BOOST_REQUIRE_SMALL(coordinates[1], 1e-7);
+  BOOST_REQUIRE_SMALL(coordinates[2], 1e-7);
+}
+
+/**
+ * Optimize with all of the functions in one batch, with momentum.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchSGDMomentumTest)
+{
+  SGDTestFunction f;
+  MiniBatchSGD<SGDTestFunction> s(f, 3, 0.0003, 0.9, 5000000, 1e-9, true);
+
+  arma::mat coordinates = f.GetInitialPoint();
+  double result = s.Optimize(coordinates);
+
+  BOOST_REQUIRE_CLOSE(result, -1.0, 0.05);
+  BOOST_REQUIRE_SMALL(coordinates[0], 1e-3);
+  BOOST_REQUIRE_SMALL(coordinates[1], 1e-7);
+  BOOST_REQUIRE_SMALL(coordinates[2], 1e-7);
+}
+
+/**
+ * The last batch may be smaller than the others.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchSGDUnevenBatchTest)
+{
+  SGDTestFunction f;
+  MiniBatchSGD<SGDTestFunction> s(f, 2, 0.0003, 0.5, 5000000, 1e-9, false);
+
+  arma::mat coordinates = f.GetInitialPoint();
+  double result = s.Optimize(coordinates);
+
+  BOOST_REQUIRE_CLOSE(result, -1.0, 0.05);
+  BOOST_REQUIRE_SMALL(coordinates[0], 1e-3);
+  BOOST_REQUIRE_SMALL(coordinates[1], 1e-7);
+  BOOST_REQUIRE_SMALL(coordinates[2], 1e-7);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -122,4 +122,200 @@ BOOST_AUTO_TEST_CASE(NaiveBayesClassifierIncrementalTest)
     BOOST_REQUIRE_EQUAL(testRes(i), calcVec(i));
 }
 
+/**
+ * Train on a dataset large enough to be split into many blocks, and make sure
+ * the means and variances are the same as those computed naively, and that
+ * classification gives the class with the highest log-probability.
+ */
+BOOST_AUTO_TEST_CASE(NaiveBayesClassifierBlockTest)
+{
+  const size_t classes = 3;
+  const size_t points = 5 * NaiveBayesClassifier<>::BlockSize + 17;
+  arma::mat data(4, points);
+  arma::Col<size_t> labels(points);
+  for (size_t i = 0; i < points; ++i)
+  {
+    labels[i] = math::RandInt(classes);
+    // Put the classes far away from the origin, so that a one-pass algorithm
+    // that isn't stable would lose precision.
+    data.col(i) = 1e6 + 3.0 * labels[i] + arma::randn<arma::vec>(4);
+  }
+  // The last feature is constant within each class.
+  data.row(3) = arma::conv_to<arma::rowvec>::from(labels) + 1.0;
+
+  NaiveBayesClassifier<> nbc(data, labels, classes);
+
+  for (size_t c = 0; c < classes; ++c)
+  {
+    const arma::uvec indices = arma::find(labels == c);
+    const arma::mat classData = data.cols(indices);
+    const arma::vec mean = arma::mean(classData, 1);
+    const arma::vec variance = arma::var(classData, 0, 1);
+
+    BOOST_REQUIRE_CLOSE(nbc.Probabilities()[c],
+        (double) indices.n_elem / points, 1e-5);
+    for (size_t d = 0; d < 3; ++d)
+    {
+      BOOST_REQUIRE_CLOSE(nbc.Means()(d, c), mean[d], 1e-5);
+      BOOST_REQUIRE_CLOSE(nbc.Variances()(d, c), variance[d], 1e-5);
+    }
+    BOOST_REQUIRE_CLOSE(nbc.Means()(3, c), mean[3], 1e-5);
+    BOOST_REQUIRE_SMALL(nbc.Variances()(3, c), 1e-40);
+  }
+
+  // Points with the constant feature of a class can only belong to that class.
+  arma::Col<size_t> results;
+  nbc.Classify(data, results);
+  for (size_t i = 0; i < points; ++i)
+    BOOST_REQUIRE_EQUAL(results[i], labels[i]);
+}
+
+/**
+ * Make sure that training and classification on sparse data gives the same
+ * results as on the same data stored densely.
+ */
+BOOST_AUTO_TEST_CASE(NaiveBayesClassifierSparseTest)
+{
+  const size_t classes = 4;
+  const size_t points = 3000;
+  arma::sp_mat sparseData;
+  sparseData.sprandu(50, points, 0.1);
+  arma::Col<size_t> labels(points);
+  for (size_t i = 0; i < points; ++i)
+    labels[i] = math::RandInt(classes);
+
+  const arma::mat denseData(sparseData);
+
+  NaiveBayesClassifier<> nbc(denseData, labels, classes);
+  NaiveBayesClassifier<arma::sp_mat> sparseNbc(sparseData, labels, classes);
+
+  for (size_t c = 0; c < classes; ++c)
+  {
+    BOOST_REQUIRE_CLOSE(sparseNbc.Probabilities()[c], nbc.Probabilities()[c],
+        1e-5);
+    for (size_t d = 0; d < denseData.n_rows; ++d)
+    {
+      BOOST_REQUIRE_CLOSE(sparseNbc.Means()(d, c), nbc.Means()(d, c), 1e-5);
+      BOOST_REQUIRE_CLOSE(sparseNbc.Variances()(d, c), nbc.Variances()(d, c),
+          1e-5);
+    }
+  }
+
+  arma::sp_mat sparseTest;
+  sparseTest.sprandu(50, 1000, 0.1);
+  const arma::mat denseTest(sparseTest);
+
+  arma::Col<size_t> results, sparseResults;
+  nbc.Classify(denseTest, results);
+  sparseNbc.Classify(sparseTest, sparseResults);
+
+  BOOST_REQUIRE_EQUAL(sparseResults.n_elem, results.n_elem);
+  for (size_t i = 0; i < results.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(sparseResults[i], results[i]);
+}
+
+/**
+ * The variances of sparse data must be accurate even when the data is far from
+ * the origin, so that the squared deviations are much smaller than the squared
+ * means.
+ */
+BOOST_AUTO_TEST_CASE(NaiveBayesClassifierSparseOffsetTest)
+{
+  const size_t classes = 2;
+  const size_t points = 2000;
+  arma::mat denseData = 1e8 + arma::randn<arma::mat>(5, points);
+  arma::Col<size_t> labels(points);
+  for (size_t i = 0; i < points; ++i)
+    labels[i] = i % classes;
+
+  // Make some elements zero too, so that both kinds of element are used.
+  denseData.row(4).zeros();
+  for (size_t i = 0; i < points; i += 3)
+    denseData(3, i) = 0.0;
+
+  const arma::sp_mat sparseData(denseData);
+  NaiveBayesClassifier<arma::sp_mat> sparseNbc(sparseData, labels, classes);
+
+  for (size_t c = 0; c < classes; ++c)
+  {
+    const arma::uvec indices = arma::find(labels == c);
+    const arma::mat classData = denseData.cols(indices);
+    for (size_t d = 0; d < denseData.n_rows; ++d)
+    {
+      const arma::rowvec row = classData.row(d);
+      const double mean = arma::mean(row);
+      const double variance = arma::var(row);
+
+      BOOST_REQUIRE_CLOSE(sparseNbc.Means()(d, c), mean, 1e-8);
+      if (variance == 0.0)
+        BOOST_REQUIRE_SMALL(sparseNbc.Variances()(d, c), 1e-10);
+      else
+        BOOST_REQUIRE_CLOSE(sparseNbc.Variances()(d, c), variance, 1e-3);
+    }
+  }
+}
+
+/**
+ * Make sure that training incrementally, one batch or one point at a time, and
+ * merging models trained on separate shards all give the same model as
+ * training on all of the data at once.
+ */
+BOOST_AUTO_TEST_CASE(NaiveBayesClassifierIncrementalTrainTest)
+{
+  const size_t classes = 3;
+  const size_t points = 3000;
+  arma::mat data(5, points);
+  arma::Col<size_t> labels(points);
+  for (size_t i = 0; i < points; ++i)
+  {
+    labels[i] = math::RandInt(classes);
+    data.col(i) = 100.0 + 2.0 * labels[i] + arma::randn<arma::vec>(5);
+  }
+
+  NaiveBayesClassifier<> nbc(data, labels, classes);
+  BOOST_REQUIRE_EQUAL(nbc.TrainingPoints(), points);
+
+  // Train in three batches.
+  NaiveBayesClassifier<> batchNbc(data.n_rows, classes);
+  batchNbc.Train(data.cols(0, 999), labels.subvec(0, 999));
+  batchNbc.Train(data.cols(1000, 1999), labels.subvec(1000, 1999));
+  batchNbc.Train(data.cols(2000, points - 1), labels.subvec(2000, points - 1));
+
+  // Train on the first 2000 points in a batch, then on the rest one at a time.
+  NaiveBayesClassifier<> pointNbc(data.n_rows, classes);
+  pointNbc.Train(data.cols(0, 1999), labels.subvec(0, 1999));
+  for (size_t i = 2000; i < points; ++i)
+    pointNbc.Train(data.col(i), labels[i]);
+
+  // Train on two shards and merge them.
+  NaiveBayesClassifier<> mergedNbc(data.cols(0, 1499), labels.subvec(0, 1499),
+      classes);
+  NaiveBayesClassifier<> otherNbc(data.cols(1500, points - 1),
+      labels.subvec(1500, points - 1), classes);
+  mergedNbc.Merge(otherNbc);
+
+  // Retraining from scratch should forget the old data.
+  NaiveBayesClassifier<> retrainedNbc(data.cols(0, 99), labels.subvec(0, 99),
+      classes);
+  retrainedNbc.Train(data, labels, false);
+
+  const NaiveBayesClassifier<>* models[4] = { &batchNbc, &pointNbc, &mergedNbc,
+      &retrainedNbc };
+  for (size_t m = 0; m < 4; ++m)
+  {
+    BOOST_REQUIRE_EQUAL(models[m]->TrainingPoints(), points);
+    for (size_t c = 0; c < classes; ++c)
+    {
+      BOOST_REQUIRE_CLOSE(models[m]->Probabilities()[c],
+          nbc.Probabilities()[c], 1e-5);
+      for (size_t d = 0; d < data.n_rows; ++d)
+      {
+        BOOST_REQUIRE_CLOSE(models[m]->Means()(d, c), nbc.Means()(d, c), 1e-5);
+        BOOST_REQUIRE_CLOSE(models[m]->Variances()(d, c),
+            nbc.Variances()(d, c), 1e-5);
+      }
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -244,6 +244,113 @@ BOOST_AUTO_TEST_CASE(SoftmaxSeparableGradient)
   BOOST_REQUIRE_CLOSE(gradient(1, 1), -2.0 * -0.1435886, 0.01);
 }
 
+/**
+ * Ensure the batch objective function and gradient are the sums of the
+ * separable objective function and gradient, and that a batch over the whole
+ * dataset gives the non-separable objective function and gradient.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxBatchObjectiveAndGradient)
+{
+  arma::mat data;
+  data.randu(3, 40);
+  arma::Col<size_t> labels(40);
+  for (size_t i = 0; i < 40; ++i)
+    labels[i] = (data(0, i) + data(1, i) > 1.0) ? 1 : 0;
+
+  SoftmaxErrorFunction<SquaredEuclideanDistance> sef(data, labels);
+
+  arma::mat coordinates = arma::eye<arma::mat>(3, 3) +
+      0.2 * arma::randu<arma::mat>(3, 3);
+
+  // A batch in the middle of the dataset.
+  double objective = 0;
+  arma::mat gradient, pointGradient;
+  gradient.zeros(3, 3);
+  for (size_t i = 10; i < 25; ++i)
+  {
+    objective += sef.Evaluate(coordinates, i);
+    sef.Gradient(coordinates, i, pointGradient);
+    gradient += pointGradient;
+  }
+
+  arma::mat batchGradient;
+  BOOST_REQUIRE_CLOSE(sef.Evaluate(coordinates, 10, 15), objective, 1e-5);
+  sef.Gradient(coordinates, 10, batchGradient, 15);
+  for (size_t j = 0; j < 9; ++j)
+    BOOST_REQUIRE_CLOSE(batchGradient[j], gradient[j], 1e-5);
+
+  // The whole dataset.
+  arma::mat fullGradient;
+  BOOST_REQUIRE_CLOSE(sef.Evaluate(coordinates, 0, 40),
+      sef.Evaluate(coordinates), 1e-5);
+  sef.Gradient(coordinates, 0, batchGradient, 40);
+  sef.Gradient(coordinates, fullGradient);
+  for (size_t j = 0; j < 9; ++j)
+    BOOST_REQUIRE_CLOSE(batchGradient[j], fullGradient[j], 1e-5);
+}
+
+/**
+ * With a cutoff larger than any distance, the truncated objective and gradient
+ * are the same as the exact ones.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxLargeCutoff)
+{
+  arma::mat data;
+  data.randu(3, 60);
+  arma::Col<size_t> labels(60);
+  for (size_t i = 0; i < 60; ++i)
+    labels[i] = (data(0, i) + data(1, i) > 1.0) ? 1 : 0;
+
+  SoftmaxErrorFunction<SquaredEuclideanDistance> sef(data, labels);
+  SoftmaxErrorFunction<SquaredEuclideanDistance> cutoffSef(data, labels,
+      SquaredEuclideanDistance(), 1e5);
+
+  arma::mat coordinates = arma::eye<arma::mat>(3, 3) +
+      0.2 * arma::randu<arma::mat>(3, 3);
+
+  BOOST_REQUIRE_CLOSE(cutoffSef.Evaluate(coordinates),
+      sef.Evaluate(coordinates), 1e-5);
+
+  arma::mat gradient, cutoffGradient;
+  sef.Gradient(coordinates, gradient);
+  cutoffSef.Gradient(coordinates, cutoffGradient);
+  for (size_t j = 0; j < 9; ++j)
+    BOOST_REQUIRE_CLOSE(cutoffGradient[j], gradient[j], 1e-5);
+}
+
+/**
+ * With a cutoff of 30, the ignored terms are tiny, so the truncated objective
+ * and gradient must be very close to the exact ones.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxCutoffApproximation)
+{
+  // Spread the points out so that most pairs are outside the cutoff.
+  arma::mat data;
+  data.randu(3, 300);
+  data *= 20.0;
+  arma::Col<size_t> labels(300);
+  for (size_t i = 0; i < 300; ++i)
+    labels[i] = (data(0, i) > 10.0) ? 1 : 0;
+
+  SoftmaxErrorFunction<SquaredEuclideanDistance> sef(data, labels);
+  arma::mat coordinates = arma::eye<arma::mat>(3, 3);
+
+  const double objective = sef.Evaluate(coordinates);
+  arma::mat gradient;
+  sef.Gradient(coordinates, gradient);
+
+  // Changing the cutoff must cause the precalculation to be redone, even though
+  // the coordinates are the same.
+  sef.Cutoff() = 30.0;
+  const double cutoffObjective = sef.Evaluate(coordinates);
+  arma::mat cutoffGradient;
+  sef.Gradient(coordinates, cutoffGradient);
+
+  BOOST_REQUIRE_CLOSE(cutoffObjective, objective, 1e-6);
+  BOOST_REQUIRE_SMALL(arma::norm(cutoffGradient - gradient, "fro"),
+      1e-8 * arma::norm(gradient, "fro"));
+}
+
 //
 // Tests for the NCA algorithm.
 //
@@ -318,4 +425,29 @@ BOOST_AUTO_TEST_CASE(NCALBFGSSimpleDataset)
 
 }
 
+/**
+ * Run L-BFGS on the simple dataset with a cutoff.
+ */
+BOOST_AUTO_TEST_CASE(NCALBFGSCutoffSimpleDataset)
+{
+  arma::mat data           = "-0.1 -0.1 -0.1  0.1  0.1  0.1;"
+                             " 1.0  0.0 -1.0  1.0  0.0 -1.0 ";
+  arma::Col<size_t> labels = " 0    0    0    1    1    1   ";
+
+  NCA<SquaredEuclideanDistance, L_BFGS> nca(data, labels);
+  nca.Optimizer().NumBasis() = 5;
+  nca.Optimizer().Function().Cutoff() = 30.0;
+
+  arma::mat outputMatrix;
+  nca.LearnDistance(outputMatrix);
+
+  // The objective is evaluated exactly.
+  SoftmaxErrorFunction<SquaredEuclideanDistance> sef(data, labels);
+  const double initObj = sef.Evaluate(arma::eye<arma::mat>(2, 2));
+  const double finalObj = sef.Evaluate(outputMatrix);
+
+  BOOST_REQUIRE_LT(finalObj, initObj);
+  BOOST_REQUIRE_CLOSE(finalObj, -6.0, 1e-3);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,214 @@
+/**
+ * @file parallel_sgd_test.cpp
+ *
+ * Test file for ParallelSGD (parallel, lock-free stochastic gradient descent)
+ * and the sparse gradients it uses.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/optimizers/parallel_sgd/parallel_sgd.hpp>
+#include <mlpack/methods/logistic_regression/logistic_regression.hpp>
+#include <mlpack/methods/regularized_svd/regularized_svd.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "old_boost_test_definitions.hpp"
+
+using namespace mlpack;
+using namespace mlpack::optimization;
+using namespace mlpack::regression;
+using namespace mlpack::svd;
+using namespace mlpack::distribution;
+
+BOOST_AUTO_TEST_SUITE(ParallelSGDTest);
+
+/**
+ * Make a two-Gaussian logistic regression dataset.
+ */
+void GaussianDataset(arma::mat& data, arma::vec& responses)
+{
+  GaussianDistribution g1(arma::vec("1.0 1.0 1.0"), arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("9.0 9.0 9.0"), arma::eye<arma::mat>(3, 3));
+
+  data.set_size(3, 1000);
+  responses.set_size(1000);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    data.col(i) = (i < 500) ? g1.Random() : g2.Random();
+    responses[i] = (i < 500) ? 0 : 1;
+  }
+}
+
+/**
+ * The sparse gradients must be the same as the dense ones.
+ */
+BOOST_AUTO_TEST_CASE(SparseGradientTest)
+{
+  // Logistic regression, with some zero features.
+  arma::mat data;
+  data.randu(6, 50);
+  data.row(2).zeros();
+  data(4, 10) = 0.0;
+  arma::vec responses(50);
+  for (size_t i = 0; i < 50; ++i)
+    responses[i] = (data(0, i) > 0.5) ? 1.0 : 0.0;
+
+  const arma::vec parameters = arma::randu<arma::vec>(7) - 0.5;
+  for (size_t l = 0; l < 2; ++l)
+  {
+    LogisticRegressionFunction<> lrf(data, responses, (l == 0) ? 0.0 : 0.3);
+    for (size_t i = 0; i < 50; ++i)
+    {
+      arma::mat gradient;
+      arma::sp_mat sparseGradient;
+      lrf.Gradient(parameters, i, gradient);
+      lrf.Gradient(parameters, i, sparseGradient);
+
+      BOOST_REQUIRE_EQUAL(sparseGradient.n_rows, 7);
+      BOOST_REQUIRE_EQUAL(sparseGradient.n_cols, 1);
+      // Without regularization, the zero features are not stored.
+      if (l == 0)
+        BOOST_REQUIRE_LE(sparseGradient.n_nonzero, (i == 10) ? 5 : 6);
+
+      for (size_t j = 0; j < 7; ++j)
+        BOOST_REQUIRE_CLOSE((double) sparseGradient(j, 0) + 1.0,
+            gradient[j] + 1.0, 1e-5);
+    }
+  }
+
+  // Regularized SVD.
+  arma::mat ratings = arma::randu(3, 100);
+  ratings.row(0) = floor(ratings.row(0) * 20);
+  ratings.row(1) = floor(ratings.row(1) * 30);
+  ratings.row(2) = floor(ratings.row(2) * 5 + 0.5);
+
+  RegularizedSVDFunction rSVDFunc(ratings, 4, 0.1);
+  const arma::mat svdParameters = rSVDFunc.GetInitialPoint();
+  for (size_t i = 0; i < 100; ++i)
+  {
+    arma::mat gradient;
+    arma::sp_mat sparseGradient;
+    rSVDFunc.Gradient(svdParameters, i, gradient, 1);
+    rSVDFunc.Gradient(svdParameters, i, sparseGradient);
+
+    BOOST_REQUIRE_EQUAL(sparseGradient.n_rows, gradient.n_rows);
+    BOOST_REQUIRE_EQUAL(sparseGradient.n_cols, gradient.n_cols);
+    BOOST_REQUIRE_LE(sparseGradient.n_nonzero, 8);
+    for (size_t c = 0; c < gradient.n_cols; ++c)
+      for (size_t r = 0; r < gradient.n_rows; ++r)
+        BOOST_REQUIRE_CLOSE((double) sparseGradient(r, c) + 1.0,
+            gradient(r, c) + 1.0, 1e-5);
+  }
+}
+
+/**
+ * With one thread, the optimization is deterministic.
+ */
+BOOST_AUTO_TEST_CASE(SingleThreadDeterministicTest)
+{
+#ifdef _OPENMP
+  const int threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+
+  arma::mat data;
+  arma::vec responses;
+  GaussianDataset(data, responses);
+  LogisticRegressionFunction<> lrf(data, responses, 0.5);
+
+  arma::mat iterate1 = lrf.GetInitialPoint();
+  arma::mat iterate2 = lrf.GetInitialPoint();
+
+  ParallelSGD<LogisticRegressionFunction<> > s(lrf, 0.01, 20000);
+  math::RandomSeed(42);
+  const double objective1 = s.Optimize(iterate1);
+  math::RandomSeed(42);
+  const double objective2 = s.Optimize(iterate2);
+
+#ifdef _OPENMP
+  omp_set_num_threads(threads);
+#endif
+
+  BOOST_REQUIRE_EQUAL(objective1, objective2);
+  for (size_t i = 0; i < iterate1.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(iterate1[i], iterate2[i]);
+}
+
+/**
+ * Train logistic regression with ParallelSGD, using every thread.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionParallelSGDTest)
+{
+  arma::mat data;
+  arma::vec responses;
+  GaussianDataset(data, responses);
+
+  LogisticRegression<ParallelSGD> lr(data, responses, 0.5);
+
+  // Ensure that the error is close to zero.
+  const double acc = lr.ComputeAccuracy(data, responses);
+  BOOST_REQUIRE_CLOSE(acc, 100.0, 0.3); // 0.3% error tolerance.
+
+  // Ensure that the error is close to zero on a test set.
+  GaussianDataset(data, responses);
+  const double testAcc = lr.ComputeAccuracy(data, responses);
+  BOOST_REQUIRE_CLOSE(testAcc, 100.0, 0.6); // 0.6% error tolerance.
+}
+
+/**
+ * Factorize a rating matrix with RegularizedSVD and ParallelSGD.
+ */
+BOOST_AUTO_TEST_CASE(RegularizedSVDParallelSGDTest)
+{
+  // Define useful constants.
+  const size_t numUsers = 50;
+  const size_t numItems = 50;
+  const size_t numRatings = 100;
+  const size_t iterations = 30;
+  const size_t rank = 10;
+  const double alpha = 0.01;
+  const double lambda = 0.01;
+
+  // Initiate random parameters.
+  arma::mat parameters = arma::randu(rank, numUsers + numItems);
+
+  // Make a random rating dataset.
+  arma::mat data = arma::randu(3, numRatings);
+  data.row(0) = floor(data.row(0) * numUsers);
+  data.row(1) = floor(data.row(1) * numItems);
+
+  // Manually set last row to maximum user and maximum item.
+  data(0, numRatings - 1) = numUsers - 1;
+  data(1, numRatings - 1) = numItems - 1;
+
+  // Make rating entries based on the parameters.
+  for (size_t i = 0; i < numRatings; i++)
+  {
+    data(2, i) = arma::dot(parameters.col(data(0, i)),
+                           parameters.col(numUsers + data(1, i)));
+  }
+
+  // Make the Reg SVD function and the optimizer.
+  RegularizedSVDFunction rSVDFunc(data, rank, lambda);
+  ParallelSGD<RegularizedSVDFunction> optimizer(rSVDFunc, alpha,
+      iterations * numRatings, 0.0);
+
+  // Obtain optimized parameters after training.
+  arma::mat optParameters = arma::randu(rank, numUsers + numItems);
+  optimizer.Optimize(optParameters);
+
+  // Get predicted ratings from optimized parameters.
+  arma::mat predictedData(1, numRatings);
+  for (size_t i = 0; i < numRatings; i++)
+  {
+    predictedData(0, i) = arma::dot(optParameters.col(data(0, i)),
+                                    optParameters.col(numUsers + data(1, i)));
+  }
+
+  // Calculate relative error.
+  const double relativeError = arma::norm(data.row(2) - predictedData, "frob") /
+                               arma::norm(data, "frob");
+
+  // Relative error should be small.
+  BOOST_REQUIRE_SMALL(relativeError, 1e-2);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
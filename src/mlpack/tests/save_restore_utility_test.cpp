@@ -5,6 +5,7 @@
  * Here we have tests for the SaveRestoreModel class.
  */
 #include <mlpack/core/util/save_restore_utility.hpp>
+#include <fstream>
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
 
@@ -149,6 +150,164 @@ BOOST_AUTO_TEST_CASE(SaveArmaMat)
   delete sRM;
 }
 
+/**
+ * Make sure that basic types survive the binary format.
+ */
+BOOST_AUTO_TEST_CASE(SaveBasicTypesBinary)
+{
+  size_t s = 12;
+  int i = -23;
+  double d = 3.14159;
+  std::string cc = "Hello world!";
+  std::string empty = "";
+
+  SaveRestoreUtility sRM;
+
+  sRM.SaveParameter(ARGSTR(s));
+  sRM.SaveParameter(ARGSTR(i));
+  sRM.SaveParameter(ARGSTR(d));
+  sRM.SaveParameter(ARGSTR(cc));
+  sRM.SaveParameter(ARGSTR(empty));
+  BOOST_REQUIRE(sRM.WriteFile("test_basic_types.bin"));
+
+  SaveRestoreUtility sRM2;
+  BOOST_REQUIRE(sRM2.ReadFile("test_basic_types.bin"));
+  remove("test_basic_types.bin");
+
+  size_t s2 = 0;
+  int i2 = 0;
+  double d2 = 0.0;
+  std::string cc2, empty2 = "not empty";
+  sRM2.LoadParameter(s2, "s");
+  sRM2.LoadParameter(i2, "i");
+  sRM2.LoadParameter(d2, "d");
+  sRM2.LoadParameter(cc2, "cc");
+  sRM2.LoadParameter(empty2, "empty");
+
+  BOOST_REQUIRE_EQUAL(s, s2);
+  BOOST_REQUIRE_EQUAL(i, i2);
+  BOOST_REQUIRE_CLOSE(d, d2, 1e-5);
+  BOOST_REQUIRE_EQUAL(cc, cc2);
+  BOOST_REQUIRE_EQUAL(empty, empty2);
+}
+
+/**
+ * Matrices stored in the binary format should be loaded back exactly, along
+ * with the children of the model.
+ */
+BOOST_AUTO_TEST_CASE(SaveArmaMatBinary)
+{
+  arma::mat matrix = arma::randu<arma::mat>(7, 13);
+  arma::vec vector = arma::randn<arma::vec>(5);
+  arma::mat childMatrix = arma::randu<arma::mat>(3, 1);
+
+  SaveRestoreUtility sRM, child;
+  sRM.SaveParameter(ARGSTR(matrix));
+  sRM.SaveParameter(ARGSTR(vector));
+  child.SaveParameter(ARGSTR(childMatrix));
+  sRM.AddChild(child, "child");
+  BOOST_REQUIRE(sRM.WriteFile("test_arma_mat_type.bin"));
+
+  SaveRestoreUtility sRM2;
+  BOOST_REQUIRE(sRM2.ReadFile("test_arma_mat_type.bin"));
+  remove("test_arma_mat_type.bin");
+
+  BOOST_REQUIRE(sRM2.HasParameter("matrix"));
+  BOOST_REQUIRE(sRM2.HasParameter("vector"));
+  BOOST_REQUIRE(!sRM2.HasParameter("childMatrix"));
+
+  arma::mat matrix2;
+  arma::vec vector2;
+  arma::mat childMatrix2;
+  sRM2.LoadParameter(matrix2, "matrix");
+  sRM2.LoadParameter(vector2, "vector");
+  sRM2.Children().at("child").LoadParameter(childMatrix2, "childMatrix");
+
+  BOOST_REQUIRE_EQUAL(matrix2.n_rows, matrix.n_rows);
+  BOOST_REQUIRE_EQUAL(matrix2.n_cols, matrix.n_cols);
+  for (size_t j = 0; j < matrix.n_elem; ++j)
+    BOOST_REQUIRE_EQUAL(matrix[j], matrix2[j]);
+
+  BOOST_REQUIRE_EQUAL(vector2.n_elem, vector.n_elem);
+  for (size_t j = 0; j < vector.n_elem; ++j)
+    BOOST_REQUIRE_EQUAL(vector[j], vector2[j]);
+
+  BOOST_REQUIRE_EQUAL(childMatrix2.n_rows, childMatrix.n_rows);
+  BOOST_REQUIRE_EQUAL(childMatrix2.n_cols, childMatrix.n_cols);
+  for (size_t j = 0; j < childMatrix.n_elem; ++j)
+    BOOST_REQUIRE_EQUAL(childMatrix[j], childMatrix2[j]);
+}
+
+/**
+ * Saving a parameter with the name of an existing matrix must replace the
+ * matrix, so that only one of them is written.
+ */
+BOOST_AUTO_TEST_CASE(OverwriteMatrixParameter)
+{
+  arma::mat matrix = arma::randu<arma::mat>(5, 5);
+  std::string name = "a string";
+
+  SaveRestoreUtility sRM;
+  sRM.SaveParameter(matrix, "parameter");
+  sRM.SaveParameter(name, "parameter");
+  BOOST_REQUIRE(sRM.WriteFile("test_overwrite.bin"));
+
+  SaveRestoreUtility sRM2;
+  sRM2.SaveParameter(name, "parameter");
+  BOOST_REQUIRE(sRM2.WriteFile("test_overwrite2.bin"));
+
+  std::ifstream in("test_overwrite.bin", std::ios::binary | std::ios::ate);
+  std::ifstream in2("test_overwrite2.bin", std::ios::binary | std::ios::ate);
+  BOOST_REQUIRE_EQUAL((size_t) in.tellg(), (size_t) in2.tellg());
+  in.close();
+  in2.close();
+
+  SaveRestoreUtility sRM3;
+  BOOST_REQUIRE(sRM3.ReadFile("test_overwrite.bin"));
+  remove("test_overwrite.bin");
+  remove("test_overwrite2.bin");
+
+  std::string name2;
+  sRM3.LoadParameter(name2, "parameter");
+  BOOST_REQUIRE_EQUAL(name2, name);
+}
+
+/**
+ * Test converting an XML file to the binary format.
+ */
+BOOST_AUTO_TEST_CASE(ConvertXMLToBinary)
+{
+  arma::mat matrix;
+  matrix <<  1.2 << 2.3 << -0.1 << arma::endr
+         <<  3.5 << 2.4 << -1.2 << arma::endr;
+  size_t s = 1200;
+
+  SaveRestoreUtility sRM;
+  sRM.SaveParameter(ARGSTR(matrix));
+  sRM.SaveParameter(ARGSTR(s));
+  BOOST_REQUIRE(sRM.WriteFile("test_convert.xml"));
+
+  SaveRestoreUtility sRM2;
+  BOOST_REQUIRE(sRM2.ReadFile("test_convert.xml"));
+  BOOST_REQUIRE(sRM2.WriteFile("test_convert.bin"));
+
+  SaveRestoreUtility sRM3;
+  BOOST_REQUIRE(sRM3.ReadFile("test_convert.bin"));
+  remove("test_convert.xml");
+  remove("test_convert.bin");
+
+  arma::mat matrix2;
+  size_t s2 = 0;
+  sRM3.LoadParameter(matrix2, "matrix");
+  sRM3.LoadParameter(s2, "s");
+
+  BOOST_REQUIRE_EQUAL(s, s2);
+  BOOST_REQUIRE_EQUAL(matrix2.n_rows, matrix.n_rows);
+  BOOST_REQUIRE_EQUAL(matrix2.n_cols, matrix.n_cols);
+  for (size_t j = 0; j < matrix.n_elem; ++j)
+    BOOST_REQUIRE_CLOSE(matrix[j], matrix2[j], 1e-5);
+}
+
 /**
  * Test SaveRestoreModel proper usage in child classes and loading from
  *   separately defined objects
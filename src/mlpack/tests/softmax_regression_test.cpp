@@ -13,6 +13,7 @@
 using namespace mlpack;
 using namespace mlpack::regression;
 using namespace mlpack::distribution;
+using namespace mlpack::optimization;
 
 BOOST_AUTO_TEST_SUITE(SoftmaxRegressionTest);
 
@@ -33,7 +34,7 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionEvaluate)
     labels(i) = math::RandInt(0, numClasses);
 
   // Create a SoftmaxRegressionFunction. Regularization term ignored.
-  SoftmaxRegressionFunction srf(data, labels, inputSize, numClasses, 0);
+  SoftmaxRegressionFunction<> srf(data, labels, inputSize, numClasses, 0);
 
   // Run a number of trials.
   for(size_t i = 0; i < trials; i++)
@@ -78,9 +79,11 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionRegularizationEvaluate)
     labels(i) = math::RandInt(0, numClasses);
 
   // 3 objects for comparing regularization costs.
-  SoftmaxRegressionFunction srfNoReg(data, labels, inputSize, numClasses, 0);
-  SoftmaxRegressionFunction srfSmallReg(data, labels, inputSize, numClasses, 1);
-  SoftmaxRegressionFunction srfBigReg(data, labels, inputSize, numClasses, 20);
+  SoftmaxRegressionFunction<> srfNoReg(data, labels, inputSize, numClasses, 0);
+  SoftmaxRegressionFunction<> srfSmallReg(data, labels, inputSize, numClasses,
+      1);
+  SoftmaxRegressionFunction<> srfBigReg(data, labels, inputSize, numClasses,
+      20);
 
   // Run a number of trials.
   for (size_t i = 0; i < trials; i++)
@@ -120,8 +123,8 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionGradient)
 
   // 2 objects for 2 terms in the cost function. Each term contributes towards
   // the gradient and thus need to be checked independently.
-  SoftmaxRegressionFunction srf1(data, labels, inputSize, numClasses, 0);
-  SoftmaxRegressionFunction srf2(data, labels, inputSize, numClasses, 20);
+  SoftmaxRegressionFunction<> srf1(data, labels, inputSize, numClasses, 0);
+  SoftmaxRegressionFunction<> srf2(data, labels, inputSize, numClasses, 20);
 
   // Create a random set of parameters.
   arma::mat parameters;
@@ -166,6 +169,42 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionGradient)
   }
 }
 
+/**
+ * EvaluateWithGradient() gives the same results as Evaluate() and Gradient(),
+ * including when it is called again with the same workspace.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionEvaluateWithGradient)
+{
+  const size_t points = 1000;
+  const size_t inputSize = 10;
+  const size_t numClasses = 5;
+
+  arma::mat data;
+  data.randu(inputSize, points);
+
+  arma::vec labels(points);
+  for (size_t i = 0; i < points; i++)
+    labels(i) = math::RandInt(0, numClasses);
+
+  SoftmaxRegressionFunction<> srf(data, labels, inputSize, numClasses, 20);
+
+  for (size_t trial = 0; trial < 3; trial++)
+  {
+    arma::mat parameters;
+    parameters.randu(numClasses, inputSize);
+
+    arma::mat gradient, fusedGradient;
+    srf.Gradient(parameters, gradient);
+    BOOST_REQUIRE_CLOSE(srf.EvaluateWithGradient(parameters, fusedGradient),
+        srf.Evaluate(parameters), 1e-5);
+
+    BOOST_REQUIRE_EQUAL(fusedGradient.n_rows, gradient.n_rows);
+    BOOST_REQUIRE_EQUAL(fusedGradient.n_cols, gradient.n_cols);
+    for (size_t i = 0; i < gradient.n_elem; i++)
+      BOOST_REQUIRE_CLOSE(fusedGradient[i], gradient[i], 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(SoftmaxRegressionTwoClasses)
 {
   const size_t points = 1000;
@@ -298,4 +337,92 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionMultipleClasses)
   BOOST_REQUIRE_CLOSE(testAcc, 100.0, 2.0);
 }
 
+/**
+ * The sparse SoftmaxRegressionFunction gives the same results as the dense one
+ * on the same data.
+ */
+BOOST_AUTO_TEST_CASE(SparseSoftmaxRegressionFunctionTest)
+{
+  const size_t points = 500;
+  const size_t inputSize = 30;
+  const size_t numClasses = 4;
+
+  arma::sp_mat data;
+  data.sprandu(inputSize, points, 0.1);
+  const arma::mat denseData(data);
+
+  arma::vec labels(points);
+  for (size_t i = 0; i < points; i++)
+    labels(i) = math::RandInt(0, numClasses);
+
+  SoftmaxRegressionFunction<arma::sp_mat> sparseSrf(data, labels, inputSize,
+      numClasses, 0.5);
+  SoftmaxRegressionFunction<> srf(denseData, labels, inputSize, numClasses,
+      0.5);
+
+  for (size_t trial = 0; trial < 3; trial++)
+  {
+    arma::mat parameters;
+    parameters.randu(numClasses, inputSize);
+
+    BOOST_REQUIRE_CLOSE(sparseSrf.Evaluate(parameters),
+        srf.Evaluate(parameters), 1e-5);
+
+    arma::mat sparseGradient, gradient;
+    sparseSrf.Gradient(parameters, sparseGradient);
+    srf.Gradient(parameters, gradient);
+    BOOST_REQUIRE_EQUAL(sparseGradient.n_rows, gradient.n_rows);
+    BOOST_REQUIRE_EQUAL(sparseGradient.n_cols, gradient.n_cols);
+    for (size_t i = 0; i < gradient.n_elem; i++)
+      BOOST_REQUIRE_CLOSE(sparseGradient[i], gradient[i], 1e-5);
+
+    BOOST_REQUIRE_CLOSE(sparseSrf.EvaluateWithGradient(parameters,
+        sparseGradient), srf.Evaluate(parameters), 1e-5);
+    for (size_t i = 0; i < gradient.n_elem; i++)
+      BOOST_REQUIRE_CLOSE(sparseGradient[i], gradient[i], 1e-5);
+  }
+}
+
+/**
+ * Train softmax regression on sparse data, where each class has its own set of
+ * nonzero features.
+ */
+BOOST_AUTO_TEST_CASE(SparseSoftmaxRegressionTest)
+{
+  const size_t points = 1000;
+  const size_t inputSize = 90;
+  const size_t numClasses = 3;
+  const double lambda = 0.001;
+
+  arma::mat denseData(inputSize, points);
+  denseData.zeros();
+  arma::vec labels(points);
+  for (size_t i = 0; i < points; i++)
+  {
+    labels(i) = i % numClasses;
+    const size_t offset = (i % numClasses) * (inputSize / numClasses);
+    for (size_t k = 0; k < 5; k++)
+      denseData(offset + math::RandInt(0, inputSize / numClasses), i) =
+          math::Random(0.5, 1.5);
+  }
+  const arma::sp_mat data(denseData);
+
+  // Train softmax regression object.
+  SoftmaxRegression<L_BFGS, arma::sp_mat> sr(data, labels, inputSize,
+      numClasses, lambda);
+
+  // Compare training accuracy to 100.
+  const double acc = sr.ComputeAccuracy(data, labels);
+  BOOST_REQUIRE_CLOSE(acc, 100.0, 0.5);
+
+  // The dense model makes the same predictions.
+  SoftmaxRegression<> denseSr(denseData, labels, inputSize, numClasses,
+      lambda);
+  arma::vec predictions, densePredictions;
+  sr.Predict(data, predictions);
+  denseSr.Predict(denseData, densePredictions);
+  for (size_t i = 0; i < points; i++)
+    BOOST_REQUIRE_EQUAL(predictions(i), densePredictions(i));
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -263,4 +263,36 @@ BOOST_AUTO_TEST_CASE(SparseAutoencoderFunctionGradient)
   }
 }
 
+/**
+ * EvaluateWithGradient() gives the same results as Evaluate() and Gradient(),
+ * including when it is called again with the same workspace.
+ */
+BOOST_AUTO_TEST_CASE(SparseAutoencoderFunctionEvaluateWithGradient)
+{
+  const size_t points = 1000;
+  const size_t vSize = 20;
+  const size_t hSize = 10;
+
+  arma::mat data;
+  data.randu(vSize, points);
+
+  SparseAutoencoderFunction saf(data, vSize, hSize, 20, 20);
+
+  for (size_t trial = 0; trial < 3; trial++)
+  {
+    arma::mat parameters;
+    parameters.randu(2 * hSize + 1, vSize + 1);
+
+    arma::mat gradient, fusedGradient;
+    saf.Gradient(parameters, gradient);
+    BOOST_REQUIRE_CLOSE(saf.EvaluateWithGradient(parameters, fusedGradient),
+        saf.Evaluate(parameters), 1e-5);
+
+    BOOST_REQUIRE_EQUAL(fusedGradient.n_rows, gradient.n_rows);
+    BOOST_REQUIRE_EQUAL(fusedGradient.n_cols, gradient.n_cols);
+    for (size_t i = 0; i < gradient.n_elem; i++)
+      BOOST_REQUIRE_CLOSE(fusedGradient[i] + 1.0, gradient[i] + 1.0, 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -101,6 +101,34 @@ BOOST_AUTO_TEST_CASE(SparseCodingTestCodingStepElasticNet)
   }
 }
 
+BOOST_AUTO_TEST_CASE(SparseCodingTestCodingStepWarmStart)
+{
+  double lambda1 = 0.1;
+  uword nAtoms = 25;
+
+  mat X;
+  X.load("mnist_first250_training_4s_and_9s.arm");
+  uword nPoints = X.n_cols;
+
+  // Normalize each point since these are images.
+  for (uword i = 0; i < nPoints; ++i)
+    X.col(i) /= norm(X.col(i), 2);
+
+  SparseCoding<> sc(X, nAtoms, lambda1);
+  sc.OptimizeCode();
+  const mat coldCodes = sc.Codes();
+
+  // Warm-starting from the codes (or from slightly perturbed codes) should
+  // give the same codes.
+  sc.WarmStart() = true;
+  sc.OptimizeCode();
+  BOOST_REQUIRE_SMALL(norm(sc.Codes() - coldCodes, "fro"), 1e-8);
+
+  sc.Codes() += 0.01 * randn<mat>(nAtoms, nPoints);
+  sc.OptimizeCode();
+  BOOST_REQUIRE_SMALL(norm(sc.Codes() - coldCodes, "fro"), 1e-8);
+}
+
 BOOST_AUTO_TEST_CASE(SparseCodingTestDictionaryStep)
 {
   const double tol = 1e-6;
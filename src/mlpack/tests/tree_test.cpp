@@ -6,6 +6,7 @@
 #include <mlpack/core.hpp>
 #include <mlpack/core/tree/bounds.hpp>
 #include <mlpack/core/tree/binary_space_tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/binary_space_tree/mapped_tree.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/tree/cover_tree/cover_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
@@ -1881,6 +1882,94 @@ BOOST_AUTO_TEST_CASE(BinarySpaceTreeCopyConstructor)
   BOOST_REQUIRE_EQUAL(b.Right()->Right(), c.Right()->Right());
 }
 
+//! Check that two binary space trees have the same structure and bounds.
+template<typename TreeType>
+void CheckSameTree(const TreeType& a, const TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.Begin(), b.Begin());
+  BOOST_REQUIRE_EQUAL(a.Count(), b.Count());
+  BOOST_REQUIRE_EQUAL(a.SplitDimension(), b.SplitDimension());
+  BOOST_REQUIRE_CLOSE(a.ParentDistance(), b.ParentDistance(), 1e-5);
+  BOOST_REQUIRE_CLOSE(a.FurthestDescendantDistance(),
+      b.FurthestDescendantDistance(), 1e-5);
+  BOOST_REQUIRE_CLOSE(a.Bound().Diameter(), b.Bound().Diameter(), 1e-5);
+
+  arma::vec aCentroid, bCentroid;
+  a.Bound().Centroid(aCentroid);
+  b.Bound().Centroid(bCentroid);
+  for (size_t i = 0; i < aCentroid.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(aCentroid[i], bCentroid[i], 1e-5);
+
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(b.Child(i).Parent(), &b);
+    CheckSameTree(a.Child(i), b.Child(i));
+  }
+}
+
+/**
+ * Save a kd-tree with MappedTree, load it again, and make sure that the loaded
+ * tree and dataset are the same as what was saved.
+ */
+BOOST_AUTO_TEST_CASE(MappedTreeKDTreeTest)
+{
+  typedef BinarySpaceTree<HRectBound<2> > TreeType;
+
+  arma::mat dataset;
+  dataset.randu(4, 1000);
+  std::vector<size_t> oldFromNew;
+  TreeType tree(dataset, oldFromNew, 15);
+
+  BOOST_REQUIRE(MappedTree<TreeType>::Save(tree, oldFromNew,
+      "test-kd-tree.tree"));
+
+  {
+    MappedTree<TreeType> mappedTree("test-kd-tree.tree");
+
+    BOOST_REQUIRE_EQUAL(mappedTree.Dataset().n_rows, dataset.n_rows);
+    BOOST_REQUIRE_EQUAL(mappedTree.Dataset().n_cols, dataset.n_cols);
+    for (size_t i = 0; i < dataset.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(mappedTree.Dataset()[i], dataset[i]);
+
+    BOOST_REQUIRE_EQUAL(mappedTree.OldFromNew().size(), oldFromNew.size());
+    for (size_t i = 0; i < oldFromNew.size(); ++i)
+      BOOST_REQUIRE_EQUAL(mappedTree.OldFromNew()[i], oldFromNew[i]);
+
+    BOOST_REQUIRE_EQUAL(&mappedTree.Tree().Dataset(), &mappedTree.Dataset());
+    BOOST_REQUIRE_EQUAL(mappedTree.Tree().Parent(), (TreeType*) NULL);
+    CheckSameTree(tree, mappedTree.Tree());
+  }
+
+  remove("test-kd-tree.tree");
+}
+
+/**
+ * Save and load a ball tree with MappedTree.
+ */
+BOOST_AUTO_TEST_CASE(MappedTreeBallTreeTest)
+{
+  typedef BinarySpaceTree<BallBound<> > TreeType;
+
+  arma::mat dataset;
+  dataset.randu(3, 500);
+  std::vector<size_t> oldFromNew;
+  TreeType tree(dataset, oldFromNew, 10);
+
+  BOOST_REQUIRE(MappedTree<TreeType>::Save(tree, oldFromNew,
+      "test-ball-tree.tree"));
+
+  {
+    MappedTree<TreeType> mappedTree("test-ball-tree.tree");
+
+    for (size_t i = 0; i < dataset.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(mappedTree.Dataset()[i], dataset[i]);
+    CheckSameTree(tree, mappedTree.Tree());
+  }
+
+  remove("test-ball-tree.tree");
+}
+
 //! Count the number of leaves under this node.
 template<typename TreeType>
 size_t NumLeaves(TreeType* node)